@@ -69,8 +69,23 @@ enum
   ARG_DRC,
   ARG_MODE,
   ARG_LFE,
+  ARG_GAIN,
+  ARG_REPLAYGAIN,
+  ARG_STATS,
+  ARG_STATS_INTERVAL
 };
 
+/* counters of the stats property */
+enum
+{
+  STAT_FRAMES,
+  STAT_SYNC_LOSSES,
+  STAT_SKIPPED_BYTES
+};
+
+#define DEFAULT_GAIN 0.0
+#define DEFAULT_REPLAYGAIN FALSE
+
 static GstStaticPadTemplate sink_factory = GST_STATIC_PAD_TEMPLATE ("sink",
     GST_PAD_SINK,
     GST_PAD_ALWAYS,
@@ -95,10 +110,12 @@ static gboolean gst_a52dec_sink_event (GstPad * pad, GstEvent * event);
 static GstStateChangeReturn gst_a52dec_change_state (GstElement * element,
     GstStateChange transition);
 
+static void gst_a52dec_finalize (GObject * object);
 static void gst_a52dec_set_property (GObject * object, guint prop_id,
     const GValue * value, GParamSpec * pspec);
 static void gst_a52dec_get_property (GObject * object, guint prop_id,
     GValue * value, GParamSpec * pspec);
+static void gst_a52dec_update_gain (GstA52Dec * a52dec);
 
 #define GST_TYPE_A52DEC_MODE (gst_a52dec_mode_get_type())
 static GType
@@ -151,6 +168,7 @@ gst_a52dec_class_init (GstA52DecClass * klass)
 
   gobject_class->set_property = gst_a52dec_set_property;
   gobject_class->get_property = gst_a52dec_get_property;
+  gobject_class->finalize = gst_a52dec_finalize;
 
   gstelement_class->change_state = GST_DEBUG_FUNCPTR (gst_a52dec_change_state);
 
@@ -185,6 +203,44 @@ gst_a52dec_class_init (GstA52DecClass * klass)
   g_object_class_install_property (G_OBJECT_CLASS (klass), ARG_LFE,
       g_param_spec_boolean ("lfe", "LFE", "LFE", TRUE,
           G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
+  /**
+   * GstA52Dec::gain
+   *
+   * Gain in dB applied while interleaving the decoded samples. When a gain
+   * other than 0 dB is applied, the float output is clipped to the
+   * [-1.0, 1.0] range.
+   */
+  g_object_class_install_property (G_OBJECT_CLASS (klass), ARG_GAIN,
+      g_param_spec_double ("gain", "Gain", "Output gain in dB",
+          GST_DECODER_GAIN_MIN, GST_DECODER_GAIN_MAX, DEFAULT_GAIN,
+          G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
+  /**
+   * GstA52Dec::replaygain
+   *
+   * Add the ReplayGain from upstream tags to the gain property. Dynamic
+   * range compression is applied before the gain.
+   */
+  g_object_class_install_property (G_OBJECT_CLASS (klass), ARG_REPLAYGAIN,
+      g_param_spec_boolean ("replaygain", "ReplayGain",
+          "Apply the ReplayGain from upstream tags", DEFAULT_REPLAYGAIN,
+          G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
+  /**
+   * GstA52Dec::stats
+   *
+   * A structure named "a52dec-stats" with the number of frames found, the
+   * number of times sync was lost in the middle of the stream (not counting
+   * discontinuities signalled by upstream) and the bytes skipped to find the
+   * next frame, all counted since the element was created.
+   */
+  /**
+   * GstA52Dec::stats-interval
+   *
+   * When not 0, the stats are also posted as element message at this
+   * interval while data flows.
+   */
+  gst_stream_stats_install_properties (gobject_class, ARG_STATS,
+      "Frames, lost syncs and skipped bytes since creation",
+      ARG_STATS_INTERVAL);
 
   /* If no CPU instruction based acceleration is available, end up using the
    * generic software djbfft based one when available in the used liba52 */
@@ -233,9 +289,25 @@ gst_a52dec_init (GstA52Dec * a52dec, GstA52DecClass * g_class)
   a52dec->state = NULL;
   a52dec->samples = NULL;
 
+  gst_decoder_gain_init (&a52dec->output_gain);
+  a52dec->gain_factor = 1;
+
+  gst_stream_stats_init (&a52dec->stats, "a52dec-stats", "frames",
+      "sync-losses", "skipped-bytes", NULL);
+
   gst_segment_init (&a52dec->segment, GST_FORMAT_UNDEFINED);
 }
 
+static void
+gst_a52dec_finalize (GObject * object)
+{
+  GstA52Dec *a52dec = GST_A52DEC (object);
+
+  gst_stream_stats_clear (&a52dec->stats);
+
+  G_OBJECT_CLASS (parent_class)->finalize (object);
+}
+
 static gint
 gst_a52dec_channels (int flags, GstAudioChannelPosition ** _pos)
 {
@@ -372,6 +444,7 @@ gst_a52dec_push (GstA52Dec * a52dec,
 {
   GstBuffer *buf;
   int chans, n, c;
+  sample_t gain, *out;
   GstFlowReturn result;
 
   flags &= (A52_CHANNEL_MASK | A52_LFE);
@@ -388,10 +461,24 @@ gst_a52dec_push (GstA52Dec * a52dec,
   if (result != GST_FLOW_OK)
     return result;
 
-  for (n = 0; n < 256; n++) {
-    for (c = 0; c < chans; c++) {
-      ((sample_t *) GST_BUFFER_DATA (buf))[n * chans + c] =
-          samples[c * 256 + n];
+  GST_OBJECT_LOCK (a52dec);
+  gain = a52dec->gain_factor;
+  GST_OBJECT_UNLOCK (a52dec);
+
+  out = (sample_t *) GST_BUFFER_DATA (buf);
+  if (gain != 1) {
+    for (n = 0; n < 256; n++) {
+      for (c = 0; c < chans; c++) {
+        sample_t s = samples[c * 256 + n] * gain;
+
+        out[n * chans + c] = CLAMP (s, -1, 1);
+      }
+    }
+  } else {
+    for (n = 0; n < 256; n++) {
+      for (c = 0; c < chans; c++) {
+        out[n * chans + c] = samples[c * 256 + n];
+      }
     }
   }
 
@@ -504,9 +591,17 @@ gst_a52dec_sink_event (GstPad * pad, GstEvent * event)
           end, pos);
       break;
     }
-    case GST_EVENT_TAG:
+    case GST_EVENT_TAG:{
+      GstTagList *list;
+
+      gst_event_parse_tag (event, &list);
+      GST_OBJECT_LOCK (a52dec);
+      if (gst_decoder_gain_parse_tags (&a52dec->output_gain, list))
+        gst_a52dec_update_gain (a52dec);
+      GST_OBJECT_UNLOCK (a52dec);
       ret = gst_pad_push_event (a52dec->srcpad, event);
       break;
+    }
     case GST_EVENT_EOS:
       gst_a52dec_drain (a52dec);
       ret = gst_pad_push_event (a52dec->srcpad, event);
@@ -547,6 +642,15 @@ gst_a52dec_update_streaminfo (GstA52Dec * a52dec)
       GST_PAD (a52dec->srcpad), taglist);
 }
 
+/* call with the object lock */
+static void
+gst_a52dec_update_gain (GstA52Dec * a52dec)
+{
+  a52dec->gain_factor = gst_decoder_gain_get_factor (&a52dec->output_gain);
+  GST_DEBUG_OBJECT (a52dec, "output gain %.2f dB",
+      gst_decoder_gain_get_db (&a52dec->output_gain));
+}
+
 static GstFlowReturn
 gst_a52dec_handle_frame (GstA52Dec * a52dec, guint8 * data,
     guint length, gint flags, gint sample_rate, gint bit_rate)
@@ -701,6 +805,7 @@ gst_a52dec_chain (GstPad * pad, GstBuffer * buf)
       a52dec->cache = NULL;
     }
     a52dec->discont = TRUE;
+    a52dec->synced = FALSE;
   }
 
   if (a52dec->dvdmode) {
@@ -753,6 +858,7 @@ gst_a52dec_chain (GstPad * pad, GstBuffer * buf)
 
 done:
   gst_buffer_unref (buf);
+  gst_stream_stats_post (&a52dec->stats, GST_ELEMENT_CAST (a52dec));
   return ret;
 
 /* ERRORS */
@@ -779,6 +885,7 @@ gst_a52dec_chain_raw (GstPad * pad, GstBuffer * buf)
   guint8 *data;
   guint size;
   gint length = 0, flags, sample_rate, bit_rate;
+  guint skipped = 0;
   GstFlowReturn result = GST_FLOW_OK;
 
   a52dec = GST_A52DEC (GST_PAD_PARENT (pad));
@@ -824,10 +931,18 @@ gst_a52dec_chain_raw (GstPad * pad, GstBuffer * buf)
 
     if (length == 0) {
       /* no sync */
+      if (a52dec->synced) {
+        GST_DEBUG_OBJECT (a52dec, "lost sync");
+        gst_stream_stats_add (&a52dec->stats, STAT_SYNC_LOSSES, 1);
+        a52dec->synced = FALSE;
+      }
+      skipped++;
       data++;
       size--;
     } else if (length <= size) {
       GST_DEBUG ("Sync: %d", length);
+      a52dec->synced = TRUE;
+      gst_stream_stats_add (&a52dec->stats, STAT_FRAMES, 1);
 
       if (flags != a52dec->prev_flags)
         a52dec->flag_update = TRUE;
@@ -848,6 +963,9 @@ gst_a52dec_chain_raw (GstPad * pad, GstBuffer * buf)
     }
   }
 
+  if (skipped > 0)
+    gst_stream_stats_add (&a52dec->stats, STAT_SKIPPED_BYTES, skipped);
+
   /* keep cache */
   if (length == 0) {
     GST_LOG ("No sync found");
@@ -895,6 +1013,10 @@ gst_a52dec_change_state (GstElement * element, GstStateChange transition)
       a52dec->sent_segment = FALSE;
       a52dec->flag_update = TRUE;
       gst_segment_init (&a52dec->segment, GST_FORMAT_UNDEFINED);
+      GST_OBJECT_LOCK (a52dec);
+      gst_decoder_gain_reset (&a52dec->output_gain);
+      gst_a52dec_update_gain (a52dec);
+      GST_OBJECT_UNLOCK (a52dec);
       break;
     case GST_STATE_CHANGE_PAUSED_TO_PLAYING:
       break;
@@ -952,6 +1074,21 @@ gst_a52dec_set_property (GObject * object, guint prop_id, const GValue * value,
       src->request_channels |= g_value_get_boolean (value) ? A52_LFE : 0;
       GST_OBJECT_UNLOCK (src);
       break;
+    case ARG_GAIN:
+      GST_OBJECT_LOCK (src);
+      src->output_gain.gain = g_value_get_double (value);
+      gst_a52dec_update_gain (src);
+      GST_OBJECT_UNLOCK (src);
+      break;
+    case ARG_REPLAYGAIN:
+      GST_OBJECT_LOCK (src);
+      src->output_gain.replaygain = g_value_get_boolean (value);
+      gst_a52dec_update_gain (src);
+      GST_OBJECT_UNLOCK (src);
+      break;
+    case ARG_STATS_INTERVAL:
+      gst_stream_stats_set_interval (&src->stats, g_value_get_uint (value));
+      break;
     default:
       G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
       break;
@@ -980,6 +1117,22 @@ gst_a52dec_get_property (GObject * object, guint prop_id, GValue * value,
       g_value_set_boolean (value, src->request_channels & A52_LFE);
       GST_OBJECT_UNLOCK (src);
       break;
+    case ARG_GAIN:
+      GST_OBJECT_LOCK (src);
+      g_value_set_double (value, src->output_gain.gain);
+      GST_OBJECT_UNLOCK (src);
+      break;
+    case ARG_REPLAYGAIN:
+      GST_OBJECT_LOCK (src);
+      g_value_set_boolean (value, src->output_gain.replaygain);
+      GST_OBJECT_UNLOCK (src);
+      break;
+    case ARG_STATS:
+      g_value_take_boxed (value, gst_stream_stats_get (&src->stats));
+      break;
+    case ARG_STATS_INTERVAL:
+      g_value_set_uint (value, gst_stream_stats_get_interval (&src->stats));
+      break;
     default:
       G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
       break;
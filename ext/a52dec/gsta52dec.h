@@ -22,6 +22,8 @@
 #define __GST_A52DEC_H__
 
 #include <gst/gst.h>
+#include <gst/decodergain-private.h>
+#include <gst/streamstats-private.h>
 
 G_BEGIN_DECLS
 
@@ -71,6 +73,14 @@ struct _GstA52Dec {
 
   /* reverse */
   GList         *queued;
+
+  /* output gain, see the gain and replaygain properties */
+  GstDecoderGain output_gain;     /* with LOCK */
+  sample_t       gain_factor;     /* resulting factor, with LOCK */
+
+  /* stream health since creation, see the stats property */
+  gboolean       synced;          /* last data was a frame */
+  GstStreamStats stats;
 };
 
 struct _GstA52DecClass {
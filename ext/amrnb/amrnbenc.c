@@ -32,6 +32,11 @@
  * Please note that the above stream misses the header, that is needed to play
  * the stream.
  * </refsect2>
+ *
+ * With #GstAmrnbEnc:dtx enabled the encoder runs voice activity detection and
+ * only sends comfort noise updates (SID frames) and empty NO_DATA frames
+ * during silence. Every output frame still covers 20 ms, so timestamps and
+ * durations stay continuous.
  */
 
 #ifdef HAVE_CONFIG_H
@@ -66,12 +71,21 @@ gst_amrnbenc_bandmode_get_type (void)
 #define GST_AMRNBENC_BANDMODE_TYPE (gst_amrnbenc_bandmode_get_type())
 
 #define BANDMODE_DEFAULT MR122
+#define DTX_DEFAULT FALSE
 enum
 {
   PROP_0,
-  PROP_BANDMODE
+  PROP_BANDMODE,
+  PROP_DTX,
+  PROP_SPEECH_FRAMES,
+  PROP_SID_FRAMES,
+  PROP_NO_DATA_FRAMES
 };
 
+/* frame types in the first byte of a storage format frame */
+#define AMRNB_FT_SID     8
+#define AMRNB_FT_NO_DATA 15
+
 static GstStaticPadTemplate sink_template = GST_STATIC_PAD_TEMPLATE ("sink",
     GST_PAD_SINK,
     GST_PAD_ALWAYS,
@@ -112,6 +126,9 @@ gst_amrnbenc_set_property (GObject * object, guint prop_id,
     case PROP_BANDMODE:
       self->bandmode = g_value_get_enum (value);
       break;
+    case PROP_DTX:
+      self->dtx = g_value_get_boolean (value);
+      break;
     default:
       G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
       break;
@@ -129,6 +146,24 @@ gst_amrnbenc_get_property (GObject * object, guint prop_id,
     case PROP_BANDMODE:
       g_value_set_enum (value, self->bandmode);
       break;
+    case PROP_DTX:
+      g_value_set_boolean (value, self->dtx);
+      break;
+    case PROP_SPEECH_FRAMES:
+      GST_OBJECT_LOCK (self);
+      g_value_set_uint64 (value, self->speech_frames);
+      GST_OBJECT_UNLOCK (self);
+      break;
+    case PROP_SID_FRAMES:
+      GST_OBJECT_LOCK (self);
+      g_value_set_uint64 (value, self->sid_frames);
+      GST_OBJECT_UNLOCK (self);
+      break;
+    case PROP_NO_DATA_FRAMES:
+      GST_OBJECT_LOCK (self);
+      g_value_set_uint64 (value, self->no_data_frames);
+      GST_OBJECT_UNLOCK (self);
+      break;
     default:
       G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
       break;
@@ -170,6 +205,23 @@ gst_amrnbenc_class_init (GstAmrnbEncClass * klass)
           "Encoding Band Mode (Kbps)", GST_AMRNBENC_BANDMODE_TYPE,
           BANDMODE_DEFAULT,
           G_PARAM_READWRITE | G_PARAM_CONSTRUCT | G_PARAM_STATIC_STRINGS));
+  g_object_class_install_property (object_class, PROP_DTX,
+      g_param_spec_boolean ("dtx", "DTX",
+          "Enable voice activity detection and discontinuous transmission "
+          "(takes effect when the encoder starts)", DTX_DEFAULT,
+          G_PARAM_READWRITE | G_PARAM_CONSTRUCT | G_PARAM_STATIC_STRINGS));
+  g_object_class_install_property (object_class, PROP_SPEECH_FRAMES,
+      g_param_spec_uint64 ("speech-frames", "Speech frames",
+          "Number of fully encoded frames", 0, G_MAXUINT64, 0,
+          G_PARAM_READABLE | G_PARAM_STATIC_STRINGS));
+  g_object_class_install_property (object_class, PROP_SID_FRAMES,
+      g_param_spec_uint64 ("sid-frames", "SID frames",
+          "Number of silence descriptor frames produced with DTX", 0,
+          G_MAXUINT64, 0, G_PARAM_READABLE | G_PARAM_STATIC_STRINGS));
+  g_object_class_install_property (object_class, PROP_NO_DATA_FRAMES,
+      g_param_spec_uint64 ("no-data-frames", "NO_DATA frames",
+          "Number of empty frames produced during silence with DTX", 0,
+          G_MAXUINT64, 0, G_PARAM_READABLE | G_PARAM_STATIC_STRINGS));
 
   GST_DEBUG_CATEGORY_INIT (gst_amrnbenc_debug, "amrnbenc", 0,
       "AMR-NB audio encoder");
@@ -185,11 +237,17 @@ gst_amrnbenc_start (GstAudioEncoder * enc)
 {
   GstAmrnbEnc *amrnbenc = GST_AMRNBENC (enc);
 
-  GST_DEBUG_OBJECT (amrnbenc, "start");
+  GST_DEBUG_OBJECT (amrnbenc, "start, dtx %d", amrnbenc->dtx);
 
-  if (!(amrnbenc->handle = Encoder_Interface_init (0)))
+  if (!(amrnbenc->handle = Encoder_Interface_init (amrnbenc->dtx ? 1 : 0)))
     return FALSE;
 
+  GST_OBJECT_LOCK (amrnbenc);
+  amrnbenc->speech_frames = 0;
+  amrnbenc->sid_frames = 0;
+  amrnbenc->no_data_frames = 0;
+  GST_OBJECT_UNLOCK (amrnbenc);
+
   return TRUE;
 }
 
@@ -281,10 +339,23 @@ gst_amrnbenc_handle_frame (GstAudioEncoder * enc, GstBuffer * buffer)
   GST_LOG_OBJECT (amrnbenc, "output data size %d", outsize);
 
   if (outsize) {
+    guint ft = (GST_BUFFER_DATA (out)[0] >> 3) & 0x0f;
+
+    /* with DTX, silence gives SID and NO_DATA frames. They still stand for
+     * 160 samples, so the base class keeps timestamps going */
+    GST_OBJECT_LOCK (amrnbenc);
+    if (ft == AMRNB_FT_NO_DATA)
+      amrnbenc->no_data_frames++;
+    else if (ft == AMRNB_FT_SID)
+      amrnbenc->sid_frames++;
+    else
+      amrnbenc->speech_frames++;
+    GST_OBJECT_UNLOCK (amrnbenc);
+
     GST_BUFFER_SIZE (out) = outsize;
     ret = gst_audio_encoder_finish_frame (enc, out, 160);
   } else {
-    /* should not happen (without dtx or so at least) */
+    /* should not happen, even NO_DATA frames have a header byte */
     GST_WARNING_OBJECT (amrnbenc, "no encoded data; discarding input");
     gst_buffer_unref (out);
     ret = gst_audio_encoder_finish_frame (enc, NULL, -1);
@@ -52,6 +52,12 @@ struct _GstAmrnbEnc {
 
   /* property */
   enum Mode bandmode;
+  gboolean dtx;
+
+  /* statistics, protected by the object lock */
+  guint64 speech_frames;
+  guint64 sid_frames;
+  guint64 no_data_frames;
 };
 
 struct _GstAmrnbEncClass {
@@ -30,9 +30,20 @@
 #include <unistd.h>
 #include <string.h>
 #include <errno.h>
+#include <fcntl.h>
+#include <sys/stat.h>
+#ifdef HAVE_SYS_MMAN_H
+#include <sys/mman.h>
+#endif
+
+#include <glib/gstdio.h>
 
 #include "dvdreadsrc.h"
 
+#ifdef HAVE_DVDREAD_DVD_UDF_H
+#include <dvdread/dvd_udf.h>
+#endif
+
 #include <gst/gst-i18n-plugin.h>
 
 GST_DEBUG_CATEGORY_STATIC (gstgst_dvd_read_src_debug);
@@ -46,9 +57,38 @@ enum
   ARG_DEVICE,
   ARG_TITLE,
   ARG_CHAPTER,
-  ARG_ANGLE
+  ARG_ANGLE,
+  ARG_CACHE_SIZE,
+  ARG_CACHE_HITS,
+  ARG_CACHE_MISSES,
+  ARG_MMAP,
+  ARG_PREWARM_KEYS
 };
 
+#define DEFAULT_CACHE_SIZE 0
+#define DEFAULT_MMAP TRUE
+#define DEFAULT_PREWARM_KEYS FALSE
+
+typedef struct
+{
+  gint64 key;
+  GstBuffer *buf;
+  GList link;
+} GstDvdReadCacheEntry;
+
+typedef struct
+{
+  guint first_sector;           /* in the title set VOBs */
+  guint n_sectors;
+  GstBuffer *buf;               /* covers the whole mapping */
+} GstDvdReadMap;
+
+typedef struct
+{
+  gpointer addr;
+  gsize size;
+} GstDvdReadMapping;
+
 static GstStaticPadTemplate srctemplate = GST_STATIC_PAD_TEMPLATE ("src",
     GST_PAD_SRC,
     GST_PAD_ALWAYS,
@@ -85,6 +125,10 @@ static gint gst_dvd_read_src_get_next_cell (GstDvdReadSrc * src,
     pgc_t * pgc, gint cell);
 static GstClockTime gst_dvd_read_src_get_time_for_sector (GstDvdReadSrc * src,
     guint sector);
+static void gst_dvd_read_src_cache_clear (GstDvdReadSrc * src);
+static void gst_dvd_read_src_map_title_set (GstDvdReadSrc * src,
+    gint title_set_nr);
+static void gst_dvd_read_src_unmap_title_set (GstDvdReadSrc * src);
 static gint gst_dvd_read_src_get_sector_from_time (GstDvdReadSrc * src,
     GstClockTime ts);
 
@@ -112,6 +156,14 @@ gst_dvd_read_src_finalize (GObject * object)
   g_free (src->location);
   g_free (src->last_uri);
 
+  gst_dvd_read_src_cache_clear (src);
+  g_hash_table_destroy (src->cache);
+
+  gst_dvd_read_src_unmap_title_set (src);
+  g_ptr_array_free (src->maps, TRUE);
+
+  g_mutex_free (src->css_lock);
+
   G_OBJECT_CLASS (parent_class)->finalize (object);
 }
 
@@ -135,6 +187,19 @@ gst_dvd_read_src_init (GstDvdReadSrc * src, GstDvdReadSrcClass * klass)
   src->title_lang_event_pending = NULL;
   src->pending_clut_event = NULL;
 
+  src->cache = g_hash_table_new (g_int64_hash, g_int64_equal);
+  g_queue_init (&src->cache_lru);
+  src->cache_used = 0;
+  src->cache_size = DEFAULT_CACHE_SIZE;
+
+  src->use_mmap = DEFAULT_MMAP;
+  src->maps = g_ptr_array_new ();
+
+  src->prewarm_keys = DEFAULT_PREWARM_KEYS;
+  src->prewarm_thread = NULL;
+  src->prewarm_location = NULL;
+  src->css_lock = g_mutex_new ();
+
   gst_pad_use_fixed_caps (GST_BASE_SRC_PAD (src));
   gst_pad_set_caps (GST_BASE_SRC_PAD (src),
       gst_static_pad_template_get_caps (&srctemplate));
@@ -170,6 +235,57 @@ gst_dvd_read_src_class_init (GstDvdReadSrcClass * klass)
   g_object_class_install_property (G_OBJECT_CLASS (klass), ARG_ANGLE,
       g_param_spec_int ("angle", "angle", "angle",
           1, 999, 1, G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
+  /**
+   * GstDvdReadSrc:cache-size
+   *
+   * Maximum number of bytes of already read VOBUs to keep in memory. Menus
+   * and still frames often loop over the same cells, repeated reads are then
+   * served from memory without accessing (and descrambling) the disc
+   * again. A few MiB are enough for typical menus. 0, the default, disables
+   * the cache.
+   */
+  g_object_class_install_property (G_OBJECT_CLASS (klass), ARG_CACHE_SIZE,
+      g_param_spec_uint64 ("cache-size", "Cache size",
+          "Maximum memory used for caching sectors in bytes (0 = disabled)",
+          0, G_MAXUINT64, DEFAULT_CACHE_SIZE,
+          G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
+  g_object_class_install_property (G_OBJECT_CLASS (klass), ARG_CACHE_HITS,
+      g_param_spec_uint64 ("cache-hits", "Cache hits",
+          "Number of VOBUs served from the sector cache",
+          0, G_MAXUINT64, 0, G_PARAM_READABLE | G_PARAM_STATIC_STRINGS));
+  g_object_class_install_property (G_OBJECT_CLASS (klass), ARG_CACHE_MISSES,
+      g_param_spec_uint64 ("cache-misses", "Cache misses",
+          "Number of VOBUs that had to be read from the disc",
+          0, G_MAXUINT64, 0, G_PARAM_READABLE | G_PARAM_STATIC_STRINGS));
+  /**
+   * GstDvdReadSrc:mmap
+   *
+   * When the device is an image file or a VIDEO_TS directory, memory-map the
+   * VOBs of the title set and output VOBUs as sub-buffers of the mapping
+   * instead of reading them into newly allocated buffers. Encrypted discs are
+   * detected on the first scrambled sector and read through libdvdread
+   * again, which decrypts them, and so are files shorter than the title set
+   * libdvdread reports. Only used on 64 bit systems. Takes effect when the
+   * next title is opened.
+   */
+  g_object_class_install_property (G_OBJECT_CLASS (klass), ARG_MMAP,
+      g_param_spec_boolean ("mmap", "mmap",
+          "Memory-map unencrypted DVD images and directories", DEFAULT_MMAP,
+          G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
+  /**
+   * GstDvdReadSrc:prewarm-keys
+   *
+   * Opening a title set of an encrypted disc makes libdvdcss retrieve its
+   * title key, which stalls the first read after a title change for up to a
+   * few seconds. When set, the VOBs of all title sets are opened once in a
+   * background thread after the disc is opened. This uses a second reader,
+   * so it only helps when the libdvdcss key cache (DVDCSS_CACHE) is enabled,
+   * which is the default.
+   */
+  g_object_class_install_property (G_OBJECT_CLASS (klass), ARG_PREWARM_KEYS,
+      g_param_spec_boolean ("prewarm-keys", "Prewarm keys",
+          "Retrieve the CSS keys of all title sets in the background",
+          DEFAULT_PREWARM_KEYS, G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
 
   gstbasesrc_class->start = GST_DEBUG_FUNCPTR (gst_dvd_read_src_start);
   gstbasesrc_class->stop = GST_DEBUG_FUNCPTR (gst_dvd_read_src_stop);
@@ -182,10 +298,102 @@ gst_dvd_read_src_class_init (GstDvdReadSrcClass * klass)
   gstpushsrc_class->create = GST_DEBUG_FUNCPTR (gst_dvd_read_src_create);
 }
 
+/* libdvdread handles can't be used from two threads and locking the
+ * streaming thread's handle would stall playback while the keys are fetched,
+ * so this runs on a second reader and the keys reach the streaming reader
+ * through the libdvdcss key cache.
+ *
+ * Both readers authenticate with the same drive. libdvdcss does not
+ * coordinate its instances and a drive only has a few authentication
+ * sessions, so the DVDOpen() here and every title set DVDOpenFile() on
+ * either reader are done with css_lock held. The streaming reader's own
+ * DVDOpen() finished before this thread started. The lock is dropped between
+ * title sets, so a title change waits for at most one key. Reading blocks
+ * needs no authentication and is not serialized. */
+static gpointer
+gst_dvd_read_src_prewarm_thread (GstDvdReadSrc * src)
+{
+  dvd_reader_t *dvd;
+  dvd_file_t *file;
+  GstClockTime start;
+  gint i;
+
+  start = gst_util_get_timestamp ();
+
+  g_mutex_lock (src->css_lock);
+  dvd = DVDOpen (src->prewarm_location);
+  g_mutex_unlock (src->css_lock);
+
+  if (dvd == NULL) {
+    GST_WARNING_OBJECT (src, "DVDOpen(%s) failed, not prewarming keys",
+        src->prewarm_location);
+    return NULL;
+  }
+
+  for (i = 1; i <= src->prewarm_title_sets; i++) {
+    if (g_atomic_int_get (&src->prewarm_cancel))
+      break;
+
+    g_mutex_lock (src->css_lock);
+    if ((file = DVDOpenFile (dvd, i, DVD_READ_TITLE_VOBS)))
+      DVDCloseFile (file);
+    g_mutex_unlock (src->css_lock);
+  }
+  DVDClose (dvd);
+
+  GST_DEBUG_OBJECT (src, "prewarmed keys of %d title sets in %" GST_TIME_FORMAT,
+      i - 1, GST_TIME_ARGS (gst_util_get_timestamp () - start));
+
+  return NULL;
+}
+
+static void
+gst_dvd_read_src_start_prewarm (GstDvdReadSrc * src)
+{
+  GError *err = NULL;
+
+  /* the thread gets its own copies, the streaming thread owns the VMG */
+  g_atomic_int_set (&src->prewarm_cancel, 0);
+  src->prewarm_location = g_strdup (src->location);
+  src->prewarm_title_sets = src->vmg_file->vmgi_mat->vts_nr;
+
+#if GLIB_CHECK_VERSION (2, 31, 0)
+  src->prewarm_thread = g_thread_try_new ("dvdreadsrc-prewarm",
+      (GThreadFunc) gst_dvd_read_src_prewarm_thread, src, &err);
+#else
+  src->prewarm_thread =
+      g_thread_create ((GThreadFunc) gst_dvd_read_src_prewarm_thread, src,
+      TRUE, &err);
+#endif
+  if (src->prewarm_thread == NULL) {
+    GST_WARNING_OBJECT (src, "could not start prewarming keys: %s",
+        err->message);
+    g_error_free (err);
+    g_free (src->prewarm_location);
+    src->prewarm_location = NULL;
+  }
+}
+
+static void
+gst_dvd_read_src_stop_prewarm (GstDvdReadSrc * src)
+{
+  if (src->prewarm_thread == NULL)
+    return;
+
+  /* stop after the current title set and wait for the thread */
+  g_atomic_int_set (&src->prewarm_cancel, 1);
+  g_thread_join (src->prewarm_thread);
+  src->prewarm_thread = NULL;
+
+  g_free (src->prewarm_location);
+  src->prewarm_location = NULL;
+}
+
 static gboolean
 gst_dvd_read_src_start (GstBaseSrc * basesrc)
 {
   GstDvdReadSrc *src = GST_DVD_READ_SRC (basesrc);
+  gboolean prewarm_keys;
 
   g_return_val_if_fail (src->location != NULL, FALSE);
 
@@ -202,6 +410,12 @@ gst_dvd_read_src_start (GstBaseSrc * basesrc)
 
   src->tt_srpt = src->vmg_file->tt_srpt;
 
+  GST_OBJECT_LOCK (src);
+  src->cache_hits = 0;
+  src->cache_misses = 0;
+  prewarm_keys = src->prewarm_keys;
+  GST_OBJECT_UNLOCK (src);
+
   src->title = src->uri_title - 1;
   src->chapter = src->uri_chapter - 1;
   src->angle = src->uri_angle - 1;
@@ -212,6 +426,11 @@ gst_dvd_read_src_start (GstBaseSrc * basesrc)
   if (!gst_dvd_read_src_goto_chapter (src, src->chapter))
     goto chapter_open_failed;
 
+  /* after opening the first title, so its own key is not delayed by the
+   * prewarming */
+  if (prewarm_keys)
+    gst_dvd_read_src_start_prewarm (src);
+
   src->new_seek = FALSE;
   src->change_cell = TRUE;
 
@@ -252,6 +471,8 @@ gst_dvd_read_src_stop (GstBaseSrc * basesrc)
 {
   GstDvdReadSrc *src = GST_DVD_READ_SRC (basesrc);
 
+  gst_dvd_read_src_stop_prewarm (src);
+
   if (src->vts_file) {
     ifoClose (src->vts_file);
     src->vts_file = NULL;
@@ -287,6 +508,9 @@ gst_dvd_read_src_stop (GstBaseSrc * basesrc)
     g_free (src->chapter_starts);
     src->chapter_starts = NULL;
   }
+  /* might be a different disc next time */
+  gst_dvd_read_src_cache_clear (src);
+  gst_dvd_read_src_unmap_title_set (src);
 
   GST_LOG_OBJECT (src, "closed DVD");
 
@@ -471,10 +695,15 @@ gst_dvd_read_src_goto_title (GstDvdReadSrc * src, gint title, gint angle)
     goto commands_only_pgc;
   }
 
-  /* we've got enough info, time to open the title set data */
+  /* we've got enough info, time to open the title set data. This fetches
+   * the title key on encrypted discs, see the prewarm thread */
+  g_mutex_lock (src->css_lock);
   src->dvd_title = DVDOpenFile (src->dvd, title_set_nr, DVD_READ_TITLE_VOBS);
+  g_mutex_unlock (src->css_lock);
   if (src->dvd_title == NULL)
     goto title_open_failed;
+  src->title_set_nr = title_set_nr;
+  gst_dvd_read_src_map_title_set (src, title_set_nr);
 
   GST_INFO_OBJECT (src, "Opened title %d, angle %d", title + 1, angle);
   src->title = title;
@@ -719,6 +948,356 @@ gst_dvd_read_src_get_sector_from_time (GstDvdReadSrc * src, GstClockTime ts)
   return -1;
 }
 
+/* dvdreadsrc only opens the title VOBs (DVD_READ_TITLE_VOBS) of a title set,
+ * so the title set and the first sector identify a VOBU */
+#define CACHE_KEY(src,sector) \
+  (((gint64) (src)->title_set_nr << 32) | (guint32) (sector))
+
+static void
+gst_dvd_read_src_cache_free_entry (GstDvdReadSrc * src,
+    GstDvdReadCacheEntry * entry)
+{
+  g_queue_unlink (&src->cache_lru, &entry->link);
+  g_hash_table_remove (src->cache, &entry->key);
+  src->cache_used -= GST_BUFFER_SIZE (entry->buf);
+  gst_buffer_unref (entry->buf);
+  g_slice_free (GstDvdReadCacheEntry, entry);
+}
+
+/* drop least recently used entries until at most @limit bytes are used */
+static void
+gst_dvd_read_src_cache_trim (GstDvdReadSrc * src, guint64 limit)
+{
+  while (src->cache_used > limit) {
+    GList *last = g_queue_peek_tail_link (&src->cache_lru);
+
+    GST_LOG_OBJECT (src, "evicting VOBU @ pack %u from cache",
+        (guint) ((GstDvdReadCacheEntry *) last->data)->key);
+    gst_dvd_read_src_cache_free_entry (src, last->data);
+  }
+}
+
+static void
+gst_dvd_read_src_cache_clear (GstDvdReadSrc * src)
+{
+  gst_dvd_read_src_cache_trim (src, 0);
+}
+
+static GstBuffer *
+gst_dvd_read_src_cache_lookup (GstDvdReadSrc * src, gint sector)
+{
+  GstDvdReadCacheEntry *entry;
+  gint64 key = CACHE_KEY (src, sector);
+  guint64 limit;
+
+  GST_OBJECT_LOCK (src);
+  limit = src->cache_size;
+  GST_OBJECT_UNLOCK (src);
+
+  /* a smaller cache-size applies from the next read on */
+  gst_dvd_read_src_cache_trim (src, limit);
+
+  entry = g_hash_table_lookup (src->cache, &key);
+  if (entry == NULL)
+    return NULL;
+
+  /* move to the front */
+  g_queue_unlink (&src->cache_lru, &entry->link);
+  g_queue_push_head_link (&src->cache_lru, &entry->link);
+
+  return entry->buf;
+}
+
+static void
+gst_dvd_read_src_cache_insert (GstDvdReadSrc * src, gint sector,
+    GstBuffer * buf)
+{
+  GstDvdReadCacheEntry *entry;
+  gint64 key = CACHE_KEY (src, sector);
+  guint64 limit;
+
+  GST_OBJECT_LOCK (src);
+  limit = src->cache_size;
+  if (limit > 0)
+    src->cache_misses++;
+  GST_OBJECT_UNLOCK (src);
+
+  entry = g_hash_table_lookup (src->cache, &key);
+  if (entry)
+    gst_dvd_read_src_cache_free_entry (src, entry);
+
+  if (GST_BUFFER_SIZE (buf) > limit) {
+    gst_dvd_read_src_cache_trim (src, limit);
+    return;
+  }
+
+  gst_dvd_read_src_cache_trim (src, limit - GST_BUFFER_SIZE (buf));
+
+  entry = g_slice_new (GstDvdReadCacheEntry);
+  entry->key = key;
+  entry->buf = gst_buffer_ref (buf);
+  entry->link.data = entry;
+  entry->link.prev = entry->link.next = NULL;
+  g_hash_table_insert (src->cache, &entry->key, entry);
+  g_queue_push_head_link (&src->cache_lru, &entry->link);
+  src->cache_used += GST_BUFFER_SIZE (buf);
+}
+
+#ifdef HAVE_SYS_MMAN_H
+static void
+gst_dvd_read_src_mapping_free (GstDvdReadMapping * mapping)
+{
+  munmap (mapping->addr, mapping->size);
+  g_slice_free (GstDvdReadMapping, mapping);
+}
+
+/* maps @size bytes at @offset of @filename into a buffer that unmaps them
+ * when the last sub-buffer is gone. Fails if the file is shorter than that,
+ * touching a page past its end would raise SIGBUS */
+static GstBuffer *
+gst_dvd_read_src_map_file (GstDvdReadSrc * src, const gchar * filename,
+    guint64 offset, guint64 size)
+{
+  GstDvdReadMapping *mapping;
+  GstBuffer *buf;
+  struct stat st;
+  gpointer addr;
+  guint64 delta;
+  gint fd;
+
+  fd = g_open (filename, O_RDONLY, 0);
+  if (fd < 0)
+    goto open_failed;
+
+  if (fstat (fd, &st) < 0 || st.st_size < 0 ||
+      offset + size > (guint64) st.st_size)
+    goto too_short;
+
+  /* the offset of a mapping has to be page aligned */
+  delta = offset % sysconf (_SC_PAGESIZE);
+  addr = mmap (NULL, size + delta, PROT_READ, MAP_SHARED, fd, offset - delta);
+  close (fd);
+  if (addr == MAP_FAILED)
+    goto mmap_failed;
+
+#ifdef HAVE_MADVISE
+  madvise (addr, size + delta, MADV_SEQUENTIAL);
+#endif
+
+  mapping = g_slice_new (GstDvdReadMapping);
+  mapping->addr = addr;
+  mapping->size = size + delta;
+
+  buf = gst_buffer_new ();
+  GST_BUFFER_DATA (buf) = (guint8 *) addr + delta;
+  GST_BUFFER_SIZE (buf) = size;
+  GST_BUFFER_MALLOCDATA (buf) = (guint8 *) mapping;
+  GST_BUFFER_FREE_FUNC (buf) = (GFreeFunc) gst_dvd_read_src_mapping_free;
+
+  return buf;
+
+  /* ERRORS */
+open_failed:
+  {
+    GST_DEBUG_OBJECT (src, "could not open %s: %s", filename,
+        g_strerror (errno));
+    return NULL;
+  }
+too_short:
+  {
+    GST_DEBUG_OBJECT (src, "%s has less than %" G_GUINT64_FORMAT " bytes at %"
+        G_GUINT64_FORMAT, filename, size, offset);
+    close (fd);
+    return NULL;
+  }
+mmap_failed:
+  {
+    GST_DEBUG_OBJECT (src, "could not map %s: %s", filename,
+        g_strerror (errno));
+    return NULL;
+  }
+}
+
+/* finds VTS_XX_N.VOB in a VIDEO_TS directory or the directory above */
+static gchar *
+gst_dvd_read_src_find_vob (const gchar * dir, gint title_set_nr, gint part)
+{
+  const gchar *subdirs[] = { "VIDEO_TS", "video_ts", "" };
+  gchar *names[2], *path = NULL;
+  guint i, j;
+
+  names[0] = g_strdup_printf ("VTS_%02d_%d.VOB", title_set_nr, part);
+  names[1] = g_ascii_strdown (names[0], -1);
+
+  for (i = 0; i < G_N_ELEMENTS (subdirs) && path == NULL; i++) {
+    for (j = 0; j < G_N_ELEMENTS (names) && path == NULL; j++) {
+      path = g_build_filename (dir, subdirs[i], names[j], NULL);
+      if (!g_file_test (path, G_FILE_TEST_IS_REGULAR)) {
+        g_free (path);
+        path = NULL;
+      }
+    }
+  }
+  g_free (names[0]);
+  g_free (names[1]);
+
+  return path;
+}
+
+static void
+gst_dvd_read_src_add_map (GstDvdReadSrc * src, guint first_sector,
+    guint n_sectors, GstBuffer * buf)
+{
+  GstDvdReadMap *map;
+
+  map = g_slice_new (GstDvdReadMap);
+  map->first_sector = first_sector;
+  map->n_sectors = n_sectors;
+  map->buf = buf;
+  g_ptr_array_add (src->maps, map);
+}
+#endif /* HAVE_SYS_MMAN_H */
+
+static void
+gst_dvd_read_src_unmap_title_set (GstDvdReadSrc * src)
+{
+  guint i;
+
+  for (i = 0; i < src->maps->len; i++) {
+    GstDvdReadMap *map = g_ptr_array_index (src->maps, i);
+
+    /* sub-buffers downstream keep their part mapped */
+    gst_buffer_unref (map->buf);
+    g_slice_free (GstDvdReadMap, map);
+  }
+  g_ptr_array_set_size (src->maps, 0);
+}
+
+static void
+gst_dvd_read_src_map_title_set (GstDvdReadSrc * src, gint title_set_nr)
+{
+#ifdef HAVE_SYS_MMAN_H
+  GstBuffer *buf;
+  gboolean use_mmap;
+  guint n_sectors;
+
+  gst_dvd_read_src_unmap_title_set (src);
+
+  GST_OBJECT_LOCK (src);
+  use_mmap = src->use_mmap;
+  GST_OBJECT_UNLOCK (src);
+
+  /* all VOBs of a title set easily exhaust a 32 bit address space */
+  if (!use_mmap || GLIB_SIZEOF_VOID_P < 8)
+    return;
+
+#if defined (HAVE_DVDREAD_DVD_UDF_H) && defined (HAVE_UDFFINDFILE)
+  if (g_file_test (src->location, G_FILE_TEST_IS_REGULAR)) {
+    gchar name[32];
+    uint32_t lb, size;
+    ssize_t blocks;
+
+    /* an image, libdvdread also expects the title VOBs to be contiguous */
+    g_snprintf (name, sizeof (name), "/VIDEO_TS/VTS_%02d_1.VOB",
+        title_set_nr);
+    lb = UDFFindFile (src->dvd, name, &size);
+    blocks = DVDFileSize (src->dvd_title);
+    if (lb == 0 || blocks <= 0)
+      return;
+    n_sectors = blocks;
+
+    buf = gst_dvd_read_src_map_file (src, src->location,
+        (guint64) lb * DVD_VIDEO_LB_LEN, (guint64) n_sectors * DVD_VIDEO_LB_LEN);
+    if (buf == NULL)
+      return;
+    gst_dvd_read_src_add_map (src, 0, n_sectors, buf);
+  } else
+#endif
+  if (g_file_test (src->location, G_FILE_TEST_IS_DIR)) {
+    guint first_sector = 0;
+    ssize_t blocks;
+    gint part;
+
+    /* a title set is split into files of at most 1GB */
+    for (part = 1; part <= 9; part++) {
+      struct stat st;
+      gchar *path;
+
+      path = gst_dvd_read_src_find_vob (src->location, title_set_nr, part);
+      if (path == NULL)
+        break;
+
+      buf = NULL;
+      if (g_stat (path, &st) == 0) {
+        n_sectors = st.st_size / DVD_VIDEO_LB_LEN;
+        if (n_sectors > 0)
+          buf = gst_dvd_read_src_map_file (src, path, 0,
+              (guint64) n_sectors * DVD_VIDEO_LB_LEN);
+      }
+      g_free (path);
+
+      if (buf == NULL) {
+        gst_dvd_read_src_unmap_title_set (src);
+        return;
+      }
+      gst_dvd_read_src_add_map (src, first_sector, n_sectors, buf);
+      first_sector += n_sectors;
+    }
+
+    /* libdvdread numbers the sectors of the title set the same way only if
+     * it sees the same files */
+    blocks = DVDFileSize (src->dvd_title);
+    if (src->maps->len > 0 && (blocks < 0 || first_sector != blocks)) {
+      GST_DEBUG_OBJECT (src, "mapped %u sectors, libdvdread has %"
+          G_GSSIZE_FORMAT, first_sector, (gssize) blocks);
+      gst_dvd_read_src_unmap_title_set (src);
+    }
+  }
+
+  if (src->maps->len > 0) {
+    GST_INFO_OBJECT (src, "mapped VOBs of title set %d in %u parts",
+        title_set_nr, src->maps->len);
+  }
+#endif
+}
+
+/* returns the mapping with @n_sectors sectors at @sector, or NULL if they are
+ * not mapped or don't lie in the same file */
+static GstDvdReadMap *
+gst_dvd_read_src_find_map (GstDvdReadSrc * src, guint sector, guint n_sectors)
+{
+  guint i;
+
+  for (i = 0; i < src->maps->len; i++) {
+    GstDvdReadMap *map = g_ptr_array_index (src->maps, i);
+
+    if (sector >= map->first_sector &&
+        sector - map->first_sector < map->n_sectors) {
+      if (sector - map->first_sector + n_sectors > map->n_sectors)
+        return NULL;
+      return map;
+    }
+  }
+
+  return NULL;
+}
+
+/* checks the PES scrambling control bits of the first packet in each
+ * sector, like libdvdcss does */
+static gboolean
+gst_dvd_read_src_is_scrambled (const guint8 * data, guint n_sectors)
+{
+  guint i;
+
+  for (i = 0; i < n_sectors; i++) {
+    if (data[0x14] & 0x30)
+      return TRUE;
+    data += DVD_VIDEO_LB_LEN;
+  }
+
+  return FALSE;
+}
+
 typedef enum
 {
   GST_DVD_READ_OK = 0,
@@ -731,9 +1310,11 @@ static GstDvdReadReturn
 gst_dvd_read_src_read (GstDvdReadSrc * src, gint angle, gint new_seek,
     GstBuffer ** p_buf)
 {
-  GstBuffer *buf;
+  GstBuffer *buf, *cached;
+  GstDvdReadMap *map;
   GstSegment *seg;
   guint8 oneblock[DVD_VIDEO_LB_LEN];
+  const guint8 *navblock;
   dsi_t dsi_pack;
   guint next_vobu, cur_output_size;
   gint len;
@@ -803,11 +1384,22 @@ again:
 nav_retry:
   retries++;
 
-  len = DVDReadBlocks (src->dvd_title, src->cur_pack, 1, oneblock);
-  if (len != 1)
-    goto read_error;
+  /* VOBUs in the cache always start with their NAV packet */
+  cached = gst_dvd_read_src_cache_lookup (src, src->cur_pack);
+  map = gst_dvd_read_src_find_map (src, src->cur_pack, 1);
+  if (cached) {
+    navblock = GST_BUFFER_DATA (cached);
+  } else if (map) {
+    navblock = GST_BUFFER_DATA (map->buf) +
+        (src->cur_pack - map->first_sector) * DVD_VIDEO_LB_LEN;
+  } else {
+    len = DVDReadBlocks (src->dvd_title, src->cur_pack, 1, oneblock);
+    if (len != 1)
+      goto read_error;
+    navblock = oneblock;
+  }
 
-  if (!gst_dvd_read_src_is_nav_pack (oneblock, src->cur_pack, &dsi_pack)) {
+  if (!gst_dvd_read_src_is_nav_pack (navblock, src->cur_pack, &dsi_pack)) {
     GST_LOG_OBJECT (src, "Skipping nav packet @ pack %d", src->cur_pack);
     src->cur_pack++;
 
@@ -840,26 +1432,61 @@ nav_retry:
 
   g_assert (cur_output_size < 1024);
 
-  /* create the buffer (TODO: use buffer pool?) */
-  buf = gst_buffer_new_and_alloc (cur_output_size * DVD_VIDEO_LB_LEN);
+  map = gst_dvd_read_src_find_map (src, src->cur_pack, cur_output_size);
+  if (map && gst_dvd_read_src_is_scrambled (GST_BUFFER_DATA (map->buf) +
+          (src->cur_pack - map->first_sector) * DVD_VIDEO_LB_LEN,
+          cur_output_size)) {
+    /* libdvdread decrypts, don't map this title set anymore */
+    GST_INFO_OBJECT (src, "scrambled sectors @ pack %d, not using mmap",
+        src->cur_pack);
+    gst_dvd_read_src_unmap_title_set (src);
+    map = NULL;
+  }
 
-  GST_LOG_OBJECT (src, "Going to read %u sectors @ pack %d", cur_output_size,
-      src->cur_pack);
+  if (cached && GST_BUFFER_SIZE (cached) == cur_output_size * DVD_VIDEO_LB_LEN) {
+    GST_LOG_OBJECT (src, "Using %u cached sectors @ pack %d", cur_output_size,
+        src->cur_pack);
 
-  /* read in and output cursize packs */
-  len = DVDReadBlocks (src->dvd_title, src->cur_pack, cur_output_size,
-      GST_BUFFER_DATA (buf));
+    GST_OBJECT_LOCK (src);
+    src->cache_hits++;
+    GST_OBJECT_UNLOCK (src);
+
+    buf = gst_buffer_make_metadata_writable (gst_buffer_ref (cached));
+  } else if (map) {
+    GST_LOG_OBJECT (src, "Using %u mapped sectors @ pack %d",
+        cur_output_size, src->cur_pack);
 
-  if (len != cur_output_size)
-    goto block_read_error;
+    buf = gst_buffer_create_sub (map->buf,
+        (src->cur_pack - map->first_sector) * DVD_VIDEO_LB_LEN,
+        cur_output_size * DVD_VIDEO_LB_LEN);
+  } else {
+    /* create the buffer (TODO: use buffer pool?) */
+    buf = gst_buffer_new_and_alloc (cur_output_size * DVD_VIDEO_LB_LEN);
+
+    GST_LOG_OBJECT (src, "Going to read %u sectors @ pack %d",
+        cur_output_size, src->cur_pack);
 
-  GST_BUFFER_SIZE (buf) = cur_output_size * DVD_VIDEO_LB_LEN;
+    /* read in and output cursize packs */
+    len = DVDReadBlocks (src->dvd_title, src->cur_pack, cur_output_size,
+        GST_BUFFER_DATA (buf));
+
+    if (len != cur_output_size)
+      goto block_read_error;
+
+    GST_BUFFER_SIZE (buf) = cur_output_size * DVD_VIDEO_LB_LEN;
+    cached = NULL;
+  }
   /* GST_BUFFER_OFFSET (buf) = priv->cur_pack * DVD_VIDEO_LB_LEN; */
   GST_BUFFER_TIMESTAMP (buf) =
       gst_dvd_read_src_get_time_for_sector (src, src->cur_pack);
 
   gst_buffer_set_caps (buf, GST_PAD_CAPS (GST_BASE_SRC_PAD (src)));
 
+  /* the buffer is not metadata writable anymore once it is in the cache,
+   * mapped sectors are cached by the kernel already */
+  if (cached == NULL && map == NULL)
+    gst_dvd_read_src_cache_insert (src, src->cur_pack, buf);
+
   *p_buf = buf;
 
   GST_LOG_OBJECT (src, "Read %u sectors", cur_output_size);
@@ -1030,6 +1657,17 @@ gst_dvd_read_src_set_property (GObject * object, guint prop_id,
         src->angle = src->uri_angle - 1;
       }
       break;
+    case ARG_CACHE_SIZE:
+      /* the streaming thread owns the cache and trims it on the next read */
+      src->cache_size = g_value_get_uint64 (value);
+      break;
+    case ARG_MMAP:
+      src->use_mmap = g_value_get_boolean (value);
+      break;
+    case ARG_PREWARM_KEYS:
+      /* read under the lock in start(), used when the device is opened next */
+      src->prewarm_keys = g_value_get_boolean (value);
+      break;
     default:
       G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
       break;
@@ -1059,6 +1697,21 @@ gst_dvd_read_src_get_property (GObject * object, guint prop_id, GValue * value,
     case ARG_ANGLE:
       g_value_set_int (value, src->uri_angle);
       break;
+    case ARG_CACHE_SIZE:
+      g_value_set_uint64 (value, src->cache_size);
+      break;
+    case ARG_CACHE_HITS:
+      g_value_set_uint64 (value, src->cache_hits);
+      break;
+    case ARG_CACHE_MISSES:
+      g_value_set_uint64 (value, src->cache_misses);
+      break;
+    case ARG_MMAP:
+      g_value_set_boolean (value, src->use_mmap);
+      break;
+    case ARG_PREWARM_KEYS:
+      g_value_set_boolean (value, src->prewarm_keys);
+      break;
     default:
       G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
       break;
@@ -88,6 +88,34 @@ struct _GstDvdReadSrc {
   gboolean         need_newsegment;
   GstEvent        *title_lang_event_pending;
   GstEvent        *pending_clut_event;
+
+  /* LRU cache of VOBUs read from the disc, for menus and still frames that
+   * loop over the same cells. Keyed by title set and first sector. The cache
+   * itself is only used from the streaming thread, and from start/stop */
+  gint             title_set_nr;
+  GHashTable      *cache;
+  GQueue           cache_lru;     /* most recently used first */
+  guint64          cache_used;    /* bytes in the cache */
+  guint64          cache_size;    /* with LOCK: maximum bytes in the cache */
+  guint64          cache_hits;    /* with LOCK */
+  guint64          cache_misses;  /* with LOCK */
+
+  /* memory mapped VOBs of the current title set when reading an unencrypted
+   * image or VIDEO_TS directory, see the mmap property */
+  gboolean         use_mmap;      /* with LOCK */
+  GPtrArray       *maps;          /* GstDvdReadMap, in sector order */
+
+  /* opens the VOBs of all title sets in the background on a separate reader
+   * to fill the libdvdcss key cache, see the prewarm-keys property */
+  gboolean         prewarm_keys;  /* with LOCK */
+  GThread         *prewarm_thread;
+  gchar           *prewarm_location;
+  gint             prewarm_title_sets;
+  volatile gint    prewarm_cancel;
+
+  /* held while either reader opens the disc or a title set, so the CSS
+   * authentication with the drive of the two readers never interleaves */
+  GMutex          *css_lock;
 };
 
 struct _GstDvdReadSrcClass {
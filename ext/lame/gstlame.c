@@ -118,40 +118,38 @@ GST_STATIC_PAD_TEMPLATE ("src",
         "channels = (int) [ 1, 2 ]")
     );
 
-static struct
-{
-  gint bitrate;
-  gfloat compression_ratio;
-  gint quality;
-  gint mode;
-  gboolean force_ms;
-  gboolean free_format;
-  gboolean copyright;
-  gboolean original;
-  gboolean error_protection;
-  gboolean extension;
-  gboolean strict_iso;
-  gboolean disable_reservoir;
-  gint vbr;
-  gint vbr_quality;
-  gint vbr_mean_bitrate;
-  gint vbr_min_bitrate;
-  gint vbr_max_bitrate;
-  gint vbr_hard_min;
-  gint lowpass_freq;
-  gint lowpass_width;
-  gint highpass_freq;
-  gint highpass_width;
-  gboolean ath_only;
-  gboolean ath_short;
-  gboolean no_ath;
-  gint ath_type;
-  gint ath_lower;
-  gboolean allow_diff_short;
-  gboolean no_short_blocks;
-  gboolean emphasis;
-  gint preset;
-} gst_lame_default_settings;
+/* what lame_init () and lame_init_params () give for 44.1 kHz stereo input,
+ * tests/check/elements/lame.c checks them against the installed LAME */
+#define DEFAULT_BITRATE 128
+#define DEFAULT_COMPRESSION_RATIO 0.0
+#define DEFAULT_QUALITY 3
+#define DEFAULT_MODE 1          /* joint stereo */
+#define DEFAULT_FORCE_MS FALSE
+#define DEFAULT_FREE_FORMAT FALSE
+#define DEFAULT_COPYRIGHT FALSE
+#define DEFAULT_ORIGINAL TRUE
+#define DEFAULT_ERROR_PROTECTION FALSE
+#define DEFAULT_EXTENSION FALSE
+#define DEFAULT_STRICT_ISO FALSE
+#define DEFAULT_DISABLE_RESERVOIR FALSE
+#define DEFAULT_VBR vbr_off
+#define DEFAULT_VBR_QUALITY 4
+#define DEFAULT_VBR_MEAN_BITRATE 128
+#define DEFAULT_VBR_MIN_BITRATE 0
+#define DEFAULT_VBR_MAX_BITRATE 0
+#define DEFAULT_VBR_HARD_MIN 0
+#define DEFAULT_LOWPASS_FREQ 17000
+#define DEFAULT_LOWPASS_WIDTH -1
+#define DEFAULT_HIGHPASS_FREQ 0
+#define DEFAULT_HIGHPASS_WIDTH -1
+#define DEFAULT_ATH_ONLY FALSE
+#define DEFAULT_ATH_SHORT FALSE
+#define DEFAULT_NO_ATH FALSE
+#define DEFAULT_ATH_LOWER 0
+#define DEFAULT_ALLOW_DIFF_SHORT FALSE
+#define DEFAULT_NO_SHORT_BLOCKS FALSE
+#define DEFAULT_EMPHASIS FALSE
+#define DEFAULT_PRESET 0
 
 /********** Define useful types for non-programmatic interfaces **********/
 #define GST_TYPE_LAME_MODE (gst_lame_mode_get_type())
@@ -387,45 +385,45 @@ gst_lame_class_init (GstLameClass * klass)
       g_param_spec_int ("bitrate", "Bitrate (kb/s)",
           "Bitrate in kbit/sec (8, 16, 24, 32, 40, 48, 56, 64, 80, 96, "
           "112, 128, 160, 192, 224, 256 or 320)",
-          0, 320, gst_lame_default_settings.bitrate,
+          0, 320, DEFAULT_BITRATE,
           G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
   /* compression ratio set to 0.0 by default otherwise it overrides the bitrate setting */
   g_object_class_install_property (G_OBJECT_CLASS (klass),
       ARG_COMPRESSION_RATIO, g_param_spec_float ("compression-ratio",
           "Compression Ratio",
           "let lame choose bitrate to achieve selected compression ratio", 0.0,
-          200.0, gst_lame_default_settings.compression_ratio,
+          200.0, DEFAULT_COMPRESSION_RATIO,
           G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
   g_object_class_install_property (G_OBJECT_CLASS (klass), ARG_QUALITY,
       g_param_spec_enum ("quality", "Quality",
           "Quality of algorithm used for encoding", GST_TYPE_LAME_QUALITY,
-          gst_lame_default_settings.quality,
+          DEFAULT_QUALITY,
           G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
   g_object_class_install_property (G_OBJECT_CLASS (klass), ARG_MODE,
       g_param_spec_enum ("mode", "Mode", "Encoding mode", GST_TYPE_LAME_MODE,
-          gst_lame_default_settings.mode,
+          DEFAULT_MODE,
           G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
   g_object_class_install_property (G_OBJECT_CLASS (klass), ARG_FORCE_MS,
       g_param_spec_boolean ("force-ms", "Force ms",
-          "Force ms_stereo on all frames", gst_lame_default_settings.force_ms,
+          "Force ms_stereo on all frames", DEFAULT_FORCE_MS,
           G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
   g_object_class_install_property (G_OBJECT_CLASS (klass), ARG_FREE_FORMAT,
       g_param_spec_boolean ("free-format", "Free format",
           "Produce a free format bitstream",
-          gst_lame_default_settings.free_format,
+          DEFAULT_FREE_FORMAT,
           G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
   g_object_class_install_property (G_OBJECT_CLASS (klass), ARG_COPYRIGHT,
       g_param_spec_boolean ("copyright", "Copyright", "Mark as copyright",
-          gst_lame_default_settings.copyright,
+          DEFAULT_COPYRIGHT,
           G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
   g_object_class_install_property (G_OBJECT_CLASS (klass), ARG_ORIGINAL,
       g_param_spec_boolean ("original", "Original", "Mark as original",
-          gst_lame_default_settings.original,
+          DEFAULT_ORIGINAL,
           G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
   g_object_class_install_property (G_OBJECT_CLASS (klass), ARG_ERROR_PROTECTION,
       g_param_spec_boolean ("error-protection", "Error protection",
           "Adds 16 bit checksum to every frame",
-          gst_lame_default_settings.error_protection,
+          DEFAULT_ERROR_PROTECTION,
           G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
   g_object_class_install_property (G_OBJECT_CLASS (klass), ARG_PADDING_TYPE,
       g_param_spec_enum ("padding-type", "Padding type",
@@ -434,7 +432,7 @@ gst_lame_class_init (GstLameClass * klass)
           G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
   g_object_class_install_property (G_OBJECT_CLASS (klass), ARG_EXTENSION,
       g_param_spec_boolean ("extension", "Extension", "Extension",
-          gst_lame_default_settings.extension,
+          DEFAULT_EXTENSION,
           G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
   g_object_class_install_property (G_OBJECT_CLASS (klass), ARG_STRICT_ISO,
       g_param_spec_boolean ("strict-iso", "Strict ISO",
@@ -446,73 +444,73 @@ gst_lame_class_init (GstLameClass * klass)
           G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
   g_object_class_install_property (G_OBJECT_CLASS (klass), ARG_VBR,
       g_param_spec_enum ("vbr", "VBR", "Specify bitrate mode",
-          GST_TYPE_LAME_VBRMODE, gst_lame_default_settings.vbr,
+          GST_TYPE_LAME_VBRMODE, DEFAULT_VBR,
           G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
   g_object_class_install_property (G_OBJECT_CLASS (klass), ARG_VBR_QUALITY,
       g_param_spec_enum ("vbr-quality", "VBR Quality", "VBR Quality",
-          GST_TYPE_LAME_QUALITY, gst_lame_default_settings.vbr_quality,
+          GST_TYPE_LAME_QUALITY, DEFAULT_VBR_QUALITY,
           G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
   g_object_class_install_property (G_OBJECT_CLASS (klass), ARG_VBR_MEAN_BITRATE,
       g_param_spec_int ("vbr-mean-bitrate", "VBR mean bitrate",
           "Specify mean VBR bitrate", 0, 320,
-          gst_lame_default_settings.vbr_mean_bitrate,
+          DEFAULT_VBR_MEAN_BITRATE,
           G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
   g_object_class_install_property (G_OBJECT_CLASS (klass), ARG_VBR_MIN_BITRATE,
       g_param_spec_int ("vbr-min-bitrate", "VBR min bitrate",
           "Specify minimum VBR bitrate (8, 16, 24, 32, 40, 48, 56, 64, 80, 96, "
           "112, 128, 160, 192, 224, 256 or 320)", 0, 320,
-          gst_lame_default_settings.vbr_min_bitrate,
+          DEFAULT_VBR_MIN_BITRATE,
           G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
   g_object_class_install_property (G_OBJECT_CLASS (klass), ARG_VBR_MAX_BITRATE,
       g_param_spec_int ("vbr-max-bitrate", "VBR max bitrate",
           "Specify maximum VBR bitrate (8, 16, 24, 32, 40, 48, 56, 64, 80, 96, "
           "112, 128, 160, 192, 224, 256 or 320)", 0, 320,
-          gst_lame_default_settings.vbr_max_bitrate,
+          DEFAULT_VBR_MAX_BITRATE,
           G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
   g_object_class_install_property (G_OBJECT_CLASS (klass), ARG_VBR_HARD_MIN,
       g_param_spec_int ("vbr-hard-min", "VBR hard min",
           "Specify whether min VBR bitrate is a hard limit. Normally, "
           "it can be violated for silence", 0, 1,
-          gst_lame_default_settings.vbr_hard_min,
+          DEFAULT_VBR_HARD_MIN,
           G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
   g_object_class_install_property (G_OBJECT_CLASS (klass), ARG_LOWPASS_FREQ,
       g_param_spec_int ("lowpass-freq", "Lowpass freq",
           "frequency(kHz), lowpass filter cutoff above freq", 0, 50000,
-          gst_lame_default_settings.lowpass_freq,
+          DEFAULT_LOWPASS_FREQ,
           G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
   g_object_class_install_property (G_OBJECT_CLASS (klass), ARG_LOWPASS_WIDTH,
       g_param_spec_int ("lowpass-width", "Lowpass width",
           "frequency(kHz) - default 15% of lowpass freq", -1, G_MAXINT,
-          gst_lame_default_settings.lowpass_width,
+          DEFAULT_LOWPASS_WIDTH,
           G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
   g_object_class_install_property (G_OBJECT_CLASS (klass), ARG_HIGHPASS_FREQ,
       g_param_spec_int ("highpass-freq", "Highpass freq",
           "frequency(kHz), highpass filter cutoff below freq", 0, 50000,
-          gst_lame_default_settings.highpass_freq,
+          DEFAULT_HIGHPASS_FREQ,
           G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
   g_object_class_install_property (G_OBJECT_CLASS (klass), ARG_HIGHPASS_WIDTH,
       g_param_spec_int ("highpass-width", "Highpass width",
           "frequency(kHz) - default 15% of highpass freq", -1, G_MAXINT,
-          gst_lame_default_settings.highpass_width,
+          DEFAULT_HIGHPASS_WIDTH,
           G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
   g_object_class_install_property (G_OBJECT_CLASS (klass), ARG_ATH_ONLY,
       g_param_spec_boolean ("ath-only", "ATH only",
           "Ignore GPSYCHO completely, use ATH only",
-          gst_lame_default_settings.ath_only,
+          DEFAULT_ATH_ONLY,
           G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
   g_object_class_install_property (G_OBJECT_CLASS (klass), ARG_ATH_SHORT,
       g_param_spec_boolean ("ath-short", "ATH short",
           "Ignore GPSYCHO for short blocks, use ATH only",
-          gst_lame_default_settings.ath_short,
+          DEFAULT_ATH_SHORT,
           G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
   g_object_class_install_property (G_OBJECT_CLASS (klass), ARG_NO_ATH,
       g_param_spec_boolean ("no-ath", "No ath",
           "turns ATH down to a flat noise floor",
-          gst_lame_default_settings.no_ath,
+          DEFAULT_NO_ATH,
           G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
   g_object_class_install_property (G_OBJECT_CLASS (klass), ARG_ATH_LOWER,
       g_param_spec_int ("ath-lower", "ATH lower", "lowers ATH by x dB",
-          G_MININT, G_MAXINT, gst_lame_default_settings.ath_lower,
+          G_MININT, G_MAXINT, DEFAULT_ATH_LOWER,
           G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
   g_object_class_install_property (G_OBJECT_CLASS (klass), ARG_CWLIMIT,
       g_param_spec_int ("cwlimit", "Cwlimit",
@@ -521,15 +519,15 @@ gst_lame_class_init (GstLameClass * klass)
           G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
   g_object_class_install_property (G_OBJECT_CLASS (klass), ARG_ALLOW_DIFF_SHORT,
       g_param_spec_boolean ("allow-diff-short", "Allow diff short",
-          "Allow diff short", gst_lame_default_settings.allow_diff_short,
+          "Allow diff short", DEFAULT_ALLOW_DIFF_SHORT,
           G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
   g_object_class_install_property (G_OBJECT_CLASS (klass), ARG_NO_SHORT_BLOCKS,
       g_param_spec_boolean ("no-short-blocks", "No short blocks",
-          "Do not use short blocks", gst_lame_default_settings.no_short_blocks,
+          "Do not use short blocks", DEFAULT_NO_SHORT_BLOCKS,
           G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
   g_object_class_install_property (G_OBJECT_CLASS (klass), ARG_EMPHASIS,
       g_param_spec_boolean ("emphasis", "Emphasis", "Emphasis",
-          gst_lame_default_settings.emphasis,
+          DEFAULT_EMPHASIS,
           G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
   g_object_class_install_property (G_OBJECT_CLASS (klass), ARG_XINGHEADER,
       g_param_spec_boolean ("xingheader", "Output Xing Header",
@@ -538,7 +536,7 @@ gst_lame_class_init (GstLameClass * klass)
 #ifdef GSTLAME_PRESET
   g_object_class_install_property (G_OBJECT_CLASS (klass), ARG_PRESET,
       g_param_spec_enum ("preset", "Lame Preset", "Lame Preset",
-          GST_TYPE_LAME_PRESET, gst_lame_default_settings.preset,
+          GST_TYPE_LAME_PRESET, DEFAULT_PRESET,
           G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
 #endif
 }
@@ -624,37 +622,37 @@ gst_lame_init (GstLame * lame, GstLameClass * klass)
   GST_DEBUG_OBJECT (lame, "starting initialization");
 
   /* Set default settings */
-  lame->bitrate = gst_lame_default_settings.bitrate;
-  lame->compression_ratio = gst_lame_default_settings.compression_ratio;
-  lame->quality = gst_lame_default_settings.quality;
-  lame->mode = gst_lame_default_settings.mode;
+  lame->bitrate = DEFAULT_BITRATE;
+  lame->compression_ratio = DEFAULT_COMPRESSION_RATIO;
+  lame->quality = DEFAULT_QUALITY;
+  lame->mode = DEFAULT_MODE;
   lame->requested_mode = lame->mode;
-  lame->force_ms = gst_lame_default_settings.force_ms;
-  lame->free_format = gst_lame_default_settings.free_format;
-  lame->copyright = gst_lame_default_settings.copyright;
-  lame->original = gst_lame_default_settings.original;
-  lame->error_protection = gst_lame_default_settings.error_protection;
-  lame->extension = gst_lame_default_settings.extension;
-  lame->strict_iso = gst_lame_default_settings.strict_iso;
-  lame->disable_reservoir = gst_lame_default_settings.disable_reservoir;
-  lame->vbr = gst_lame_default_settings.vbr;
-  lame->vbr_quality = gst_lame_default_settings.vbr_quality;
-  lame->vbr_mean_bitrate = gst_lame_default_settings.vbr_mean_bitrate;
-  lame->vbr_min_bitrate = gst_lame_default_settings.vbr_min_bitrate;
-  lame->vbr_max_bitrate = gst_lame_default_settings.vbr_max_bitrate;
-  lame->vbr_hard_min = gst_lame_default_settings.vbr_hard_min;
-  lame->lowpass_freq = gst_lame_default_settings.lowpass_freq;
-  lame->lowpass_width = gst_lame_default_settings.lowpass_width;
-  lame->highpass_freq = gst_lame_default_settings.highpass_freq;
-  lame->highpass_width = gst_lame_default_settings.highpass_width;
-  lame->ath_only = gst_lame_default_settings.ath_only;
-  lame->ath_short = gst_lame_default_settings.ath_short;
-  lame->no_ath = gst_lame_default_settings.no_ath;
-  lame->ath_lower = gst_lame_default_settings.ath_lower;
-  lame->allow_diff_short = gst_lame_default_settings.allow_diff_short;
-  lame->no_short_blocks = gst_lame_default_settings.no_short_blocks;
-  lame->emphasis = gst_lame_default_settings.emphasis;
-  lame->preset = gst_lame_default_settings.preset;
+  lame->force_ms = DEFAULT_FORCE_MS;
+  lame->free_format = DEFAULT_FREE_FORMAT;
+  lame->copyright = DEFAULT_COPYRIGHT;
+  lame->original = DEFAULT_ORIGINAL;
+  lame->error_protection = DEFAULT_ERROR_PROTECTION;
+  lame->extension = DEFAULT_EXTENSION;
+  lame->strict_iso = DEFAULT_STRICT_ISO;
+  lame->disable_reservoir = DEFAULT_DISABLE_RESERVOIR;
+  lame->vbr = DEFAULT_VBR;
+  lame->vbr_quality = DEFAULT_VBR_QUALITY;
+  lame->vbr_mean_bitrate = DEFAULT_VBR_MEAN_BITRATE;
+  lame->vbr_min_bitrate = DEFAULT_VBR_MIN_BITRATE;
+  lame->vbr_max_bitrate = DEFAULT_VBR_MAX_BITRATE;
+  lame->vbr_hard_min = DEFAULT_VBR_HARD_MIN;
+  lame->lowpass_freq = DEFAULT_LOWPASS_FREQ;
+  lame->lowpass_width = DEFAULT_LOWPASS_WIDTH;
+  lame->highpass_freq = DEFAULT_HIGHPASS_FREQ;
+  lame->highpass_width = DEFAULT_HIGHPASS_WIDTH;
+  lame->ath_only = DEFAULT_ATH_ONLY;
+  lame->ath_short = DEFAULT_ATH_SHORT;
+  lame->no_ath = DEFAULT_NO_ATH;
+  lame->ath_lower = DEFAULT_ATH_LOWER;
+  lame->allow_diff_short = DEFAULT_ALLOW_DIFF_SHORT;
+  lame->no_short_blocks = DEFAULT_NO_SHORT_BLOCKS;
+  lame->emphasis = DEFAULT_EMPHASIS;
+  lame->preset = DEFAULT_PRESET;
 
   GST_DEBUG_OBJECT (lame, "done initializing");
 }
@@ -1386,71 +1384,11 @@ gst_lame_setup (GstLame * lame)
 #undef CHECK_ERROR
 }
 
-static gboolean
-gst_lame_get_default_settings (void)
-{
-  lame_global_flags *lgf = NULL;
-
-  lgf = lame_init ();
-  if (lgf == NULL) {
-    GST_ERROR ("Error initializing LAME");
-    return FALSE;
-  }
-
-  if (lame_init_params (lgf) < 0) {
-    GST_ERROR ("Error getting default settings");
-    return FALSE;
-  }
-
-  gst_lame_default_settings.bitrate = lame_get_brate (lgf);
-  gst_lame_default_settings.compression_ratio = 0.0;    /* lame_get_compression_ratio (lgf); */
-  gst_lame_default_settings.quality = lame_get_quality (lgf);
-  gst_lame_default_settings.mode = lame_get_mode (lgf);
-  gst_lame_default_settings.force_ms = lame_get_force_ms (lgf);
-  gst_lame_default_settings.free_format = lame_get_free_format (lgf);
-  gst_lame_default_settings.copyright = lame_get_copyright (lgf);
-  gst_lame_default_settings.original = lame_get_original (lgf);
-  gst_lame_default_settings.error_protection = lame_get_error_protection (lgf);
-  gst_lame_default_settings.extension = lame_get_extension (lgf);
-  gst_lame_default_settings.strict_iso = lame_get_strict_ISO (lgf);
-  gst_lame_default_settings.disable_reservoir =
-      lame_get_disable_reservoir (lgf);
-  gst_lame_default_settings.vbr = lame_get_VBR (lgf);
-  gst_lame_default_settings.vbr_quality = lame_get_VBR_q (lgf);
-  gst_lame_default_settings.vbr_mean_bitrate =
-      lame_get_VBR_mean_bitrate_kbps (lgf);
-  gst_lame_default_settings.vbr_min_bitrate =
-      lame_get_VBR_min_bitrate_kbps (lgf);
-  gst_lame_default_settings.vbr_max_bitrate =
-      lame_get_VBR_max_bitrate_kbps (lgf);
-  gst_lame_default_settings.vbr_hard_min = lame_get_VBR_hard_min (lgf);
-  gst_lame_default_settings.lowpass_freq = lame_get_lowpassfreq (lgf);
-  gst_lame_default_settings.lowpass_width = lame_get_lowpasswidth (lgf);
-  gst_lame_default_settings.highpass_freq = lame_get_highpassfreq (lgf);
-  gst_lame_default_settings.highpass_width = lame_get_highpasswidth (lgf);
-  gst_lame_default_settings.ath_only = lame_get_ATHonly (lgf);
-  gst_lame_default_settings.ath_short = lame_get_ATHshort (lgf);
-  gst_lame_default_settings.no_ath = lame_get_noATH (lgf);
-  gst_lame_default_settings.ath_type = lame_get_ATHtype (lgf);
-  gst_lame_default_settings.ath_lower = lame_get_ATHlower (lgf);
-  gst_lame_default_settings.allow_diff_short = lame_get_allow_diff_short (lgf);
-  gst_lame_default_settings.no_short_blocks = lame_get_no_short_blocks (lgf);
-  gst_lame_default_settings.emphasis = lame_get_emphasis (lgf);
-  gst_lame_default_settings.preset = 0;
-
-  lame_close (lgf);
-
-  return TRUE;
-}
-
 gboolean
 gst_lame_register (GstPlugin * plugin)
 {
   GST_DEBUG_CATEGORY_INIT (debug, "lame", 0, "lame mp3 encoder");
 
-  if (!gst_lame_get_default_settings ())
-    return FALSE;
-
   if (!gst_element_register (plugin, "lame", GST_RANK_MARGINAL, GST_TYPE_LAME))
     return FALSE;
 
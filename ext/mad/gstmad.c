@@ -44,9 +44,14 @@ enum
 {
   ARG_0,
   ARG_HALF,
-  ARG_IGNORE_CRC
+  ARG_IGNORE_CRC,
+  ARG_GAIN,
+  ARG_REPLAYGAIN
 };
 
+#define DEFAULT_GAIN 0.0
+#define DEFAULT_REPLAYGAIN FALSE
+
 GST_DEBUG_CATEGORY_STATIC (mad_debug);
 #define GST_CAT_DEFAULT mad_debug
 
@@ -209,6 +214,28 @@ gst_mad_class_init (GstMadClass * klass)
   g_object_class_install_property (gobject_class, ARG_IGNORE_CRC,
       g_param_spec_boolean ("ignore-crc", "Ignore CRC", "Ignore CRC errors",
           TRUE, G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
+  /**
+   * GstMad:gain
+   *
+   * Gain in dB applied to the decoded samples before they are converted to
+   * 32-bit integers. Decoded samples above full scale are only clipped after
+   * the gain, so a negative gain recovers them.
+   */
+  g_object_class_install_property (gobject_class, ARG_GAIN,
+      g_param_spec_double ("gain", "Gain", "Output gain in dB",
+          GST_DECODER_GAIN_MIN, GST_DECODER_GAIN_MAX, DEFAULT_GAIN,
+          G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
+  /**
+   * GstMad:replaygain
+   *
+   * Add the ReplayGain from the ID3 or APE tags of the stream to
+   * #GstMad:gain, limited by the tagged peak. Leave this off when the
+   * pipeline has an rgvolume element.
+   */
+  g_object_class_install_property (gobject_class, ARG_REPLAYGAIN,
+      g_param_spec_boolean ("replaygain", "ReplayGain",
+          "Apply the ReplayGain from upstream tags", DEFAULT_REPLAYGAIN,
+          G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
 
   /* register tags */
 #define GST_TAG_LAYER    "layer"
@@ -272,6 +299,8 @@ gst_mad_init (GstMad * mad, GstMadClass * klass)
 
   mad->half = FALSE;
   mad->ignore_crc = TRUE;
+  gst_decoder_gain_init (&mad->output_gain);
+  mad->gain_fixed = MAD_F_ONE;
   mad->check_for_xing = TRUE;
   mad->xing_found = FALSE;
 }
@@ -833,6 +862,27 @@ scale (mad_fixed_t sample)
   return (gint32) (sample << 3);
 }
 
+/* scale() with a gain. The product is computed in 64 bits so that samples
+ * decoded above full scale still come back with a negative gain, only the
+ * result is clipped */
+static inline gint32
+scale_gain (mad_fixed_t sample, mad_fixed_t gain)
+{
+  gint64 res = ((gint64) sample * gain) >> MAD_F_FRACBITS;
+
+  return scale ((mad_fixed_t) CLAMP (res, -MAD_F_ONE, MAD_F_ONE));
+}
+
+/* call with the object lock */
+static void
+gst_mad_update_gain (GstMad * mad)
+{
+  mad->gain_fixed =
+      mad_f_tofixed (gst_decoder_gain_get_factor (&mad->output_gain));
+  GST_DEBUG_OBJECT (mad, "output gain %.2f dB",
+      gst_decoder_gain_get_db (&mad->output_gain));
+}
+
 /* do we need this function? */
 static void
 gst_mad_set_property (GObject * object, guint prop_id,
@@ -849,6 +899,18 @@ gst_mad_set_property (GObject * object, guint prop_id,
     case ARG_IGNORE_CRC:
       mad->ignore_crc = g_value_get_boolean (value);
       break;
+    case ARG_GAIN:
+      GST_OBJECT_LOCK (mad);
+      mad->output_gain.gain = g_value_get_double (value);
+      gst_mad_update_gain (mad);
+      GST_OBJECT_UNLOCK (mad);
+      break;
+    case ARG_REPLAYGAIN:
+      GST_OBJECT_LOCK (mad);
+      mad->output_gain.replaygain = g_value_get_boolean (value);
+      gst_mad_update_gain (mad);
+      GST_OBJECT_UNLOCK (mad);
+      break;
     default:
       G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
       break;
@@ -870,6 +932,16 @@ gst_mad_get_property (GObject * object, guint prop_id,
     case ARG_IGNORE_CRC:
       g_value_set_boolean (value, mad->ignore_crc);
       break;
+    case ARG_GAIN:
+      GST_OBJECT_LOCK (mad);
+      g_value_set_double (value, mad->output_gain.gain);
+      GST_OBJECT_UNLOCK (mad);
+      break;
+    case ARG_REPLAYGAIN:
+      GST_OBJECT_LOCK (mad);
+      g_value_set_boolean (value, mad->output_gain.replaygain);
+      GST_OBJECT_UNLOCK (mad);
+      break;
     default:
       G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
       break;
@@ -1011,6 +1083,16 @@ gst_mad_sink_event (GstPad * pad, GstEvent * event)
     case GST_EVENT_FLUSH_START:
       result = gst_pad_event_default (pad, event);
       break;
+    case GST_EVENT_TAG:{
+      GstTagList *list;
+
+      gst_event_parse_tag (event, &list);
+      GST_OBJECT_LOCK (mad);
+      if (gst_decoder_gain_parse_tags (&mad->output_gain, list))
+        gst_mad_update_gain (mad);
+      GST_OBJECT_UNLOCK (mad);
+    }
+      /* fall-through */
     default:
       if (mad->restart) {
         /* Cache all other events if we still have to send a NEWSEGMENT */
@@ -1645,6 +1727,7 @@ gst_mad_chain (GstPad * pad, GstBuffer * buffer)
         GstBuffer *outbuffer = NULL;
         gint32 *outdata;
         mad_fixed_t const *left_ch, *right_ch;
+        mad_fixed_t gain;
 
         if (mad->need_newsegment) {
           gint64 start = time_offset;
@@ -1705,8 +1788,25 @@ gst_mad_chain (GstPad * pad, GstBuffer * buffer)
         GST_BUFFER_OFFSET (outbuffer) = mad->total_samples;
         GST_BUFFER_OFFSET_END (outbuffer) = mad->total_samples + nsamples;
 
+        GST_OBJECT_LOCK (mad);
+        gain = mad->gain_fixed;
+        GST_OBJECT_UNLOCK (mad);
+
         /* output sample(s) in 16-bit signed native-endian PCM */
-        if (mad->channels == 1) {
+        if (gain != MAD_F_ONE) {
+          gint count = nsamples;
+
+          if (mad->channels == 1) {
+            while (count--) {
+              *outdata++ = scale_gain (*left_ch++, gain) & 0xffffffff;
+            }
+          } else {
+            while (count--) {
+              *outdata++ = scale_gain (*left_ch++, gain) & 0xffffffff;
+              *outdata++ = scale_gain (*right_ch++, gain) & 0xffffffff;
+            }
+          }
+        } else if (mad->channels == 1) {
           gint count = nsamples;
 
           while (count--) {
@@ -1832,6 +1932,10 @@ gst_mad_change_state (GstElement * element, GstStateChange transition)
       mad->vbr_rate = 0;
       mad->frame.header.samplerate = 0;
       mad->last_ts = GST_CLOCK_TIME_NONE;
+      GST_OBJECT_LOCK (mad);
+      gst_decoder_gain_reset (&mad->output_gain);
+      gst_mad_update_gain (mad);
+      GST_OBJECT_UNLOCK (mad);
       if (mad->ignore_crc)
         options |= MAD_OPTION_IGNORECRC;
       if (mad->half)
@@ -23,6 +23,7 @@
 
 #include <gst/gst.h>
 #include <gst/tag/tag.h>
+#include <gst/decodergain-private.h>
 #include <mad.h>
 
 G_BEGIN_DECLS
@@ -77,6 +78,10 @@ struct _GstMad
   gboolean half;
   gboolean ignore_crc;
 
+  /* output gain, see the gain and replaygain properties */
+  GstDecoderGain output_gain;   /* with object lock */
+  mad_fixed_t gain_fixed;       /* resulting factor, with object lock */
+
   GstTagList *tags;
 
   /* negotiated format */
@@ -50,6 +50,14 @@ GST_DEBUG_CATEGORY_STATIC (mpeg2dec_debug);
  */
 #define WARN_THRESHOLD (5)
 
+#define DEFAULT_LOW_DELAY FALSE
+
+enum
+{
+  PROP_0,
+  PROP_LOW_DELAY
+};
+
 //#define enable_user_data
 #ifdef enable_user_data
 static GstStaticPadTemplate user_data_template_factory =
@@ -83,6 +91,10 @@ static void gst_mpeg2dec_class_init (GstMpeg2decClass * klass);
 static void gst_mpeg2dec_init (GstMpeg2dec * mpeg2dec);
 
 static void gst_mpeg2dec_finalize (GObject * object);
+static void gst_mpeg2dec_set_property (GObject * object, guint prop_id,
+    const GValue * value, GParamSpec * pspec);
+static void gst_mpeg2dec_get_property (GObject * object, guint prop_id,
+    GValue * value, GParamSpec * pspec);
 static void gst_mpeg2dec_reset (GstMpeg2dec * mpeg2dec);
 
 static void gst_mpeg2dec_set_index (GstElement * element, GstIndex * index);
@@ -183,6 +195,23 @@ gst_mpeg2dec_class_init (GstMpeg2decClass * klass)
   parent_class = g_type_class_peek_parent (klass);
 
   gobject_class->finalize = gst_mpeg2dec_finalize;
+  gobject_class->set_property = gst_mpeg2dec_set_property;
+  gobject_class->get_property = gst_mpeg2dec_get_property;
+
+  /**
+   * GstMpeg2dec:low-delay
+   *
+   * Push each picture downstream as soon as it is decoded instead of waiting
+   * for the next reference picture, on streams that have the low_delay flag
+   * set in their sequence extension or that turn out not to contain any
+   * B-frames. This saves one frame period of latency on such streams. When a
+   * B-frame shows up after all, the decoder goes back to normal reordering
+   * and drops pictures until the next keyframe.
+   */
+  g_object_class_install_property (gobject_class, PROP_LOW_DELAY,
+      g_param_spec_boolean ("low-delay", "Low delay",
+          "Output pictures in decoding order on streams without B-frames",
+          DEFAULT_LOW_DELAY, G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
 
   gstelement_class->change_state = gst_mpeg2dec_change_state;
   gstelement_class->set_index = gst_mpeg2dec_set_index;
@@ -227,6 +256,7 @@ gst_mpeg2dec_init (GstMpeg2dec * mpeg2dec)
 
   mpeg2dec->error_count = 0;
   mpeg2dec->can_allocate_aligned = TRUE;
+  mpeg2dec->low_delay = DEFAULT_LOW_DELAY;
 
   /* initialize the mpeg2dec acceleration */
 }
@@ -254,6 +284,42 @@ gst_mpeg2dec_finalize (GObject * object)
   G_OBJECT_CLASS (parent_class)->finalize (object);
 }
 
+static void
+gst_mpeg2dec_set_property (GObject * object, guint prop_id,
+    const GValue * value, GParamSpec * pspec)
+{
+  GstMpeg2dec *mpeg2dec = GST_MPEG2DEC (object);
+
+  switch (prop_id) {
+    case PROP_LOW_DELAY:
+      GST_OBJECT_LOCK (mpeg2dec);
+      mpeg2dec->low_delay = g_value_get_boolean (value);
+      GST_OBJECT_UNLOCK (mpeg2dec);
+      break;
+    default:
+      G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
+      break;
+  }
+}
+
+static void
+gst_mpeg2dec_get_property (GObject * object, guint prop_id, GValue * value,
+    GParamSpec * pspec)
+{
+  GstMpeg2dec *mpeg2dec = GST_MPEG2DEC (object);
+
+  switch (prop_id) {
+    case PROP_LOW_DELAY:
+      GST_OBJECT_LOCK (mpeg2dec);
+      g_value_set_boolean (value, mpeg2dec->low_delay);
+      GST_OBJECT_UNLOCK (mpeg2dec);
+      break;
+    default:
+      G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
+      break;
+  }
+}
+
 static void
 gst_mpeg2dec_reset (GstMpeg2dec * mpeg2dec)
 {
@@ -267,6 +333,9 @@ gst_mpeg2dec_reset (GstMpeg2dec * mpeg2dec)
   mpeg2dec->format = GST_VIDEO_FORMAT_UNKNOWN;
   mpeg2dec->width = -1;
   mpeg2dec->height = -1;
+  mpeg2dec->scale = 1;
+  mpeg2dec->out_width = -1;
+  mpeg2dec->out_height = -1;
   gst_segment_init (&mpeg2dec->segment, GST_FORMAT_UNDEFINED);
   mpeg2dec->discont_state = MPEG2DEC_DISC_NEW_PICTURE;
   mpeg2dec->frame_period = 0;
@@ -275,6 +344,10 @@ gst_mpeg2dec_reset (GstMpeg2dec * mpeg2dec)
   mpeg2dec->offset = 0;
   mpeg2dec->error_count = 0;
   mpeg2dec->can_allocate_aligned = TRUE;
+  mpeg2dec->low_delay_active = FALSE;
+  mpeg2dec->seq_low_delay = FALSE;
+  mpeg2dec->seen_keyframe = FALSE;
+  mpeg2dec->seen_b_frame = FALSE;
   mpeg2_reset (mpeg2dec->decoder, 1);
 }
 
@@ -316,6 +389,67 @@ gst_mpeg2dec_get_index (GstElement * element)
   return (mpeg2dec->index) ? gst_object_ref (mpeg2dec->index) : NULL;
 }
 
+/* downscale a plane by averaging blocks of @scale x @scale pixels, @scale
+ * being 2 or 4. Blocks at the right and bottom edges are clamped to the
+ * source plane. */
+static void
+gst_mpeg2dec_box_filter (guint8 * dest, guint stride_out, guint width,
+    guint height, const guint8 * src, guint stride_in, guint src_width,
+    guint src_height, guint scale)
+{
+  guint x, y, i, j, inner, shift, round;
+
+  shift = (scale == 4) ? 4 : 2;
+  round = 1 << (shift - 1);
+
+  /* columns for which the whole block is inside the source plane */
+  inner = MIN (width, src_width / scale);
+
+  for (y = 0; y < height; y++) {
+    const guint8 *rows[4];
+
+    for (j = 0; j < scale; j++)
+      rows[j] = src + MIN (y * scale + j, src_height - 1) * stride_in;
+
+    if (scale == 2) {
+      const guint8 *s0 = rows[0], *s1 = rows[1];
+
+      for (x = 0; x < inner; x++) {
+        dest[x] = (s0[0] + s0[1] + s1[0] + s1[1] + round) >> shift;
+        s0 += 2;
+        s1 += 2;
+      }
+    } else {
+      const guint8 *s0 = rows[0], *s1 = rows[1], *s2 = rows[2], *s3 = rows[3];
+
+      for (x = 0; x < inner; x++) {
+        dest[x] = (s0[0] + s0[1] + s0[2] + s0[3] +
+            s1[0] + s1[1] + s1[2] + s1[3] +
+            s2[0] + s2[1] + s2[2] + s2[3] +
+            s3[0] + s3[1] + s3[2] + s3[3] + round) >> shift;
+        s0 += 4;
+        s1 += 4;
+        s2 += 4;
+        s3 += 4;
+      }
+    }
+
+    for (x = inner; x < width; x++) {
+      guint sum = 0;
+
+      for (j = 0; j < scale; j++)
+        for (i = 0; i < scale; i++)
+          sum += rows[j][MIN (x * scale + i, src_width - 1)];
+
+      dest[x] = (sum + round) >> shift;
+    }
+
+    dest += stride_out;
+  }
+}
+
+/* copy the visible area of the decoded picture to a new buffer, cropping
+ * and, when a smaller output size was negotiated, downscaling it */
 static GstFlowReturn
 gst_mpeg2dec_crop_buffer (GstMpeg2dec * dec, GstBuffer ** buf)
 {
@@ -324,11 +458,13 @@ gst_mpeg2dec_crop_buffer (GstMpeg2dec * dec, GstBuffer ** buf)
   GstBuffer *outbuf;
   guint outsize, c;
 
-  outsize = gst_video_format_get_size (dec->format, dec->width, dec->height);
+  outsize = gst_video_format_get_size (dec->format, dec->out_width,
+      dec->out_height);
 
   GST_LOG_OBJECT (dec, "Copying input buffer %ux%u (%u) to output buffer "
-      "%ux%u (%u)", dec->decoded_width, dec->decoded_height,
-      GST_BUFFER_SIZE (inbuf), dec->width, dec->height, outsize);
+      "%ux%u (%u), scale 1/%d", dec->decoded_width, dec->decoded_height,
+      GST_BUFFER_SIZE (inbuf), dec->out_width, dec->out_height, outsize,
+      dec->scale);
 
   flow_ret = gst_pad_alloc_buffer_and_set_caps (dec->srcpad,
       GST_BUFFER_OFFSET_NONE, outsize, GST_PAD_CAPS (dec->srcpad), &outbuf);
@@ -348,14 +484,42 @@ gst_mpeg2dec_crop_buffer (GstMpeg2dec * dec, GstBuffer ** buf)
         dec->decoded_width, dec->decoded_height);
     dest =
         GST_BUFFER_DATA (outbuf) +
-        gst_video_format_get_component_offset (dec->format, c, dec->width,
-        dec->height);
-    stride_out = gst_video_format_get_row_stride (dec->format, c, dec->width);
+        gst_video_format_get_component_offset (dec->format, c, dec->out_width,
+        dec->out_height);
+    stride_out =
+        gst_video_format_get_row_stride (dec->format, c, dec->out_width);
     stride_in =
         gst_video_format_get_row_stride (dec->format, c, dec->decoded_width);
     c_height =
-        gst_video_format_get_component_height (dec->format, c, dec->height);
-    c_width = gst_video_format_get_component_width (dec->format, c, dec->width);
+        gst_video_format_get_component_height (dec->format, c,
+        dec->out_height);
+    c_width =
+        gst_video_format_get_component_width (dec->format, c, dec->out_width);
+
+    if (dec->scale > 1) {
+      guint src_width, src_height, field;
+
+      src_width =
+          gst_video_format_get_component_width (dec->format, c, dec->width);
+      src_height =
+          gst_video_format_get_component_height (dec->format, c, dec->height);
+
+      if (!dec->interlaced) {
+        gst_mpeg2dec_box_filter (dest, stride_out, c_width, c_height, src,
+            stride_in, src_width, src_height, dec->scale);
+        continue;
+      }
+
+      /* scale the two fields separately, so the output lines of a field
+       * are only made from the lines of that field and stay interlaced */
+      for (field = 0; field < 2; field++) {
+        gst_mpeg2dec_box_filter (dest + field * stride_out, 2 * stride_out,
+            c_width, (c_height + 1 - field) / 2, src + field * stride_in,
+            2 * stride_in, src_width, (src_height + 1 - field) / 2,
+            dec->scale);
+      }
+      continue;
+    }
 
     for (line = 0; line < c_height; line++) {
       memcpy (dest, src, c_width);
@@ -379,8 +543,8 @@ gst_mpeg2dec_alloc_sized_buf (GstMpeg2dec * mpeg2dec, guint size,
     GstBuffer ** obuf)
 {
   if (mpeg2dec->can_allocate_aligned
-      && mpeg2dec->decoded_width == mpeg2dec->width
-      && mpeg2dec->decoded_height == mpeg2dec->height) {
+      && mpeg2dec->decoded_width == mpeg2dec->out_width
+      && mpeg2dec->decoded_height == mpeg2dec->out_height) {
     GstFlowReturn ret;
 
     ret = gst_pad_alloc_buffer_and_set_caps (mpeg2dec->srcpad,
@@ -460,6 +624,19 @@ no_buffer:
   }
 }
 
+static GstCaps *
+gst_mpeg2dec_make_caps (GstMpeg2dec * mpeg2dec, guint32 fourcc, gint scale)
+{
+  return gst_caps_new_simple ("video/x-raw-yuv",
+      "format", GST_TYPE_FOURCC, fourcc,
+      "width", G_TYPE_INT, mpeg2dec->width / scale,
+      "height", G_TYPE_INT, mpeg2dec->height / scale,
+      "pixel-aspect-ratio", GST_TYPE_FRACTION, mpeg2dec->pixel_width,
+      mpeg2dec->pixel_height,
+      "framerate", GST_TYPE_FRACTION, mpeg2dec->fps_n, mpeg2dec->fps_d,
+      "interlaced", G_TYPE_BOOLEAN, mpeg2dec->interlaced, NULL);
+}
+
 static gboolean
 gst_mpeg2dec_negotiate_format (GstMpeg2dec * mpeg2dec)
 {
@@ -467,6 +644,7 @@ gst_mpeg2dec_negotiate_format (GstMpeg2dec * mpeg2dec)
   guint32 fourcc;
   const mpeg2_info_t *info;
   const mpeg2_sequence_t *sequence;
+  gint scale;
 
   info = mpeg2_info (mpeg2dec->decoder);
   sequence = info->sequence;
@@ -518,14 +696,33 @@ gst_mpeg2dec_negotiate_format (GstMpeg2dec * mpeg2dec)
     g_value_unset (&dimensions);
   }
 
-  caps = gst_caps_new_simple ("video/x-raw-yuv",
-      "format", GST_TYPE_FOURCC, fourcc,
-      "width", G_TYPE_INT, mpeg2dec->width,
-      "height", G_TYPE_INT, mpeg2dec->height,
-      "pixel-aspect-ratio", GST_TYPE_FRACTION, mpeg2dec->pixel_width,
-      mpeg2dec->pixel_height,
-      "framerate", GST_TYPE_FRACTION, mpeg2dec->fps_n, mpeg2dec->fps_d,
-      "interlaced", G_TYPE_BOOLEAN, mpeg2dec->interlaced, NULL);
+  /* prefer the full size, but output 1/2 or 1/4 of it when downstream only
+   * accepts that, e.g. for thumbnails. Downscaling is done while copying the
+   * picture out of the libmpeg2 buffer, which saves a videoscale pass. */
+  caps = NULL;
+  for (scale = 1; scale <= 4 && mpeg2dec->width / scale >= 16 &&
+      mpeg2dec->height / scale >= 16; scale *= 2) {
+    caps = gst_mpeg2dec_make_caps (mpeg2dec, fourcc, scale);
+    if (gst_pad_peer_accept_caps (mpeg2dec->srcpad, caps))
+      break;
+
+    GST_DEBUG_OBJECT (mpeg2dec, "downstream does not accept %" GST_PTR_FORMAT,
+        caps);
+    gst_caps_unref (caps);
+    caps = NULL;
+  }
+
+  /* none accepted, the full size will fail normally when pushing */
+  if (caps == NULL) {
+    scale = 1;
+    caps = gst_mpeg2dec_make_caps (mpeg2dec, fourcc, scale);
+  }
+
+  mpeg2dec->scale = scale;
+  mpeg2dec->out_width = mpeg2dec->width / scale;
+  mpeg2dec->out_height = mpeg2dec->height / scale;
+  GST_DEBUG_OBJECT (mpeg2dec, "output size %dx%d (1/%d)", mpeg2dec->out_width,
+      mpeg2dec->out_height, scale);
 
   gst_pad_set_caps (mpeg2dec->srcpad, caps);
   gst_caps_unref (caps);
@@ -585,6 +782,16 @@ handle_sequence (GstMpeg2dec * mpeg2dec, const mpeg2_info_t * info)
   mpeg2dec->interlaced =
       !(info->sequence->flags & SEQ_FLAG_PROGRESSIVE_SEQUENCE);
 
+  /* B-frames are not allowed in low_delay sequences, so we can output the
+   * pictures in decoding order right away. For other streams we only know
+   * after having seen a complete GOP, see handle_picture() */
+  mpeg2dec->seq_low_delay = ! !(info->sequence->flags & SEQ_FLAG_LOW_DELAY);
+  GST_OBJECT_LOCK (mpeg2dec);
+  mpeg2dec->low_delay_active = mpeg2dec->low_delay && mpeg2dec->seq_low_delay;
+  GST_OBJECT_UNLOCK (mpeg2dec);
+  mpeg2dec->seen_keyframe = FALSE;
+  mpeg2dec->seen_b_frame = FALSE;
+
   GST_DEBUG_OBJECT (mpeg2dec,
       "sequence flags: %d, frame period: %d (%g), frame rate: %d/%d",
       info->sequence->flags, info->sequence->frame_period,
@@ -645,6 +852,7 @@ clear_buffers (GstMpeg2dec * mpeg2dec)
   if (*bufpen)
     gst_buffer_unref (*bufpen);
   *bufpen = NULL;
+  gst_buffer_replace (&mpeg2dec->last_output, NULL);
 }
 
 static void
@@ -676,6 +884,50 @@ flush_queued (GstMpeg2dec * mpeg2dec)
   return res;
 }
 
+/* check whether we can output pictures in decoding order. We switch to
+ * low-delay output after a complete GOP without B-frames and back to normal
+ * reordering as soon as a B-frame shows up. */
+static void
+update_low_delay (GstMpeg2dec * mpeg2dec, gint type)
+{
+  gboolean low_delay;
+
+  GST_OBJECT_LOCK (mpeg2dec);
+  low_delay = mpeg2dec->low_delay;
+  GST_OBJECT_UNLOCK (mpeg2dec);
+
+  switch (type) {
+    case PIC_FLAG_CODING_TYPE_I:
+      if (low_delay && !mpeg2dec->low_delay_active && mpeg2dec->seen_keyframe
+          && !mpeg2dec->seen_b_frame) {
+        GST_DEBUG_OBJECT (mpeg2dec, "no B-frames in last GOP, low-delay output");
+        mpeg2dec->low_delay_active = TRUE;
+      }
+      mpeg2dec->seen_keyframe = TRUE;
+      mpeg2dec->seen_b_frame = FALSE;
+      break;
+    case PIC_FLAG_CODING_TYPE_B:
+      mpeg2dec->seen_b_frame = TRUE;
+      if (mpeg2dec->low_delay_active && !mpeg2dec->seq_low_delay) {
+        /* we already pushed the reference picture that should be displayed
+         * after this one, drop everything until the next keyframe */
+        GST_WARNING_OBJECT (mpeg2dec, "B-frame in low-delay mode, "
+            "going back to reordered output");
+        mpeg2dec->low_delay_active = FALSE;
+        mpeg2dec->discont_state = MPEG2DEC_DISC_NEW_PICTURE;
+        gst_buffer_replace (&mpeg2dec->last_output, NULL);
+      }
+      break;
+    default:
+      break;
+  }
+
+  if (!low_delay && mpeg2dec->low_delay_active) {
+    GST_DEBUG_OBJECT (mpeg2dec, "low-delay output disabled");
+    mpeg2dec->low_delay_active = FALSE;
+  }
+}
+
 static GstFlowReturn
 handle_picture (GstMpeg2dec * mpeg2dec, const mpeg2_info_t * info)
 {
@@ -698,6 +950,8 @@ handle_picture (GstMpeg2dec * mpeg2dec, const mpeg2_info_t * info)
 
   key_frame = type == PIC_FLAG_CODING_TYPE_I;
 
+  update_low_delay (mpeg2dec, type);
+
   switch (type) {
     case PIC_FLAG_CODING_TYPE_I:
       mpeg2_skip (mpeg2dec->decoder, 0);
@@ -786,25 +1040,20 @@ beach:
 }
 
 static GstFlowReturn
-handle_slice (GstMpeg2dec * mpeg2dec, const mpeg2_info_t * info)
+output_picture (GstMpeg2dec * mpeg2dec, GstBuffer * outbuf,
+    const mpeg2_picture_t * picture, const mpeg2_picture_t * picture_2nd)
 {
-  GstBuffer *outbuf = NULL;
   GstFlowReturn ret = GST_FLOW_OK;
-  const mpeg2_picture_t *picture;
   gboolean key_frame = FALSE;
   GstClockTime time;
 
-  GST_DEBUG_OBJECT (mpeg2dec, "picture slice/end %p %p %p %p",
-      info->display_fbuf,
-      info->display_picture, info->current_picture,
-      (info->display_fbuf ? info->display_fbuf->id : NULL));
+  /* in low-delay mode the picture was pushed when it was decoded, which is
+   * before libmpeg2 hands it to us for display */
+  if (outbuf == mpeg2dec->last_output)
+    goto already_pushed;
 
-  if (!info->display_fbuf || !info->display_fbuf->id)
-    goto no_display;
-
-  outbuf = GST_BUFFER (info->display_fbuf->id);
-
-  picture = info->display_picture;
+  if (mpeg2dec->low_delay_active)
+    gst_buffer_replace (&mpeg2dec->last_output, outbuf);
 
   key_frame = (picture->flags & PIC_MASK_CODING_TYPE) == PIC_FLAG_CODING_TYPE_I;
 
@@ -852,9 +1101,9 @@ handle_slice (GstMpeg2dec * mpeg2dec, const mpeg2_info_t * info)
   GST_BUFFER_TIMESTAMP (outbuf) = time;
 
   /* TODO set correct offset here based on frame number */
-  if (info->display_picture_2nd) {
+  if (picture_2nd) {
     GST_BUFFER_DURATION (outbuf) = (picture->nb_fields +
-        info->display_picture_2nd->nb_fields) * mpeg2dec->frame_period / 2;
+        picture_2nd->nb_fields) * mpeg2dec->frame_period / 2;
   } else {
     GST_BUFFER_DURATION (outbuf) =
         picture->nb_fields * mpeg2dec->frame_period / 2;
@@ -952,8 +1201,8 @@ handle_slice (GstMpeg2dec * mpeg2dec, const mpeg2_info_t * info)
   gst_buffer_ref (outbuf);
 
   /* do cropping if the target region is smaller than the input one */
-  if (mpeg2dec->decoded_width != mpeg2dec->width ||
-      mpeg2dec->decoded_height != mpeg2dec->height) {
+  if (mpeg2dec->decoded_width != mpeg2dec->out_width ||
+      mpeg2dec->decoded_height != mpeg2dec->out_height) {
     GST_DEBUG_OBJECT (mpeg2dec, "cropping buffer");
     ret = gst_mpeg2dec_crop_buffer (mpeg2dec, &outbuf);
     if (ret != GST_FLOW_OK)
@@ -985,9 +1234,11 @@ done:
   return ret;
 
   /* special cases */
-no_display:
+already_pushed:
   {
-    GST_DEBUG_OBJECT (mpeg2dec, "no picture to display");
+    GST_DEBUG_OBJECT (mpeg2dec, "picture %p was already pushed", outbuf);
+    if (!mpeg2dec->low_delay_active)
+      gst_buffer_replace (&mpeg2dec->last_output, NULL);
     return GST_FLOW_OK;
   }
 skip:
@@ -1013,6 +1264,38 @@ dropping_qos:
   }
 }
 
+static GstFlowReturn
+handle_slice (GstMpeg2dec * mpeg2dec, const mpeg2_info_t * info)
+{
+  GstFlowReturn ret = GST_FLOW_OK;
+
+  GST_DEBUG_OBJECT (mpeg2dec, "picture slice/end %p %p %p %p",
+      info->display_fbuf,
+      info->display_picture, info->current_picture,
+      (info->display_fbuf ? info->display_fbuf->id : NULL));
+
+  /* when switching to low-delay mode, the last reference picture of the
+   * previous GOP is still waiting to be displayed, so always output the
+   * display picture first. */
+  if (info->display_fbuf && info->display_fbuf->id) {
+    ret = output_picture (mpeg2dec, GST_BUFFER (info->display_fbuf->id),
+        info->display_picture, info->display_picture_2nd);
+  } else {
+    GST_DEBUG_OBJECT (mpeg2dec, "no picture to display");
+  }
+
+  /* the picture that was just decoded can go out right away when there are
+   * no B-frames that need to be displayed before it */
+  if (ret == GST_FLOW_OK && mpeg2dec->low_delay_active &&
+      info->current_fbuf && info->current_fbuf->id && info->current_picture) {
+    GST_LOG_OBJECT (mpeg2dec, "low-delay output of decoded picture");
+    ret = output_picture (mpeg2dec, GST_BUFFER (info->current_fbuf->id),
+        info->current_picture, info->current_picture_2nd);
+  }
+
+  return ret;
+}
+
 #if 0
 static void
 update_streaminfo (GstMpeg2dec * mpeg2dec)
@@ -1402,7 +1685,7 @@ gst_mpeg2dec_src_convert (GstPad * pad, GstFormat src_format, gint64 src_value,
     case GST_FORMAT_TIME:
       switch (*dest_format) {
         case GST_FORMAT_BYTES:
-          scale = 6 * (mpeg2dec->width * mpeg2dec->height >> 2);
+          scale = 6 * (mpeg2dec->out_width * mpeg2dec->out_height >> 2);
         case GST_FORMAT_DEFAULT:
           if (info->sequence && mpeg2dec->frame_period) {
             *dest_value =
@@ -1421,7 +1704,8 @@ gst_mpeg2dec_src_convert (GstPad * pad, GstFormat src_format, gint64 src_value,
           break;
         case GST_FORMAT_BYTES:
           *dest_value =
-              src_value * 6 * ((mpeg2dec->width * mpeg2dec->height) >> 2);
+              src_value * 6 * ((mpeg2dec->out_width *
+                  mpeg2dec->out_height) >> 2);
           break;
         default:
           res = FALSE;
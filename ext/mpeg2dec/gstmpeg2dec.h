@@ -83,6 +83,10 @@ struct _GstMpeg2dec {
   gint           height;
   gint           decoded_width;
   gint           decoded_height;
+  /* output size, width and height divided by the negotiated scale */
+  gint           scale;
+  gint           out_width;
+  gint           out_height;
   gint           pixel_width;
   gint           pixel_height;
   gint           frame_rate_code;
@@ -120,6 +124,14 @@ struct _GstMpeg2dec {
 
   /* whether we have a pixel aspect ratio from the sink caps */
   gboolean have_par;
+
+  /* low-delay output */
+  gboolean low_delay;           /* property */
+  gboolean low_delay_active;    /* push pictures in decode order */
+  gboolean seq_low_delay;       /* SEQ_FLAG_LOW_DELAY was set */
+  gboolean seen_keyframe;       /* an I picture started the current GOP */
+  gboolean seen_b_frame;        /* a B picture was seen in the current GOP */
+  GstBuffer *last_output;       /* last buffer pushed in low-delay mode */
 };
 
 struct _GstMpeg2decClass {
@@ -90,24 +90,24 @@ GST_STATIC_PAD_TEMPLATE ("src",
         "channels = (int) [ 1, 2 ]")
     );
 
-static struct
-{
-  gint mode;
-  gint psymodel;
-  gint bitrate;
-  gint padding;
-  gboolean energy_level_extension;
-  gint emphasis;
-  gboolean error_protection;
-  gboolean copyright;
-  gboolean original;
-  gboolean vbr;
-  gfloat vbr_level;
-  gfloat ath_level;
-  gint vbr_max_bitrate;
-  gboolean quick_mode;
-  gint quick_mode_count;
-} gst_two_lame_default_settings;
+/* what twolame_init () and twolame_init_params () give for 44.1 kHz stereo
+ * input, tests/check/elements/twolame.c checks them against the installed
+ * TwoLAME */
+#define DEFAULT_MODE TWOLAME_JOINT_STEREO
+#define DEFAULT_PSYMODEL 3
+#define DEFAULT_BITRATE 192
+#define DEFAULT_PADDING TWOLAME_PAD_NO
+#define DEFAULT_ENERGY_LEVEL_EXTENSION FALSE
+#define DEFAULT_EMPHASIS TWOLAME_EMPHASIS_N
+#define DEFAULT_ERROR_PROTECTION FALSE
+#define DEFAULT_COPYRIGHT FALSE
+#define DEFAULT_ORIGINAL TRUE
+#define DEFAULT_VBR FALSE
+#define DEFAULT_VBR_LEVEL 5.0
+#define DEFAULT_ATH_LEVEL 0.0
+#define DEFAULT_VBR_MAX_BITRATE 0
+#define DEFAULT_QUICK_MODE FALSE
+#define DEFAULT_QUICK_MODE_COUNT 10
 
 /********** Define useful types for non-programmatic interfaces **********/
 #define GST_TYPE_TWO_LAME_MODE (gst_two_lame_mode_get_type())
@@ -263,88 +263,88 @@ gst_two_lame_class_init (GstTwoLameClass * klass)
 
   g_object_class_install_property (G_OBJECT_CLASS (klass), ARG_MODE,
       g_param_spec_enum ("mode", "Mode", "Encoding mode",
-          GST_TYPE_TWO_LAME_MODE, gst_two_lame_default_settings.mode,
+          GST_TYPE_TWO_LAME_MODE, DEFAULT_MODE,
           G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
 
   g_object_class_install_property (G_OBJECT_CLASS (klass), ARG_PSYMODEL,
       g_param_spec_int ("psymodel", "Psychoacoustic Model",
           "Psychoacoustic model used to encode the audio",
-          -1, 4, gst_two_lame_default_settings.psymodel,
+          -1, 4, DEFAULT_PSYMODEL,
           G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
 
   g_object_class_install_property (G_OBJECT_CLASS (klass), ARG_BITRATE,
       g_param_spec_int ("bitrate", "Bitrate (kb/s)",
           "Bitrate in kbit/sec (8, 16, 24, 32, 40, 48, 56, 64, 80, 96, "
           "112, 128, 144, 160, 192, 224, 256, 320, 384)",
-          8, 384, gst_two_lame_default_settings.bitrate,
+          8, 384, DEFAULT_BITRATE,
           G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
 
   g_object_class_install_property (G_OBJECT_CLASS (klass), ARG_PADDING,
       g_param_spec_enum ("padding", "Padding", "Padding type",
-          GST_TYPE_TWO_LAME_PADDING, gst_two_lame_default_settings.padding,
+          GST_TYPE_TWO_LAME_PADDING, DEFAULT_PADDING,
           G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
 
   g_object_class_install_property (G_OBJECT_CLASS (klass),
       ARG_ENERGY_LEVEL_EXTENSION,
       g_param_spec_boolean ("energy-level-extension", "Energy Level Extension",
           "Write peak PCM level to each frame",
-          gst_two_lame_default_settings.energy_level_extension,
+          DEFAULT_ENERGY_LEVEL_EXTENSION,
           G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
 
   g_object_class_install_property (G_OBJECT_CLASS (klass), ARG_EMPHASIS,
       g_param_spec_enum ("emphasis", "Emphasis",
           "Pre-emphasis to apply to the decoded audio",
-          GST_TYPE_TWO_LAME_EMPHASIS, gst_two_lame_default_settings.emphasis,
+          GST_TYPE_TWO_LAME_EMPHASIS, DEFAULT_EMPHASIS,
           G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
 
   g_object_class_install_property (G_OBJECT_CLASS (klass), ARG_ERROR_PROTECTION,
       g_param_spec_boolean ("error-protection", "Error protection",
           "Adds checksum to every frame",
-          gst_two_lame_default_settings.error_protection,
+          DEFAULT_ERROR_PROTECTION,
           G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
 
   g_object_class_install_property (G_OBJECT_CLASS (klass), ARG_COPYRIGHT,
       g_param_spec_boolean ("copyright", "Copyright", "Mark as copyright",
-          gst_two_lame_default_settings.copyright,
+          DEFAULT_COPYRIGHT,
           G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
 
   g_object_class_install_property (G_OBJECT_CLASS (klass), ARG_ORIGINAL,
       g_param_spec_boolean ("original", "Original", "Mark as original",
-          gst_two_lame_default_settings.original,
+          DEFAULT_ORIGINAL,
           G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
 
   g_object_class_install_property (G_OBJECT_CLASS (klass), ARG_VBR,
       g_param_spec_boolean ("vbr", "VBR", "Enable variable bitrate mode",
-          gst_two_lame_default_settings.vbr,
+          DEFAULT_VBR,
           G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
 
   g_object_class_install_property (G_OBJECT_CLASS (klass), ARG_VBR_LEVEL,
       g_param_spec_float ("vbr-level", "VBR Level", "VBR Level",
-          -10.0, 10.0, gst_two_lame_default_settings.vbr_level,
+          -10.0, 10.0, DEFAULT_VBR_LEVEL,
           G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
 
   g_object_class_install_property (G_OBJECT_CLASS (klass), ARG_ATH_LEVEL,
       g_param_spec_float ("ath-level", "ATH Level", "ATH Level in dB",
-          -G_MAXFLOAT, G_MAXFLOAT, gst_two_lame_default_settings.ath_level,
+          -G_MAXFLOAT, G_MAXFLOAT, DEFAULT_ATH_LEVEL,
           G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
 
   g_object_class_install_property (G_OBJECT_CLASS (klass), ARG_VBR_MAX_BITRATE,
       g_param_spec_int ("vbr-max-bitrate", "VBR max bitrate",
           "Specify maximum VBR bitrate (0=off, 8, 16, 24, 32, 40, 48, 56, 64, 80, 96, "
           "112, 128, 144, 160, 192, 224, 256, 320, 384)",
-          0, 384, gst_two_lame_default_settings.vbr_max_bitrate,
+          0, 384, DEFAULT_VBR_MAX_BITRATE,
           G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
 
   g_object_class_install_property (G_OBJECT_CLASS (klass), ARG_QUICK_MODE,
       g_param_spec_boolean ("quick-mode", "Quick mode",
           "Calculate Psymodel every frames",
-          gst_two_lame_default_settings.quick_mode,
+          DEFAULT_QUICK_MODE,
           G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
 
   g_object_class_install_property (G_OBJECT_CLASS (klass), ARG_QUICK_MODE_COUNT,
       g_param_spec_int ("quick-mode-count", "Quick mode count",
           "Calculate Psymodel every n frames",
-          0, G_MAXINT, gst_two_lame_default_settings.quick_mode_count,
+          0, G_MAXINT, DEFAULT_QUICK_MODE_COUNT,
           G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
 }
 
@@ -428,22 +428,22 @@ gst_two_lame_init (GstTwoLame * twolame, GstTwoLameClass * klass)
 {
   GST_DEBUG_OBJECT (twolame, "starting initialization");
 
-  twolame->mode = gst_two_lame_default_settings.mode;
-  twolame->psymodel = gst_two_lame_default_settings.psymodel;
-  twolame->bitrate = gst_two_lame_default_settings.bitrate;
-  twolame->padding = gst_two_lame_default_settings.padding;
+  twolame->mode = DEFAULT_MODE;
+  twolame->psymodel = DEFAULT_PSYMODEL;
+  twolame->bitrate = DEFAULT_BITRATE;
+  twolame->padding = DEFAULT_PADDING;
   twolame->energy_level_extension =
-      gst_two_lame_default_settings.energy_level_extension;
-  twolame->emphasis = gst_two_lame_default_settings.emphasis;
-  twolame->error_protection = gst_two_lame_default_settings.error_protection;
-  twolame->copyright = gst_two_lame_default_settings.copyright;
-  twolame->original = gst_two_lame_default_settings.original;
-  twolame->vbr = gst_two_lame_default_settings.vbr;
-  twolame->vbr_level = gst_two_lame_default_settings.vbr_level;
-  twolame->ath_level = gst_two_lame_default_settings.ath_level;
-  twolame->vbr_max_bitrate = gst_two_lame_default_settings.vbr_max_bitrate;
-  twolame->quick_mode = gst_two_lame_default_settings.quick_mode;
-  twolame->quick_mode_count = gst_two_lame_default_settings.quick_mode_count;
+      DEFAULT_ENERGY_LEVEL_EXTENSION;
+  twolame->emphasis = DEFAULT_EMPHASIS;
+  twolame->error_protection = DEFAULT_ERROR_PROTECTION;
+  twolame->copyright = DEFAULT_COPYRIGHT;
+  twolame->original = DEFAULT_ORIGINAL;
+  twolame->vbr = DEFAULT_VBR;
+  twolame->vbr_level = DEFAULT_VBR_LEVEL;
+  twolame->ath_level = DEFAULT_ATH_LEVEL;
+  twolame->vbr_max_bitrate = DEFAULT_VBR_MAX_BITRATE;
+  twolame->quick_mode = DEFAULT_QUICK_MODE;
+  twolame->quick_mode_count = DEFAULT_QUICK_MODE_COUNT;
 
   GST_DEBUG_OBJECT (twolame, "done initializing");
 }
@@ -828,58 +828,11 @@ gst_two_lame_setup (GstTwoLame * twolame)
 #undef CHECK_ERROR
 }
 
-static gboolean
-gst_two_lame_get_default_settings (void)
-{
-  twolame_options *glopts = NULL;
-
-  glopts = twolame_init ();
-  if (glopts == NULL) {
-    GST_ERROR ("Couldn't initialize TwoLAME");
-    return FALSE;
-  }
-
-  twolame_set_num_channels (glopts, 2);
-  twolame_set_in_samplerate (glopts, 44100);
-
-  if (twolame_init_params (glopts) != 0) {
-    GST_ERROR ("Couldn't set default parameters");
-    return FALSE;
-  }
-
-  gst_two_lame_default_settings.mode = TWOLAME_JOINT_STEREO;    /* twolame_get_mode (glopts); */
-  gst_two_lame_default_settings.psymodel = twolame_get_psymodel (glopts);
-  gst_two_lame_default_settings.bitrate = twolame_get_bitrate (glopts);
-  gst_two_lame_default_settings.padding = twolame_get_padding (glopts);
-  gst_two_lame_default_settings.energy_level_extension =
-      twolame_get_energy_levels (glopts);
-  gst_two_lame_default_settings.emphasis = twolame_get_emphasis (glopts);
-  gst_two_lame_default_settings.error_protection =
-      twolame_get_error_protection (glopts);
-  gst_two_lame_default_settings.copyright = twolame_get_copyright (glopts);
-  gst_two_lame_default_settings.original = twolame_get_original (glopts);
-  gst_two_lame_default_settings.vbr = twolame_get_VBR (glopts);
-  gst_two_lame_default_settings.vbr_level = twolame_get_VBR_level (glopts);
-  gst_two_lame_default_settings.ath_level = twolame_get_ATH_level (glopts);
-  gst_two_lame_default_settings.vbr_max_bitrate =
-      twolame_get_VBR_max_bitrate_kbps (glopts);
-  gst_two_lame_default_settings.quick_mode = twolame_get_quick_mode (glopts);
-  gst_two_lame_default_settings.quick_mode_count =
-      twolame_get_quick_count (glopts);
-
-  twolame_close (&glopts);
-
-  return TRUE;
-}
-
 static gboolean
 plugin_init (GstPlugin * plugin)
 {
   GST_DEBUG_CATEGORY_INIT (debug, "twolame", 0, "twolame mp2 encoder");
 
-  if (!gst_two_lame_get_default_settings ())
-    return FALSE;
-
 #ifdef ENABLE_NLS
   GST_DEBUG ("binding text domain %s to locale dir %s", GETTEXT_PACKAGE,
       LOCALEDIR);
@@ -87,6 +87,25 @@
  * specific settings are needed in this case to avoid pipeline stalling.
  * Depending on goals and context, other approaches are possible, e.g.
  * tune=zerolatency might be configured, or queue sizes increased.
+ * |[
+ * gst-launch -v videotestsrc num-buffers=1000 ! x264enc numa-node=0 ! fakesink \
+ *   videotestsrc num-buffers=1000 ! x264enc numa-node=1 ! fakesink
+ * ]| This example pipeline runs two encoders on a dual-socket machine, each
+ * with all its x264 threads on the CPUs of one NUMA node. The streaming
+ * thread is only pinned while it starts the x264 threads, which inherit its
+ * CPU set, so their picture buffers also end up in memory local to that node.
+ * The automatic thread count only counts the CPUs in the set.
+ * |[
+ * gst-launch -v filesrc location=movie.y4m ! decodebin2 ! x264enc segment-frames=250 \
+ *   segment-rc-budget=true bitrate=4000 ! mp4mux ! filesink location=movie.mp4
+ * ]| This example pipeline transcodes a file on a machine with many cores by
+ * splitting the video into segments of 250 frames that are encoded at the
+ * same time by independent x264 instances. Every segment starts with an IDR
+ * frame and uses the same SPS and PPS, so the output is one stream. The
+ * queued segments hold up to segment-max-bytes of raw video, 4 GiB by default,
+ * which is about five segments of 250 1080p frames. Raise it on machines with
+ * enough memory to keep all segment threads busy. This only makes sense when
+ * not encoding in real time.
  * </refsect2>
  */
 
@@ -94,6 +113,15 @@
 #  include "config.h"
 #endif
 
+#if defined (HAVE_SCHED_GETAFFINITY) && defined (HAVE_SCHED_SETAFFINITY)
+#  define X264_ENC_AFFINITY 1
+#  ifndef _GNU_SOURCE
+#    define _GNU_SOURCE
+#  endif
+#  include <sched.h>
+#  include <errno.h>
+#endif
+
 #include "gstx264enc.h"
 
 #include <gst/pbutils/pbutils.h>
@@ -129,6 +157,9 @@
 
 #include <string.h>
 #include <stdlib.h>
+#ifdef HAVE_UNISTD_H
+#include <unistd.h>
+#endif
 
 GST_DEBUG_CATEGORY_STATIC (x264_enc_debug);
 #define GST_CAT_DEFAULT x264_enc_debug
@@ -175,6 +206,13 @@ enum
   ARG_SPEED_PRESET,
   ARG_PSY_TUNE,
   ARG_TUNE,
+  ARG_REUSE_ENCODER,
+  ARG_CPU_AFFINITY,
+  ARG_NUMA_NODE,
+  ARG_SEGMENT_FRAMES,
+  ARG_SEGMENT_THREADS,
+  ARG_SEGMENT_RC_BUDGET,
+  ARG_SEGMENT_MAX_BYTES,
 };
 
 #define ARG_THREADS_DEFAULT            0        /* 0 means 'auto' which is 1.5x number of CPU cores */
@@ -213,10 +251,16 @@ enum
 #define ARG_INTRA_REFRESH_DEFAULT      FALSE
 #define ARG_PROFILE_DEFAULT            2        /* 'Main Profile' - matches profile of property defaults */
 #define ARG_OPTION_STRING_DEFAULT      ""
-static GString *x264enc_defaults;
 #define ARG_SPEED_PRESET_DEFAULT       6        /* 'medium' preset - matches x264 CLI default */
 #define ARG_PSY_TUNE_DEFAULT           0        /* no psy tuning */
 #define ARG_TUNE_DEFAULT               0        /* no tuning */
+#define ARG_REUSE_ENCODER_DEFAULT      FALSE
+#define ARG_CPU_AFFINITY_DEFAULT       ""
+#define ARG_NUMA_NODE_DEFAULT          -1
+#define ARG_SEGMENT_FRAMES_DEFAULT     0        /* no segments */
+#define ARG_SEGMENT_THREADS_DEFAULT    0        /* one per CPU */
+#define ARG_SEGMENT_RC_BUDGET_DEFAULT  FALSE
+#define ARG_SEGMENT_MAX_BYTES_DEFAULT  (G_GUINT64_CONSTANT (4) << 30)
 
 enum
 {
@@ -489,6 +533,15 @@ static gboolean gst_x264_enc_sink_event (GstPad * pad, GstEvent * event);
 static gboolean gst_x264_enc_src_event (GstPad * pad, GstEvent * event);
 static GstFlowReturn gst_x264_enc_chain (GstPad * pad, GstBuffer * buf);
 static void gst_x264_enc_flush_frames (GstX264Enc * encoder, gboolean send);
+static gboolean gst_x264_enc_start_segments (GstX264Enc * encoder);
+static void gst_x264_enc_stop_segments (GstX264Enc * encoder);
+static GstFlowReturn gst_x264_enc_finish_segments (GstX264Enc * encoder,
+    gboolean send);
+static GstFlowReturn gst_x264_enc_segment_chain (GstX264Enc * encoder,
+    GstBuffer * buf);
+static GstBuffer *gst_x264_enc_pop_delayed (GstX264Enc * encoder,
+    gboolean send);
+static void gst_x264_enc_discard_frames (GstX264Enc * encoder);
 static GstFlowReturn gst_x264_enc_encode_frame (GstX264Enc * encoder,
     x264_picture_t * pic_in, int *i_nal, gboolean send);
 static GstStateChangeReturn gst_x264_enc_change_state (GstElement * element,
@@ -553,16 +606,93 @@ gst_x264_enc_build_partitions (gint analyse)
   return (const gchar *) g_string_free (string, FALSE);
 }
 
+/* the option string matching the property defaults, applied when neither a
+ * preset nor a tuning is used. Built on first use rather than in class_init,
+ * which also runs when the registry is updated */
+static gpointer
+gst_x264_enc_build_defaults (gpointer data)
+{
+  GString *defaults;
+  const gchar *partitions;
+
+  defaults = g_string_new ("");
+
+  /* NOTE: this first string append doesn't require the ':' delimiter but the
+   * rest do */
+  g_string_append_printf (defaults, "threads=%d", ARG_THREADS_DEFAULT);
+#ifdef X264_ENH_THREADING
+  g_string_append_printf (defaults, ":sliced-threads=%d",
+      ARG_SLICED_THREADS_DEFAULT);
+  g_string_append_printf (defaults, ":sync-lookahead=%d",
+      ARG_SYNC_LOOKAHEAD_DEFAULT);
+#endif
+  g_string_append_printf (defaults, ":stats=%s",
+      ARG_MULTIPASS_CACHE_FILE_DEFAULT);
+  g_string_append_printf (defaults, ":annexb=%d", ARG_BYTE_STREAM_DEFAULT);
+#ifdef X264_INTRA_REFRESH
+  g_string_append_printf (defaults, ":intra-refresh=%d",
+      ARG_INTRA_REFRESH_DEFAULT);
+#endif
+  g_string_append_printf (defaults, ":me=%s",
+      x264_motion_est_names[ARG_ME_DEFAULT]);
+  g_string_append_printf (defaults, ":subme=%d", ARG_SUBME_DEFAULT);
+  partitions = gst_x264_enc_build_partitions (ARG_ANALYSE_DEFAULT);
+  if (partitions) {
+    g_string_append_printf (defaults, ":partitions=%s", partitions);
+    g_free ((gpointer) partitions);
+  }
+  g_string_append_printf (defaults, ":8x8dct=%d", ARG_DCT8x8_DEFAULT);
+  g_string_append_printf (defaults, ":ref=%d", ARG_REF_DEFAULT);
+  g_string_append_printf (defaults, ":bframes=%d", ARG_BFRAMES_DEFAULT);
+  g_string_append_printf (defaults, ":b-adapt=%d", ARG_B_ADAPT_DEFAULT);
+#ifdef X264_B_PYRAMID
+  g_string_append_printf (defaults, ":b-pyramid=%s",
+      x264_b_pyramid_names[ARG_B_PYRAMID_DEFAULT]);
+#else
+  g_string_append_printf (defaults, ":b-pyramid=%d", ARG_B_PYRAMID_DEFAULT);
+#endif /* X264_B_PYRAMID */
+  g_string_append_printf (defaults, ":weightb=%d", ARG_WEIGHTB_DEFAULT);
+  g_string_append_printf (defaults, ":sps-id=%d", ARG_SPS_ID_DEFAULT);
+  g_string_append_printf (defaults, ":aud=%d", ARG_AU_NALU_DEFAULT);
+  g_string_append_printf (defaults, ":trellis=%d", ARG_TRELLIS_DEFAULT);
+  g_string_append_printf (defaults, ":keyint=%d", ARG_KEYINT_MAX_DEFAULT);
+  g_string_append_printf (defaults, ":cabac=%d", ARG_CABAC_DEFAULT);
+  g_string_append_printf (defaults, ":qpmin=%d", ARG_QP_MIN_DEFAULT);
+  g_string_append_printf (defaults, ":qpmax=%d", ARG_QP_MAX_DEFAULT);
+  g_string_append_printf (defaults, ":qpstep=%d", ARG_QP_STEP_DEFAULT);
+  g_string_append_printf (defaults, ":ip-factor=%f", ARG_IP_FACTOR_DEFAULT);
+  g_string_append_printf (defaults, ":pb-factor=%f", ARG_PB_FACTOR_DEFAULT);
+#ifdef X264_MB_RC
+  g_string_append_printf (defaults, ":mbtree=%d", ARG_RC_MB_TREE_DEFAULT);
+  g_string_append_printf (defaults, ":rc-lookahead=%d",
+      ARG_RC_LOOKAHEAD_DEFAULT);
+#endif
+  g_string_append_printf (defaults, ":nr=%d", ARG_NR_DEFAULT);
+  g_string_append_printf (defaults, ":interlaced=%d", ARG_INTERLACED_DEFAULT);
+  /* append deblock parameters */
+  g_string_append_printf (defaults, ":deblock=0,0");
+  /* append weighted prediction parameter */
+  g_string_append_printf (defaults, ":weightp=0");
+
+  return g_string_free (defaults, FALSE);
+}
+
+static const gchar *
+gst_x264_enc_get_defaults (void)
+{
+  static GOnce defaults_once = G_ONCE_INIT;
+
+  g_once (&defaults_once, gst_x264_enc_build_defaults, NULL);
+
+  return defaults_once.retval;
+}
+
 static void
 gst_x264_enc_class_init (GstX264EncClass * klass)
 {
   GObjectClass *gobject_class;
   GstElementClass *gstelement_class;
 
-  const gchar *partitions = NULL;
-
-  x264enc_defaults = g_string_new ("");
-
   gobject_class = (GObjectClass *) klass;
   gstelement_class = (GstElementClass *) klass;
 
@@ -632,24 +762,17 @@ gst_x264_enc_class_init (GstX264EncClass * klass)
           "Number of threads used by the codec (0 for automatic)",
           0, 4, ARG_THREADS_DEFAULT,
           G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
-  /* NOTE: this first string append doesn't require the ':' delimiter but the
-   * rest do */
-  g_string_append_printf (x264enc_defaults, "threads=%d", ARG_THREADS_DEFAULT);
 #ifdef X264_ENH_THREADING
   g_object_class_install_property (gobject_class, ARG_SLICED_THREADS,
       g_param_spec_boolean ("sliced-threads", "Sliced Threads",
           "Low latency but lower efficiency threading",
           ARG_SLICED_THREADS_DEFAULT,
           G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
-  g_string_append_printf (x264enc_defaults, ":sliced-threads=%d",
-      ARG_SLICED_THREADS_DEFAULT);
   g_object_class_install_property (gobject_class, ARG_SYNC_LOOKAHEAD,
       g_param_spec_int ("sync-lookahead", "Sync Lookahead",
           "Number of buffer frames for threaded lookahead (-1 for automatic)",
           -1, 250, ARG_SYNC_LOOKAHEAD_DEFAULT,
           G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
-  g_string_append_printf (x264enc_defaults, ":sync-lookahead=%d",
-      ARG_SYNC_LOOKAHEAD_DEFAULT);
 #endif
   g_object_class_install_property (gobject_class, ARG_STATS_FILE,
       g_param_spec_string ("stats-file", "Stats File",
@@ -660,169 +783,161 @@ gst_x264_enc_class_init (GstX264EncClass * klass)
           "Filename for multipass cache file",
           ARG_MULTIPASS_CACHE_FILE_DEFAULT,
           G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
-  g_string_append_printf (x264enc_defaults, ":stats=%s",
-      ARG_MULTIPASS_CACHE_FILE_DEFAULT);
   g_object_class_install_property (gobject_class, ARG_BYTE_STREAM,
       g_param_spec_boolean ("byte-stream", "Byte Stream",
           "Generate byte stream format of NALU", ARG_BYTE_STREAM_DEFAULT,
           G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
-  g_string_append_printf (x264enc_defaults, ":annexb=%d",
-      ARG_BYTE_STREAM_DEFAULT);
 #ifdef X264_INTRA_REFRESH
   g_object_class_install_property (gobject_class, ARG_INTRA_REFRESH,
       g_param_spec_boolean ("intra-refresh", "Intra Refresh",
           "Use Periodic Intra Refresh instead of IDR frames",
           ARG_INTRA_REFRESH_DEFAULT,
           G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
-  g_string_append_printf (x264enc_defaults, ":intra-refresh=%d",
-      ARG_INTRA_REFRESH_DEFAULT);
 #endif
   g_object_class_install_property (gobject_class, ARG_ME,
       g_param_spec_enum ("me", "Motion Estimation",
           "Integer pixel motion estimation method", GST_X264_ENC_ME_TYPE,
           ARG_ME_DEFAULT, G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
-  g_string_append_printf (x264enc_defaults, ":me=%s",
-      x264_motion_est_names[ARG_ME_DEFAULT]);
   g_object_class_install_property (gobject_class, ARG_SUBME,
       g_param_spec_uint ("subme", "Subpixel Motion Estimation",
           "Subpixel motion estimation and partition decision quality: 1=fast, 10=best",
           1, 10, ARG_SUBME_DEFAULT,
           G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
-  g_string_append_printf (x264enc_defaults, ":subme=%d", ARG_SUBME_DEFAULT);
   g_object_class_install_property (gobject_class, ARG_ANALYSE,
       g_param_spec_flags ("analyse", "Analyse", "Partitions to consider",
           GST_X264_ENC_ANALYSE_TYPE, ARG_ANALYSE_DEFAULT,
           G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
-  partitions = gst_x264_enc_build_partitions (ARG_ANALYSE_DEFAULT);
-  if (partitions) {
-    g_string_append_printf (x264enc_defaults, ":partitions=%s", partitions);
-    g_free ((gpointer) partitions);
-  }
   g_object_class_install_property (gobject_class, ARG_DCT8x8,
       g_param_spec_boolean ("dct8x8", "DCT8x8",
           "Adaptive spatial transform size", ARG_DCT8x8_DEFAULT,
           G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
-  g_string_append_printf (x264enc_defaults, ":8x8dct=%d", ARG_DCT8x8_DEFAULT);
   g_object_class_install_property (gobject_class, ARG_REF,
       g_param_spec_uint ("ref", "Reference Frames",
           "Number of reference frames",
           1, 12, ARG_REF_DEFAULT, G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
-  g_string_append_printf (x264enc_defaults, ":ref=%d", ARG_REF_DEFAULT);
   g_object_class_install_property (gobject_class, ARG_BFRAMES,
       g_param_spec_uint ("bframes", "B-Frames",
           "Number of B-frames between I and P",
           0, 4, ARG_BFRAMES_DEFAULT,
           G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
-  g_string_append_printf (x264enc_defaults, ":bframes=%d", ARG_BFRAMES_DEFAULT);
   g_object_class_install_property (gobject_class, ARG_B_ADAPT,
       g_param_spec_boolean ("b-adapt", "B-Adapt",
           "Automatically decide how many B-frames to use",
           ARG_B_ADAPT_DEFAULT, G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
-  g_string_append_printf (x264enc_defaults, ":b-adapt=%d", ARG_B_ADAPT_DEFAULT);
   g_object_class_install_property (gobject_class, ARG_B_PYRAMID,
       g_param_spec_boolean ("b-pyramid", "B-Pyramid",
           "Keep some B-frames as references", ARG_B_PYRAMID_DEFAULT,
           G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
-#ifdef X264_B_PYRAMID
-  g_string_append_printf (x264enc_defaults, ":b-pyramid=%s",
-      x264_b_pyramid_names[ARG_B_PYRAMID_DEFAULT]);
-#else
-  g_string_append_printf (x264enc_defaults, ":b-pyramid=%d",
-      ARG_B_PYRAMID_DEFAULT);
-#endif /* X264_B_PYRAMID */
   g_object_class_install_property (gobject_class, ARG_WEIGHTB,
       g_param_spec_boolean ("weightb", "Weighted B-Frames",
           "Weighted prediction for B-frames", ARG_WEIGHTB_DEFAULT,
           G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
-  g_string_append_printf (x264enc_defaults, ":weightb=%d", ARG_WEIGHTB_DEFAULT);
   g_object_class_install_property (gobject_class, ARG_SPS_ID,
       g_param_spec_uint ("sps-id", "SPS ID",
           "SPS and PPS ID number",
           0, 31, ARG_SPS_ID_DEFAULT,
           G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
-  g_string_append_printf (x264enc_defaults, ":sps-id=%d", ARG_SPS_ID_DEFAULT);
   g_object_class_install_property (gobject_class, ARG_AU_NALU,
       g_param_spec_boolean ("aud", "AUD",
           "Use AU (Access Unit) delimiter", ARG_AU_NALU_DEFAULT,
           G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
-  g_string_append_printf (x264enc_defaults, ":aud=%d", ARG_AU_NALU_DEFAULT);
   g_object_class_install_property (gobject_class, ARG_TRELLIS,
       g_param_spec_boolean ("trellis", "Trellis quantization",
           "Enable trellis searched quantization", ARG_TRELLIS_DEFAULT,
           G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
-  g_string_append_printf (x264enc_defaults, ":trellis=%d", ARG_TRELLIS_DEFAULT);
   g_object_class_install_property (gobject_class, ARG_KEYINT_MAX,
       g_param_spec_uint ("key-int-max", "Key-frame maximal interval",
           "Maximal distance between two key-frames (0 for automatic)",
           0, G_MAXINT, ARG_KEYINT_MAX_DEFAULT,
           G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
-  g_string_append_printf (x264enc_defaults, ":keyint=%d",
-      ARG_KEYINT_MAX_DEFAULT);
   g_object_class_install_property (gobject_class, ARG_CABAC,
       g_param_spec_boolean ("cabac", "Use CABAC", "Enable CABAC entropy coding",
           ARG_CABAC_DEFAULT, G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
-  g_string_append_printf (x264enc_defaults, ":cabac=%d", ARG_CABAC_DEFAULT);
   g_object_class_install_property (gobject_class, ARG_QP_MIN,
       g_param_spec_uint ("qp-min", "Minimum Quantizer",
           "Minimum quantizer", 1, 51, ARG_QP_MIN_DEFAULT,
           G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
-  g_string_append_printf (x264enc_defaults, ":qpmin=%d", ARG_QP_MIN_DEFAULT);
   g_object_class_install_property (gobject_class, ARG_QP_MAX,
       g_param_spec_uint ("qp-max", "Maximum Quantizer",
           "Maximum quantizer", 1, 51, ARG_QP_MAX_DEFAULT,
           G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
-  g_string_append_printf (x264enc_defaults, ":qpmax=%d", ARG_QP_MAX_DEFAULT);
   g_object_class_install_property (gobject_class, ARG_QP_STEP,
       g_param_spec_uint ("qp-step", "Maximum Quantizer Difference",
           "Maximum quantizer difference between frames",
           1, 50, ARG_QP_STEP_DEFAULT,
           G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
-  g_string_append_printf (x264enc_defaults, ":qpstep=%d", ARG_QP_STEP_DEFAULT);
   g_object_class_install_property (gobject_class, ARG_IP_FACTOR,
       g_param_spec_float ("ip-factor", "IP-Factor",
           "Quantizer factor between I- and P-frames",
           0, 2, ARG_IP_FACTOR_DEFAULT,
           G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
-  g_string_append_printf (x264enc_defaults, ":ip-factor=%f",
-      ARG_IP_FACTOR_DEFAULT);
   g_object_class_install_property (gobject_class, ARG_PB_FACTOR,
       g_param_spec_float ("pb-factor", "PB-Factor",
           "Quantizer factor between P- and B-frames", 0, 2,
           ARG_PB_FACTOR_DEFAULT, G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
-  g_string_append_printf (x264enc_defaults, ":pb-factor=%f",
-      ARG_PB_FACTOR_DEFAULT);
 #ifdef X264_MB_RC
   g_object_class_install_property (gobject_class, ARG_RC_MB_TREE,
       g_param_spec_boolean ("mb-tree", "Macroblock Tree",
           "Macroblock-Tree ratecontrol",
           ARG_RC_MB_TREE_DEFAULT, G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
-  g_string_append_printf (x264enc_defaults, ":mbtree=%d",
-      ARG_RC_MB_TREE_DEFAULT);
   g_object_class_install_property (gobject_class, ARG_RC_LOOKAHEAD,
       g_param_spec_int ("rc-lookahead", "Rate Control Lookahead",
           "Number of frames for frametype lookahead", 0, 250,
           ARG_RC_LOOKAHEAD_DEFAULT,
           G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
-  g_string_append_printf (x264enc_defaults, ":rc-lookahead=%d",
-      ARG_RC_LOOKAHEAD_DEFAULT);
 #endif
   g_object_class_install_property (gobject_class, ARG_NR,
       g_param_spec_uint ("noise-reduction", "Noise Reduction",
           "Noise reduction strength",
           0, 100000, ARG_NR_DEFAULT,
           G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
-  g_string_append_printf (x264enc_defaults, ":nr=%d", ARG_NR_DEFAULT);
   g_object_class_install_property (gobject_class, ARG_INTERLACED,
       g_param_spec_boolean ("interlaced", "Interlaced",
           "Interlaced material", ARG_INTERLACED_DEFAULT,
           G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
-  g_string_append_printf (x264enc_defaults, ":interlaced=%d",
-      ARG_INTERLACED_DEFAULT);
 
-  /* append deblock parameters */
-  g_string_append_printf (x264enc_defaults, ":deblock=0,0");
-  /* append weighted prediction parameter */
-  g_string_append_printf (x264enc_defaults, ":weightp=0");
+  g_object_class_install_property (gobject_class, ARG_REUSE_ENCODER,
+      g_param_spec_boolean ("reuse-encoder", "Reuse encoder",
+          "Keep the encoder running across flushes and new segments and start "
+          "each of them with an IDR frame instead of restarting the encoder",
+          ARG_REUSE_ENCODER_DEFAULT,
+          G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
+  g_object_class_install_property (gobject_class, ARG_CPU_AFFINITY,
+      g_param_spec_string ("cpu-affinity", "CPU affinity",
+          "List of CPUs (e.g. \"0-3,8\") to run the x264 threads on, empty "
+          "for no restriction",
+          ARG_CPU_AFFINITY_DEFAULT,
+          G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
+  g_object_class_install_property (gobject_class, ARG_NUMA_NODE,
+      g_param_spec_int ("numa-node", "NUMA node",
+          "Run the x264 threads on the CPUs of this NUMA node, combined with "
+          "cpu-affinity (-1 = any node)",
+          -1, G_MAXINT, ARG_NUMA_NODE_DEFAULT,
+          G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
+  g_object_class_install_property (gobject_class, ARG_SEGMENT_FRAMES,
+      g_param_spec_uint ("segment-frames", "Segment frames",
+          "Split the video into segments of this many frames and encode them "
+          "in parallel with independent encoders, for offline encoding. "
+          "Needs at least 2 and at most key-int-max frames (0 = disabled)",
+          0, G_MAXINT, ARG_SEGMENT_FRAMES_DEFAULT,
+          G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
+  g_object_class_install_property (gobject_class, ARG_SEGMENT_THREADS,
+      g_param_spec_uint ("segment-threads", "Segment threads",
+          "Number of segments to encode at the same time (0 = one per CPU)",
+          0, G_MAXINT, ARG_SEGMENT_THREADS_DEFAULT,
+          G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
+  g_object_class_install_property (gobject_class, ARG_SEGMENT_RC_BUDGET,
+      g_param_spec_boolean ("segment-rc-budget", "Segment RC budget",
+          "With segment-frames and an average bitrate, correct the bitrate of "
+          "each new segment by how far the finished ones missed their target",
+          ARG_SEGMENT_RC_BUDGET_DEFAULT,
+          G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
+  g_object_class_install_property (gobject_class, ARG_SEGMENT_MAX_BYTES,
+      g_param_spec_uint64 ("segment-max-bytes", "Segment max bytes",
+          "With segment-frames, block upstream while the queued segments hold "
+          "more than this many bytes of raw video (0 = no limit)",
+          0, G_MAXUINT64, ARG_SEGMENT_MAX_BYTES_DEFAULT,
+          G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
 }
 
 static void
@@ -923,9 +1038,19 @@ gst_x264_enc_init (GstX264Enc * encoder, GstX264EncClass * klass)
   encoder->speed_preset = ARG_SPEED_PRESET_DEFAULT;
   encoder->psy_tune = ARG_PSY_TUNE_DEFAULT;
   encoder->tune = ARG_TUNE_DEFAULT;
+  encoder->reuse_encoder = ARG_REUSE_ENCODER_DEFAULT;
+  encoder->cpu_affinity = g_strdup (ARG_CPU_AFFINITY_DEFAULT);
+  encoder->numa_node = ARG_NUMA_NODE_DEFAULT;
+  encoder->segment_frames = ARG_SEGMENT_FRAMES_DEFAULT;
+  encoder->segment_threads = ARG_SEGMENT_THREADS_DEFAULT;
+  encoder->segment_rc_budget = ARG_SEGMENT_RC_BUDGET_DEFAULT;
+  encoder->segment_max_bytes = ARG_SEGMENT_MAX_BYTES_DEFAULT;
 
   /* resources */
   encoder->delay = g_queue_new ();
+  encoder->segments = g_queue_new ();
+  encoder->segment_lock = g_mutex_new ();
+  encoder->segment_cond = g_cond_new ();
   encoder->buffer_size = 100000;
   encoder->buffer = g_malloc (encoder->buffer_size);
 
@@ -946,6 +1071,11 @@ gst_x264_enc_reset (GstX264Enc * encoder)
   encoder->width = 0;
   encoder->height = 0;
   encoder->current_byte_stream = GST_X264_ENC_STREAM_FORMAT_FROM_PROPERTY;
+  encoder->discard_frames = 0;
+  encoder->drained = FALSE;
+  encoder->pts_offset = 0;
+  encoder->next_pts = 0;
+  encoder->pts_resync = FALSE;
 
   GST_OBJECT_LOCK (encoder);
   encoder->i_type = X264_TYPE_AUTO;
@@ -972,6 +1102,8 @@ gst_x264_enc_finalize (GObject * object)
 
   g_free (encoder->mp_cache_file);
   encoder->mp_cache_file = NULL;
+  g_free (encoder->cpu_affinity);
+  encoder->cpu_affinity = NULL;
   g_free (encoder->buffer);
   encoder->buffer = NULL;
   g_queue_free (encoder->delay);
@@ -979,6 +1111,11 @@ gst_x264_enc_finalize (GObject * object)
 
   gst_x264_enc_close_encoder (encoder);
 
+  g_queue_free (encoder->segments);
+  encoder->segments = NULL;
+  g_mutex_free (encoder->segment_lock);
+  g_cond_free (encoder->segment_cond);
+
   G_OBJECT_CLASS (parent_class)->finalize (object);
 }
 
@@ -1030,6 +1167,175 @@ gst_x264_enc_parse_options (GstX264Enc * encoder, const gchar * str)
   return !ret;
 }
 
+#ifdef X264_ENC_AFFINITY
+typedef cpu_set_t GstX264EncCpuSet;
+
+/* CPU_AND and CPU_COUNT are missing from older C libraries */
+#ifndef CPU_AND
+#  define CPU_AND(dest, a, b) gst_x264_enc_cpu_and (dest, a, b)
+static void
+gst_x264_enc_cpu_and (cpu_set_t * dest, cpu_set_t * a, cpu_set_t * b)
+{
+  gint i;
+
+  for (i = 0; i < CPU_SETSIZE; i++) {
+    if (CPU_ISSET (i, a) && CPU_ISSET (i, b))
+      CPU_SET (i, dest);
+    else
+      CPU_CLR (i, dest);
+  }
+}
+#endif
+
+#ifndef CPU_COUNT
+#  define CPU_COUNT(set) gst_x264_enc_cpu_count (set)
+static gint
+gst_x264_enc_cpu_count (cpu_set_t * set)
+{
+  gint i, count = 0;
+
+  for (i = 0; i < CPU_SETSIZE; i++) {
+    if (CPU_ISSET (i, set))
+      count++;
+  }
+  return count;
+}
+#endif
+
+/* parse a list of CPUs like "0-3,8,10-11", as also used in sysfs */
+static gboolean
+gst_x264_enc_parse_cpu_list (const gchar * str, cpu_set_t * set)
+{
+  gchar **ranges;
+  gboolean ret = TRUE;
+  gint i;
+
+  CPU_ZERO (set);
+
+  ranges = g_strsplit (str, ",", -1);
+  for (i = 0; ranges[i] != NULL && ret; i++) {
+    gchar *range = g_strstrip (ranges[i]);
+    gchar *end;
+    guint64 first, last;
+
+    if (*range == '\0')
+      continue;
+
+    first = last = g_ascii_strtoull (range, &end, 10);
+    if (end == range) {
+      ret = FALSE;
+      break;
+    }
+    if (*end == '-') {
+      range = end + 1;
+      last = g_ascii_strtoull (range, &end, 10);
+      if (end == range)
+        ret = FALSE;
+    }
+    if (*end != '\0' || last < first || last >= CPU_SETSIZE) {
+      ret = FALSE;
+      break;
+    }
+    for (; first <= last; first++)
+      CPU_SET (first, set);
+  }
+  g_strfreev (ranges);
+
+  return ret;
+}
+#else
+typedef gint GstX264EncCpuSet;
+#endif
+
+/*
+ * gst_x264_enc_set_affinity
+ * @encoder: Encoder with the cpu-affinity and numa-node properties
+ * @old_set: Where to store the previous CPU set of the thread, or NULL
+ *
+ * Restrict the calling thread to the configured CPUs. Must be called with the
+ * object lock.
+ *
+ * Returns: TRUE if the thread was pinned and @old_set was filled in.
+ */
+static gboolean
+gst_x264_enc_set_affinity (GstX264Enc * encoder, GstX264EncCpuSet * old_set)
+{
+#ifdef X264_ENC_AFFINITY
+  cpu_set_t set, node_set;
+  gboolean have_set = FALSE;
+
+  if (encoder->cpu_affinity && *encoder->cpu_affinity) {
+    if (!gst_x264_enc_parse_cpu_list (encoder->cpu_affinity, &set)) {
+      GST_WARNING_OBJECT (encoder, "invalid CPU list \"%s\"",
+          encoder->cpu_affinity);
+      return FALSE;
+    }
+    have_set = TRUE;
+  }
+
+  if (encoder->numa_node >= 0) {
+    gchar *path, *contents = NULL;
+
+    path = g_strdup_printf ("/sys/devices/system/node/node%d/cpulist",
+        encoder->numa_node);
+    if (g_file_get_contents (path, &contents, NULL, NULL) &&
+        gst_x264_enc_parse_cpu_list (g_strstrip (contents), &node_set)) {
+      if (have_set)
+        CPU_AND (&set, &set, &node_set);
+      else
+        memcpy (&set, &node_set, sizeof (cpu_set_t));
+      have_set = TRUE;
+    } else {
+      GST_WARNING_OBJECT (encoder, "could not get the CPUs of NUMA node %d",
+          encoder->numa_node);
+    }
+    g_free (contents);
+    g_free (path);
+  }
+
+  if (!have_set)
+    return FALSE;
+
+  if (CPU_COUNT (&set) == 0) {
+    GST_WARNING_OBJECT (encoder, "no CPUs left to run on, not pinning");
+    return FALSE;
+  }
+
+  if (old_set && sched_getaffinity (0, sizeof (cpu_set_t), old_set) < 0) {
+    GST_WARNING_OBJECT (encoder, "could not get CPU affinity: %s",
+        g_strerror (errno));
+    return FALSE;
+  }
+
+  if (sched_setaffinity (0, sizeof (cpu_set_t), &set) < 0) {
+    GST_WARNING_OBJECT (encoder, "could not set CPU affinity: %s",
+        g_strerror (errno));
+    return FALSE;
+  }
+
+  GST_INFO_OBJECT (encoder, "running on %d CPUs", CPU_COUNT (&set));
+  return TRUE;
+#else
+  if ((encoder->cpu_affinity && *encoder->cpu_affinity) ||
+      encoder->numa_node >= 0)
+    GST_WARNING_OBJECT (encoder, "CPU affinity not supported on this system");
+  return FALSE;
+#endif
+}
+
+/* give the calling thread back the CPU set it had before
+ * gst_x264_enc_set_affinity() */
+static void
+gst_x264_enc_restore_affinity (GstX264Enc * encoder,
+    GstX264EncCpuSet * old_set)
+{
+#ifdef X264_ENC_AFFINITY
+  if (sched_setaffinity (0, sizeof (cpu_set_t), old_set) < 0)
+    GST_WARNING_OBJECT (encoder, "could not restore CPU affinity: %s",
+        g_strerror (errno));
+#endif
+}
+
 /*
  * gst_x264_enc_init_encoder
  * @encoder:  Encoder which should be initialized.
@@ -1041,6 +1347,8 @@ static gboolean
 gst_x264_enc_init_encoder (GstX264Enc * encoder)
 {
   guint pass = 0;
+  GstX264EncCpuSet old_set;
+  gboolean pinned;
 
   /* make sure that the encoder is closed */
   gst_x264_enc_close_encoder (encoder);
@@ -1069,9 +1377,8 @@ gst_x264_enc_init_encoder (GstX264Enc * encoder)
   if (!encoder->speed_preset && !encoder->tunings->len) {
 #endif /* X264_PRESETS */
     GST_DEBUG_OBJECT (encoder, "Applying x264enc_defaults");
-    if (x264enc_defaults->len
-        && gst_x264_enc_parse_options (encoder,
-            x264enc_defaults->str) == FALSE) {
+    if (gst_x264_enc_parse_options (encoder,
+            gst_x264_enc_get_defaults ()) == FALSE) {
       GST_DEBUG_OBJECT (encoder,
           "x264enc_defaults string contains errors. This is a bug.");
       goto unlock_and_return;
@@ -1261,14 +1568,29 @@ gst_x264_enc_init_encoder (GstX264Enc * encoder)
 
   encoder->reconfig = FALSE;
 
+  /* x264 starts its threads from this thread when opening the encoder and
+   * they inherit its CPU set. This is the upstream streaming thread, so it
+   * only keeps that set until the encoder is open */
+  pinned = gst_x264_enc_set_affinity (encoder, &old_set);
+
   GST_OBJECT_UNLOCK (encoder);
 
-  encoder->x264enc = x264_encoder_open (&encoder->x264param);
-  if (!encoder->x264enc) {
+  /* with segment-frames the segment encoders do all the work, the threads of
+   * their pool are started here and inherit the CPU set too */
+  if (!gst_x264_enc_start_segments (encoder))
+    encoder->x264enc = x264_encoder_open (&encoder->x264param);
+  if (pinned)
+    gst_x264_enc_restore_affinity (encoder, &old_set);
+  if (!encoder->x264enc && !encoder->segment_pool) {
     GST_ELEMENT_ERROR (encoder, STREAM, ENCODE,
         ("Can not initialize x264 encoder."), (NULL));
     return FALSE;
   }
+  encoder->drained = FALSE;
+  encoder->discard_frames = 0;
+  encoder->pts_offset = 0;
+  encoder->next_pts = 0;
+  encoder->pts_resync = FALSE;
 
   return TRUE;
 
@@ -1285,6 +1607,8 @@ unlock_and_return:
 static void
 gst_x264_enc_close_encoder (GstX264Enc * encoder)
 {
+  gst_x264_enc_stop_segments (encoder);
+
   if (encoder->x264enc != NULL) {
     x264_encoder_close (encoder->x264enc);
     encoder->x264enc = NULL;
@@ -1442,8 +1766,21 @@ gst_x264_enc_set_src_caps (GstX264Enc * encoder, GstPad * pad, GstCaps * caps)
   GstBuffer *buf;
   GstCaps *outcaps;
   GstStructure *structure;
+  x264_t *header_enc = NULL;
   gboolean res;
 
+  /* with segment-frames there is no encoder of our own, take the headers
+   * from one opened with the parameters of the segment encoders */
+  if (encoder->x264enc == NULL && encoder->segment_pool) {
+    header_enc = x264_encoder_open (&encoder->segment_param);
+    if (header_enc == NULL) {
+      GST_ELEMENT_ERROR (encoder, STREAM, ENCODE,
+          ("Can not initialize x264 encoder."), (NULL));
+      return FALSE;
+    }
+    encoder->x264enc = header_enc;
+  }
+
   outcaps = gst_caps_new_simple ("video/x-h264",
       "width", G_TYPE_INT, encoder->width,
       "height", G_TYPE_INT, encoder->height,
@@ -1473,14 +1810,17 @@ gst_x264_enc_set_src_caps (GstX264Enc * encoder, GstPad * pad, GstCaps * caps)
   }
   gst_structure_set (structure, "alignment", G_TYPE_STRING, "au", NULL);
 
-  if (!gst_x264_enc_set_profile_and_level (encoder, outcaps)) {
-    gst_caps_unref (outcaps);
-    return FALSE;
-  }
-
-  res = gst_pad_set_caps (pad, outcaps);
+  if (gst_x264_enc_set_profile_and_level (encoder, outcaps))
+    res = gst_pad_set_caps (pad, outcaps);
+  else
+    res = FALSE;
   gst_caps_unref (outcaps);
 
+  if (header_enc) {
+    x264_encoder_close (header_enc);
+    encoder->x264enc = NULL;
+  }
+
   return res;
 }
 
@@ -1510,11 +1850,22 @@ gst_x264_enc_sink_set_caps (GstPad * pad, GstCaps * caps)
 
   /* If the encoder is initialized, do not reinitialize it again if not
    * necessary */
-  if (encoder->x264enc) {
+  if (encoder->x264enc || encoder->segment_pool) {
     if (width == encoder->width && height == encoder->height
         && fps_num == encoder->fps_num && fps_den == encoder->fps_den
-        && par_num == encoder->par_num && par_den == encoder->par_den)
+        && par_num == encoder->par_num && par_den == encoder->par_den) {
+      /* I420 and YV12 only differ in the plane layout we hand to x264 */
+      if (format != encoder->format) {
+        encoder->format = format;
+        for (i = 0; i < 3; ++i) {
+          encoder->offset[i] =
+              gst_video_format_get_component_offset (format, i, width, height);
+          encoder->stride[i] =
+              gst_video_format_get_row_stride (format, i, width);
+        }
+      }
       return TRUE;
+    }
 
     /* clear out pending frames */
     gst_x264_enc_flush_frames (encoder, TRUE);
@@ -1780,6 +2131,31 @@ gst_x264_enc_sink_event (GstPad * pad, GstEvent * event)
   switch (GST_EVENT_TYPE (event)) {
     case GST_EVENT_EOS:
       gst_x264_enc_flush_frames (encoder, TRUE);
+      /* x264 stops its lookahead when flushed, with reuse-encoder we need a
+       * new one for more data after a flushing seek */
+      if (encoder->reuse_encoder && encoder->x264enc)
+        encoder->drained = TRUE;
+      break;
+    case GST_EVENT_FLUSH_STOP:
+      gst_x264_enc_finish_segments (encoder, FALSE);
+      if (encoder->reuse_encoder && encoder->x264enc && !encoder->drained)
+        gst_x264_enc_discard_frames (encoder);
+      break;
+    case GST_EVENT_NEWSEGMENT:
+      if (encoder->reuse_encoder && encoder->x264enc && !encoder->drained) {
+        GST_DEBUG_OBJECT (encoder, "new segment, forcing IDR frame");
+        GST_OBJECT_LOCK (encoder);
+        encoder->i_type = X264_TYPE_IDR;
+        GST_OBJECT_UNLOCK (encoder);
+
+        /* frames of the previous segment are still in x264, send the event
+         * after them */
+        if (!g_queue_is_empty (encoder->delay)) {
+          g_queue_push_tail (encoder->delay, event);
+          gst_object_unref (encoder);
+          return TRUE;
+        }
+      }
       break;
     case GST_EVENT_TAG:{
       GstTagList *tags = NULL;
@@ -1828,7 +2204,13 @@ gst_x264_enc_chain (GstPad * pad, GstBuffer * buf)
   GstFlowReturn ret;
   x264_picture_t pic_in;
   gint i_nal, i;
-  if (G_UNLIKELY (encoder->x264enc == NULL))
+
+  if (G_UNLIKELY (encoder->drained)) {
+    GST_DEBUG_OBJECT (encoder, "encoder was drained, restarting it");
+    gst_x264_enc_init_encoder (encoder);
+  }
+
+  if (G_UNLIKELY (encoder->x264enc == NULL && encoder->segment_pool == NULL))
     goto not_inited;
 
   /* create x264_picture_t from the buffer */
@@ -1836,6 +2218,9 @@ gst_x264_enc_chain (GstPad * pad, GstBuffer * buf)
   if (G_UNLIKELY (GST_BUFFER_SIZE (buf) < encoder->image_size))
     goto wrong_buffer_size;
 
+  if (encoder->segment_pool)
+    return gst_x264_enc_segment_chain (encoder, buf);
+
   /* remember the timestamp and duration */
   g_queue_push_tail (encoder->delay, buf);
 
@@ -1856,7 +2241,18 @@ gst_x264_enc_chain (GstPad * pad, GstBuffer * buf)
   encoder->i_type = X264_TYPE_AUTO;
   GST_OBJECT_UNLOCK (encoder);
 
-  pic_in.i_pts = GST_BUFFER_TIMESTAMP (buf);
+  if (G_UNLIKELY (encoder->pts_resync)) {
+    encoder->pts_offset =
+        encoder->next_pts - (gint64) GST_BUFFER_TIMESTAMP (buf);
+    encoder->pts_resync = FALSE;
+    GST_DEBUG_OBJECT (encoder, "pts offset after flush %" G_GINT64_FORMAT,
+        encoder->pts_offset);
+  }
+  pic_in.i_pts = GST_BUFFER_TIMESTAMP (buf) + encoder->pts_offset;
+  if (GST_BUFFER_DURATION_IS_VALID (buf))
+    encoder->next_pts = pic_in.i_pts + GST_BUFFER_DURATION (buf);
+  else
+    encoder->next_pts = pic_in.i_pts + 1;
 
   ret = gst_x264_enc_encode_frame (encoder, &pic_in, &i_nal, TRUE);
 
@@ -1881,6 +2277,51 @@ wrong_buffer_size:
   }
 }
 
+/* pop the input buffer that goes with the next encoded frame. Events queued
+ * before it are pushed downstream first, or dropped when @send is FALSE */
+static GstBuffer *
+gst_x264_enc_pop_delayed (GstX264Enc * encoder, gboolean send)
+{
+  GstMiniObject *obj;
+
+  while ((obj = g_queue_pop_head (encoder->delay))) {
+    if (GST_IS_BUFFER (obj))
+      return GST_BUFFER_CAST (obj);
+
+    if (send)
+      gst_pad_push_event (encoder->srcpad, GST_EVENT_CAST (obj));
+    else
+      gst_event_unref (GST_EVENT_CAST (obj));
+  }
+  return NULL;
+}
+
+/* after a flush, keep x264 running but throw away what it still outputs for
+ * the old input and start the new data with an IDR frame */
+static void
+gst_x264_enc_discard_frames (GstX264Enc * encoder)
+{
+  GList *walk, *next;
+
+  for (walk = encoder->delay->head; walk; walk = next) {
+    next = walk->next;
+    if (!GST_IS_BUFFER (walk->data)) {
+      gst_event_unref (GST_EVENT_CAST (walk->data));
+      g_queue_delete_link (encoder->delay, walk);
+    }
+  }
+  encoder->discard_frames = g_queue_get_length (encoder->delay);
+  /* the new data may start before what x264 already saw */
+  encoder->pts_resync = TRUE;
+
+  GST_DEBUG_OBJECT (encoder, "flushed, discarding %u frames, forcing IDR",
+      encoder->discard_frames);
+
+  GST_OBJECT_LOCK (encoder);
+  encoder->i_type = X264_TYPE_IDR;
+  GST_OBJECT_UNLOCK (encoder);
+}
+
 static GstFlowReturn
 gst_x264_enc_encode_frame (GstX264Enc * encoder, x264_picture_t * pic_in,
     int *i_nal, gboolean send)
@@ -1950,7 +2391,7 @@ gst_x264_enc_encode_frame (GstX264Enc * encoder, x264_picture_t * pic_in,
   data = nal[0].p_payload;
 #endif
 
-  in_buf = g_queue_pop_head (encoder->delay);
+  in_buf = gst_x264_enc_pop_delayed (encoder, send);
   if (in_buf) {
     duration = GST_BUFFER_DURATION (in_buf);
     gst_buffer_unref (in_buf);
@@ -1960,6 +2401,14 @@ gst_x264_enc_encode_frame (GstX264Enc * encoder, x264_picture_t * pic_in,
     return GST_FLOW_ERROR;
   }
 
+  /* output for input from before a flush */
+  if (encoder->discard_frames > 0) {
+    encoder->discard_frames--;
+    GST_LOG_OBJECT (encoder, "discarding frame, %u left",
+        encoder->discard_frames);
+    return GST_FLOW_OK;
+  }
+
   if (!send)
     return GST_FLOW_OK;
 
@@ -1976,7 +2425,7 @@ gst_x264_enc_encode_frame (GstX264Enc * encoder, x264_picture_t * pic_in,
    * - it is so practiced by other encoders,
    * - downstream (e.g. muxers) might not enjoy non-monotone timestamps,
    *   whereas a decoder can also deal with DTS */
-  GST_BUFFER_TIMESTAMP (out_buf) = pic_out.i_pts;
+  GST_BUFFER_TIMESTAMP (out_buf) = pic_out.i_pts - encoder->pts_offset;
   GST_BUFFER_DURATION (out_buf) = duration;
 
 #ifdef X264_INTRA_REFRESH
@@ -2006,8 +2455,11 @@ static void
 gst_x264_enc_flush_frames (GstX264Enc * encoder, gboolean send)
 {
   GstFlowReturn flow_ret;
+  GstBuffer *buf;
   gint i_nal;
 
+  gst_x264_enc_finish_segments (encoder, send);
+
   /* first send the remaining frames */
   if (encoder->x264enc)
     do {
@@ -2021,8 +2473,446 @@ gst_x264_enc_flush_frames (GstX264Enc * encoder, gboolean send)
 #endif
 
   /* in any case, make sure the delay queue is emptied */
-  while (!g_queue_is_empty (encoder->delay))
-    gst_buffer_unref (g_queue_pop_head (encoder->delay));
+  while ((buf = gst_x264_enc_pop_delayed (encoder, send)))
+    gst_buffer_unref (buf);
+  encoder->discard_frames = 0;
+}
+
+struct _GstX264EncSegment
+{
+  /* input, with the plane layout at the time it was queued */
+  GPtrArray *frames;
+  gint offset[3], stride[3];
+  guint64 bytes;
+  /* from a force-key-unit request that started this segment */
+  GstEvent *forcekeyunit_event;
+
+  /* output, valid once done is set */
+  GList *output;
+  GstFlowReturn ret;
+  guint64 bits;
+  gboolean done;                /* with segment_lock */
+};
+
+static GstX264EncSegment *
+gst_x264_enc_segment_new (GstX264Enc * encoder)
+{
+  GstX264EncSegment *segment;
+  gint i;
+
+  segment = g_slice_new0 (GstX264EncSegment);
+  segment->frames = g_ptr_array_sized_new (encoder->segment_len);
+  for (i = 0; i < 3; i++) {
+    segment->offset[i] = encoder->offset[i];
+    segment->stride[i] = encoder->stride[i];
+  }
+  segment->ret = GST_FLOW_OK;
+
+  return segment;
+}
+
+static void
+gst_x264_enc_unref_buffer (GstBuffer * buf)
+{
+  /* frames already given to x264 and buffers already pushed are NULL */
+  if (buf)
+    gst_buffer_unref (buf);
+}
+
+static void
+gst_x264_enc_segment_free (GstX264EncSegment * segment)
+{
+  g_ptr_array_foreach (segment->frames, (GFunc) gst_x264_enc_unref_buffer,
+      NULL);
+  g_ptr_array_free (segment->frames, TRUE);
+  g_list_foreach (segment->output, (GFunc) gst_x264_enc_unref_buffer, NULL);
+  g_list_free (segment->output);
+  if (segment->forcekeyunit_event)
+    gst_event_unref (segment->forcekeyunit_event);
+  g_slice_free (GstX264EncSegment, segment);
+}
+
+/* thread pool function: encode @segment with its own x264 instance. The
+ * encoder starts with an IDR frame and is drained at the end, so each segment
+ * is a closed sequence that can be concatenated with the others.
+ *
+ * Every segment's first IDR frame has idr_pic_id 0, and two IDR frames in a
+ * row must not have the same one. So the last frame of a segment is forced
+ * to be a P frame, which x264 keeps because segments are not longer than
+ * key-int-max. Only a segment at the end of the stream can have just one
+ * frame, see gst_x264_enc_segment_chain(). */
+static void
+gst_x264_enc_segment_encode (GstX264EncSegment * segment, GstX264Enc * encoder)
+{
+  x264_param_t param;
+  x264_t *x264 = NULL;
+  x264_picture_t pic_in, pic_out, *pic;
+  x264_nal_t *nal;
+  gint i_nal, encoder_return;
+  guint i, n_out = 0;
+  GstClockTime *durations;
+  gboolean cancel;
+  guint n_frames = segment->frames->len;
+
+  g_mutex_lock (encoder->segment_lock);
+  param = encoder->segment_param;
+  if (encoder->segment_budget && param.rc.i_rc_method == X264_RC_ABR &&
+      encoder->segment_bits > 0) {
+    gdouble ratio;
+
+    /* spend what the finished segments saved, or save what they overspent,
+     * but not more than halving or doubling the rate */
+    ratio = (gdouble) encoder->segment_target_bits / encoder->segment_bits;
+    param.rc.i_bitrate = param.rc.i_bitrate * CLAMP (ratio, 0.5, 2.0);
+    if (param.rc.i_vbv_max_bitrate > 0)
+      param.rc.i_bitrate = MIN (param.rc.i_bitrate,
+          param.rc.i_vbv_max_bitrate);
+  }
+  cancel = encoder->segment_cancel;
+  g_mutex_unlock (encoder->segment_lock);
+
+  if (cancel)
+    goto done;
+
+  GST_DEBUG_OBJECT (encoder, "encoding segment of %u frames at %d kbit/s",
+      n_frames, param.rc.i_bitrate);
+
+  /* this is one of our own threads, it can stay pinned */
+  GST_OBJECT_LOCK (encoder);
+  gst_x264_enc_set_affinity (encoder, NULL);
+  GST_OBJECT_UNLOCK (encoder);
+
+  x264 = x264_encoder_open (&param);
+  if (x264 == NULL) {
+    segment->ret = GST_FLOW_ERROR;
+    goto done;
+  }
+
+  /* x264 copies the input picture, so the frames can go right away */
+  durations = g_new (GstClockTime, n_frames);
+  for (i = 0; i <= n_frames && segment->ret == GST_FLOW_OK; i++) {
+    GstBuffer *buf = NULL;
+    guint j;
+
+    if (i < n_frames) {
+      buf = g_ptr_array_index (segment->frames, i);
+      g_ptr_array_index (segment->frames, i) = NULL;
+      durations[i] = GST_BUFFER_DURATION (buf);
+
+      memset (&pic_in, 0, sizeof (pic_in));
+      pic_in.img.i_csp = X264_CSP_I420;
+      pic_in.img.i_plane = 3;
+      for (j = 0; j < 3; j++) {
+        pic_in.img.plane[j] = GST_BUFFER_DATA (buf) + segment->offset[j];
+        pic_in.img.i_stride[j] = segment->stride[j];
+      }
+      pic_in.i_type = X264_TYPE_AUTO;
+      if (i == n_frames - 1 && n_frames > 1)
+        pic_in.i_type = X264_TYPE_P;
+      pic_in.i_pts = GST_BUFFER_TIMESTAMP (buf);
+      pic = &pic_in;
+    } else {
+      /* drain */
+      pic = NULL;
+    }
+
+    do {
+      encoder_return = x264_encoder_encode (x264, &nal, &i_nal, pic, &pic_out);
+      if (encoder_return < 0) {
+        segment->ret = GST_FLOW_ERROR;
+        break;
+      }
+      if (encoder_return > 0) {
+        GstBuffer *out_buf;
+
+        out_buf = gst_buffer_new_and_alloc (encoder_return);
+        memcpy (GST_BUFFER_DATA (out_buf), nal[0].p_payload, encoder_return);
+        GST_BUFFER_TIMESTAMP (out_buf) = pic_out.i_pts;
+        /* same approximation as for the non-segmented output */
+        GST_BUFFER_DURATION (out_buf) =
+            n_out < n_frames ? durations[n_out] : GST_CLOCK_TIME_NONE;
+#ifdef X264_INTRA_REFRESH
+        if (!pic_out.b_keyframe)
+#else
+        if (pic_out.i_type != X264_TYPE_IDR)
+#endif
+          GST_BUFFER_FLAG_SET (out_buf, GST_BUFFER_FLAG_DELTA_UNIT);
+
+        segment->output = g_list_prepend (segment->output, out_buf);
+        segment->bits += (guint64) encoder_return * 8;
+        n_out++;
+      }
+    } while (pic == NULL && x264_encoder_delayed_frames (x264) > 0);
+
+    if (buf)
+      gst_buffer_unref (buf);
+
+    g_mutex_lock (encoder->segment_lock);
+    cancel = encoder->segment_cancel;
+    g_mutex_unlock (encoder->segment_lock);
+    if (cancel)
+      break;
+  }
+  g_free (durations);
+  x264_encoder_close (x264);
+
+  segment->output = g_list_reverse (segment->output);
+
+done:
+  g_mutex_lock (encoder->segment_lock);
+  if (segment->ret == GST_FLOW_OK && !cancel && param.i_fps_num > 0) {
+    encoder->segment_target_bits += gst_util_uint64_scale (n_frames,
+        (guint64) encoder->segment_param.rc.i_bitrate * 1000 *
+        param.i_fps_den, param.i_fps_num);
+    encoder->segment_bits += segment->bits;
+  }
+  encoder->segment_queued_bytes -= segment->bytes;
+  segment->done = TRUE;
+  g_cond_broadcast (encoder->segment_cond);
+  g_mutex_unlock (encoder->segment_lock);
+}
+
+/* called from init_encoder instead of opening the encoder, copies its
+ * configuration for the segment encoders. Returns FALSE if the input is not
+ * encoded in segments */
+static gboolean
+gst_x264_enc_start_segments (GstX264Enc * encoder)
+{
+  GError *err = NULL;
+  guint n_threads, n_cpus = 1;
+
+  GST_OBJECT_LOCK (encoder);
+  encoder->segment_len = encoder->segment_frames;
+  encoder->segment_budget = encoder->segment_rc_budget;
+  encoder->max_segment_bytes = encoder->segment_max_bytes;
+  n_threads = encoder->segment_threads;
+  GST_OBJECT_UNLOCK (encoder);
+
+  if (encoder->segment_len == 0)
+    return FALSE;
+
+#ifndef X264_ENC_NALS
+  GST_WARNING_OBJECT (encoder, "x264 too old for segment-frames");
+  return FALSE;
+#endif
+  if (encoder->pass >= GST_X264_ENC_PASS_PASS1) {
+    GST_WARNING_OBJECT (encoder,
+        "segment-frames can't be used with multipass encoding");
+    return FALSE;
+  }
+  /* see gst_x264_enc_segment_encode() */
+  if (encoder->segment_len < 2 ||
+      encoder->segment_len > (guint) encoder->x264param.i_keyint_max) {
+    GST_WARNING_OBJECT (encoder, "segment-frames must be between 2 and "
+        "key-int-max (%d)", encoder->x264param.i_keyint_max);
+    return FALSE;
+  }
+
+#if defined (HAVE_UNISTD_H) && defined (_SC_NPROCESSORS_ONLN)
+  n_cpus = MAX (1, sysconf (_SC_NPROCESSORS_ONLN));
+#endif
+  if (n_threads == 0)
+    n_threads = n_cpus;
+
+  encoder->segment_param = encoder->x264param;
+  /* don't start 1.5 threads per CPU in every segment encoder */
+  if (encoder->segment_param.i_threads == 0)
+    encoder->segment_param.i_threads = MAX (1, n_cpus / n_threads);
+
+  encoder->segment_pool =
+      g_thread_pool_new ((GFunc) gst_x264_enc_segment_encode, encoder,
+      n_threads, TRUE, &err);
+  if (encoder->segment_pool == NULL) {
+    GST_WARNING_OBJECT (encoder, "could not start segment threads: %s",
+        err->message);
+    g_error_free (err);
+    return FALSE;
+  }
+  /* keep the next segments ready while the current ones are encoded */
+  encoder->max_segments = 2 * n_threads;
+  encoder->segment_queued_bytes = 0;
+  encoder->segment_target_bits = 0;
+  encoder->segment_bits = 0;
+
+  GST_INFO_OBJECT (encoder, "encoding segments of %u frames, %u at a time "
+      "with %d threads each", encoder->segment_len, n_threads,
+      encoder->segment_param.i_threads);
+
+  return TRUE;
+}
+
+static void
+gst_x264_enc_stop_segments (GstX264Enc * encoder)
+{
+  if (encoder->segment_pool == NULL)
+    return;
+
+  gst_x264_enc_finish_segments (encoder, FALSE);
+  g_thread_pool_free (encoder->segment_pool, FALSE, TRUE);
+  encoder->segment_pool = NULL;
+}
+
+static GstFlowReturn
+gst_x264_enc_segment_push (GstX264Enc * encoder, GstX264EncSegment * segment)
+{
+  GstFlowReturn ret = segment->ret;
+  GList *walk;
+
+  if (ret == GST_FLOW_ERROR) {
+    GST_ELEMENT_ERROR (encoder, STREAM, ENCODE,
+        ("Encode x264 frame failed."), ("could not encode segment"));
+  }
+
+  if (ret == GST_FLOW_OK && segment->forcekeyunit_event && segment->output) {
+    GstEvent *event = segment->forcekeyunit_event;
+
+    segment->forcekeyunit_event = NULL;
+    gst_structure_set (event->structure, "timestamp", G_TYPE_UINT64,
+        GST_BUFFER_TIMESTAMP (segment->output->data), NULL);
+    gst_pad_push_event (encoder->srcpad, event);
+  }
+
+  for (walk = segment->output; walk && ret == GST_FLOW_OK; walk = walk->next) {
+    GstBuffer *buf = GST_BUFFER_CAST (walk->data);
+
+    walk->data = NULL;
+    gst_buffer_set_caps (buf, GST_PAD_CAPS (encoder->srcpad));
+    ret = gst_pad_push (encoder->srcpad, buf);
+  }
+  gst_x264_enc_segment_free (segment);
+
+  return ret;
+}
+
+/* push the finished segments at the head of the queue. Waits for the head
+ * when too many segments or bytes are queued, or until all are pushed if
+ * @all */
+static GstFlowReturn
+gst_x264_enc_push_segments (GstX264Enc * encoder, gboolean all)
+{
+  GstX264EncSegment *segment;
+  GstFlowReturn ret = GST_FLOW_OK;
+
+  g_mutex_lock (encoder->segment_lock);
+  while (ret == GST_FLOW_OK &&
+      (segment = g_queue_peek_head (encoder->segments))) {
+    if (!segment->done) {
+      if (!all && g_queue_get_length (encoder->segments) <=
+          encoder->max_segments && (encoder->max_segment_bytes == 0 ||
+              encoder->segment_queued_bytes <= encoder->max_segment_bytes))
+        break;
+      g_cond_wait (encoder->segment_cond, encoder->segment_lock);
+      continue;
+    }
+    g_queue_pop_head (encoder->segments);
+    g_mutex_unlock (encoder->segment_lock);
+
+    ret = gst_x264_enc_segment_push (encoder, segment);
+
+    g_mutex_lock (encoder->segment_lock);
+  }
+  g_mutex_unlock (encoder->segment_lock);
+
+  return ret;
+}
+
+static void
+gst_x264_enc_submit_segment (GstX264Enc * encoder)
+{
+  GstX264EncSegment *segment = encoder->segment;
+
+  encoder->segment = NULL;
+
+  g_mutex_lock (encoder->segment_lock);
+  g_queue_push_tail (encoder->segments, segment);
+  encoder->segment_queued_bytes += segment->bytes;
+  g_mutex_unlock (encoder->segment_lock);
+
+  g_thread_pool_push (encoder->segment_pool, segment, NULL);
+}
+
+static GstFlowReturn
+gst_x264_enc_segment_chain (GstX264Enc * encoder, GstBuffer * buf)
+{
+  GstEvent *forcekeyunit_event = NULL;
+  GstFlowReturn ret;
+  gboolean cut;
+
+  /* a requested key unit starts a new segment. A segment with one frame
+   * would put two IDR frames in a row, then the cut waits for one more */
+  GST_OBJECT_LOCK (encoder);
+  cut = encoder->i_type != X264_TYPE_AUTO &&
+      (encoder->segment == NULL || encoder->segment->frames->len > 1);
+  if (cut) {
+    encoder->i_type = X264_TYPE_AUTO;
+    forcekeyunit_event = encoder->forcekeyunit_event;
+    encoder->forcekeyunit_event = NULL;
+  }
+  GST_OBJECT_UNLOCK (encoder);
+
+  if (cut && encoder->segment) {
+    GST_DEBUG_OBJECT (encoder, "key unit requested, cutting segment after %u "
+        "frames", encoder->segment->frames->len);
+    gst_x264_enc_submit_segment (encoder);
+    ret = gst_x264_enc_push_segments (encoder, FALSE);
+    if (ret != GST_FLOW_OK) {
+      if (forcekeyunit_event)
+        gst_event_unref (forcekeyunit_event);
+      gst_buffer_unref (buf);
+      return ret;
+    }
+  }
+
+  if (encoder->segment == NULL)
+    encoder->segment = gst_x264_enc_segment_new (encoder);
+  if (forcekeyunit_event)
+    encoder->segment->forcekeyunit_event = forcekeyunit_event;
+
+  g_ptr_array_add (encoder->segment->frames, buf);
+  encoder->segment->bytes += GST_BUFFER_SIZE (buf);
+  if (encoder->segment->frames->len < encoder->segment_len)
+    return GST_FLOW_OK;
+
+  gst_x264_enc_submit_segment (encoder);
+
+  return gst_x264_enc_push_segments (encoder, FALSE);
+}
+
+/* encode and push all queued frames if @send, otherwise throw them away
+ * and wait for the running segment encoders to stop */
+static GstFlowReturn
+gst_x264_enc_finish_segments (GstX264Enc * encoder, gboolean send)
+{
+  GstX264EncSegment *segment;
+  GstFlowReturn ret = GST_FLOW_OK;
+
+  if (encoder->segment_pool == NULL)
+    return GST_FLOW_OK;
+
+  if (encoder->segment) {
+    if (send) {
+      gst_x264_enc_submit_segment (encoder);
+    } else {
+      gst_x264_enc_segment_free (encoder->segment);
+      encoder->segment = NULL;
+    }
+  }
+
+  if (send)
+    ret = gst_x264_enc_push_segments (encoder, TRUE);
+
+  /* whatever is left after an error or when not sending */
+  g_mutex_lock (encoder->segment_lock);
+  encoder->segment_cancel = TRUE;
+  while ((segment = g_queue_pop_head (encoder->segments))) {
+    while (!segment->done)
+      g_cond_wait (encoder->segment_cond, encoder->segment_lock);
+    gst_x264_enc_segment_free (segment);
+  }
+  encoder->segment_cancel = FALSE;
+  g_mutex_unlock (encoder->segment_lock);
+
+  return ret;
 }
 
 static GstStateChangeReturn
@@ -2285,6 +3175,28 @@ gst_x264_enc_set_property (GObject * object, guint prop_id,
       g_string_append_printf (encoder->option_string, ":interlaced=%d",
           encoder->interlaced);
       break;
+    case ARG_REUSE_ENCODER:
+      encoder->reuse_encoder = g_value_get_boolean (value);
+      break;
+    case ARG_CPU_AFFINITY:
+      g_free (encoder->cpu_affinity);
+      encoder->cpu_affinity = g_value_dup_string (value);
+      break;
+    case ARG_NUMA_NODE:
+      encoder->numa_node = g_value_get_int (value);
+      break;
+    case ARG_SEGMENT_FRAMES:
+      encoder->segment_frames = g_value_get_uint (value);
+      break;
+    case ARG_SEGMENT_THREADS:
+      encoder->segment_threads = g_value_get_uint (value);
+      break;
+    case ARG_SEGMENT_RC_BUDGET:
+      encoder->segment_rc_budget = g_value_get_boolean (value);
+      break;
+    case ARG_SEGMENT_MAX_BYTES:
+      encoder->segment_max_bytes = g_value_get_uint64 (value);
+      break;
     default:
       G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
       break;
@@ -2425,6 +3337,27 @@ gst_x264_enc_get_property (GObject * object, guint prop_id,
     case ARG_OPTION_STRING:
       g_value_set_string (value, encoder->option_string_prop->str);
       break;
+    case ARG_REUSE_ENCODER:
+      g_value_set_boolean (value, encoder->reuse_encoder);
+      break;
+    case ARG_CPU_AFFINITY:
+      g_value_set_string (value, encoder->cpu_affinity);
+      break;
+    case ARG_NUMA_NODE:
+      g_value_set_int (value, encoder->numa_node);
+      break;
+    case ARG_SEGMENT_FRAMES:
+      g_value_set_uint (value, encoder->segment_frames);
+      break;
+    case ARG_SEGMENT_THREADS:
+      g_value_set_uint (value, encoder->segment_threads);
+      break;
+    case ARG_SEGMENT_RC_BUDGET:
+      g_value_set_boolean (value, encoder->segment_rc_budget);
+      break;
+    case ARG_SEGMENT_MAX_BYTES:
+      g_value_set_uint64 (value, encoder->segment_max_bytes);
+      break;
     default:
       G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
       break;
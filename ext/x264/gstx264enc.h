@@ -41,6 +41,7 @@ G_BEGIN_DECLS
 
 typedef struct _GstX264Enc GstX264Enc;
 typedef struct _GstX264EncClass GstX264EncClass;
+typedef struct _GstX264EncSegment GstX264EncSegment;
 
 struct _GstX264Enc
 {
@@ -95,6 +96,13 @@ struct _GstX264Enc
   gint profile;
   GString *option_string_prop; /* option-string property */
   GString *option_string; /* used by set prop */
+  gboolean reuse_encoder;
+  gchar *cpu_affinity;
+  gint numa_node;
+  guint segment_frames;
+  guint segment_threads;
+  gboolean segment_rc_budget;
+  guint64 segment_max_bytes;
 
   /* input description */
   GstVideoFormat format;
@@ -105,8 +113,18 @@ struct _GstX264Enc
   gint stride[4], offset[4];
   gint image_size;
 
-  /* for b-frame delay handling */
+  /* for b-frame delay handling, with reuse-encoder this also holds the
+   * newsegment events that have to follow the frames queued before them */
   GQueue *delay;
+  /* reuse-encoder: frames still in x264 from before a flush, and whether x264
+   * was drained at EOS and can't take new frames */
+  guint discard_frames;
+  gboolean drained;
+  /* reuse-encoder: x264 needs increasing pts, after a flush the new input
+   * is offset to continue after the last pts given to x264 */
+  gint64 pts_offset;
+  gint64 next_pts;
+  gboolean pts_resync;
 
   guint8 *buffer;
   gulong buffer_size;
@@ -121,6 +139,26 @@ struct _GstX264Enc
   const gchar *peer_profile;
   gboolean peer_intra_profile;
   const x264_level_t *peer_level;
+
+  /* segment-frames: independently encoded segments, the one being filled
+   * and the ones handed to the thread pool in stream order. No encoder of
+   * our own is opened then */
+  GThreadPool *segment_pool;
+  x264_param_t segment_param;
+  /* copied from the properties when the pool is started */
+  guint segment_len;
+  gboolean segment_budget;
+  guint64 max_segment_bytes;
+  guint max_segments;
+  GstX264EncSegment *segment;
+  GQueue *segments;             /* with segment_lock */
+  guint64 segment_queued_bytes; /* with segment_lock: raw input they hold */
+  GMutex *segment_lock;
+  GCond *segment_cond;
+  gboolean segment_cancel;      /* with segment_lock */
+  /* bits the finished segments should have used and did use */
+  guint64 segment_target_bits;  /* with segment_lock */
+  guint64 segment_bits;         /* with segment_lock */
 };
 
 struct _GstX264EncClass
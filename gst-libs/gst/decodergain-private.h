@@ -0,0 +1,61 @@
+/* GStreamer
+ * Copyright (C) 2013 GStreamer developers
+ *
+ * decodergain-private.h: output gain and ReplayGain for audio decoders
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 59 Temple Place - Suite 330,
+ * Boston, MA 02111-1307, USA.
+ */
+
+/* Decoders that apply a gain while writing their output samples keep the
+ * gain and replaygain property values and the ReplayGain tags seen on the
+ * sinkpad in a GstDecoderGain, and turn the result into a linear factor
+ * in their own sample format with gst_decoder_gain_get_factor().
+ *
+ * GstDecoderGain has no lock of its own, the element protects it with its
+ * object lock.
+ */
+
+#ifndef __GST_DECODER_GAIN_PRIVATE_H__
+#define __GST_DECODER_GAIN_PRIVATE_H__
+
+#include <gst/gst.h>
+
+G_BEGIN_DECLS
+
+/* range of the gain property in dB. +18 dB keeps the factor below 8, the
+ * largest value mad's fixed point format can hold */
+#define GST_DECODER_GAIN_MIN    -60.0
+#define GST_DECODER_GAIN_MAX    18.0
+
+typedef struct
+{
+  gdouble gain;                 /* dB, the gain property */
+  gboolean replaygain;          /* the replaygain property */
+
+  gboolean have_rg;             /* ReplayGain tags were received */
+  gdouble rg_gain, rg_peak;
+} GstDecoderGain;
+
+void     gst_decoder_gain_init       (GstDecoderGain * gain);
+void     gst_decoder_gain_reset      (GstDecoderGain * gain);
+gboolean gst_decoder_gain_parse_tags (GstDecoderGain * gain,
+                                      const GstTagList * list);
+gdouble  gst_decoder_gain_get_db     (const GstDecoderGain * gain);
+gdouble  gst_decoder_gain_get_factor (const GstDecoderGain * gain);
+
+G_END_DECLS
+
+#endif /* __GST_DECODER_GAIN_PRIVATE_H__ */
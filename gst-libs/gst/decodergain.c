@@ -0,0 +1,89 @@
+/* GStreamer
+ * Copyright (C) 2013 GStreamer developers
+ *
+ * decodergain.c: output gain and ReplayGain for audio decoders
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 59 Temple Place - Suite 330,
+ * Boston, MA 02111-1307, USA.
+ */
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include <math.h>
+
+#include "decodergain-private.h"
+
+void
+gst_decoder_gain_init (GstDecoderGain * gain)
+{
+  gain->gain = 0.0;
+  gain->replaygain = FALSE;
+  gst_decoder_gain_reset (gain);
+}
+
+/* forgets the ReplayGain tags of the previous stream */
+void
+gst_decoder_gain_reset (GstDecoderGain * gain)
+{
+  gain->have_rg = FALSE;
+  gain->rg_gain = 0.0;
+  gain->rg_peak = 0.0;
+}
+
+/* takes the track gain and peak from @list, or the album gain and peak if
+ * there is no track gain. Returns TRUE if @list had one of them */
+gboolean
+gst_decoder_gain_parse_tags (GstDecoderGain * gain, const GstTagList * list)
+{
+  gdouble rg_gain, rg_peak = 0.0;
+
+  if (gst_tag_list_get_double (list, GST_TAG_TRACK_GAIN, &rg_gain)) {
+    gst_tag_list_get_double (list, GST_TAG_TRACK_PEAK, &rg_peak);
+  } else if (gst_tag_list_get_double (list, GST_TAG_ALBUM_GAIN, &rg_gain)) {
+    gst_tag_list_get_double (list, GST_TAG_ALBUM_PEAK, &rg_peak);
+  } else {
+    return FALSE;
+  }
+
+  gain->have_rg = TRUE;
+  gain->rg_gain = rg_gain;
+  gain->rg_peak = rg_peak;
+
+  return TRUE;
+}
+
+/* the gain to apply in dB: the gain property plus the ReplayGain if enabled,
+ * lowered so that the tagged peak doesn't clip */
+gdouble
+gst_decoder_gain_get_db (const GstDecoderGain * gain)
+{
+  gdouble db = gain->gain;
+
+  if (gain->replaygain && gain->have_rg) {
+    db += gain->rg_gain;
+    if (gain->rg_peak > 0.0)
+      db = MIN (db, -20.0 * log10 (gain->rg_peak));
+  }
+
+  return CLAMP (db, GST_DECODER_GAIN_MIN, GST_DECODER_GAIN_MAX);
+}
+
+gdouble
+gst_decoder_gain_get_factor (const GstDecoderGain * gain)
+{
+  return pow (10.0, gst_decoder_gain_get_db (gain) / 20.0);
+}
@@ -0,0 +1,74 @@
+/* GStreamer
+ * Copyright (C) 2013 GStreamer developers
+ *
+ * readahead-private.h: read-ahead hints for pull-mode demuxers
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 59 Temple Place - Suite 330,
+ * Boston, MA 02111-1307, USA.
+ */
+
+/* Demuxers operating in pull mode read their input mostly sequentially, but
+ * each gst_pad_pull_range() ends up in a blocking read() in the streaming
+ * thread. With a cold page cache every read then waits for the disk.
+ *
+ * When upstream is a local file, GstReadAhead opens the file a second time
+ * and lets a helper thread tell the kernel which range will be read next
+ * (posix_fadvise(POSIX_FADV_WILLNEED), or plain reads into a scratch buffer
+ * where that is not available). The page cache is shared, so the reads done
+ * by the source element then find the data already in memory. Seeks are
+ * detected from the pulled offsets, nothing needs to be done for them.
+ *
+ * Usage: call gst_read_ahead_start() when activating the sinkpad in pull
+ * mode, gst_read_ahead_hint() before each gst_pad_pull_range() and
+ * gst_read_ahead_stop() when deactivating. All functions are no-ops when
+ * upstream is not a local file.
+ */
+
+#ifndef __GST_READ_AHEAD_PRIVATE_H__
+#define __GST_READ_AHEAD_PRIVATE_H__
+
+#include <gst/gst.h>
+
+G_BEGIN_DECLS
+
+/* default number of bytes to read ahead of the current position */
+#define GST_READ_AHEAD_DEFAULT_WINDOW   (2 * 1024 * 1024)
+
+typedef struct
+{
+  gint fd;                      /* our own fd on the upstream file, or -1 */
+  guint64 window;
+
+  /* end of the range we asked the thread to prefetch */
+  guint64 hinted;
+
+  GThread *thread;
+  GMutex *lock;
+  GCond *cond;
+  gboolean running;
+  gboolean pending;
+  guint64 req_offset;
+  guint64 req_size;
+} GstReadAhead;
+
+void gst_read_ahead_init  (GstReadAhead * ra);
+void gst_read_ahead_start (GstReadAhead * ra, GstPad * sinkpad,
+                           guint64 window);
+void gst_read_ahead_stop  (GstReadAhead * ra);
+void gst_read_ahead_hint  (GstReadAhead * ra, guint64 offset, guint size);
+
+G_END_DECLS
+
+#endif /* __GST_READ_AHEAD_PRIVATE_H__ */
@@ -0,0 +1,245 @@
+/* GStreamer
+ * Copyright (C) 2013 GStreamer developers
+ *
+ * readahead.c: read-ahead hints for pull-mode demuxers
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 59 Temple Place - Suite 330,
+ * Boston, MA 02111-1307, USA.
+ */
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include <string.h>
+#include <glib/gstdio.h>
+
+#ifdef G_OS_UNIX
+#include <unistd.h>
+#include <fcntl.h>
+#endif
+
+#include "readahead-private.h"
+#include "glib-compat-private.h"
+
+GST_DEBUG_CATEGORY_STATIC (read_ahead_debug);
+#define GST_CAT_DEFAULT read_ahead_debug
+
+/* size of the chunks read by the helper thread without posix_fadvise() */
+#define GST_READ_AHEAD_CHUNK_SIZE       (64 * 1024)
+
+void
+gst_read_ahead_init (GstReadAhead * ra)
+{
+  static gsize cat_gonce = 0;
+
+  if (g_once_init_enter (&cat_gonce)) {
+    GST_DEBUG_CATEGORY_INIT (read_ahead_debug, "readahead", 0,
+        "read-ahead hints for pull-mode demuxers");
+    g_once_init_leave (&cat_gonce, 1);
+  }
+
+  memset (ra, 0, sizeof (GstReadAhead));
+  ra->fd = -1;
+}
+
+#ifdef G_OS_UNIX
+#define GST_READ_AHEAD_ENABLED 1
+
+static void
+gst_read_ahead_prefetch (GstReadAhead * ra, guint64 offset, guint64 size)
+{
+#ifdef HAVE_POSIX_FADVISE
+  /* this can block while the I/O is being queued, which is why we are not
+   * doing it in the streaming thread */
+  posix_fadvise (ra->fd, offset, size, POSIX_FADV_WILLNEED);
+#else
+  guint8 *scratch;
+
+  scratch = g_malloc (GST_READ_AHEAD_CHUNK_SIZE);
+  while (size > 0) {
+    gssize res;
+
+    /* abort when a newer request or stop came in */
+    if (G_UNLIKELY (ra->pending || !ra->running))
+      break;
+
+    res = pread (ra->fd, scratch, MIN (size, GST_READ_AHEAD_CHUNK_SIZE),
+        offset);
+    if (res <= 0)
+      break;
+
+    offset += res;
+    size -= res;
+  }
+  g_free (scratch);
+#endif
+}
+
+static gpointer
+gst_read_ahead_thread (GstReadAhead * ra)
+{
+  g_mutex_lock (ra->lock);
+  while (ra->running) {
+    guint64 offset, size;
+
+    if (!ra->pending) {
+      g_cond_wait (ra->cond, ra->lock);
+      continue;
+    }
+    offset = ra->req_offset;
+    size = ra->req_size;
+    ra->pending = FALSE;
+    g_mutex_unlock (ra->lock);
+
+    GST_LOG ("prefetching %" G_GUINT64_FORMAT "+%" G_GUINT64_FORMAT, offset,
+        size);
+    gst_read_ahead_prefetch (ra, offset, size);
+
+    g_mutex_lock (ra->lock);
+  }
+  g_mutex_unlock (ra->lock);
+
+  return NULL;
+}
+
+/* returns the local filename of the file upstream of @sinkpad, if any */
+static gchar *
+gst_read_ahead_get_upstream_file (GstPad * sinkpad)
+{
+  GstQuery *query;
+  gchar *uri = NULL, *filename = NULL;
+
+  query = gst_query_new_uri ();
+  if (gst_pad_peer_query (sinkpad, query))
+    gst_query_parse_uri (query, &uri);
+
+  if (uri != NULL && gst_uri_has_protocol (uri, "file"))
+    filename = g_filename_from_uri (uri, NULL, NULL);
+
+  g_free (uri);
+  gst_query_unref (query);
+
+  return filename;
+}
+#endif /* G_OS_UNIX */
+
+void
+gst_read_ahead_start (GstReadAhead * ra, GstPad * sinkpad, guint64 window)
+{
+#ifdef GST_READ_AHEAD_ENABLED
+  gchar *filename;
+
+  if (ra->fd != -1)
+    return;
+
+  filename = gst_read_ahead_get_upstream_file (sinkpad);
+  if (filename == NULL) {
+    GST_DEBUG_OBJECT (sinkpad, "upstream is not a local file, no read-ahead");
+    return;
+  }
+
+  ra->fd = g_open (filename, O_RDONLY, 0);
+  if (ra->fd == -1) {
+    GST_DEBUG_OBJECT (sinkpad, "could not open %s, no read-ahead", filename);
+    g_free (filename);
+    return;
+  }
+
+  ra->window = window;
+  ra->hinted = 0;
+  ra->pending = FALSE;
+  ra->running = TRUE;
+  ra->lock = g_mutex_new ();
+  ra->cond = g_cond_new ();
+#if GLIB_CHECK_VERSION (2, 31, 0)
+  ra->thread = g_thread_try_new ("readahead",
+      (GThreadFunc) gst_read_ahead_thread, ra, NULL);
+#else
+  ra->thread = g_thread_create ((GThreadFunc) gst_read_ahead_thread, ra,
+      TRUE, NULL);
+#endif
+  if (ra->thread == NULL) {
+    GST_WARNING_OBJECT (sinkpad, "could not create read-ahead thread");
+    g_mutex_free (ra->lock);
+    g_cond_free (ra->cond);
+    ra->lock = NULL;
+    ra->cond = NULL;
+    ra->running = FALSE;
+    close (ra->fd);
+    ra->fd = -1;
+  } else {
+    GST_DEBUG_OBJECT (sinkpad, "reading ahead %" G_GUINT64_FORMAT " bytes "
+        "of %s", window, filename);
+  }
+  g_free (filename);
+#endif
+}
+
+void
+gst_read_ahead_stop (GstReadAhead * ra)
+{
+#ifdef GST_READ_AHEAD_ENABLED
+  if (ra->fd == -1)
+    return;
+
+  g_mutex_lock (ra->lock);
+  ra->running = FALSE;
+  g_cond_signal (ra->cond);
+  g_mutex_unlock (ra->lock);
+  g_thread_join (ra->thread);
+  ra->thread = NULL;
+
+  g_mutex_free (ra->lock);
+  g_cond_free (ra->cond);
+  ra->lock = NULL;
+  ra->cond = NULL;
+
+  close (ra->fd);
+  ra->fd = -1;
+#endif
+}
+
+/* call before pulling @size bytes at @offset */
+void
+gst_read_ahead_hint (GstReadAhead * ra, guint64 offset, guint size)
+{
+#ifdef GST_READ_AHEAD_ENABLED
+  guint64 start;
+
+  if (G_LIKELY (ra->fd == -1))
+    return;
+
+  /* refill when less than half a window is left in front of the reader. A
+   * read outside of the hinted range means that we seeked. */
+  if (offset + size + ra->window / 2 <= ra->hinted &&
+      offset + ra->window >= ra->hinted)
+    return;
+
+  if (offset <= ra->hinted && offset + ra->window >= ra->hinted)
+    start = ra->hinted;
+  else
+    start = offset;
+
+  g_mutex_lock (ra->lock);
+  ra->req_offset = start;
+  ra->req_size = offset + size + ra->window - start;
+  ra->pending = TRUE;
+  g_cond_signal (ra->cond);
+  g_mutex_unlock (ra->lock);
+
+  ra->hinted = offset + size + ra->window;
+#endif
+}
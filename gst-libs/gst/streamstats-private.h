@@ -0,0 +1,86 @@
+/* GStreamer
+ * Copyright (C) 2013 GStreamer developers
+ *
+ * streamstats-private.h: stream health counters for parsers and decoders
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 59 Temple Place - Suite 330,
+ * Boston, MA 02111-1307, USA.
+ */
+
+/* Elements that skip or drop damaged input count what they see in a
+ * GstStreamStats. Applications read the counters from the read-only "stats"
+ * property as a GstStructure, and with the "stats-interval" property set the
+ * element also posts that structure as element message at that interval
+ * while data flows.
+ *
+ * The streaming thread writes the counters and any thread may read them.
+ * 64 bit values can't be read in one go on all systems, so the counters and
+ * the interval are protected by the lock of the GstStreamStats.
+ *
+ * Usage: gst_stream_stats_install_properties() in class_init,
+ * gst_stream_stats_init() when initializing the instance and
+ * gst_stream_stats_clear() in finalize. The streaming thread counts with
+ * gst_stream_stats_add() and calls gst_stream_stats_post() after each buffer.
+ */
+
+#ifndef __GST_STREAM_STATS_PRIVATE_H__
+#define __GST_STREAM_STATS_PRIVATE_H__
+
+#include <gst/gst.h>
+
+G_BEGIN_DECLS
+
+#define GST_STREAM_STATS_MAX_COUNTERS   4
+
+typedef struct
+{
+  GMutex *lock;
+
+  /* names of the structure and of its fields, one per counter */
+  const gchar *name;
+  const gchar *fields[GST_STREAM_STATS_MAX_COUNTERS];
+  guint n_counters;
+
+  guint64 counters[GST_STREAM_STATS_MAX_COUNTERS];     /* with lock */
+  GstClockTime interval;        /* with lock */
+
+  /* streaming thread only */
+  GstClockTime last_post;
+} GstStreamStats;
+
+void          gst_stream_stats_install_properties (GObjectClass * klass,
+                                                   guint stats_prop_id,
+                                                   const gchar * stats_blurb,
+                                                   guint interval_prop_id);
+
+void          gst_stream_stats_init         (GstStreamStats * stats,
+                                             const gchar * name,
+                                             const gchar * first_field,
+                                             ...) G_GNUC_NULL_TERMINATED;
+void          gst_stream_stats_clear        (GstStreamStats * stats);
+
+void          gst_stream_stats_add          (GstStreamStats * stats,
+                                             guint counter, guint64 n);
+GstStructure *gst_stream_stats_get          (GstStreamStats * stats);
+
+void          gst_stream_stats_set_interval (GstStreamStats * stats,
+                                             guint interval_ms);
+guint         gst_stream_stats_get_interval (GstStreamStats * stats);
+void          gst_stream_stats_post         (GstStreamStats * stats,
+                                             GstElement * element);
+
+G_END_DECLS
+
+#endif /* __GST_STREAM_STATS_PRIVATE_H__ */
@@ -0,0 +1,156 @@
+/* GStreamer
+ * Copyright (C) 2013 GStreamer developers
+ *
+ * streamstats.c: stream health counters for parsers and decoders
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 59 Temple Place - Suite 330,
+ * Boston, MA 02111-1307, USA.
+ */
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include "streamstats-private.h"
+
+/* installs the "stats" property with @stats_blurb and the "stats-interval"
+ * property */
+void
+gst_stream_stats_install_properties (GObjectClass * klass,
+    guint stats_prop_id, const gchar * stats_blurb, guint interval_prop_id)
+{
+  g_object_class_install_property (klass, stats_prop_id,
+      g_param_spec_boxed ("stats", "Statistics", stats_blurb,
+          GST_TYPE_STRUCTURE, G_PARAM_READABLE | G_PARAM_STATIC_STRINGS));
+  g_object_class_install_property (klass, interval_prop_id,
+      g_param_spec_uint ("stats-interval", "Statistics interval",
+          "Post the stats as element message every this many milliseconds "
+          "(0 = never)", 0, G_MAXUINT, 0,
+          G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
+}
+
+/* sets up @stats for a structure named @name with one counter per field
+ * name in the NULL terminated list. The names must be static strings */
+void
+gst_stream_stats_init (GstStreamStats * stats, const gchar * name,
+    const gchar * first_field, ...)
+{
+  const gchar *field;
+  va_list args;
+
+  stats->lock = g_mutex_new ();
+  stats->name = name;
+  stats->n_counters = 0;
+
+  va_start (args, first_field);
+  for (field = first_field; field; field = va_arg (args, const gchar *)) {
+    g_return_if_fail (stats->n_counters < GST_STREAM_STATS_MAX_COUNTERS);
+    stats->fields[stats->n_counters] = field;
+    stats->counters[stats->n_counters] = 0;
+    stats->n_counters++;
+  }
+  va_end (args);
+
+  stats->interval = 0;
+  stats->last_post = GST_CLOCK_TIME_NONE;
+}
+
+void
+gst_stream_stats_clear (GstStreamStats * stats)
+{
+  if (stats->lock) {
+    g_mutex_free (stats->lock);
+    stats->lock = NULL;
+  }
+}
+
+/* adds @n to the @counter-th counter */
+void
+gst_stream_stats_add (GstStreamStats * stats, guint counter, guint64 n)
+{
+  g_return_if_fail (counter < stats->n_counters);
+
+  g_mutex_lock (stats->lock);
+  stats->counters[counter] += n;
+  g_mutex_unlock (stats->lock);
+}
+
+/* returns a new structure with the current counters */
+GstStructure *
+gst_stream_stats_get (GstStreamStats * stats)
+{
+  guint64 counters[GST_STREAM_STATS_MAX_COUNTERS];
+  GstStructure *s;
+  guint i;
+
+  g_mutex_lock (stats->lock);
+  for (i = 0; i < stats->n_counters; i++)
+    counters[i] = stats->counters[i];
+  g_mutex_unlock (stats->lock);
+
+  s = gst_structure_empty_new (stats->name);
+  for (i = 0; i < stats->n_counters; i++)
+    gst_structure_set (s, stats->fields[i], G_TYPE_UINT64, counters[i], NULL);
+
+  return s;
+}
+
+void
+gst_stream_stats_set_interval (GstStreamStats * stats, guint interval_ms)
+{
+  g_mutex_lock (stats->lock);
+  stats->interval = interval_ms * GST_MSECOND;
+  g_mutex_unlock (stats->lock);
+}
+
+guint
+gst_stream_stats_get_interval (GstStreamStats * stats)
+{
+  guint interval_ms;
+
+  g_mutex_lock (stats->lock);
+  interval_ms = stats->interval / GST_MSECOND;
+  g_mutex_unlock (stats->lock);
+
+  return interval_ms;
+}
+
+/* posts the counters as element message from @element if the interval has
+ * passed since the last time. The first call only starts the interval */
+void
+gst_stream_stats_post (GstStreamStats * stats, GstElement * element)
+{
+  GstClockTime interval, now;
+
+  g_mutex_lock (stats->lock);
+  interval = stats->interval;
+  g_mutex_unlock (stats->lock);
+
+  if (interval == 0)
+    return;
+
+  now = gst_util_get_timestamp ();
+  if (!GST_CLOCK_TIME_IS_VALID (stats->last_post)) {
+    stats->last_post = now;
+    return;
+  }
+  if (now - stats->last_post < interval)
+    return;
+  stats->last_post = now;
+
+  gst_element_post_message (element,
+      gst_message_new_element (GST_OBJECT_CAST (element),
+          gst_stream_stats_get (stats)));
+}
@@ -194,3 +194,18 @@ gst_asf_get_guid_nick (const ASFGuidHash * guids, guint32 obj_id)
   /* The base case if none is found */
   return "ASF_OBJ_UNDEFINED";
 }
+
+const ASFGuid *
+gst_asf_get_guid (const ASFGuidHash * guids, guint32 obj_id)
+{
+  gint i;
+
+  for (i = 0; guids[i].obj_id != ASF_OBJ_UNDEFINED; ++i) {
+    if (guids[i].obj_id == obj_id) {
+      return &guids[i].guid;
+    }
+  }
+
+  /* The base case if none is found */
+  return NULL;
+}
@@ -105,6 +105,9 @@ guint32        gst_asf_identify_guid (const ASFGuidHash * guids,
 const gchar   *gst_asf_get_guid_nick (const ASFGuidHash * guids,
                                       guint32             obj_id);
 
+const ASFGuid *gst_asf_get_guid      (const ASFGuidHash * guids,
+                                      guint32             obj_id);
+
 struct _asf_stream_audio {
   guint16 codec_tag;
   guint16 channels;
@@ -29,16 +29,24 @@
 #include <gst/gstinfo.h>
 #include <string.h>
 
+/* property flags of nearly all files: byte replicated data length, dword
+ * media object offset, byte media object number and byte stream number */
+#define ASF_PROP_FLAGS_COMMON  0x5d
+
+/* packets with the same layout needed before using the fast path */
+#define ASF_PACKET_LAYOUT_MIN_PACKETS  2
+
+static const guint asf_varlen_lens[4] = { 0, 1, 2, 4 };
+
 /* we are unlikely to deal with lengths > 2GB here any time soon, so just
  * return a signed int and use that for error reporting */
 static inline gint
 asf_packet_read_varlen_int (guint lentype_flags, guint lentype_bit_offset,
     const guint8 ** p_data, guint * p_size)
 {
-  static const guint lens[4] = { 0, 1, 2, 4 };
   guint len, val;
 
-  len = lens[(lentype_flags >> lentype_bit_offset) & 0x03];
+  len = asf_varlen_lens[(lentype_flags >> lentype_bit_offset) & 0x03];
 
   /* will make caller bail out with a short read if there's not enough data */
   if (G_UNLIKELY (*p_size < len)) {
@@ -69,6 +77,22 @@ asf_packet_read_varlen_int (guint lentype_flags, guint lentype_bit_offset,
   return (gint) val;
 }
 
+/* reads a field of a length determined by a packet layout */
+static inline guint
+asf_packet_read_fixed_int (const guint8 * data, guint len)
+{
+  switch (len) {
+    case 1:
+      return GST_READ_UINT8 (data);
+    case 2:
+      return GST_READ_UINT16_LE (data);
+    case 4:
+      return GST_READ_UINT32_LE (data);
+    default:
+      return 0;
+  }
+}
+
 static GstBuffer *
 asf_packet_create_payload_buffer (AsfPacket * packet, const guint8 ** p_data,
     guint * p_size, guint payload_len)
@@ -302,12 +326,22 @@ gst_asf_demux_parse_payload (GstASFDemux * demux, AsfPacket * packet,
   payload.tff = FALSE;
   payload.rff = FALSE;
 
-  payload.mo_number =
-      asf_packet_read_varlen_int (packet->prop_flags, 4, p_data, p_size);
-  payload.mo_offset =
-      asf_packet_read_varlen_int (packet->prop_flags, 2, p_data, p_size);
-  payload.rep_data_len =
-      asf_packet_read_varlen_int (packet->prop_flags, 0, p_data, p_size);
+  if (G_LIKELY (packet->prop_flags == ASF_PROP_FLAGS_COMMON && *p_size >= 6)) {
+    const guint8 *data = *p_data;
+
+    payload.mo_number = GST_READ_UINT8 (data);
+    payload.mo_offset = GST_READ_UINT32_LE (data + 1);
+    payload.rep_data_len = GST_READ_UINT8 (data + 5);
+    *p_data += 6;
+    *p_size -= 6;
+  } else {
+    payload.mo_number =
+        asf_packet_read_varlen_int (packet->prop_flags, 4, p_data, p_size);
+    payload.mo_offset =
+        asf_packet_read_varlen_int (packet->prop_flags, 2, p_data, p_size);
+    payload.rep_data_len =
+        asf_packet_read_varlen_int (packet->prop_flags, 0, p_data, p_size);
+  }
 
   is_compressed = (payload.rep_data_len == 1);
 
@@ -469,13 +503,82 @@ gst_asf_demux_parse_payload (GstASFDemux * demux, AsfPacket * packet,
   return TRUE;
 }
 
-GstAsfDemuxParsePacketError
-gst_asf_demux_parse_packet (GstASFDemux * demux, GstBuffer * buf)
+/* parses the payloads of a packet whose header was parsed into @packet;
+ * @data points to the data following the header */
+static GstAsfDemuxParsePacketError
+gst_asf_demux_parse_packet_payloads (GstASFDemux * demux, AsfPacket * packet,
+    gboolean has_multiple_payloads, const guint8 * data, guint size)
+{
+  GstAsfDemuxParsePacketError ret = GST_ASF_DEMUX_PARSE_PACKET_ERROR_NONE;
+
+  if (G_UNLIKELY (packet->padding == (guint) - 1 || size < packet->padding)) {
+    GST_WARNING_OBJECT (demux, "No padding, or padding bigger than buffer");
+    return GST_ASF_DEMUX_PARSE_PACKET_ERROR_RECOVERABLE;
+  }
+
+  size -= packet->padding;
+
+  /* adjust available size for parsing if there's less actual packet data for
+   * parsing than there is data in bytes (for sample see bug 431318) */
+  if (G_UNLIKELY (packet->length != 0 && packet->padding == 0
+          && packet->length < demux->packet_size)) {
+    GST_LOG_OBJECT (demux, "shortened packet with implicit padding, "
+        "adjusting available data size");
+    if (size < demux->packet_size - packet->length) {
+      /* the buffer is smaller than the implicit padding */
+      GST_WARNING_OBJECT (demux, "Buffer is smaller than the implicit padding");
+      return GST_ASF_DEMUX_PARSE_PACKET_ERROR_RECOVERABLE;
+    } else {
+      /* subtract the implicit padding */
+      size -= (demux->packet_size - packet->length);
+    }
+  }
+
+  if (has_multiple_payloads) {
+    guint i, num, lentype;
+
+    if (G_UNLIKELY (size < 1)) {
+      GST_WARNING_OBJECT (demux, "No room more in buffer");
+      return GST_ASF_DEMUX_PARSE_PACKET_ERROR_RECOVERABLE;
+    }
+
+    num = (GST_READ_UINT8 (data) & 0x3F) >> 0;
+    lentype = (GST_READ_UINT8 (data) & 0xC0) >> 6;
+
+    ++data;
+    --size;
+
+    GST_LOG_OBJECT (demux, "num payloads     : %u", num);
+
+    for (i = 0; i < num; ++i) {
+      GST_LOG_OBJECT (demux, "Parsing payload %u/%u, size left: %u", i + 1, num,
+          size);
+
+      if (G_UNLIKELY (!gst_asf_demux_parse_payload (demux, packet, lentype,
+                  &data, &size))) {
+        GST_WARNING_OBJECT (demux, "Failed to parse payload %u/%u", i + 1, num);
+        ret = GST_ASF_DEMUX_PARSE_PACKET_ERROR_FATAL;
+        break;
+      }
+    }
+  } else {
+    GST_LOG_OBJECT (demux, "Parsing single payload");
+    if (G_UNLIKELY (!gst_asf_demux_parse_payload (demux, packet, -1, &data,
+                &size))) {
+      GST_WARNING_OBJECT (demux, "Failed to parse payload");
+      ret = GST_ASF_DEMUX_PARSE_PACKET_ERROR_RECOVERABLE;
+    }
+  }
+
+  return ret;
+}
+
+static GstAsfDemuxParsePacketError
+gst_asf_demux_parse_packet_data (GstASFDemux * demux, GstBuffer * buf)
 {
   AsfPacket packet = { 0, };
   const guint8 *data;
   gboolean has_multiple_payloads;
-  GstAsfDemuxParsePacketError ret = GST_ASF_DEMUX_PARSE_PACKET_ERROR_NONE;
   guint8 ec_flags, flags1;
   guint size;
 
@@ -553,64 +656,120 @@ gst_asf_demux_parse_packet (GstASFDemux * demux, GstBuffer * buf)
   GST_LOG_OBJECT (demux, "duration         : %" GST_TIME_FORMAT,
       GST_TIME_ARGS (packet.duration));
 
-  if (G_UNLIKELY (packet.padding == (guint) - 1 || size < packet.padding)) {
-    GST_WARNING_OBJECT (demux, "No padding, or padding bigger than buffer");
-    return GST_ASF_DEMUX_PARSE_PACKET_ERROR_RECOVERABLE;
-  }
+  return gst_asf_demux_parse_packet_payloads (demux, &packet,
+      has_multiple_payloads, data, size);
+}
 
-  size -= packet.padding;
+/* derives the header layout from the flag bytes of a packet and counts how
+ * many packets in a row used it */
+static void
+asf_packet_update_layout (GstASFDemux * demux, const guint8 * data,
+    guint size)
+{
+  AsfPacketLayout *layout = &demux->packet_layout;
+  guint8 ec_flags, flags, prop_flags;
+  guint off, seq_len;
 
-  /* adjust available size for parsing if there's less actual packet data for
-   * parsing than there is data in bytes (for sample see bug 431318) */
-  if (G_UNLIKELY (packet.length != 0 && packet.padding == 0
-          && packet.length < demux->packet_size)) {
-    GST_LOG_OBJECT (demux, "shortened packet with implicit padding, "
-        "adjusting available data size");
-    if (size < demux->packet_size - packet.length) {
-      /* the buffer is smaller than the implicit padding */
-      GST_WARNING_OBJECT (demux, "Buffer is smaller than the implicit padding");
-      return GST_ASF_DEMUX_PARSE_PACKET_ERROR_RECOVERABLE;
-    } else {
-      /* subtract the implicit padding */
-      size -= (demux->packet_size - packet.length);
-    }
+  ec_flags = GST_READ_UINT8 (data);
+  off = 0;
+  if ((ec_flags & 0x80) != 0) {
+    /* other error correction length types are handled by the generic path */
+    if ((ec_flags & 0x60) != 0)
+      goto no_layout;
+    off = 1 + (ec_flags & 0x0f);
   }
 
-  if (has_multiple_payloads) {
-    guint i, num, lentype;
+  if (size < off + 2)
+    goto no_layout;
 
-    if (G_UNLIKELY (size < 1)) {
-      GST_WARNING_OBJECT (demux, "No room more in buffer");
-      return GST_ASF_DEMUX_PARSE_PACKET_ERROR_RECOVERABLE;
-    }
+  flags = GST_READ_UINT8 (data + off);
+  prop_flags = GST_READ_UINT8 (data + off + 1);
 
-    num = (GST_READ_UINT8 (data) & 0x3F) >> 0;
-    lentype = (GST_READ_UINT8 (data) & 0xC0) >> 6;
+  if (layout->count > 0 && layout->ec_flags == ec_flags &&
+      layout->flags == flags && layout->prop_flags == prop_flags) {
+    layout->count++;
+    return;
+  }
 
-    ++data;
-    --size;
+  layout->ec_flags = ec_flags;
+  layout->flags = flags;
+  layout->prop_flags = prop_flags;
+  layout->flags_off = off;
+  layout->length_off = off + 2;
+  layout->length_len = asf_varlen_lens[(flags >> 5) & 0x03];
+  seq_len = asf_varlen_lens[(flags >> 1) & 0x03];
+  layout->padding_off = layout->length_off + layout->length_len + seq_len;
+  layout->padding_len = asf_varlen_lens[(flags >> 3) & 0x03];
+  layout->header_len = layout->padding_off + layout->padding_len + 4 + 2;
+  layout->count = 1;
+
+  GST_DEBUG_OBJECT (demux, "packet layout: flags 0x%02x 0x%02x 0x%02x, "
+      "header length %u", ec_flags, flags, prop_flags, layout->header_len);
+  return;
+
+no_layout:
+  layout->count = 0;
+}
 
-    GST_LOG_OBJECT (demux, "num payloads     : %u", num);
+static inline gboolean
+asf_packet_matches_layout (const AsfPacketLayout * layout,
+    const guint8 * data, guint size)
+{
+  return layout->count >= ASF_PACKET_LAYOUT_MIN_PACKETS &&
+      size > layout->header_len &&
+      GST_READ_UINT8 (data) == layout->ec_flags &&
+      GST_READ_UINT8 (data + layout->flags_off) == layout->flags &&
+      GST_READ_UINT8 (data + layout->flags_off + 1) == layout->prop_flags;
+}
 
-    for (i = 0; i < num; ++i) {
-      GST_LOG_OBJECT (demux, "Parsing payload %u/%u, size left: %u", i + 1, num,
-          size);
+/* gst_asf_demux_parse_packet_data() for packets known to match the packet
+ * layout, reading the header fields at their precomputed offsets */
+static GstAsfDemuxParsePacketError
+gst_asf_demux_parse_packet_fast (GstASFDemux * demux, GstBuffer * buf)
+{
+  const AsfPacketLayout *layout = &demux->packet_layout;
+  AsfPacket packet = { 0, };
+  const guint8 *data;
 
-      if (G_UNLIKELY (!gst_asf_demux_parse_payload (demux, &packet, lentype,
-                  &data, &size))) {
-        GST_WARNING_OBJECT (demux, "Failed to parse payload %u/%u", i + 1, num);
-        ret = GST_ASF_DEMUX_PARSE_PACKET_ERROR_FATAL;
-        break;
-      }
-    }
+  data = GST_BUFFER_DATA (buf);
+
+  packet.buf = buf;
+  packet.prop_flags = layout->prop_flags;
+  packet.length = asf_packet_read_fixed_int (data + layout->length_off,
+      layout->length_len);
+  packet.padding = asf_packet_read_fixed_int (data + layout->padding_off,
+      layout->padding_len);
+  packet.send_time =
+      GST_READ_UINT32_LE (data + layout->header_len - 6) * GST_MSECOND;
+  packet.duration =
+      GST_READ_UINT16_LE (data + layout->header_len - 2) * GST_MSECOND;
+
+  return gst_asf_demux_parse_packet_payloads (demux, &packet,
+      (layout->flags & 0x01) != 0, data + layout->header_len,
+      GST_BUFFER_SIZE (buf) - layout->header_len);
+}
+
+GstAsfDemuxParsePacketError
+gst_asf_demux_parse_packet (GstASFDemux * demux, GstBuffer * buf)
+{
+  GstAsfDemuxParsePacketError ret;
+  const guint8 *data = GST_BUFFER_DATA (buf);
+  guint size = GST_BUFFER_SIZE (buf);
+
+  /* anything that doesn't look like the previous packets, including too
+   * short packets, goes through the generic parser, which reports errors */
+  if (G_LIKELY (asf_packet_matches_layout (&demux->packet_layout, data,
+              size))) {
+    ret = gst_asf_demux_parse_packet_fast (demux, buf);
   } else {
-    GST_LOG_OBJECT (demux, "Parsing single payload");
-    if (G_UNLIKELY (!gst_asf_demux_parse_payload (demux, &packet, -1, &data,
-                &size))) {
-      GST_WARNING_OBJECT (demux, "Failed to parse payload");
-      ret = GST_ASF_DEMUX_PARSE_PACKET_ERROR_RECOVERABLE;
-    }
+    if (size > 0)
+      asf_packet_update_layout (demux, data, size);
+    ret = gst_asf_demux_parse_packet_data (demux, buf);
   }
 
+  gst_stream_stats_add (&demux->stats, ASF_DEMUX_STAT_PACKETS, 1);
+  if (G_UNLIKELY (ret != GST_ASF_DEMUX_PARSE_PACKET_ERROR_NONE))
+    gst_stream_stats_add (&demux->stats, ASF_DEMUX_STAT_PACKET_ERRORS, 1);
+
   return ret;
 }
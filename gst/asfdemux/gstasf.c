@@ -29,7 +29,7 @@
 #include "gstrtspwms.h"
 #include "gstrtpasfdepay.h"
 
-/* #include "gstasfmux.h" */
+#include "gstasfmux.h"
 
 static gboolean
 plugin_init (GstPlugin * plugin)
@@ -57,10 +57,11 @@ plugin_init (GstPlugin * plugin)
           GST_TYPE_RTP_ASF_DEPAY)) {
     return FALSE;
   }
-/*
-  if (!gst_element_register (plugin, "asfmux", GST_RANK_NONE, GST_TYPE_ASFMUX))
+  /* not "asfmux", which gst-plugins-bad registers too */
+  if (!gst_element_register (plugin, "asfindexmux", GST_RANK_NONE,
+          GST_TYPE_ASF_INDEX_MUX)) {
     return FALSE;
-*/
+  }
 
   return TRUE;
 }
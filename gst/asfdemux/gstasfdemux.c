@@ -81,6 +81,22 @@ GST_STATIC_PAD_TEMPLATE ("video_%02d",
 
 GST_DEBUG_CATEGORY (asfdemux_dbg);
 
+enum
+{
+  PROP_0,
+  PROP_STATS,
+  PROP_STATS_INTERVAL,
+  PROP_LOW_LATENCY
+};
+
+#define DEFAULT_LOW_LATENCY FALSE
+
+static void gst_asf_demux_set_property (GObject * object, guint prop_id,
+    const GValue * value, GParamSpec * pspec);
+static void gst_asf_demux_finalize (GObject * object);
+static void gst_asf_demux_get_property (GObject * object, guint prop_id,
+    GValue * value, GParamSpec * pspec);
+
 static GstStateChangeReturn gst_asf_demux_change_state (GstElement * element,
     GstStateChange transition);
 static gboolean gst_asf_demux_element_send_event (GstElement * element,
@@ -135,10 +151,31 @@ gst_asf_demux_base_init (gpointer g_class)
 static void
 gst_asf_demux_class_init (GstASFDemuxClass * klass)
 {
+  GObjectClass *gobject_class;
   GstElementClass *gstelement_class;
 
+  gobject_class = (GObjectClass *) klass;
   gstelement_class = (GstElementClass *) klass;
 
+  gobject_class->set_property = gst_asf_demux_set_property;
+  gobject_class->get_property = gst_asf_demux_get_property;
+  gobject_class->finalize = gst_asf_demux_finalize;
+
+  /* packets that failed to parse are dropped; these let applications notice
+   * damaged input without enabling debug logs */
+  gst_stream_stats_install_properties (gobject_class, PROP_STATS,
+      "Data packets parsed and packets dropped because of parse errors "
+      "since creation", PROP_STATS_INTERVAL);
+  /* normally output only starts once every stream has data queued beyond the
+   * preroll advertised in the header, which is several seconds for typical
+   * live streams; in low-latency mode output starts with the first complete
+   * payload and streams showing up later get their pads added then */
+  g_object_class_install_property (gobject_class, PROP_LOW_LATENCY,
+      g_param_spec_boolean ("low-latency", "Low latency",
+          "Start pushing as soon as a stream has a complete payload instead "
+          "of waiting for the preroll of all streams",
+          DEFAULT_LOW_LATENCY, G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
+
   gstelement_class->change_state =
       GST_DEBUG_FUNCPTR (gst_asf_demux_change_state);
   gstelement_class->send_event =
@@ -244,6 +281,8 @@ gst_asf_demux_reset (GstASFDemux * demux, gboolean chain_reset)
   }
   demux->num_streams = 0;
   demux->activated_streams = FALSE;
+  demux->early_activation = FALSE;
+  demux->no_more_pads = FALSE;
   demux->first_ts = GST_CLOCK_TIME_NONE;
   demux->segment_ts = GST_CLOCK_TIME_NONE;
   demux->in_gap = 0;
@@ -256,6 +295,7 @@ gst_asf_demux_reset (GstASFDemux * demux, gboolean chain_reset)
   demux->sidx_num_entries = 0;
   g_free (demux->sidx_entries);
   demux->sidx_entries = NULL;
+  memset (&demux->packet_layout, 0, sizeof (demux->packet_layout));
 
   demux->speed_packets = 1;
 
@@ -292,10 +332,26 @@ gst_asf_demux_init (GstASFDemux * demux, GstASFDemuxClass * klass)
       GST_DEBUG_FUNCPTR (gst_asf_demux_activate_push));
   gst_element_add_pad (GST_ELEMENT (demux), demux->sinkpad);
 
+  gst_read_ahead_init (&demux->readahead);
+
+  gst_stream_stats_init (&demux->stats, "asfdemux-stats", "packets",
+      "packet-errors", NULL);
+  demux->low_latency = DEFAULT_LOW_LATENCY;
+
   /* set initial state */
   gst_asf_demux_reset (demux, FALSE);
 }
 
+static void
+gst_asf_demux_finalize (GObject * object)
+{
+  GstASFDemux *demux = GST_ASF_DEMUX (object);
+
+  gst_stream_stats_clear (&demux->stats);
+
+  G_OBJECT_CLASS (parent_class)->finalize (object);
+}
+
 static gboolean
 gst_asf_demux_activate (GstPad * sinkpad)
 {
@@ -330,10 +386,18 @@ gst_asf_demux_activate_pull (GstPad * pad, gboolean active)
     demux->state = GST_ASF_DEMUX_STATE_HEADER;
     demux->streaming = FALSE;
 
+    gst_read_ahead_start (&demux->readahead, pad,
+        GST_READ_AHEAD_DEFAULT_WINDOW);
+
     return gst_pad_start_task (pad, (GstTaskFunction) gst_asf_demux_loop,
         demux);
   } else {
-    return gst_pad_stop_task (pad);
+    gboolean res;
+
+    res = gst_pad_stop_task (pad);
+    gst_read_ahead_stop (&demux->readahead);
+
+    return res;
   }
 }
 
@@ -938,6 +1002,7 @@ gst_asf_demux_pull_data (GstASFDemux * demux, guint64 offset, guint size,
   GST_LOG_OBJECT (demux, "pulling buffer at %" G_GUINT64_FORMAT "+%u",
       offset, size);
 
+  gst_read_ahead_hint (&demux->readahead, offset, size);
   flow = gst_pad_pull_range (demux->sinkpad, offset, size, p_buf);
 
   if (G_LIKELY (p_flow))
@@ -1133,14 +1198,20 @@ parse_failed:
   }
 }
 
+static GstClockTime
+gst_asf_demux_get_preroll_time (GstASFDemux * demux)
+{
+  /* Allow at least 500ms of preroll_time  */
+  return MAX (demux->preroll, 500 * GST_MSECOND);
+}
+
 static gboolean
 all_streams_prerolled (GstASFDemux * demux)
 {
   GstClockTime preroll_time;
   guint i, num_no_data = 0;
 
-  /* Allow at least 500ms of preroll_time  */
-  preroll_time = MAX (demux->preroll, 500 * GST_MSECOND);
+  preroll_time = gst_asf_demux_get_preroll_time (demux);
 
   /* returns TRUE as long as there isn't a stream which (a) has data queued
    * and (b) the timestamp of last piece of data queued is < demux->preroll
@@ -1175,7 +1246,52 @@ all_streams_prerolled (GstASFDemux * demux)
   return TRUE;
 }
 
-#if 0
+/* low-latency replacement for all_streams_prerolled(): TRUE as soon as any
+ * stream has a complete payload to push */
+static gboolean
+any_stream_has_complete_payload (GstASFDemux * demux)
+{
+  guint i;
+
+  for (i = 0; i < demux->num_streams; ++i) {
+    AsfStream *stream = &demux->stream[i];
+
+    if (stream->payloads->len > 0 &&
+        gst_asf_payload_is_complete (&g_array_index (stream->payloads,
+                AsfPayload, 0)))
+      return TRUE;
+  }
+
+  return FALSE;
+}
+
+/* TRUE if data beyond the preroll was queued for any stream; in low-latency
+ * mode this is when streams without data so far are given up on */
+static gboolean
+any_stream_beyond_preroll (GstASFDemux * demux)
+{
+  GstClockTime preroll_time;
+  guint i;
+
+  preroll_time = gst_asf_demux_get_preroll_time (demux);
+
+  for (i = 0; i < demux->num_streams; ++i) {
+    AsfStream *stream = &demux->stream[i];
+    AsfPayload *last_payload;
+
+    if (stream->payloads->len == 0)
+      continue;
+
+    last_payload = &g_array_index (stream->payloads, AsfPayload,
+        stream->payloads->len - 1);
+    if (GST_CLOCK_TIME_IS_VALID (last_payload->ts) &&
+        last_payload->ts > preroll_time)
+      return TRUE;
+  }
+
+  return FALSE;
+}
+
 static gboolean
 gst_asf_demux_have_mutually_exclusive_active_stream (GstASFDemux * demux,
     AsfStream * stream)
@@ -1212,7 +1328,35 @@ gst_asf_demux_have_mutually_exclusive_active_stream (GstASFDemux * demux,
 
   return FALSE;
 }
-#endif
+
+/* TRUE if every stream has a pad, or is an alternative of a stream that has
+ * one */
+static gboolean
+all_streams_exposed (GstASFDemux * demux)
+{
+  guint i;
+
+  for (i = 0; i < demux->num_streams; ++i) {
+    AsfStream *stream = &demux->stream[i];
+
+    if (!stream->active &&
+        !gst_asf_demux_have_mutually_exclusive_active_stream (demux, stream))
+      return FALSE;
+  }
+
+  return TRUE;
+}
+
+static void
+gst_asf_demux_signal_no_more_pads (GstASFDemux * demux)
+{
+  if (demux->no_more_pads)
+    return;
+
+  demux->no_more_pads = TRUE;
+  GST_LOG_OBJECT (demux, "signalling no more pads");
+  gst_element_no_more_pads (GST_ELEMENT (demux));
+}
 
 static gboolean
 gst_asf_demux_check_activate_streams (GstASFDemux * demux, gboolean force)
@@ -1222,7 +1366,12 @@ gst_asf_demux_check_activate_streams (GstASFDemux * demux, gboolean force)
   if (demux->activated_streams)
     return TRUE;
 
-  if (!all_streams_prerolled (demux) && !force) {
+  if (demux->early_activation) {
+    if (!any_stream_has_complete_payload (demux) && !force) {
+      GST_DEBUG_OBJECT (demux, "no complete payload yet");
+      return FALSE;
+    }
+  } else if (!all_streams_prerolled (demux) && !force) {
     GST_DEBUG_OBJECT (demux, "not all streams with data beyond preroll yet");
     return FALSE;
   }
@@ -1243,11 +1392,49 @@ gst_asf_demux_check_activate_streams (GstASFDemux * demux, gboolean force)
   gst_asf_demux_release_old_pads (demux);
 
   demux->activated_streams = TRUE;
-  GST_LOG_OBJECT (demux, "signalling no more pads");
-  gst_element_no_more_pads (GST_ELEMENT (demux));
+
+  /* in low-latency mode streams without data yet can still get a pad */
+  if (!demux->early_activation || force || all_streams_exposed (demux))
+    gst_asf_demux_signal_no_more_pads (demux);
+
   return TRUE;
 }
 
+/* in low-latency mode streams are activated before all of them had a chance
+ * to send data; add the pads of streams that show up later, unless they
+ * are alternatives of a stream that is already active. Once every stream
+ * has a pad or data beyond the preroll arrived, no-more-pads is signalled
+ * and streams still without data are ignored like in normal mode */
+static void
+gst_asf_demux_activate_late_streams (GstASFDemux * demux, gboolean force)
+{
+  guint i;
+
+  for (i = 0; i < demux->num_streams; ++i) {
+    AsfStream *stream = &demux->stream[i];
+
+    if (G_LIKELY (stream->active || stream->payloads->len == 0))
+      continue;
+
+    if (gst_asf_demux_have_mutually_exclusive_active_stream (demux, stream))
+      continue;
+
+    GST_LOG_OBJECT (stream->pad, "late stream - activate!");
+    gst_asf_demux_activate_stream (demux, stream);
+
+    /* the other pads already had their new-segment event */
+    if (!demux->need_newsegment) {
+      gst_pad_push_event (stream->pad,
+          gst_event_new_new_segment (FALSE, demux->segment.rate,
+              GST_FORMAT_TIME, demux->segment.start, demux->segment.stop,
+              demux->segment.start));
+    }
+  }
+
+  if (force || all_streams_exposed (demux) || any_stream_beyond_preroll (demux))
+    gst_asf_demux_signal_no_more_pads (demux);
+}
+
 /* returns the stream that has a complete payload with the lowest timestamp
  * queued, or NULL (we push things by timestamp because during the internal
  * prerolling we might accumulate more data then the external queues can take,
@@ -1318,6 +1505,8 @@ gst_asf_demux_push_complete_payloads (GstASFDemux * demux, gboolean force)
     if (!gst_asf_demux_check_activate_streams (demux, force))
       return GST_FLOW_OK;
     /* streams are now activated */
+  } else if (G_UNLIKELY (!demux->no_more_pads)) {
+    gst_asf_demux_activate_late_streams (demux, force);
   }
 
   /* wait until we had a chance to "lock on" some payload's timestamp */
@@ -1528,6 +1717,8 @@ gst_asf_demux_loop (GstASFDemux * demux)
 
   g_assert (demux->state == GST_ASF_DEMUX_STATE_DATA);
 
+  gst_stream_stats_post (&demux->stats, GST_ELEMENT_CAST (demux));
+
   if (G_UNLIKELY (demux->num_packets != 0
           && demux->packet >= demux->num_packets))
     goto eos;
@@ -1642,8 +1833,9 @@ eos:
   {
     /* if we haven't activated our streams yet, this might be because we have
      * less data queued than required for preroll; force stream activation and
-     * send any pending payloads before sending EOS */
-    if (!demux->activated_streams)
+     * send any pending payloads before sending EOS. In low-latency mode this
+     * also signals no-more-pads if some stream never sent data */
+    if (!demux->activated_streams || !demux->no_more_pads)
       gst_asf_demux_push_complete_payloads (demux, TRUE);
 
     /* we want to push an eos or post a segment-done in any case */
@@ -1846,6 +2038,8 @@ done:
   if (ret != GST_FLOW_OK)
     GST_DEBUG_OBJECT (demux, "flow: %s", gst_flow_get_name (ret));
 
+  gst_stream_stats_post (&demux->stats, GST_ELEMENT_CAST (demux));
+
   return ret;
 
 eos:
@@ -2959,8 +3153,12 @@ gst_asf_demux_process_file (GstASFDemux * demux, guint8 * data, guint64 size)
 
   demux->preroll = preroll * GST_MSECOND;
 
-  /* initial latency */
-  demux->latency = demux->preroll;
+  GST_OBJECT_LOCK (demux);
+  demux->early_activation = demux->low_latency;
+  GST_OBJECT_UNLOCK (demux);
+
+  /* initial latency; low-latency mode does not wait for the preroll */
+  demux->latency = demux->early_activation ? 0 : demux->preroll;
 
   if (demux->play_time == 0)
     demux->seekable = FALSE;
@@ -3981,6 +4179,51 @@ gst_asf_demux_handle_src_query (GstPad * pad, GstQuery * query)
   return res;
 }
 
+static void
+gst_asf_demux_set_property (GObject * object, guint prop_id,
+    const GValue * value, GParamSpec * pspec)
+{
+  GstASFDemux *demux = GST_ASF_DEMUX (object);
+
+  switch (prop_id) {
+    case PROP_STATS_INTERVAL:
+      gst_stream_stats_set_interval (&demux->stats, g_value_get_uint (value));
+      break;
+    case PROP_LOW_LATENCY:
+      GST_OBJECT_LOCK (demux);
+      demux->low_latency = g_value_get_boolean (value);
+      GST_OBJECT_UNLOCK (demux);
+      break;
+    default:
+      G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
+      break;
+  }
+}
+
+static void
+gst_asf_demux_get_property (GObject * object, guint prop_id, GValue * value,
+    GParamSpec * pspec)
+{
+  GstASFDemux *demux = GST_ASF_DEMUX (object);
+
+  switch (prop_id) {
+    case PROP_STATS:
+      g_value_take_boxed (value, gst_stream_stats_get (&demux->stats));
+      break;
+    case PROP_STATS_INTERVAL:
+      g_value_set_uint (value, gst_stream_stats_get_interval (&demux->stats));
+      break;
+    case PROP_LOW_LATENCY:
+      GST_OBJECT_LOCK (demux);
+      g_value_set_boolean (value, demux->low_latency);
+      GST_OBJECT_UNLOCK (demux);
+      break;
+    default:
+      G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
+      break;
+  }
+}
+
 static GstStateChangeReturn
 gst_asf_demux_change_state (GstElement * element, GstStateChange transition)
 {
@@ -23,6 +23,8 @@
 
 #include <gst/gst.h>
 #include <gst/base/gstadapter.h>
+#include <gst/readahead-private.h>
+#include <gst/streamstats-private.h>
 
 #include "asfheaders.h"
 
@@ -50,6 +52,20 @@ typedef struct {
   guint16	count;
 } AsfSimpleIndexEntry;
 
+/* data packet header layout, derived from its flag bytes. Files normally use
+ * the same layout for all packets, which are then parsed at these fixed
+ * offsets instead of decoding the flags every time */
+typedef struct {
+  guint8        ec_flags;         /* first byte of the packet             */
+  guint8        flags;            /* length type flags                    */
+  guint8        prop_flags;       /* property flags                       */
+  guint         flags_off;        /* offset of flags                      */
+  guint         length_off, length_len;
+  guint         padding_off, padding_len;
+  guint         header_len;       /* offset of the payload data           */
+  guint         count;            /* consecutive packets with this layout */
+} AsfPacketLayout;
+
 typedef struct {
   AsfPayloadExtensionID   id : 16;  /* extension ID; the :16 makes sure the
                                      * struct gets packed into 4 bytes       */
@@ -119,6 +135,12 @@ typedef enum {
   GST_ASF_DEMUX_STATE_INDEX
 } GstAsfDemuxState;
 
+/* counters of the stats property */
+enum {
+  ASF_DEMUX_STAT_PACKETS,
+  ASF_DEMUX_STAT_PACKET_ERRORS
+};
+
 #define GST_ASF_DEMUX_NUM_VIDEO_PADS   16
 #define GST_ASF_DEMUX_NUM_AUDIO_PADS   32
 #define GST_ASF_DEMUX_NUM_STREAMS      32
@@ -143,6 +165,7 @@ struct _GstASFDemux {
   guint64            num_packets;  /* total number of data packets, or 0       */
   gint64             packet;       /* current packet                           */
   guint              speed_packets; /* Known number of packets to get in one go*/
+  GstReadAhead       readahead;     /* read-ahead hints in pull mode          */
 
   gchar              **languages;
   guint                num_languages;
@@ -185,6 +208,11 @@ struct _GstASFDemux {
   gboolean             segment_running;  /* if we've started the current segment    */
   gboolean             streaming;        /* TRUE if we are operating chain-based    */
   GstClockTime         latency;
+  gboolean             low_latency;      /* the property, with LOCK         */
+  gboolean             early_activation; /* low_latency when the header was
+                                          * parsed: activate streams on the
+                                          * first payload                   */
+  gboolean             no_more_pads;     /* no-more-pads was signalled      */
 
   /* Descrambler settings */
   guint8               span;
@@ -199,6 +227,11 @@ struct _GstASFDemux {
   GstClockTime         sidx_interval;    /* interval between entries in ns */
   guint                sidx_num_entries; /* number of index entries        */
   AsfSimpleIndexEntry *sidx_entries;     /* packet number for each entry   */
+
+  AsfPacketLayout      packet_layout;
+
+  /* stream health since creation, see the stats property */
+  GstStreamStats       stats;
 };
 
 struct _GstASFDemuxClass {
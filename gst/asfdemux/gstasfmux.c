@@ -0,0 +1,1138 @@
+/* GStreamer ASF muxer
+ * Copyright (C) 2012 GStreamer developers
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 59 Temple Place - Suite 330,
+ * Boston, MA 02111-1307, USA.
+ */
+
+/**
+ * SECTION:element-asfindexmux
+ *
+ * asfindexmux muxes WMA, WMV and MP3 streams into an ASF file. All data packets
+ * have the same size, as required by the format, and carry the send time of
+ * their first payload.
+ *
+ * When #GstAsfIndexMux:streamable is FALSE (the default), the muxer expects a
+ * seekable downstream element: at EOS it appends a Simple Index Object for
+ * the first video stream (or the first stream for audio-only files) and
+ * rewrites the header with the final file size, duration and packet count,
+ * so the resulting file can be seeked without scanning. In streamable mode
+ * the header is written once, with the broadcast flag set, and no index is
+ * written.
+ *
+ * <refsect2>
+ * <title>Example launch line</title>
+ * |[
+ * gst-launch filesrc location=in.wmv ! asfdemux name=d  asfindexmux name=m ! filesink location=out.wmv  d.video_00 ! queue ! m.video_%d  d.audio_00 ! queue ! m.audio_%d
+ * ]| This remuxes an ASF file, adding a simple index to it.
+ * </refsect2>
+ */
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include <string.h>
+#include <gst/base/gstbytewriter.h>
+#include <gst/riff/riff-ids.h>
+
+#include "gstasfmux.h"
+
+GST_DEBUG_CATEGORY_STATIC (asfmux_debug);
+#define GST_CAT_DEFAULT asfmux_debug
+
+/* size of an ASF object header, ie. GUID (16 bytes) + object size (8 bytes) */
+#define ASF_OBJECT_HEADER_SIZE    (16+8)
+
+/* header object: object header, number of objects, two reserved bytes */
+#define ASF_HEADER_OBJECT_SIZE    (ASF_OBJECT_HEADER_SIZE + 4 + 1 + 1)
+#define ASF_FILE_OBJECT_SIZE      (ASF_OBJECT_HEADER_SIZE + 80)
+#define ASF_HEADER_EXT_SIZE       (ASF_OBJECT_HEADER_SIZE + 16 + 2 + 4)
+#define ASF_STREAM_OBJECT_SIZE    (ASF_OBJECT_HEADER_SIZE + 54)
+#define ASF_DATA_OBJECT_SIZE      (ASF_OBJECT_HEADER_SIZE + 16 + 8 + 2)
+#define ASF_SIMPLE_INDEX_SIZE     (ASF_OBJECT_HEADER_SIZE + 16 + 8 + 4 + 4)
+
+/* WAVEFORMATEX without extradata */
+#define ASF_AUDIO_SPECIFIC_SIZE   18
+/* encoded width/height, flags, format data size and BITMAPINFOHEADER */
+#define ASF_VIDEO_SPECIFIC_SIZE   (4 + 4 + 1 + 2 + 40)
+
+/* We always write packets the same way: two bytes of error correction data,
+ * no packet length (the packet size is fixed), a WORD padding length, send
+ * time and duration, followed by the multiple payloads flags byte. Each
+ * payload has BYTE stream and media object numbers, a DWORD offset, BYTE
+ * replicated data length, 8 bytes of replicated data (media object size and
+ * presentation time) and a WORD payload length. */
+#define ASF_PACKET_HEADER_SIZE    (1 + 2 + 1 + 1 + 2 + 4 + 2 + 1)
+#define ASF_PAYLOAD_HEADER_SIZE   (1 + 1 + 4 + 1 + 8 + 2)
+#define ASF_MAX_PAYLOADS          63
+
+#define ASF_PACKET_EC_FLAGS       0x82  /* error correction present, 2 bytes */
+#define ASF_PACKET_LEN_FLAGS      0x11  /* multiple payloads, WORD padding */
+#define ASF_PACKET_PROP_FLAGS     0x5d  /* BYTE, BYTE, DWORD, BYTE */
+#define ASF_PAYLOAD_LEN_FLAGS     0x80  /* WORD payload lengths */
+
+#define ASF_FILE_FLAG_BROADCAST   0x01
+#define ASF_FILE_FLAG_SEEKABLE    0x02
+
+#define DEFAULT_PACKET_SIZE       4800
+#define DEFAULT_PREROLL           5000
+#define DEFAULT_INDEX_INTERVAL    GST_SECOND
+#define DEFAULT_STREAMABLE        FALSE
+
+enum
+{
+  PROP_0,
+  PROP_PACKET_SIZE,
+  PROP_PREROLL,
+  PROP_INDEX_INTERVAL,
+  PROP_STREAMABLE
+};
+
+static GstStaticPadTemplate src_template = GST_STATIC_PAD_TEMPLATE ("src",
+    GST_PAD_SRC,
+    GST_PAD_ALWAYS,
+    GST_STATIC_CAPS ("video/x-ms-asf")
+    );
+
+static GstStaticPadTemplate audio_sink_template =
+GST_STATIC_PAD_TEMPLATE ("audio_%d",
+    GST_PAD_SINK,
+    GST_PAD_REQUEST,
+    GST_STATIC_CAPS ("audio/x-wma, wmaversion = (int) [ 1, 3 ]; "
+        "audio/mpeg, mpegversion = (int) 1, layer = (int) 3")
+    );
+
+static GstStaticPadTemplate video_sink_template =
+GST_STATIC_PAD_TEMPLATE ("video_%d",
+    GST_PAD_SINK,
+    GST_PAD_REQUEST,
+    GST_STATIC_CAPS ("video/x-wmv, wmvversion = (int) [ 1, 3 ]")
+    );
+
+static void gst_asf_mux_set_property (GObject * object, guint prop_id,
+    const GValue * value, GParamSpec * pspec);
+static void gst_asf_mux_get_property (GObject * object, guint prop_id,
+    GValue * value, GParamSpec * pspec);
+static void gst_asf_mux_finalize (GObject * object);
+static GstPad *gst_asf_mux_request_new_pad (GstElement * element,
+    GstPadTemplate * templ, const gchar * name);
+static void gst_asf_mux_release_pad (GstElement * element, GstPad * pad);
+static GstStateChangeReturn gst_asf_mux_change_state (GstElement * element,
+    GstStateChange transition);
+static gboolean gst_asf_mux_sink_setcaps (GstPad * pad, GstCaps * caps);
+static GstFlowReturn gst_asf_mux_collected (GstCollectPads * pads,
+    GstAsfIndexMux * asfmux);
+
+GST_BOILERPLATE (GstAsfIndexMux, gst_asf_mux, GstElement, GST_TYPE_ELEMENT);
+
+static void
+gst_asf_mux_base_init (gpointer g_class)
+{
+  GstElementClass *element_class = GST_ELEMENT_CLASS (g_class);
+
+  gst_element_class_add_static_pad_template (element_class, &src_template);
+  gst_element_class_add_static_pad_template (element_class,
+      &audio_sink_template);
+  gst_element_class_add_static_pad_template (element_class,
+      &video_sink_template);
+
+  gst_element_class_set_details_simple (element_class, "ASF Muxer",
+      "Codec/Muxer",
+      "Muxes audio and video into an ASF stream",
+      "GStreamer maintainers <gstreamer-devel@lists.freedesktop.org>");
+}
+
+static void
+gst_asf_mux_class_init (GstAsfIndexMuxClass * klass)
+{
+  GObjectClass *gobject_class;
+  GstElementClass *gstelement_class;
+
+  gobject_class = (GObjectClass *) klass;
+  gstelement_class = (GstElementClass *) klass;
+
+  gobject_class->set_property = gst_asf_mux_set_property;
+  gobject_class->get_property = gst_asf_mux_get_property;
+  gobject_class->finalize = gst_asf_mux_finalize;
+
+  g_object_class_install_property (gobject_class, PROP_PACKET_SIZE,
+      g_param_spec_uint ("packet-size", "Packet size",
+          "Size of the data packets in bytes",
+          ASF_PACKET_HEADER_SIZE + ASF_PAYLOAD_HEADER_SIZE + 1, G_MAXUINT16,
+          DEFAULT_PACKET_SIZE, G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
+  g_object_class_install_property (gobject_class, PROP_PREROLL,
+      g_param_spec_uint64 ("preroll", "Preroll",
+          "Time in milliseconds clients should buffer before playback",
+          0, G_MAXUINT32, DEFAULT_PREROLL,
+          G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
+  g_object_class_install_property (gobject_class, PROP_INDEX_INTERVAL,
+      g_param_spec_uint64 ("index-interval", "Index interval",
+          "Time between simple index entries in nanoseconds",
+          GST_MSECOND, G_MAXUINT64, DEFAULT_INDEX_INTERVAL,
+          G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
+  g_object_class_install_property (gobject_class, PROP_STREAMABLE,
+      g_param_spec_boolean ("streamable", "Streamable",
+          "Write a broadcast header only, without index or header rewrite "
+          "at the end (for non-seekable outputs)", DEFAULT_STREAMABLE,
+          G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
+
+  gstelement_class->request_new_pad =
+      GST_DEBUG_FUNCPTR (gst_asf_mux_request_new_pad);
+  gstelement_class->release_pad = GST_DEBUG_FUNCPTR (gst_asf_mux_release_pad);
+  gstelement_class->change_state =
+      GST_DEBUG_FUNCPTR (gst_asf_mux_change_state);
+
+  GST_DEBUG_CATEGORY_INIT (asfmux_debug, "asfindexmux", 0, "asf muxer element");
+}
+
+static void
+gst_asf_mux_reset (GstAsfIndexMux * asfmux)
+{
+  asfmux->state = GST_ASF_MUX_STATE_NONE;
+
+  asfmux->file_id.v1 = g_random_int ();
+  asfmux->file_id.v2 = g_random_int ();
+  asfmux->file_id.v3 = g_random_int ();
+  asfmux->file_id.v4 = g_random_int ();
+
+  asfmux->file_size = 0;
+
+  gst_buffer_replace (&asfmux->packet, NULL);
+  asfmux->packet_pos = 0;
+  asfmux->packet_num_payloads = 0;
+  asfmux->packet_send_time = 0;
+  asfmux->packet_last_pres = 0;
+  asfmux->num_packets = 0;
+
+  asfmux->first_ts = GST_CLOCK_TIME_NONE;
+  asfmux->last_ts = 0;
+
+  g_array_set_size (asfmux->index, 0);
+  asfmux->next_index_time = 0;
+  asfmux->last_keyframe.packet = 0;
+  asfmux->last_keyframe.count = 0;
+  asfmux->have_keyframe = FALSE;
+}
+
+static void
+gst_asf_mux_init (GstAsfIndexMux * asfmux, GstAsfIndexMuxClass * klass)
+{
+  asfmux->srcpad = gst_pad_new_from_static_template (&src_template, "src");
+  gst_pad_use_fixed_caps (asfmux->srcpad);
+  gst_element_add_pad (GST_ELEMENT (asfmux), asfmux->srcpad);
+
+  asfmux->collect = gst_collect_pads_new ();
+  gst_collect_pads_set_function (asfmux->collect,
+      (GstCollectPadsFunction) GST_DEBUG_FUNCPTR (gst_asf_mux_collected),
+      asfmux);
+
+  asfmux->prop_packet_size = DEFAULT_PACKET_SIZE;
+  asfmux->prop_preroll = DEFAULT_PREROLL;
+  asfmux->prop_index_interval = DEFAULT_INDEX_INTERVAL;
+  asfmux->prop_streamable = DEFAULT_STREAMABLE;
+
+  asfmux->index = g_array_new (FALSE, FALSE, sizeof (GstAsfMuxIndexEntry));
+
+  gst_asf_mux_reset (asfmux);
+}
+
+static void
+gst_asf_mux_finalize (GObject * object)
+{
+  GstAsfIndexMux *asfmux = GST_ASF_INDEX_MUX (object);
+
+  gst_object_unref (asfmux->collect);
+  gst_buffer_replace (&asfmux->packet, NULL);
+  g_array_free (asfmux->index, TRUE);
+
+  G_OBJECT_CLASS (parent_class)->finalize (object);
+}
+
+static void
+gst_asf_mux_pad_free (GstAsfMuxPad * pad)
+{
+  gst_buffer_replace (&pad->codec_data, NULL);
+}
+
+static GstPad *
+gst_asf_mux_request_new_pad (GstElement * element, GstPadTemplate * templ,
+    const gchar * req_name)
+{
+  GstElementClass *klass = GST_ELEMENT_GET_CLASS (element);
+  GstAsfIndexMux *asfmux = GST_ASF_INDEX_MUX (element);
+  GstAsfMuxPad *asfpad;
+  AsfStreamType type;
+  GstPad *pad;
+  gchar *name;
+
+  if (asfmux->state != GST_ASF_MUX_STATE_NONE)
+    goto too_late;
+
+  if (asfmux->num_streams >= 127)
+    goto too_many_streams;
+
+  if (templ == gst_element_class_get_pad_template (klass, "audio_%d")) {
+    name = g_strdup_printf ("audio_%02d", asfmux->num_audio_streams++);
+    type = ASF_STREAM_AUDIO;
+  } else if (templ == gst_element_class_get_pad_template (klass, "video_%d")) {
+    name = g_strdup_printf ("video_%02d", asfmux->num_video_streams++);
+    type = ASF_STREAM_VIDEO;
+  } else {
+    GST_WARNING_OBJECT (asfmux, "This is not our template!");
+    return NULL;
+  }
+
+  pad = gst_pad_new_from_template (templ, name);
+  g_free (name);
+
+  gst_pad_set_setcaps_function (pad,
+      GST_DEBUG_FUNCPTR (gst_asf_mux_sink_setcaps));
+
+  asfpad = (GstAsfMuxPad *) gst_collect_pads_add_pad_full (asfmux->collect,
+      pad, sizeof (GstAsfMuxPad), (GstCollectDataDestroyNotify)
+      gst_asf_mux_pad_free);
+
+  /* the type is only confirmed once we get caps */
+  asfpad->type = ASF_STREAM_UNDEFINED;
+  asfpad->number = ++asfmux->num_streams;
+  asfpad->media_object = 0;
+  asfpad->is_index_stream = FALSE;
+  asfpad->codec_data = NULL;
+
+  GST_DEBUG_OBJECT (asfmux, "new %s pad %s for stream %u",
+      (type == ASF_STREAM_AUDIO) ? "audio" : "video", GST_PAD_NAME (pad),
+      asfpad->number);
+
+  gst_pad_set_active (pad, TRUE);
+  gst_element_add_pad (element, pad);
+
+  return pad;
+
+/* ERRORS */
+too_late:
+  {
+    GST_WARNING_OBJECT (asfmux, "can't add new pads after the header has "
+        "been written");
+    return NULL;
+  }
+too_many_streams:
+  {
+    GST_WARNING_OBJECT (asfmux, "ASF files can't have more than 127 streams");
+    return NULL;
+  }
+}
+
+static void
+gst_asf_mux_release_pad (GstElement * element, GstPad * pad)
+{
+  GstAsfIndexMux *asfmux = GST_ASF_INDEX_MUX (element);
+
+  gst_collect_pads_remove_pad (asfmux->collect, pad);
+  gst_element_remove_pad (element, pad);
+}
+
+static gboolean
+gst_asf_mux_sink_setcaps (GstPad * pad, GstCaps * caps)
+{
+  GstAsfIndexMux *asfmux;
+  GstAsfMuxPad *asfpad;
+  GstStructure *s;
+  const GValue *value;
+  const gchar *media_type;
+  gint version, bitrate = 0;
+
+  asfmux = GST_ASF_INDEX_MUX (gst_pad_get_parent (pad));
+  asfpad = (GstAsfMuxPad *) gst_pad_get_element_private (pad);
+
+  GST_DEBUG_OBJECT (asfmux, "%s:%s, caps=%" GST_PTR_FORMAT,
+      GST_DEBUG_PAD_NAME (pad), caps);
+
+  /* the header has been written already, we can't change anything now */
+  if (asfmux->state != GST_ASF_MUX_STATE_NONE &&
+      asfpad->type != ASF_STREAM_UNDEFINED)
+    goto refuse_renegotiation;
+
+  s = gst_caps_get_structure (caps, 0);
+  media_type = gst_structure_get_name (s);
+
+  gst_structure_get_int (s, "bitrate", &bitrate);
+  asfpad->bitrate = bitrate;
+
+  value = gst_structure_get_value (s, "codec_data");
+  if (value != NULL)
+    gst_buffer_replace (&asfpad->codec_data, gst_value_get_buffer (value));
+
+  if (g_str_has_prefix (media_type, "audio/")) {
+    asfpad->channels = 0;
+    asfpad->rate = 0;
+    asfpad->block_align = 1;
+    asfpad->depth = 16;
+
+    if (!gst_structure_get_int (s, "channels", &asfpad->channels) ||
+        !gst_structure_get_int (s, "rate", &asfpad->rate))
+      goto refuse_caps;
+
+    gst_structure_get_int (s, "block_align", &asfpad->block_align);
+    gst_structure_get_int (s, "depth", &asfpad->depth);
+
+    if (strcmp (media_type, "audio/x-wma") == 0) {
+      if (!gst_structure_get_int (s, "wmaversion", &version))
+        goto refuse_caps;
+      switch (version) {
+        case 1:
+          asfpad->codec_tag = GST_RIFF_WAVE_FORMAT_WMAV1;
+          break;
+        case 2:
+          asfpad->codec_tag = GST_RIFF_WAVE_FORMAT_WMAV2;
+          break;
+        case 3:
+          asfpad->codec_tag = GST_RIFF_WAVE_FORMAT_WMAV3;
+          break;
+        default:
+          goto refuse_caps;
+      }
+    } else {
+      asfpad->codec_tag = GST_RIFF_WAVE_FORMAT_MPEGL3;
+    }
+    asfpad->type = ASF_STREAM_AUDIO;
+  } else {
+    guint32 fourcc = 0;
+
+    if (!gst_structure_get_int (s, "width", &asfpad->width) ||
+        !gst_structure_get_int (s, "height", &asfpad->height) ||
+        !gst_structure_get_int (s, "wmvversion", &version))
+      goto refuse_caps;
+
+    switch (version) {
+      case 1:
+        asfpad->fourcc = GST_MAKE_FOURCC ('W', 'M', 'V', '1');
+        break;
+      case 2:
+        asfpad->fourcc = GST_MAKE_FOURCC ('W', 'M', 'V', '2');
+        break;
+      case 3:
+        /* WMV3 or WVC1 (VC-1 advanced profile) */
+        if (gst_structure_get_fourcc (s, "format", &fourcc))
+          asfpad->fourcc = fourcc;
+        else
+          asfpad->fourcc = GST_MAKE_FOURCC ('W', 'M', 'V', '3');
+        break;
+      default:
+        goto refuse_caps;
+    }
+    asfpad->type = ASF_STREAM_VIDEO;
+  }
+
+  gst_object_unref (asfmux);
+  return TRUE;
+
+/* ERRORS */
+refuse_caps:
+  {
+    GST_WARNING_OBJECT (asfmux, "pad %s refused caps %" GST_PTR_FORMAT,
+        GST_PAD_NAME (pad), caps);
+    gst_object_unref (asfmux);
+    return FALSE;
+  }
+refuse_renegotiation:
+  {
+    GST_WARNING_OBJECT (asfmux, "pad %s refused renegotiation to %"
+        GST_PTR_FORMAT, GST_PAD_NAME (pad), caps);
+    gst_object_unref (asfmux);
+    return FALSE;
+  }
+}
+
+/* header writing */
+
+static void
+gst_asf_mux_put_guid (GstByteWriter * bw, const ASFGuid * guid)
+{
+  gst_byte_writer_put_uint32_le (bw, guid->v1);
+  gst_byte_writer_put_uint32_le (bw, guid->v2);
+  gst_byte_writer_put_uint32_le (bw, guid->v3);
+  gst_byte_writer_put_uint32_le (bw, guid->v4);
+}
+
+static void
+gst_asf_mux_put_object_header (GstByteWriter * bw, AsfObjectID id,
+    guint64 size)
+{
+  gst_asf_mux_put_guid (bw, gst_asf_get_guid (asf_object_guids, id));
+  gst_byte_writer_put_uint64_le (bw, size);
+}
+
+static guint
+gst_asf_mux_get_codec_data_size (GstAsfMuxPad * pad)
+{
+  return (pad->codec_data) ? GST_BUFFER_SIZE (pad->codec_data) : 0;
+}
+
+static guint
+gst_asf_mux_get_stream_object_size (GstAsfMuxPad * pad)
+{
+  guint size = ASF_STREAM_OBJECT_SIZE + gst_asf_mux_get_codec_data_size (pad);
+
+  if (pad->type == ASF_STREAM_AUDIO)
+    return size + ASF_AUDIO_SPECIFIC_SIZE;
+  else
+    return size + ASF_VIDEO_SPECIFIC_SIZE;
+}
+
+/* FILETIME, ie. 100-nanosecond intervals since January 1, 1601 */
+static guint64
+gst_asf_mux_get_creation_date (void)
+{
+  GTimeVal now;
+
+  g_get_current_time (&now);
+  return (((guint64) now.tv_sec + G_GUINT64_CONSTANT (11644473600)) *
+      10000000) + now.tv_usec * 10;
+}
+
+static void
+gst_asf_mux_put_stream_object (GstAsfIndexMux * asfmux, GstByteWriter * bw,
+    GstAsfMuxPad * pad)
+{
+  guint cd_size = gst_asf_mux_get_codec_data_size (pad);
+  guint specific_size;
+
+  gst_asf_mux_put_object_header (bw, ASF_OBJ_STREAM,
+      gst_asf_mux_get_stream_object_size (pad));
+
+  gst_asf_mux_put_guid (bw, gst_asf_get_guid (asf_stream_guids, pad->type));
+  gst_asf_mux_put_guid (bw, gst_asf_get_guid (asf_correction_guids,
+          ASF_CORRECTION_OFF));
+  gst_byte_writer_put_uint64_le (bw, 0);        /* time offset */
+
+  if (pad->type == ASF_STREAM_AUDIO)
+    specific_size = ASF_AUDIO_SPECIFIC_SIZE + cd_size;
+  else
+    specific_size = ASF_VIDEO_SPECIFIC_SIZE + cd_size;
+
+  gst_byte_writer_put_uint32_le (bw, specific_size);
+  gst_byte_writer_put_uint32_le (bw, 0);        /* error correction data */
+  gst_byte_writer_put_uint16_le (bw, pad->number & 0x7f);
+  gst_byte_writer_put_uint32_le (bw, 0);        /* reserved */
+
+  if (pad->type == ASF_STREAM_AUDIO) {
+    /* WAVEFORMATEX */
+    gst_byte_writer_put_uint16_le (bw, pad->codec_tag);
+    gst_byte_writer_put_uint16_le (bw, pad->channels);
+    gst_byte_writer_put_uint32_le (bw, pad->rate);
+    gst_byte_writer_put_uint32_le (bw, pad->bitrate / 8);
+    gst_byte_writer_put_uint16_le (bw, pad->block_align);
+    gst_byte_writer_put_uint16_le (bw, pad->depth);
+    gst_byte_writer_put_uint16_le (bw, cd_size);
+  } else {
+    gst_byte_writer_put_uint32_le (bw, pad->width);
+    gst_byte_writer_put_uint32_le (bw, pad->height);
+    gst_byte_writer_put_uint8 (bw, 2);  /* reserved flags */
+    gst_byte_writer_put_uint16_le (bw, 40 + cd_size);
+    /* BITMAPINFOHEADER */
+    gst_byte_writer_put_uint32_le (bw, 40 + cd_size);
+    gst_byte_writer_put_uint32_le (bw, pad->width);
+    gst_byte_writer_put_uint32_le (bw, pad->height);
+    gst_byte_writer_put_uint16_le (bw, 1);      /* planes */
+    gst_byte_writer_put_uint16_le (bw, 24);     /* bit count */
+    gst_byte_writer_put_uint32_le (bw, pad->fourcc);
+    gst_byte_writer_put_uint32_le (bw, pad->width * pad->height * 3);
+    gst_byte_writer_put_uint32_le (bw, 0);      /* x pels per meter */
+    gst_byte_writer_put_uint32_le (bw, 0);      /* y pels per meter */
+    gst_byte_writer_put_uint32_le (bw, 0);      /* colours used */
+    gst_byte_writer_put_uint32_le (bw, 0);      /* important colours */
+  }
+
+  if (cd_size > 0) {
+    gst_byte_writer_put_data (bw, GST_BUFFER_DATA (pad->codec_data),
+        cd_size);
+  }
+}
+
+/* Creates the header object followed by the start of the data object. With
+ * @final set, the sizes, duration and packet count are filled in; the size of
+ * the returned buffer doesn't depend on it, so it can be used to overwrite
+ * the initial header in place. */
+static GstBuffer *
+gst_asf_mux_create_header (GstAsfIndexMux * asfmux, gboolean final)
+{
+  GstByteWriter bw;
+  GstClockTime duration;
+  guint64 header_size, data_size, play_duration, send_duration;
+  guint32 flags, max_bitrate = 0;
+  GSList *walk;
+
+  header_size = ASF_HEADER_OBJECT_SIZE + ASF_FILE_OBJECT_SIZE +
+      ASF_HEADER_EXT_SIZE;
+  for (walk = asfmux->collect->data; walk; walk = walk->next) {
+    GstAsfMuxPad *pad = (GstAsfMuxPad *) walk->data;
+
+    header_size += gst_asf_mux_get_stream_object_size (pad);
+    max_bitrate += pad->bitrate;
+  }
+
+  if (final && GST_CLOCK_TIME_IS_VALID (asfmux->first_ts) &&
+      asfmux->last_ts > asfmux->first_ts)
+    duration = asfmux->last_ts - asfmux->first_ts;
+  else
+    duration = 0;
+
+  if (final) {
+    data_size = ASF_DATA_OBJECT_SIZE + asfmux->num_packets *
+        asfmux->packet_size;
+    /* in 100 nanosecond units */
+    send_duration = duration / 100;
+    play_duration = send_duration + asfmux->preroll * 10000;
+  } else {
+    data_size = 0;
+    send_duration = 0;
+    play_duration = 0;
+  }
+
+  if (asfmux->streamable)
+    flags = ASF_FILE_FLAG_BROADCAST;
+  else
+    flags = ASF_FILE_FLAG_SEEKABLE;
+
+  gst_byte_writer_init_with_size (&bw, header_size + ASF_DATA_OBJECT_SIZE,
+      TRUE);
+
+  /* header object */
+  gst_asf_mux_put_object_header (&bw, ASF_OBJ_HEADER, header_size);
+  gst_byte_writer_put_uint32_le (&bw,
+      2 + g_slist_length (asfmux->collect->data));
+  gst_byte_writer_put_uint8 (&bw, 0x01);
+  gst_byte_writer_put_uint8 (&bw, 0x02);
+
+  /* file properties object */
+  gst_asf_mux_put_object_header (&bw, ASF_OBJ_FILE, ASF_FILE_OBJECT_SIZE);
+  gst_asf_mux_put_guid (&bw, &asfmux->file_id);
+  gst_byte_writer_put_uint64_le (&bw, (final) ? asfmux->file_size : 0);
+  gst_byte_writer_put_uint64_le (&bw, gst_asf_mux_get_creation_date ());
+  gst_byte_writer_put_uint64_le (&bw, (final) ? asfmux->num_packets : 0);
+  gst_byte_writer_put_uint64_le (&bw, play_duration);
+  gst_byte_writer_put_uint64_le (&bw, send_duration);
+  gst_byte_writer_put_uint64_le (&bw, asfmux->preroll);
+  gst_byte_writer_put_uint32_le (&bw, flags);
+  gst_byte_writer_put_uint32_le (&bw, asfmux->packet_size);
+  gst_byte_writer_put_uint32_le (&bw, asfmux->packet_size);
+  gst_byte_writer_put_uint32_le (&bw, max_bitrate);
+
+  /* stream properties objects */
+  for (walk = asfmux->collect->data; walk; walk = walk->next)
+    gst_asf_mux_put_stream_object (asfmux, &bw, (GstAsfMuxPad *) walk->data);
+
+  /* header extension object, required even if empty */
+  gst_asf_mux_put_object_header (&bw, ASF_OBJ_HEAD1, ASF_HEADER_EXT_SIZE);
+  gst_asf_mux_put_guid (&bw, gst_asf_get_guid (asf_object_guids,
+          ASF_OBJ_HEAD2));
+  gst_byte_writer_put_uint16_le (&bw, 6);
+  gst_byte_writer_put_uint32_le (&bw, 0);
+
+  /* start of the data object */
+  gst_asf_mux_put_object_header (&bw, ASF_OBJ_DATA, data_size);
+  gst_asf_mux_put_guid (&bw, &asfmux->file_id);
+  gst_byte_writer_put_uint64_le (&bw, (final) ? asfmux->num_packets : 0);
+  gst_byte_writer_put_uint16_le (&bw, 0x0101);
+
+  return gst_byte_writer_reset_and_get_buffer (&bw);
+}
+
+static GstFlowReturn
+gst_asf_mux_push_buffer (GstAsfIndexMux * asfmux, GstBuffer * buf)
+{
+  GST_BUFFER_OFFSET (buf) = asfmux->file_size;
+  asfmux->file_size += GST_BUFFER_SIZE (buf);
+  GST_BUFFER_OFFSET_END (buf) = asfmux->file_size;
+  gst_buffer_set_caps (buf, GST_PAD_CAPS (asfmux->srcpad));
+
+  return gst_pad_push (asfmux->srcpad, buf);
+}
+
+static GstFlowReturn
+gst_asf_mux_start_file (GstAsfIndexMux * asfmux)
+{
+  GstAsfMuxPad *index_pad = NULL;
+  GstCaps *caps;
+  GSList *walk;
+
+  if (asfmux->collect->data == NULL)
+    goto no_streams;
+
+  for (walk = asfmux->collect->data; walk; walk = walk->next) {
+    GstAsfMuxPad *pad = (GstAsfMuxPad *) walk->data;
+
+    if (pad->type == ASF_STREAM_UNDEFINED)
+      goto not_negotiated;
+
+    if (pad->type == ASF_STREAM_VIDEO && (index_pad == NULL ||
+            index_pad->type != ASF_STREAM_VIDEO))
+      index_pad = pad;
+    else if (index_pad == NULL)
+      index_pad = pad;
+  }
+
+  GST_DEBUG_OBJECT (asfmux, "indexing stream %u", index_pad->number);
+  index_pad->is_index_stream = TRUE;
+
+  /* the header and all packets of a file have to agree on these */
+  GST_OBJECT_LOCK (asfmux);
+  asfmux->packet_size = asfmux->prop_packet_size;
+  asfmux->preroll = asfmux->prop_preroll;
+  asfmux->index_interval = asfmux->prop_index_interval;
+  asfmux->streamable = asfmux->prop_streamable;
+  GST_OBJECT_UNLOCK (asfmux);
+
+  caps = gst_caps_copy (gst_pad_get_pad_template_caps (asfmux->srcpad));
+  gst_pad_set_caps (asfmux->srcpad, caps);
+  gst_caps_unref (caps);
+
+  gst_pad_push_event (asfmux->srcpad,
+      gst_event_new_new_segment (FALSE, 1.0, GST_FORMAT_BYTES, 0, -1, 0));
+
+  asfmux->state = GST_ASF_MUX_STATE_HEADERS;
+  return gst_asf_mux_push_buffer (asfmux,
+      gst_asf_mux_create_header (asfmux, FALSE));
+
+/* ERRORS */
+no_streams:
+  {
+    GST_ELEMENT_ERROR (asfmux, STREAM, MUX, (NULL),
+        ("No input streams were requested"));
+    return GST_FLOW_ERROR;
+  }
+not_negotiated:
+  {
+    GST_ELEMENT_ERROR (asfmux, CORE, NEGOTIATION, (NULL),
+        ("Not all input streams have caps"));
+    return GST_FLOW_NOT_NEGOTIATED;
+  }
+}
+
+/* packet writing */
+
+static GstFlowReturn
+gst_asf_mux_flush_packet (GstAsfIndexMux * asfmux)
+{
+  GstBuffer *packet = asfmux->packet;
+  guint8 *data = GST_BUFFER_DATA (packet);
+  guint padding, duration;
+
+  padding = asfmux->packet_size - asfmux->packet_pos;
+  memset (data + asfmux->packet_pos, 0, padding);
+
+  duration = asfmux->packet_last_pres - asfmux->packet_send_time;
+
+  GST_WRITE_UINT8 (data + 0, ASF_PACKET_EC_FLAGS);
+  GST_WRITE_UINT8 (data + 1, 0);
+  GST_WRITE_UINT8 (data + 2, 0);
+  GST_WRITE_UINT8 (data + 3, ASF_PACKET_LEN_FLAGS);
+  GST_WRITE_UINT8 (data + 4, ASF_PACKET_PROP_FLAGS);
+  GST_WRITE_UINT16_LE (data + 5, padding);
+  GST_WRITE_UINT32_LE (data + 7, asfmux->packet_send_time);
+  GST_WRITE_UINT16_LE (data + 11, MIN (duration, G_MAXUINT16));
+  GST_WRITE_UINT8 (data + 13, ASF_PAYLOAD_LEN_FLAGS |
+      asfmux->packet_num_payloads);
+
+  GST_LOG_OBJECT (asfmux, "packet %" G_GUINT64_FORMAT ": %u payloads, "
+      "send time %u ms, padding %u", asfmux->num_packets,
+      asfmux->packet_num_payloads, asfmux->packet_send_time, padding);
+
+  GST_BUFFER_TIMESTAMP (packet) = asfmux->packet_send_time * GST_MSECOND;
+  GST_BUFFER_DURATION (packet) = duration * GST_MSECOND;
+
+  asfmux->packet = NULL;
+  asfmux->packet_pos = 0;
+  asfmux->packet_num_payloads = 0;
+  ++asfmux->num_packets;
+
+  return gst_asf_mux_push_buffer (asfmux, packet);
+}
+
+/* Registers a keyframe of the index stream starting in @packet at
+ * presentation time @time. All index entries before that time are now known
+ * to point to the previous keyframe. */
+static void
+gst_asf_mux_index_keyframe (GstAsfIndexMux * asfmux, GstClockTime time,
+    guint32 packet)
+{
+  if (!asfmux->have_keyframe) {
+    /* entries before the first keyframe point at the first keyframe */
+    asfmux->last_keyframe.packet = packet;
+    asfmux->last_keyframe.count = 1;
+    asfmux->have_keyframe = TRUE;
+  }
+
+  while (asfmux->next_index_time < time) {
+    g_array_append_val (asfmux->index, asfmux->last_keyframe);
+    asfmux->next_index_time += asfmux->index_interval;
+  }
+
+  asfmux->last_keyframe.packet = packet;
+  asfmux->last_keyframe.count = 1;
+}
+
+static GstFlowReturn
+gst_asf_mux_add_media_object (GstAsfIndexMux * asfmux, GstAsfMuxPad * pad,
+    GstBuffer * buf, GstClockTime ts)
+{
+  GstFlowReturn ret = GST_FLOW_OK;
+  const guint8 *obj_data;
+  guint32 pres, send;
+  guint obj_size, offset;
+  gboolean keyframe;
+
+  obj_data = GST_BUFFER_DATA (buf);
+  obj_size = GST_BUFFER_SIZE (buf);
+
+  if (G_UNLIKELY (obj_size == 0)) {
+    GST_DEBUG_OBJECT (asfmux, "skipping empty buffer for stream %u",
+        pad->number);
+    goto done;
+  }
+
+  send = (guint32) ((ts - asfmux->first_ts) / GST_MSECOND);
+  pres = send + (guint32) asfmux->preroll;
+  keyframe = !GST_BUFFER_FLAG_IS_SET (buf, GST_BUFFER_FLAG_DELTA_UNIT);
+
+  GST_LOG_OBJECT (asfmux, "stream %u: media object %u, size %u, pres %u ms%s",
+      pad->number, pad->media_object, obj_size, pres,
+      (keyframe) ? ", keyframe" : "");
+
+  offset = 0;
+  do {
+    guint8 *data;
+    guint room, len;
+
+    if (asfmux->packet != NULL) {
+      room = asfmux->packet_size - asfmux->packet_pos;
+      if (room < ASF_PAYLOAD_HEADER_SIZE + 1 ||
+          asfmux->packet_num_payloads == ASF_MAX_PAYLOADS) {
+        ret = gst_asf_mux_flush_packet (asfmux);
+        if (ret != GST_FLOW_OK)
+          goto done;
+      }
+    }
+
+    if (asfmux->packet == NULL) {
+      asfmux->packet = gst_buffer_new_and_alloc (asfmux->packet_size);
+      asfmux->packet_pos = ASF_PACKET_HEADER_SIZE;
+      asfmux->packet_send_time = send;
+      asfmux->packet_last_pres = send;
+    }
+
+    if (offset == 0 && keyframe && pad->is_index_stream)
+      gst_asf_mux_index_keyframe (asfmux, pres * GST_MSECOND,
+          asfmux->num_packets);
+
+    room = asfmux->packet_size - asfmux->packet_pos;
+    len = MIN (obj_size - offset, room - ASF_PAYLOAD_HEADER_SIZE);
+
+    data = GST_BUFFER_DATA (asfmux->packet) + asfmux->packet_pos;
+    GST_WRITE_UINT8 (data + 0, pad->number | ((keyframe) ? 0x80 : 0));
+    GST_WRITE_UINT8 (data + 1, pad->media_object);
+    GST_WRITE_UINT32_LE (data + 2, offset);
+    GST_WRITE_UINT8 (data + 6, 8);
+    GST_WRITE_UINT32_LE (data + 7, obj_size);
+    GST_WRITE_UINT32_LE (data + 11, pres);
+    GST_WRITE_UINT16_LE (data + 15, len);
+    memcpy (data + ASF_PAYLOAD_HEADER_SIZE, obj_data + offset, len);
+
+    asfmux->packet_pos += ASF_PAYLOAD_HEADER_SIZE + len;
+    asfmux->packet_last_pres = MAX (asfmux->packet_last_pres, send);
+    ++asfmux->packet_num_payloads;
+    offset += len;
+  } while (offset < obj_size);
+
+  /* the packet holding the end of the object is still being filled, but
+   * it will count as one nonetheless */
+  if (keyframe && pad->is_index_stream) {
+    asfmux->last_keyframe.count = MIN (asfmux->num_packets -
+        asfmux->last_keyframe.packet + 1, G_MAXUINT16);
+  }
+
+  ++pad->media_object;
+
+done:
+  if (GST_BUFFER_DURATION_IS_VALID (buf))
+    ts += GST_BUFFER_DURATION (buf);
+  asfmux->last_ts = MAX (asfmux->last_ts, ts);
+
+  gst_buffer_unref (buf);
+  return ret;
+}
+
+static GstFlowReturn
+gst_asf_mux_push_simple_index (GstAsfIndexMux * asfmux)
+{
+  GstByteWriter bw;
+  GstClockTime end_time;
+  guint32 max_count = 0;
+  guint i, size;
+
+  /* fill in entries up to the end of the file */
+  if (asfmux->have_keyframe) {
+    end_time = asfmux->last_ts - asfmux->first_ts +
+        asfmux->preroll * GST_MSECOND;
+    while (asfmux->next_index_time <= end_time) {
+      g_array_append_val (asfmux->index, asfmux->last_keyframe);
+      asfmux->next_index_time += asfmux->index_interval;
+    }
+  }
+
+  if (asfmux->index->len == 0) {
+    GST_DEBUG_OBJECT (asfmux, "no index entries, not writing index");
+    return GST_FLOW_OK;
+  }
+
+  for (i = 0; i < asfmux->index->len; ++i) {
+    max_count = MAX (max_count,
+        g_array_index (asfmux->index, GstAsfMuxIndexEntry, i).count);
+  }
+
+  size = ASF_SIMPLE_INDEX_SIZE + asfmux->index->len * (4 + 2);
+  gst_byte_writer_init_with_size (&bw, size, TRUE);
+
+  gst_asf_mux_put_object_header (&bw, ASF_OBJ_SIMPLE_INDEX, size);
+  gst_asf_mux_put_guid (&bw, &asfmux->file_id);
+  gst_byte_writer_put_uint64_le (&bw, asfmux->index_interval / 100);
+  gst_byte_writer_put_uint32_le (&bw, max_count);
+  gst_byte_writer_put_uint32_le (&bw, asfmux->index->len);
+
+  for (i = 0; i < asfmux->index->len; ++i) {
+    GstAsfMuxIndexEntry *entry;
+
+    entry = &g_array_index (asfmux->index, GstAsfMuxIndexEntry, i);
+    gst_byte_writer_put_uint32_le (&bw, entry->packet);
+    gst_byte_writer_put_uint16_le (&bw, entry->count);
+  }
+
+  GST_DEBUG_OBJECT (asfmux, "writing simple index with %u entries",
+      asfmux->index->len);
+
+  return gst_asf_mux_push_buffer (asfmux,
+      gst_byte_writer_reset_and_get_buffer (&bw));
+}
+
+static GstFlowReturn
+gst_asf_mux_stop_file (GstAsfIndexMux * asfmux)
+{
+  GstFlowReturn ret = GST_FLOW_OK;
+  GstBuffer *header;
+
+  if (asfmux->packet != NULL) {
+    ret = gst_asf_mux_flush_packet (asfmux);
+    if (ret != GST_FLOW_OK)
+      return ret;
+  }
+
+  if (!asfmux->streamable) {
+    ret = gst_asf_mux_push_simple_index (asfmux);
+    if (ret != GST_FLOW_OK)
+      return ret;
+
+    /* rewrite the header in place; the file size must not change */
+    if (!gst_pad_push_event (asfmux->srcpad,
+            gst_event_new_new_segment (FALSE, 1.0, GST_FORMAT_BYTES, 0, -1,
+                0))) {
+      GST_WARNING_OBJECT (asfmux, "downstream is not seekable, can't "
+          "rewrite the header");
+    } else {
+      header = gst_asf_mux_create_header (asfmux, TRUE);
+      GST_BUFFER_OFFSET (header) = 0;
+      GST_BUFFER_OFFSET_END (header) = GST_BUFFER_SIZE (header);
+      gst_buffer_set_caps (header, GST_PAD_CAPS (asfmux->srcpad));
+      ret = gst_pad_push (asfmux->srcpad, header);
+    }
+  }
+
+  asfmux->state = GST_ASF_MUX_STATE_EOS;
+  gst_pad_push_event (asfmux->srcpad, gst_event_new_eos ());
+
+  if (ret == GST_FLOW_OK)
+    ret = GST_FLOW_UNEXPECTED;
+
+  return ret;
+}
+
+static GstClockTime
+gst_asf_mux_get_running_time (GstAsfIndexMux * asfmux, GstAsfMuxPad * pad,
+    GstBuffer * buf)
+{
+  GstClockTime ts = GST_BUFFER_TIMESTAMP (buf);
+
+  if (!GST_CLOCK_TIME_IS_VALID (ts))
+    return GST_CLOCK_TIME_NONE;
+
+  return gst_segment_to_running_time (&pad->collect.segment, GST_FORMAT_TIME,
+      ts);
+}
+
+static GstFlowReturn
+gst_asf_mux_collected (GstCollectPads * pads, GstAsfIndexMux * asfmux)
+{
+  GstAsfMuxPad *best_pad = NULL;
+  GstClockTime best_time = GST_CLOCK_TIME_NONE;
+  GstFlowReturn ret;
+  GstBuffer *buf;
+  GSList *walk;
+
+  if (G_UNLIKELY (asfmux->state == GST_ASF_MUX_STATE_EOS))
+    return GST_FLOW_UNEXPECTED;
+
+  if (G_UNLIKELY (asfmux->state == GST_ASF_MUX_STATE_NONE)) {
+    ret = gst_asf_mux_start_file (asfmux);
+    if (ret != GST_FLOW_OK)
+      return ret;
+    asfmux->state = GST_ASF_MUX_STATE_DATA;
+  }
+
+  /* pick the buffer with the lowest running time, buffers without timestamp
+   * go first */
+  for (walk = pads->data; walk; walk = walk->next) {
+    GstAsfMuxPad *pad = (GstAsfMuxPad *) walk->data;
+    GstClockTime time;
+
+    buf = gst_collect_pads_peek (pads, (GstCollectData *) pad);
+    if (buf == NULL)
+      continue;
+
+    time = gst_asf_mux_get_running_time (asfmux, pad, buf);
+    gst_buffer_unref (buf);
+
+    if (best_pad == NULL || !GST_CLOCK_TIME_IS_VALID (time) ||
+        (GST_CLOCK_TIME_IS_VALID (best_time) && time < best_time)) {
+      best_pad = pad;
+      best_time = time;
+      if (!GST_CLOCK_TIME_IS_VALID (time))
+        break;
+    }
+  }
+
+  if (best_pad == NULL) {
+    GST_DEBUG_OBJECT (asfmux, "all pads are EOS, finishing file");
+    return gst_asf_mux_stop_file (asfmux);
+  }
+
+  buf = gst_collect_pads_pop (pads, (GstCollectData *) best_pad);
+
+  if (!GST_CLOCK_TIME_IS_VALID (best_time)) {
+    if (GST_CLOCK_TIME_IS_VALID (asfmux->first_ts))
+      best_time = MAX (asfmux->last_ts, asfmux->first_ts);
+    else
+      best_time = 0;
+  }
+
+  if (!GST_CLOCK_TIME_IS_VALID (asfmux->first_ts))
+    asfmux->first_ts = best_time;
+
+  if (best_time < asfmux->first_ts)
+    best_time = asfmux->first_ts;
+
+  return gst_asf_mux_add_media_object (asfmux, best_pad, buf, best_time);
+}
+
+static void
+gst_asf_mux_set_property (GObject * object, guint prop_id,
+    const GValue * value, GParamSpec * pspec)
+{
+  GstAsfIndexMux *asfmux = GST_ASF_INDEX_MUX (object);
+
+  GST_OBJECT_LOCK (asfmux);
+
+  switch (prop_id) {
+    case PROP_PACKET_SIZE:
+      asfmux->prop_packet_size = g_value_get_uint (value);
+      break;
+    case PROP_PREROLL:
+      asfmux->prop_preroll = g_value_get_uint64 (value);
+      break;
+    case PROP_INDEX_INTERVAL:
+      asfmux->prop_index_interval = g_value_get_uint64 (value);
+      break;
+    case PROP_STREAMABLE:
+      asfmux->prop_streamable = g_value_get_boolean (value);
+      break;
+    default:
+      G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
+      break;
+  }
+
+  GST_OBJECT_UNLOCK (asfmux);
+}
+
+static void
+gst_asf_mux_get_property (GObject * object, guint prop_id, GValue * value,
+    GParamSpec * pspec)
+{
+  GstAsfIndexMux *asfmux = GST_ASF_INDEX_MUX (object);
+
+  GST_OBJECT_LOCK (asfmux);
+
+  switch (prop_id) {
+    case PROP_PACKET_SIZE:
+      g_value_set_uint (value, asfmux->prop_packet_size);
+      break;
+    case PROP_PREROLL:
+      g_value_set_uint64 (value, asfmux->prop_preroll);
+      break;
+    case PROP_INDEX_INTERVAL:
+      g_value_set_uint64 (value, asfmux->prop_index_interval);
+      break;
+    case PROP_STREAMABLE:
+      g_value_set_boolean (value, asfmux->prop_streamable);
+      break;
+    default:
+      G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
+      break;
+  }
+
+  GST_OBJECT_UNLOCK (asfmux);
+}
+
+static GstStateChangeReturn
+gst_asf_mux_change_state (GstElement * element, GstStateChange transition)
+{
+  GstAsfIndexMux *asfmux = GST_ASF_INDEX_MUX (element);
+  GstStateChangeReturn ret;
+
+  switch (transition) {
+    case GST_STATE_CHANGE_READY_TO_PAUSED:
+      gst_asf_mux_reset (asfmux);
+      gst_collect_pads_start (asfmux->collect);
+      break;
+    case GST_STATE_CHANGE_PAUSED_TO_READY:
+      /* stop collectpads before chaining up, it takes the stream lock */
+      gst_collect_pads_stop (asfmux->collect);
+      break;
+    default:
+      break;
+  }
+
+  ret = GST_ELEMENT_CLASS (parent_class)->change_state (element, transition);
+  if (ret == GST_STATE_CHANGE_FAILURE)
+    return ret;
+
+  switch (transition) {
+    case GST_STATE_CHANGE_PAUSED_TO_READY:
+      gst_asf_mux_reset (asfmux);
+      break;
+    default:
+      break;
+  }
+
+  return ret;
+}
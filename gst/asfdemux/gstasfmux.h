@@ -0,0 +1,132 @@
+/* GStreamer ASF muxer
+ * Copyright (C) 2012 GStreamer developers
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 59 Temple Place - Suite 330,
+ * Boston, MA 02111-1307, USA.
+ */
+
+#ifndef __ASF_MUX_H__
+#define __ASF_MUX_H__
+
+#include <gst/gst.h>
+#include <gst/base/gstcollectpads.h>
+
+#include "asfheaders.h"
+
+G_BEGIN_DECLS
+
+#define GST_TYPE_ASF_INDEX_MUX \
+  (gst_asf_mux_get_type())
+#define GST_ASF_INDEX_MUX(obj) \
+  (G_TYPE_CHECK_INSTANCE_CAST((obj),GST_TYPE_ASF_INDEX_MUX,GstAsfIndexMux))
+#define GST_ASF_INDEX_MUX_CLASS(klass) \
+  (G_TYPE_CHECK_CLASS_CAST((klass),GST_TYPE_ASF_INDEX_MUX,GstAsfIndexMuxClass))
+#define GST_IS_ASF_INDEX_MUX(obj) \
+  (G_TYPE_CHECK_INSTANCE_TYPE((obj),GST_TYPE_ASF_INDEX_MUX))
+#define GST_IS_ASF_INDEX_MUX_CLASS(klass) \
+  (G_TYPE_CHECK_CLASS_TYPE((klass),GST_TYPE_ASF_INDEX_MUX))
+
+typedef struct _GstAsfIndexMux GstAsfIndexMux;
+typedef struct _GstAsfIndexMuxClass GstAsfIndexMuxClass;
+
+typedef struct {
+  guint32	packet;
+  guint16	count;
+} GstAsfMuxIndexEntry;
+
+typedef struct
+{
+  GstCollectData  collect;      /* we extend the CollectData */
+
+  AsfStreamType   type;
+  guint8          number;       /* ASF stream number, 1..127 */
+  guint8          media_object; /* media object number, wraps around */
+  gboolean        is_index_stream;
+
+  /* stream properties, filled in from the caps */
+  guint16         codec_tag;    /* audio: WAVEFORMATEX wFormatTag */
+  guint32         fourcc;       /* video: BITMAPINFOHEADER biCompression */
+  gint            channels;
+  gint            rate;
+  gint            depth;
+  gint            block_align;
+  gint            width;
+  gint            height;
+  guint32         bitrate;
+  GstBuffer      *codec_data;
+} GstAsfMuxPad;
+
+typedef enum {
+  GST_ASF_MUX_STATE_NONE,
+  GST_ASF_MUX_STATE_HEADERS,
+  GST_ASF_MUX_STATE_DATA,
+  GST_ASF_MUX_STATE_EOS
+} GstAsfMuxState;
+
+struct _GstAsfIndexMux {
+  GstElement          element;
+
+  GstPad             *srcpad;
+  GstCollectPads     *collect;
+
+  GstAsfMuxState      state;
+  guint               num_streams;
+  guint               num_audio_streams;
+  guint               num_video_streams;
+
+  /* properties, with LOCK */
+  guint32             prop_packet_size;
+  guint64             prop_preroll;
+  GstClockTime        prop_index_interval;
+  gboolean            prop_streamable;
+
+  /* the properties as copied when the file is started, streaming thread
+   * only */
+  guint32             packet_size;
+  guint64             preroll;         /* in milliseconds */
+  GstClockTime        index_interval;
+  gboolean            streamable;
+
+  ASFGuid             file_id;
+  guint64             file_size;       /* bytes pushed so far */
+
+  /* packet currently being filled */
+  GstBuffer          *packet;
+  guint               packet_pos;
+  guint               packet_num_payloads;
+  guint32             packet_send_time;     /* in milliseconds */
+  guint32             packet_last_pres;     /* in milliseconds */
+  guint64             num_packets;          /* packets pushed so far */
+
+  GstClockTime        first_ts;
+  GstClockTime        last_ts;              /* end of the last media object */
+
+  /* simple index for the index stream (first video stream, or first stream
+   * if there is no video) */
+  GArray             *index;
+  GstClockTime        next_index_time;      /* presentation time, in ns */
+  GstAsfMuxIndexEntry last_keyframe;
+  gboolean            have_keyframe;
+};
+
+struct _GstAsfIndexMuxClass {
+  GstElementClass parent_class;
+};
+
+GType           gst_asf_mux_get_type (void);
+
+G_END_DECLS
+
+#endif /* __ASF_MUX_H__ */
@@ -66,10 +66,16 @@ enum
 
 enum
 {
-  ARG_0
-      /* FILL ME */
+  ARG_0,
+  ARG_GAIN,
+  ARG_REPLAYGAIN
 };
 
+#define DEFAULT_GAIN 0.0
+#define DEFAULT_REPLAYGAIN FALSE
+
+#define GAIN_UNITY (1 << 16)
+
 static void gst_dvdlpcmdec_base_init (gpointer g_class);
 static void gst_dvdlpcmdec_class_init (GstDvdLpcmDecClass * klass);
 static void gst_dvdlpcmdec_init (GstDvdLpcmDec * dvdlpcmdec);
@@ -81,6 +87,11 @@ static GstFlowReturn gst_dvdlpcmdec_chain_dvd (GstPad * pad,
 static gboolean gst_dvdlpcmdec_setcaps (GstPad * pad, GstCaps * caps);
 static gboolean dvdlpcmdec_sink_event (GstPad * pad, GstEvent * event);
 
+static void gst_dvdlpcmdec_set_property (GObject * object, guint prop_id,
+    const GValue * value, GParamSpec * pspec);
+static void gst_dvdlpcmdec_get_property (GObject * object, guint prop_id,
+    GValue * value, GParamSpec * pspec);
+
 static GstStateChangeReturn gst_dvdlpcmdec_change_state (GstElement * element,
     GstStateChange transition);
 
@@ -129,13 +140,98 @@ gst_dvdlpcmdec_base_init (gpointer g_class)
 static void
 gst_dvdlpcmdec_class_init (GstDvdLpcmDecClass * klass)
 {
+  GObjectClass *gobject_class;
   GstElementClass *gstelement_class;
 
+  gobject_class = (GObjectClass *) klass;
   gstelement_class = (GstElementClass *) klass;
 
   parent_class = g_type_class_peek_parent (klass);
 
+  gobject_class->set_property = gst_dvdlpcmdec_set_property;
+  gobject_class->get_property = gst_dvdlpcmdec_get_property;
+
   gstelement_class->change_state = gst_dvdlpcmdec_change_state;
+
+  /**
+   * GstDvdLpcmDec:gain
+   *
+   * Gain in dB applied while unpacking the samples. Samples that exceed full
+   * scale after the gain saturate. 16-bit streams are only passed through
+   * without a copy at 0 dB.
+   */
+  g_object_class_install_property (gobject_class, ARG_GAIN,
+      g_param_spec_double ("gain", "Gain", "Output gain in dB",
+          GST_DECODER_GAIN_MIN, GST_DECODER_GAIN_MAX, DEFAULT_GAIN,
+          G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
+  /**
+   * GstDvdLpcmDec:replaygain
+   *
+   * Add the ReplayGain from upstream tags to #GstDvdLpcmDec:gain. DVDs don't
+   * carry ReplayGain, this is for LPCM from other containers.
+   */
+  g_object_class_install_property (gobject_class, ARG_REPLAYGAIN,
+      g_param_spec_boolean ("replaygain", "ReplayGain",
+          "Apply the ReplayGain from upstream tags", DEFAULT_REPLAYGAIN,
+          G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
+}
+
+/* call with the object lock */
+static void
+gst_dvdlpcmdec_update_gain (GstDvdLpcmDec * dvdlpcmdec)
+{
+  dvdlpcmdec->gain_factor = (gint32) (gst_decoder_gain_get_factor
+      (&dvdlpcmdec->output_gain) * GAIN_UNITY + 0.5);
+  GST_DEBUG_OBJECT (dvdlpcmdec, "output gain %.2f dB",
+      gst_decoder_gain_get_db (&dvdlpcmdec->output_gain));
+}
+
+static void
+gst_dvdlpcmdec_set_property (GObject * object, guint prop_id,
+    const GValue * value, GParamSpec * pspec)
+{
+  GstDvdLpcmDec *dvdlpcmdec = GST_DVDLPCMDEC (object);
+
+  switch (prop_id) {
+    case ARG_GAIN:
+      GST_OBJECT_LOCK (dvdlpcmdec);
+      dvdlpcmdec->output_gain.gain = g_value_get_double (value);
+      gst_dvdlpcmdec_update_gain (dvdlpcmdec);
+      GST_OBJECT_UNLOCK (dvdlpcmdec);
+      break;
+    case ARG_REPLAYGAIN:
+      GST_OBJECT_LOCK (dvdlpcmdec);
+      dvdlpcmdec->output_gain.replaygain = g_value_get_boolean (value);
+      gst_dvdlpcmdec_update_gain (dvdlpcmdec);
+      GST_OBJECT_UNLOCK (dvdlpcmdec);
+      break;
+    default:
+      G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
+      break;
+  }
+}
+
+static void
+gst_dvdlpcmdec_get_property (GObject * object, guint prop_id,
+    GValue * value, GParamSpec * pspec)
+{
+  GstDvdLpcmDec *dvdlpcmdec = GST_DVDLPCMDEC (object);
+
+  switch (prop_id) {
+    case ARG_GAIN:
+      GST_OBJECT_LOCK (dvdlpcmdec);
+      g_value_set_double (value, dvdlpcmdec->output_gain.gain);
+      GST_OBJECT_UNLOCK (dvdlpcmdec);
+      break;
+    case ARG_REPLAYGAIN:
+      GST_OBJECT_LOCK (dvdlpcmdec);
+      g_value_set_boolean (value, dvdlpcmdec->output_gain.replaygain);
+      GST_OBJECT_UNLOCK (dvdlpcmdec);
+      break;
+    default:
+      G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
+      break;
+  }
 }
 
 static void
@@ -153,6 +249,11 @@ gst_dvdlpcm_reset (GstDvdLpcmDec * dvdlpcmdec)
   dvdlpcmdec->header = 0;
 
   gst_segment_init (&dvdlpcmdec->segment, GST_FORMAT_UNDEFINED);
+
+  GST_OBJECT_LOCK (dvdlpcmdec);
+  gst_decoder_gain_reset (&dvdlpcmdec->output_gain);
+  gst_dvdlpcmdec_update_gain (dvdlpcmdec);
+  GST_OBJECT_UNLOCK (dvdlpcmdec);
 }
 
 static void
@@ -169,6 +270,8 @@ gst_dvdlpcmdec_init (GstDvdLpcmDec * dvdlpcmdec)
   gst_pad_use_fixed_caps (dvdlpcmdec->srcpad);
   gst_element_add_pad (GST_ELEMENT (dvdlpcmdec), dvdlpcmdec->srcpad);
 
+  gst_decoder_gain_init (&dvdlpcmdec->output_gain);
+
   gst_dvdlpcm_reset (dvdlpcmdec);
 }
 
@@ -567,6 +670,30 @@ negotiation_failed:
   }
 }
 
+/* applies a 16.16 fixed point gain to a sample of @width bits and clips */
+static inline gint32
+apply_gain (gint32 sample, gint32 gain, gint width)
+{
+  gint64 res = ((gint64) sample * gain + (1 << 15)) >> 16;
+
+  return CLAMP (res, -(1 << (width - 1)), (1 << (width - 1)) - 1);
+}
+
+static inline gint32
+read_s24 (guint8 hi, guint8 mid, guint8 lo)
+{
+  return ((gint32) (((guint32) hi << 24) | (mid << 16) | (lo << 8))) >> 8;
+}
+
+static inline void
+write_s24_gain (guint8 * dest, gint32 sample, gint32 gain)
+{
+  sample = apply_gain (sample, gain, 24);
+  dest[0] = (sample >> 16) & 0xff;
+  dest[1] = (sample >> 8) & 0xff;
+  dest[2] = sample & 0xff;
+}
+
 static GstFlowReturn
 gst_dvdlpcmdec_chain_raw (GstPad * pad, GstBuffer * buf)
 {
@@ -575,6 +702,7 @@ gst_dvdlpcmdec_chain_raw (GstPad * pad, GstBuffer * buf)
   guint size;
   GstFlowReturn ret;
   guint samples = 0;
+  gint32 gain;
 
   dvdlpcmdec = GST_DVDLPCMDEC (gst_pad_get_parent (pad));
 
@@ -591,6 +719,10 @@ gst_dvdlpcmdec_chain_raw (GstPad * pad, GstBuffer * buf)
   if (GST_BUFFER_TIMESTAMP_IS_VALID (buf))
     dvdlpcmdec->timestamp = GST_BUFFER_TIMESTAMP (buf);
 
+  GST_OBJECT_LOCK (dvdlpcmdec);
+  gain = dvdlpcmdec->gain_factor;
+  GST_OBJECT_UNLOCK (dvdlpcmdec);
+
   /* We don't currently do anything at all regarding emphasis, mute or
    * dynamic_range - I'm not sure what they're for */
   switch (dvdlpcmdec->width) {
@@ -601,7 +733,23 @@ gst_dvdlpcmdec_chain_raw (GstPad * pad, GstBuffer * buf)
       samples = size / dvdlpcmdec->channels / 2;
       if (samples < 1)
         goto drop;
-      buf = gst_buffer_make_metadata_writable (buf);
+      if (gain != GAIN_UNITY) {
+        guint count = size / 2;
+        guint i;
+        guint8 *src;
+
+        buf = gst_buffer_make_writable (buf);
+
+        src = GST_BUFFER_DATA (buf);
+        for (i = 0; i < count; i++) {
+          gint32 sample = (gint16) GST_READ_UINT16_BE (src);
+
+          GST_WRITE_UINT16_BE (src, apply_gain (sample, gain, 16));
+          src += 2;
+        }
+      } else {
+        buf = gst_buffer_make_metadata_writable (buf);
+      }
       break;
     }
     case 20:
@@ -634,22 +782,38 @@ gst_dvdlpcmdec_chain_raw (GstPad * pad, GstBuffer * buf)
 
       /* Copy 20-bit LPCM format to 24-bit buffers, with 0x00 in the lowest
        * nibble. Note that the first 2 bytes are already correct */
-      for (i = 0; i < count; i++) {
-        dest[0] = src[0];
-        dest[1] = src[1];
-        dest[2] = src[8] & 0xf0;
-        dest[3] = src[2];
-        dest[4] = src[3];
-        dest[5] = (src[8] & 0x0f) << 4;
-        dest[6] = src[4];
-        dest[7] = src[5];
-        dest[8] = src[9] & 0x0f;
-        dest[9] = src[6];
-        dest[10] = src[7];
-        dest[11] = (src[9] & 0x0f) << 4;
-
-        src += 10;
-        dest += 12;
+      if (gain != GAIN_UNITY) {
+        for (i = 0; i < count; i++) {
+          write_s24_gain (dest, read_s24 (src[0], src[1], src[8] & 0xf0),
+              gain);
+          write_s24_gain (dest + 3, read_s24 (src[2], src[3],
+                  (src[8] & 0x0f) << 4), gain);
+          write_s24_gain (dest + 6, read_s24 (src[4], src[5], src[9] & 0xf0),
+              gain);
+          write_s24_gain (dest + 9, read_s24 (src[6], src[7],
+                  (src[9] & 0x0f) << 4), gain);
+
+          src += 10;
+          dest += 12;
+        }
+      } else {
+        for (i = 0; i < count; i++) {
+          dest[0] = src[0];
+          dest[1] = src[1];
+          dest[2] = src[8] & 0xf0;
+          dest[3] = src[2];
+          dest[4] = src[3];
+          dest[5] = (src[8] & 0x0f) << 4;
+          dest[6] = src[4];
+          dest[7] = src[5];
+          dest[8] = src[9] & 0xf0;
+          dest[9] = src[6];
+          dest[10] = src[7];
+          dest[11] = (src[9] & 0x0f) << 4;
+
+          src += 10;
+          dest += 12;
+        }
       }
 
       gst_buffer_unref (buf);
@@ -673,21 +837,37 @@ gst_dvdlpcmdec_chain_raw (GstPad * pad, GstBuffer * buf)
       buf = gst_buffer_make_writable (buf);
 
       src = GST_BUFFER_DATA (buf);
-      for (i = 0; i < count; i++) {
-        guint8 tmp;
-
-        tmp = src[10];
-        src[10] = src[7];
-        src[7] = src[5];
-        src[5] = src[9];
-        src[9] = src[6];
-        src[6] = src[4];
-        src[4] = src[3];
-        src[3] = src[2];
-        src[2] = src[8];
-        src[8] = tmp;
-
-        src += 12;
+      if (gain != GAIN_UNITY) {
+        for (i = 0; i < count; i++) {
+          gint32 s0 = read_s24 (src[0], src[1], src[8]);
+          gint32 s1 = read_s24 (src[2], src[3], src[9]);
+          gint32 s2 = read_s24 (src[4], src[5], src[10]);
+          gint32 s3 = read_s24 (src[6], src[7], src[11]);
+
+          write_s24_gain (src, s0, gain);
+          write_s24_gain (src + 3, s1, gain);
+          write_s24_gain (src + 6, s2, gain);
+          write_s24_gain (src + 9, s3, gain);
+
+          src += 12;
+        }
+      } else {
+        for (i = 0; i < count; i++) {
+          guint8 tmp;
+
+          tmp = src[10];
+          src[10] = src[7];
+          src[7] = src[5];
+          src[5] = src[9];
+          src[9] = src[6];
+          src[6] = src[4];
+          src[4] = src[3];
+          src[3] = src[2];
+          src[2] = src[8];
+          src[8] = tmp;
+
+          src += 12;
+        }
       }
       break;
     }
@@ -779,6 +959,18 @@ dvdlpcmdec_sink_event (GstPad * pad, GstEvent * event)
       gst_segment_init (&dvdlpcmdec->segment, GST_FORMAT_UNDEFINED);
       res = gst_pad_push_event (dvdlpcmdec->srcpad, event);
       break;
+    case GST_EVENT_TAG:
+    {
+      GstTagList *list;
+
+      gst_event_parse_tag (event, &list);
+      GST_OBJECT_LOCK (dvdlpcmdec);
+      if (gst_decoder_gain_parse_tags (&dvdlpcmdec->output_gain, list))
+        gst_dvdlpcmdec_update_gain (dvdlpcmdec);
+      GST_OBJECT_UNLOCK (dvdlpcmdec);
+      res = gst_pad_push_event (dvdlpcmdec->srcpad, event);
+      break;
+    }
     default:
       res = gst_pad_push_event (dvdlpcmdec->srcpad, event);
       break;
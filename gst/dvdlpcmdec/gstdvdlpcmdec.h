@@ -22,6 +22,7 @@
 #define __GST_DVDLPCMDEC_H__
 
 #include <gst/gst.h>
+#include <gst/decodergain-private.h>
 
 G_BEGIN_DECLS
 
@@ -56,6 +57,11 @@ struct _GstDvdLpcmDec {
   
   GstClockTime timestamp;
   GstSegment   segment;
+
+  /* output gain, see the gain and replaygain properties */
+  GstDecoderGain output_gain;   /* with object lock */
+  gint32 gain_factor;           /* resulting factor in 16.16 fixed point,
+                                 * with object lock */
 };
 
 struct _GstDvdLpcmDecClass {
@@ -170,7 +170,10 @@ resync (ac3_padder * padder, int offset, int skipped)
 {
   padder->buffer_cur -= offset;
   padder->state = AC3P_STATE_SYNC1;
+  if (padder->skipped == 0 && padder->had_frame)
+    padder->resyncs++;
   padder->skipped += skipped;
+  padder->total_skipped += skipped;
 
   /* We don't want our buffer to grow unboundedly if we fail to find sync, but
    * nor do we want to do this every time we call resync() */
@@ -332,6 +335,7 @@ ac3p_parse (ac3_padder * padder)
           if (!ac3_crc_validate (&state)) {
             /* Rewind current stream pointer to immediately following the last 
              * attempted sync point, then continue parsing in initial state */
+            padder->crc_errors++;
             resync (padder, padder->ac3_frame_size - 2, 2);
             continue;
           }
@@ -346,6 +350,7 @@ ac3p_parse (ac3_padder * padder)
           if (!ac3_crc_validate (&state)) {
             /* Rewind current stream pointer to immediately following the last 
              * attempted sync point, then continue parsing in initial state */
+            padder->crc_errors++;
             resync (padder, padder->ac3_frame_size - 2, 2);
             continue;
           }
@@ -375,6 +380,8 @@ ac3p_parse (ac3_padder * padder)
 
           /* We're done, reset state and signal that we have a frame */
           padder->skipped = 0;
+          padder->frames++;
+          padder->had_frame = TRUE;
           padder->state = AC3P_STATE_SYNC1;
 
           memmove (padder->buffer, padder->buffer + padder->buffer_cur,
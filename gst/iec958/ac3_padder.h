@@ -101,6 +101,18 @@ typedef struct {
 
   gint rate;         /* Sample rate of ac3 data */
 
+  gboolean had_frame;
+                     /* A frame was found since the padder was created. */
+
+  /* Stream health counters since the owner last took and zeroed them,
+     not reset by ac3p_init(). */
+  guint frames;      /* Frames found. */
+  guint resyncs;     /* Times sync was lost after a frame. */
+  guint crc_errors;
+                     /* Frames rejected because of a bad CRC. */
+  guint total_skipped;
+                     /* Bytes skipped while trying to find sync. */
+
   ac3p_iec958_burst_frame frame;
                      /* The current output frame. */
 } ac3_padder;
@@ -48,6 +48,17 @@ enum
 {
   PROP_0,
   PROP_RAW_AUDIO,
+  PROP_STATS,
+  PROP_STATS_INTERVAL,
+};
+
+/* counters of the stats property */
+enum
+{
+  STAT_FRAMES,
+  STAT_RESYNCS,
+  STAT_CRC_ERRORS,
+  STAT_SKIPPED_BYTES
 };
 
 
@@ -161,6 +172,9 @@ ac3iec_class_init (AC3IECClass * klass)
       g_param_spec_boolean ("raw-audio", "raw-audio",
           "If true, source pad caps are set to raw audio.",
           FALSE, G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
+  gst_stream_stats_install_properties (gobject_class, PROP_STATS,
+      "Frames, lost syncs, CRC errors and skipped bytes since creation",
+      PROP_STATS_INTERVAL);
 
   gstelement_class->change_state = ac3iec_change_state;
 }
@@ -181,7 +195,9 @@ ac3iec_init (AC3IEC * ac3iec)
 
   ac3iec->cur_ts = GST_CLOCK_TIME_NONE;
 
-  ac3iec->padder = g_malloc (sizeof (ac3_padder));
+  ac3iec->padder = g_malloc0 (sizeof (ac3_padder));
+  gst_stream_stats_init (&ac3iec->stats, "ac3iec-stats", "frames", "resyncs",
+      "crc-errors", "skipped-bytes", NULL);
 }
 
 
@@ -191,6 +207,7 @@ ac3iec_finalize (GObject * object)
   AC3IEC *ac3iec = AC3IEC (object);
 
   g_free (ac3iec->padder);
+  gst_stream_stats_clear (&ac3iec->stats);
 
   G_OBJECT_CLASS (parent_class)->finalize (object);
 }
@@ -207,6 +224,9 @@ ac3iec_set_property (GObject * object, guint prop_id,
       ac3iec->raw_audio = g_value_get_boolean (value);
       break;
     }
+    case PROP_STATS_INTERVAL:
+      gst_stream_stats_set_interval (&ac3iec->stats, g_value_get_uint (value));
+      break;
     default:
       break;
   }
@@ -228,6 +248,24 @@ ac3iec_setcaps (GstPad * pad, GstCaps * caps)
   return TRUE;
 }
 
+/* moves the counters of the padder to the stats */
+static void
+ac3iec_take_padder_stats (AC3IEC * ac3iec)
+{
+  ac3_padder *padder = ac3iec->padder;
+
+  gst_stream_stats_add (&ac3iec->stats, STAT_FRAMES, padder->frames);
+  gst_stream_stats_add (&ac3iec->stats, STAT_RESYNCS, padder->resyncs);
+  gst_stream_stats_add (&ac3iec->stats, STAT_CRC_ERRORS, padder->crc_errors);
+  gst_stream_stats_add (&ac3iec->stats, STAT_SKIPPED_BYTES,
+      padder->total_skipped);
+
+  padder->frames = 0;
+  padder->resyncs = 0;
+  padder->crc_errors = 0;
+  padder->total_skipped = 0;
+}
+
 static void
 ac3iec_get_property (GObject * object, guint prop_id,
     GValue * value, GParamSpec * pspec)
@@ -238,6 +276,12 @@ ac3iec_get_property (GObject * object, guint prop_id,
     case PROP_RAW_AUDIO:
       g_value_set_boolean (value, ac3iec->raw_audio);
       break;
+    case PROP_STATS:
+      g_value_take_boxed (value, gst_stream_stats_get (&ac3iec->stats));
+      break;
+    case PROP_STATS_INTERVAL:
+      g_value_set_uint (value, gst_stream_stats_get_interval (&ac3iec->stats));
+      break;
     default:
       G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
       break;
@@ -304,11 +348,13 @@ ac3iec_chain_dvd (GstPad * pad, GstBuffer * buf)
     }
   } else {
     ret = ac3iec_chain_raw (pad, buf);
+    gst_stream_stats_post (&ac3iec->stats, GST_ELEMENT_CAST (ac3iec));
     gst_object_unref (ac3iec);
     return ret;
   }
 
 done:
+  gst_stream_stats_post (&ac3iec->stats, GST_ELEMENT_CAST (ac3iec));
   gst_object_unref (ac3iec);
   gst_buffer_unref (buf);
 
@@ -386,6 +432,7 @@ ac3iec_chain_raw (GstPad * pad, GstBuffer * buf)
     event = ac3p_parse (ac3iec->padder);
   }
 
+  ac3iec_take_padder_stats (ac3iec);
   gst_buffer_unref (buf);
 
 done:
@@ -23,6 +23,7 @@
 #define __AC3IEC_H__
 
 #include <gst/gst.h>
+#include <gst/streamstats-private.h>
 
 #include "ac3_padder.h"
 
@@ -71,6 +72,9 @@ struct _AC3IEC {
 
   gboolean raw_audio;		/* TRUE if output pad should use raw
 				   audio capabilities. */
+
+  GstStreamStats stats;         /* The padder's counters, see the
+                                   stats property. */
 };
 
 
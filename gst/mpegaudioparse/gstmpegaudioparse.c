@@ -29,6 +29,18 @@
  * gst-launch filesrc location=test.mp3 ! mp3parse ! mad ! autoaudiosink
  * ]|
  * </refsect2>
+ *
+ * The #GstMPEGAudioParse:stats property counts the frames, the number of
+ * times sync was lost and the bytes skipped to find it again. With
+ * #GstMPEGAudioParse:stats-interval set, the same structure is posted as
+ * element message named "mp3parse-stats" at that interval while data flows.
+ *
+ * Before pushing the first frame after startup or a new segment, mp3parse
+ * normally checks that several consecutive frame headers match, which delays
+ * live streams by a few frames. With #GstMPEGAudioParse:fast-start set, the
+ * first frame is pushed right away if upstream already negotiated MPEG audio
+ * caps or its CRC checks out; the strict check is only done if the next
+ * header does not match.
  */
 
 
@@ -68,6 +80,8 @@ GST_DEBUG_CATEGORY_STATIC (mp3parse_debug);
    for resyncing */
 #define MIN_RESYNC_FRAMES 3
 
+#define DEFAULT_FAST_START FALSE
+
 static inline MPEGAudioSeekEntry *
 mpeg_audio_seek_entry_new (void)
 {
@@ -107,10 +121,21 @@ enum
 {
   ARG_0,
   ARG_SKIP,
-  ARG_BIT_RATE
+  ARG_BIT_RATE,
+  ARG_STATS,
+  ARG_STATS_INTERVAL,
+  ARG_FAST_START
       /* FILL ME */
 };
 
+/* counters of the stats property */
+enum
+{
+  STAT_FRAMES,
+  STAT_RESYNCS,
+  STAT_SKIPPED_BYTES
+};
+
 
 static gboolean gst_mp3parse_sink_event (GstPad * pad, GstEvent * event);
 static GstFlowReturn gst_mp3parse_chain (GstPad * pad, GstBuffer * buffer);
@@ -327,6 +352,14 @@ gst_mp3parse_class_init (GstMPEGAudioParseClass * klass)
   g_object_class_install_property (G_OBJECT_CLASS (klass), ARG_BIT_RATE,
       g_param_spec_int ("bitrate", "Bitrate", "Bit Rate",
           G_MININT, G_MAXINT, 0, G_PARAM_READABLE | G_PARAM_STATIC_STRINGS));
+  gst_stream_stats_install_properties (gobject_class, ARG_STATS,
+      "Frames, lost syncs and bytes skipped to resync since creation",
+      ARG_STATS_INTERVAL);
+  g_object_class_install_property (G_OBJECT_CLASS (klass), ARG_FAST_START,
+      g_param_spec_boolean ("fast-start", "Fast start",
+          "Push the first frame without waiting for more frames to confirm "
+          "sync if the caps or the CRC vouch for it",
+          DEFAULT_FAST_START, G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
 
   gstelement_class->change_state = gst_mp3parse_change_state;
 
@@ -347,6 +380,8 @@ gst_mp3parse_reset (GstMPEGAudioParse * mp3parse)
 {
   mp3parse->skip = 0;
   mp3parse->resyncing = TRUE;
+  mp3parse->fast_start_pending = TRUE;
+  mp3parse->fast_start_header = 0;
   mp3parse->next_ts = GST_CLOCK_TIME_NONE;
   mp3parse->cur_offset = -1;
 
@@ -436,6 +471,9 @@ gst_mp3parse_init (GstMPEGAudioParse * mp3parse, GstMPEGAudioParseClass * klass)
 
   mp3parse->adapter = gst_adapter_new ();
   mp3parse->pending_seeks_lock = g_mutex_new ();
+  gst_stream_stats_init (&mp3parse->stats, "mp3parse-stats", "frames",
+      "resyncs", "skipped-bytes", NULL);
+  mp3parse->fast_start = DEFAULT_FAST_START;
 
   gst_mp3parse_reset (mp3parse);
 }
@@ -453,6 +491,7 @@ gst_mp3parse_dispose (GObject * object)
   }
   g_mutex_free (mp3parse->pending_seeks_lock);
   mp3parse->pending_seeks_lock = NULL;
+  gst_stream_stats_clear (&mp3parse->stats);
 
   g_list_foreach (mp3parse->pending_events, (GFunc) gst_mini_object_unref,
       NULL);
@@ -591,6 +630,8 @@ gst_mp3parse_sink_event (GstPad * pad, GstEvent * event)
       }
 
       mp3parse->resyncing = TRUE;
+      mp3parse->fast_start_pending = TRUE;
+      mp3parse->fast_start_header = 0;
       mp3parse->cur_offset = -1;
       mp3parse->next_ts = GST_CLOCK_TIME_NONE;
       mp3parse->pending_ts = GST_CLOCK_TIME_NONE;
@@ -1390,6 +1431,77 @@ gst_mp3parse_validate_extended (GstMPEGAudioParse * mp3parse, guint32 header,
   return TRUE;
 }
 
+static guint
+mp3_crc16_update (guint crc, const guint8 * data, guint len)
+{
+  guint i, j;
+
+  for (i = 0; i < len; i++) {
+    crc ^= data[i] << 8;
+    for (j = 0; j < 8; j++)
+      crc = (crc & 0x8000) ? (crc << 1) ^ 0x8005 : crc << 1;
+  }
+
+  return crc & 0xffff;
+}
+
+/* Check the CRC of a protected layer III frame, which covers the last two
+   header bytes and the side info following the checksum. Layers I and II
+   protect a range that depends on the bit allocation, so they and
+   unprotected frames never validate here. */
+static gboolean
+gst_mp3parse_check_crc (GstMPEGAudioParse * mp3parse, guint version,
+    guint layer, guint channels, guint crc)
+{
+  const guint8 *data;
+  guint side_info, sum;
+
+  if (crc != CRC_PROTECTED || layer != 3)
+    return FALSE;
+
+  if (version == 1)
+    side_info = (channels == 1) ? 17 : 32;
+  else
+    side_info = (channels == 1) ? 9 : 17;
+
+  if (gst_adapter_available (mp3parse->adapter) < 6 + side_info)
+    return FALSE;
+
+  data = gst_adapter_peek (mp3parse->adapter, 6 + side_info);
+  sum = mp3_crc16_update (0xffff, data + 2, 2);
+  sum = mp3_crc16_update (sum, data + 6, side_info);
+
+  return sum == GST_READ_UINT16_BE (data + 4);
+}
+
+/* Whether the first frame after a reset or new segment can be pushed without
+   extended validation */
+static gboolean
+gst_mp3parse_can_fast_start (GstMPEGAudioParse * mp3parse, guint version,
+    guint layer, guint channels, guint crc)
+{
+  GstCaps *caps;
+  gboolean fast_start;
+
+  if (!mp3parse->fast_start_pending)
+    return FALSE;
+
+  GST_OBJECT_LOCK (mp3parse);
+  fast_start = mp3parse->fast_start;
+  GST_OBJECT_UNLOCK (mp3parse);
+  if (!fast_start)
+    return FALSE;
+
+  /* negotiated caps mean a typefinder or demuxer already identified the
+   * stream as mpeg audio */
+  caps = GST_PAD_CAPS (mp3parse->sinkpad);
+  if (caps && gst_structure_has_name (gst_caps_get_structure (caps, 0),
+          "audio/mpeg"))
+    return TRUE;
+
+  return gst_mp3parse_check_crc (mp3parse, version, layer, channels, crc);
+}
+
 static GstFlowReturn
 gst_mp3parse_handle_data (GstMPEGAudioParse * mp3parse, gboolean at_eos)
 {
@@ -1399,7 +1511,8 @@ gst_mp3parse_handle_data (GstMPEGAudioParse * mp3parse, gboolean at_eos)
   int bpf;
   guint available;
   guint bitrate, layer, rate, channels, version, mode, crc;
-  gboolean caps_change;
+  gboolean caps_change, fast_start;
+  guint skipped = 0;
 
   /* while we still have at least 4 bytes (for the header) available */
   while (gst_adapter_available (mp3parse->adapter) >= 4) {
@@ -1410,14 +1523,34 @@ gst_mp3parse_handle_data (GstMPEGAudioParse * mp3parse, gboolean at_eos)
     if (!head_check (mp3parse, header)) {
       /* Not a valid MP3 header; we start looking forward byte-by-byte trying to
          find a place to resync */
-      if (!mp3parse->resyncing)
+      if (!mp3parse->resyncing) {
         mp3parse->sync_offset = mp3parse->tracked_offset;
+        gst_stream_stats_add (&mp3parse->stats, STAT_RESYNCS, 1);
+      }
       mp3parse->resyncing = TRUE;
       gst_mp3parse_flush_bytes (mp3parse, 1);
+      skipped++;
       GST_DEBUG_OBJECT (mp3parse, "wrong header, skipping byte");
       continue;
     }
 
+    /* The previous frame was pushed without extended validation; if this
+       header doesn't continue the stream, we got false sync after all and
+       fall back to the strict check */
+    if (G_UNLIKELY (mp3parse->fast_start_header)) {
+      if ((header & HDRMASK) != (mp3parse->fast_start_header & HDRMASK)) {
+        GST_DEBUG_OBJECT (mp3parse, "header %08X doesn't match fast start "
+            "header %08X, resyncing", (guint) header,
+            (guint) mp3parse->fast_start_header);
+        if (!mp3parse->resyncing) {
+          mp3parse->sync_offset = mp3parse->tracked_offset;
+          gst_stream_stats_add (&mp3parse->stats, STAT_RESYNCS, 1);
+        }
+        mp3parse->resyncing = TRUE;
+      }
+      mp3parse->fast_start_header = 0;
+    }
+
     /* We have a potentially valid header.
        If this is just a normal 'next frame', we go ahead and output it.
 
@@ -1451,7 +1584,12 @@ gst_mp3parse_handle_data (GstMPEGAudioParse * mp3parse, gboolean at_eos)
     else
       caps_change = FALSE;
 
-    if (mp3parse->resyncing || caps_change) {
+    fast_start = FALSE;
+    if (mp3parse->resyncing && gst_mp3parse_can_fast_start (mp3parse, version,
+            layer, channels, crc)) {
+      GST_DEBUG_OBJECT (mp3parse, "fast start, skipping extended validation");
+      fast_start = TRUE;
+    } else if (mp3parse->resyncing || caps_change) {
       gboolean valid;
       if (!gst_mp3parse_validate_extended (mp3parse, header, bpf, at_eos,
               &valid)) {
@@ -1462,10 +1600,13 @@ gst_mp3parse_handle_data (GstMPEGAudioParse * mp3parse, gboolean at_eos)
       if (!valid) {
         /* Extended validation failed; we probably got false sync.
            Continue searching from the next byte in the stream */
-        if (!mp3parse->resyncing)
+        if (!mp3parse->resyncing) {
           mp3parse->sync_offset = mp3parse->tracked_offset;
+          gst_stream_stats_add (&mp3parse->stats, STAT_RESYNCS, 1);
+        }
         mp3parse->resyncing = TRUE;
         gst_mp3parse_flush_bytes (mp3parse, 1);
+        skipped++;
         continue;
       }
     }
@@ -1526,8 +1667,13 @@ gst_mp3parse_handle_data (GstMPEGAudioParse * mp3parse, gboolean at_eos)
         (mp3parse->bitrate_sum / mp3parse->frame_count + 500);
     mp3parse->avg_bitrate -= mp3parse->avg_bitrate % 1000;
 
+    gst_stream_stats_add (&mp3parse->stats, STAT_FRAMES, 1);
+
     if (!mp3parse->skip) {
       mp3parse->resyncing = FALSE;
+      mp3parse->fast_start_pending = FALSE;
+      if (G_UNLIKELY (fast_start))
+        mp3parse->fast_start_header = header;
       flow = gst_mp3parse_emit_frame (mp3parse, bpf, mode, crc);
       if (flow != GST_FLOW_OK)
         break;
@@ -1538,11 +1684,14 @@ gst_mp3parse_handle_data (GstMPEGAudioParse * mp3parse, gboolean at_eos)
     }
   }
 
+  gst_stream_stats_add (&mp3parse->stats, STAT_SKIPPED_BYTES, skipped);
+
   return flow;
 
   /* ERRORS */
 sync_failure:
   {
+    gst_stream_stats_add (&mp3parse->stats, STAT_SKIPPED_BYTES, skipped);
     GST_ELEMENT_ERROR (mp3parse, STREAM, DECODE,
         ("Failed to parse stream"), (NULL));
     return GST_FLOW_ERROR;
@@ -1554,6 +1703,7 @@ gst_mp3parse_chain (GstPad * pad, GstBuffer * buf)
 {
   GstMPEGAudioParse *mp3parse;
   GstClockTime timestamp;
+  GstFlowReturn ret;
 
   mp3parse = GST_MP3PARSE (GST_PAD_PARENT (pad));
 
@@ -1591,7 +1741,11 @@ gst_mp3parse_chain (GstPad * pad, GstBuffer * buf)
   /* And add the data to the pool */
   gst_adapter_push (mp3parse->adapter, buf);
 
-  return gst_mp3parse_handle_data (mp3parse, FALSE);
+  ret = gst_mp3parse_handle_data (mp3parse, FALSE);
+
+  gst_stream_stats_post (&mp3parse->stats, GST_ELEMENT_CAST (mp3parse));
+
+  return ret;
 }
 
 static gboolean
@@ -1652,6 +1806,14 @@ gst_mp3parse_set_property (GObject * object, guint prop_id,
     case ARG_SKIP:
       src->skip = g_value_get_int (value);
       break;
+    case ARG_STATS_INTERVAL:
+      gst_stream_stats_set_interval (&src->stats, g_value_get_uint (value));
+      break;
+    case ARG_FAST_START:
+      GST_OBJECT_LOCK (src);
+      src->fast_start = g_value_get_boolean (value);
+      GST_OBJECT_UNLOCK (src);
+      break;
     default:
       break;
   }
@@ -1672,6 +1834,17 @@ gst_mp3parse_get_property (GObject * object, guint prop_id, GValue * value,
     case ARG_BIT_RATE:
       g_value_set_int (value, src->bit_rate * 1000);
       break;
+    case ARG_STATS:
+      g_value_take_boxed (value, gst_stream_stats_get (&src->stats));
+      break;
+    case ARG_STATS_INTERVAL:
+      g_value_set_uint (value, gst_stream_stats_get_interval (&src->stats));
+      break;
+    case ARG_FAST_START:
+      GST_OBJECT_LOCK (src);
+      g_value_set_boolean (value, src->fast_start);
+      GST_OBJECT_UNLOCK (src);
+      break;
     default:
       G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
       break;
@@ -24,6 +24,7 @@
 
 #include <gst/gst.h>
 #include <gst/base/gstadapter.h>
+#include <gst/streamstats-private.h>
 
 G_BEGIN_DECLS
 
@@ -86,6 +87,10 @@ struct _GstMPEGAudioParse {
 
   gboolean resyncing; /* True when attempting to resync (stricter checks are
                          performed) */
+  gboolean fast_start; /* property, with LOCK */
+  gboolean fast_start_pending; /* first sync since reset or newsegment */
+  guint32 fast_start_header; /* header of a frame pushed without extended
+                                validation, checked against the next one */
   gboolean sent_codec_tag;
 
   /* VBR tracking */
@@ -138,6 +143,9 @@ struct _GstMPEGAudioParse {
   GstEvent *pending_segment;
   /* pending events */
   GList *pending_events;
+
+  /* stream health, counted over the lifetime of the element */
+  GstStreamStats stats;
 };
 
 struct _GstMPEGAudioParseClass {
@@ -22,11 +22,18 @@
 #endif
 
 #include <gst/gst.h>
+#include "gstmpegaudioparse.h"
 #include "gstxingmux.h"
 
 static gboolean
 plugin_init (GstPlugin * plugin)
 {
+  /* rank none, so the baseparse based mpegaudioparse from gst-plugins-good
+   * stays the one that gets autoplugged */
+  if (!gst_element_register (plugin, "mp3parse", GST_RANK_NONE,
+          GST_TYPE_MP3PARSE))
+    return FALSE;
+
   if (!gst_element_register (plugin, "xingmux", GST_RANK_NONE,
           GST_TYPE_XING_MUX))
     return FALSE;
@@ -35,6 +35,8 @@ gst_mpeg_packetize_new (GstMPEGPacketizeType type)
 
   new = g_new0 (GstMPEGPacketize, 1);
   new->resync = TRUE;
+  /* data before the first start code is not a loss of sync */
+  new->lost_sync = TRUE;
   new->id = 0;
   new->cache_head = 0;
   new->cache_tail = 0;
@@ -61,7 +63,15 @@ gst_mpeg_packetize_flush_cache (GstMPEGPacketize * packetize)
 
   packetize->cache_byte_pos += packetize->cache_tail;
 
+  if (packetize->pack_buf) {
+    packetize->cache_byte_pos = packetize->pack_byte_pos +
+        GST_BUFFER_SIZE (packetize->pack_buf);
+    gst_buffer_unref (packetize->pack_buf);
+    packetize->pack_buf = NULL;
+  }
+
   packetize->resync = TRUE;
+  packetize->lost_sync = TRUE;
   packetize->cache_head = 0;
   packetize->cache_tail = 0;
 
@@ -73,6 +83,8 @@ gst_mpeg_packetize_destroy (GstMPEGPacketize * packetize)
 {
   g_return_if_fail (packetize != NULL);
 
+  if (packetize->pack_buf)
+    gst_buffer_unref (packetize->pack_buf);
   g_free (packetize->cache);
   g_free (packetize);
 }
@@ -80,22 +92,18 @@ gst_mpeg_packetize_destroy (GstMPEGPacketize * packetize)
 guint64
 gst_mpeg_packetize_tell (GstMPEGPacketize * packetize)
 {
+  if (packetize->pack_buf)
+    return packetize->pack_byte_pos + packetize->pack_pos;
+
   return packetize->cache_byte_pos + packetize->cache_head;
 }
 
-void
-gst_mpeg_packetize_put (GstMPEGPacketize * packetize, GstBuffer * buf)
+static void
+put_cache (GstMPEGPacketize * packetize, const guint8 * data, guint size)
 {
   int cache_len = packetize->cache_tail - packetize->cache_head;
 
-  if (packetize->cache_head == 0 && cache_len == 0 &&
-      GST_BUFFER_OFFSET_IS_VALID (buf)) {
-    packetize->cache_byte_pos = GST_BUFFER_OFFSET (buf);
-    GST_DEBUG ("cache byte position now %" G_GINT64_FORMAT,
-        packetize->cache_byte_pos);
-  }
-
-  if (cache_len + GST_BUFFER_SIZE (buf) > packetize->cache_size) {
+  if (cache_len + size > packetize->cache_size) {
     /* the buffer does not fit into the cache so grow the cache */
 
     guint8 *new_cache;
@@ -103,7 +111,7 @@ gst_mpeg_packetize_put (GstMPEGPacketize * packetize, GstBuffer * buf)
     /* get the new size of the cache */
     do {
       packetize->cache_size *= 2;
-    } while (cache_len + GST_BUFFER_SIZE (buf) > packetize->cache_size);
+    } while (cache_len + size > packetize->cache_size);
 
     /* allocate new cache - do not realloc to avoid copying data twice */
     new_cache = g_malloc (packetize->cache_size);
@@ -115,8 +123,7 @@ gst_mpeg_packetize_put (GstMPEGPacketize * packetize, GstBuffer * buf)
     packetize->cache_byte_pos += packetize->cache_head;
     packetize->cache_head = 0;
     packetize->cache_tail = cache_len;
-  } else if (packetize->cache_tail + GST_BUFFER_SIZE (buf) >
-      packetize->cache_size) {
+  } else if (packetize->cache_tail + size > packetize->cache_size) {
     /* the buffer does not fit into the end of the cache so move the cache data
        to the beginning of the cache */
 
@@ -128,9 +135,72 @@ gst_mpeg_packetize_put (GstMPEGPacketize * packetize, GstBuffer * buf)
   }
 
   /* copy the buffer to the cache */
-  memcpy (packetize->cache + packetize->cache_tail, GST_BUFFER_DATA (buf),
-      GST_BUFFER_SIZE (buf));
-  packetize->cache_tail += GST_BUFFER_SIZE (buf);
+  memcpy (packetize->cache + packetize->cache_tail, data, size);
+  packetize->cache_tail += size;
+}
+
+/* move what is left of the pack-aligned buffer into the cache and continue
+ * in normal mode */
+static void
+pack_to_cache (GstMPEGPacketize * packetize)
+{
+  GstBuffer *buf = packetize->pack_buf;
+
+  packetize->pack_buf = NULL;
+
+  if (packetize->cache_head == packetize->cache_tail) {
+    packetize->cache_head = 0;
+    packetize->cache_tail = 0;
+    packetize->cache_byte_pos = packetize->pack_byte_pos + packetize->pack_pos;
+  }
+  put_cache (packetize, GST_BUFFER_DATA (buf) + packetize->pack_pos,
+      GST_BUFFER_SIZE (buf) - packetize->pack_pos);
+
+  gst_buffer_unref (buf);
+}
+
+static gboolean
+is_pack_aligned (GstMPEGPacketize * packetize, GstBuffer * buf)
+{
+  const guint8 *data = GST_BUFFER_DATA (buf);
+  guint size = GST_BUFFER_SIZE (buf);
+
+  return packetize->type == GST_MPEG_PACKETIZE_SYSTEM &&
+      size > 0 && (size % MPEG_PACK_SIZE) == 0 &&
+      GST_READ_UINT32_BE (data) == (0x100 | PACK_START_CODE) &&
+      (data[4] & 0xc0) == 0x40;
+}
+
+void
+gst_mpeg_packetize_put (GstMPEGPacketize * packetize, GstBuffer * buf)
+{
+  int cache_len;
+
+  /* the previous buffer was not completely read */
+  if (packetize->pack_buf)
+    pack_to_cache (packetize);
+
+  cache_len = packetize->cache_tail - packetize->cache_head;
+
+  if (cache_len == 0 && is_pack_aligned (packetize, buf)) {
+    GST_LOG ("pack-aligned buffer of %u bytes", GST_BUFFER_SIZE (buf));
+    packetize->pack_buf = buf;
+    packetize->pack_pos = 0;
+    packetize->pack_byte_pos = GST_BUFFER_OFFSET_IS_VALID (buf) ?
+        GST_BUFFER_OFFSET (buf) : gst_mpeg_packetize_tell (packetize);
+    packetize->cache_head = 0;
+    packetize->cache_tail = 0;
+    return;
+  }
+
+  if (packetize->cache_head == 0 && cache_len == 0 &&
+      GST_BUFFER_OFFSET_IS_VALID (buf)) {
+    packetize->cache_byte_pos = GST_BUFFER_OFFSET (buf);
+    GST_DEBUG ("cache byte position now %" G_GINT64_FORMAT,
+        packetize->cache_byte_pos);
+  }
+
+  put_cache (packetize, GST_BUFFER_DATA (buf), GST_BUFFER_SIZE (buf));
 
   gst_buffer_unref (buf);
 }
@@ -270,6 +340,19 @@ parse_chunk (GstMPEGPacketize * packetize, GstBuffer ** outbuf)
 }
 
 
+/* skip data that is not part of a packet */
+static void
+skip_garbage (GstMPEGPacketize * packetize, guint length)
+{
+  if (!packetize->lost_sync) {
+    packetize->lost_sync = TRUE;
+    packetize->resyncs++;
+  }
+  packetize->skipped_bytes += length;
+
+  skip_cache (packetize, length);
+}
+
 /* FIXME mmx-ify me */
 static gboolean
 find_start_code (GstMPEGPacketize * packetize)
@@ -295,7 +378,7 @@ find_start_code (GstMPEGPacketize * packetize)
     GST_DEBUG ("  code = %08x %p %08x", code, buf, chunksize);
 
     if (offset == chunksize) {
-      skip_cache (packetize, offset);
+      skip_garbage (packetize, offset);
 
       chunksize = peek_cache (packetize, 4096, &buf);
       if (chunksize == 0)
@@ -306,8 +389,73 @@ find_start_code (GstMPEGPacketize * packetize)
   }
   packetize->id = code & 0xff;
   if (offset > 4) {
-    skip_cache (packetize, offset - 4);
+    skip_garbage (packetize, offset - 4);
+  }
+  packetize->lost_sync = FALSE;
+  return TRUE;
+}
+
+/* walk the packets of a pack-aligned buffer in place. Returns FALSE when
+ * the buffer does not look like we expect, after which the remaining data
+ * is parsed the normal way. */
+static gboolean
+read_pack (GstMPEGPacketize * packetize, GstBuffer ** outbuf)
+{
+  const guint8 *data;
+  guint avail, length, pack_left;
+  guint8 id;
+
+  data = GST_BUFFER_DATA (packetize->pack_buf) + packetize->pack_pos;
+  avail = GST_BUFFER_SIZE (packetize->pack_buf) - packetize->pack_pos;
+  pack_left = MPEG_PACK_SIZE - (packetize->pack_pos % MPEG_PACK_SIZE);
+
+  /* skip the stuffing after the pack header */
+  if (packetize->id == PACK_START_CODE) {
+    while (avail > 0 && pack_left > 0 && *data == 0xff) {
+      data++;
+      avail--;
+      pack_left--;
+      packetize->pack_pos++;
+    }
+  }
+
+  if (avail < 6 || (GST_READ_UINT32_BE (data) & 0xffffff00) != 0x100)
+    return FALSE;
+
+  id = data[3];
+  switch (id) {
+    case PACK_START_CODE:
+      /* MPEG-2 pack header, without the stuffing */
+      if (pack_left != MPEG_PACK_SIZE || (data[4] & 0xc0) != 0x40)
+        return FALSE;
+      length = 14;
+      packetize->MPEG2 = TRUE;
+      packetize->resync = FALSE;
+      break;
+    case ISO11172_END_START_CODE:
+      length = 4;
+      break;
+    default:
+      if (id != SYS_HEADER_START_CODE && (id < 0xBD || id > 0xFE))
+        return FALSE;
+      length = 6 + GST_READ_UINT16_BE (data + 4);
+      break;
   }
+
+  /* packets never span packs */
+  if (length > pack_left)
+    return FALSE;
+
+  packetize->id = id;
+
+  *outbuf = gst_buffer_create_sub (packetize->pack_buf, packetize->pack_pos,
+      length);
+  GST_BUFFER_TIMESTAMP (*outbuf) = GST_CLOCK_TIME_NONE;
+  GST_BUFFER_DURATION (*outbuf) = GST_CLOCK_TIME_NONE;
+  GST_BUFFER_OFFSET (*outbuf) = GST_BUFFER_OFFSET_NONE;
+  GST_BUFFER_OFFSET_END (*outbuf) = GST_BUFFER_OFFSET_NONE;
+  packetize->pack_pos += length;
+
   return TRUE;
 }
 
@@ -318,6 +466,24 @@ gst_mpeg_packetize_read (GstMPEGPacketize * packetize, GstBuffer ** outbuf)
 
   *outbuf = NULL;
 
+  if (packetize->pack_buf) {
+    if (packetize->pack_pos < GST_BUFFER_SIZE (packetize->pack_buf)) {
+      if (read_pack (packetize, outbuf))
+        return GST_FLOW_OK;
+
+      GST_DEBUG ("packet at %" G_GUINT64_FORMAT " is not pack-aligned",
+          packetize->pack_byte_pos + packetize->pack_pos);
+      pack_to_cache (packetize);
+    } else {
+      /* completely consumed */
+      packetize->cache_byte_pos = packetize->pack_byte_pos +
+          GST_BUFFER_SIZE (packetize->pack_buf);
+      gst_buffer_unref (packetize->pack_buf);
+      packetize->pack_buf = NULL;
+      return GST_FLOW_RESEND;
+    }
+  }
+
   while (*outbuf == NULL) {
     if (!find_start_code (packetize))
       return GST_FLOW_RESEND;
@@ -40,6 +40,9 @@ G_BEGIN_DECLS
 #define PACK_START_CODE                 0xba
 #define SYS_HEADER_START_CODE           0xbb
 
+/* DVD and other MPEG-2 program streams are often made of fixed-size packs */
+#define MPEG_PACK_SIZE                  2048
+
 typedef struct _GstMPEGPacketize GstMPEGPacketize;
 
 #define GST_MPEG_PACKETIZE_ID(pack)             ((pack)->id)
@@ -64,6 +67,19 @@ struct _GstMPEGPacketize {
 
   gboolean MPEG2;
   gboolean resync;
+
+  /* pack-aligned input. When a buffer consists of complete 2048 byte
+   * MPEG-2 packs and the cache is empty, the packets are returned as
+   * sub-buffers of it instead of going through the cache */
+  GstBuffer *pack_buf;
+  guint pack_pos;           /* position of the next packet in pack_buf */
+  guint64 pack_byte_pos;    /* byte position of pack_buf in the MPEG stream */
+
+  /* data skipped while looking for a start code, the counters are zeroed
+   * by the owner when it takes them */
+  gboolean lost_sync;
+  guint64 resyncs;
+  guint64 skipped_bytes;
 };
 
 GstMPEGPacketize* gst_mpeg_packetize_new     (GstMPEGPacketizeType type);
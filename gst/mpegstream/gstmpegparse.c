@@ -57,10 +57,20 @@ enum
   ARG_0,
   ARG_MAX_SCR_GAP,
   ARG_BYTE_OFFSET,
-  ARG_TIME_OFFSET
+  ARG_TIME_OFFSET,
+  ARG_STATS,
+  ARG_STATS_INTERVAL
       /* FILL ME */
 };
 
+/* counters of the stats property */
+enum
+{
+  STAT_PACKETS,
+  STAT_RESYNCS,
+  STAT_SKIPPED_BYTES
+};
+
 static GstStaticPadTemplate sink_factory = GST_STATIC_PAD_TEMPLATE ("sink",
     GST_PAD_SINK,
     GST_PAD_ALWAYS,
@@ -105,6 +115,7 @@ static void gst_mpeg_parse_pad_added (GstElement * element, GstPad * pad);
 static gboolean gst_mpeg_parse_event (GstPad * pad, GstEvent * event);
 static GstFlowReturn gst_mpeg_parse_chain (GstPad * pad, GstBuffer * buf);
 
+static void gst_mpeg_parse_finalize (GObject * object);
 static void gst_mpeg_parse_get_property (GObject * object, guint prop_id,
     GValue * value, GParamSpec * pspec);
 static void gst_mpeg_parse_set_property (GObject * object, guint prop_id,
@@ -143,6 +154,7 @@ gst_mpeg_parse_class_init (GstMPEGParseClass * klass)
 
   gobject_class->get_property = gst_mpeg_parse_get_property;
   gobject_class->set_property = gst_mpeg_parse_set_property;
+  gobject_class->finalize = gst_mpeg_parse_finalize;
 
   gstelement_class->pad_added = gst_mpeg_parse_pad_added;
   gstelement_class->change_state = gst_mpeg_parse_change_state;
@@ -181,6 +193,9 @@ gst_mpeg_parse_class_init (GstMPEGParseClass * klass)
           "Time offset in the stream.",
           0, G_MAXUINT64, G_MAXUINT64,
           G_PARAM_READABLE | G_PARAM_STATIC_STRINGS));
+  gst_stream_stats_install_properties (gobject_class, ARG_STATS,
+      "Packets, lost syncs and bytes skipped to find a start code "
+      "since creation", ARG_STATS_INTERVAL);
 }
 
 static void
@@ -197,6 +212,9 @@ gst_mpeg_parse_init (GstMPEGParse * mpeg_parse, GstMPEGParseClass * klass)
 
   mpeg_parse->byte_offset = G_MAXUINT64;
 
+  gst_stream_stats_init (&mpeg_parse->stats, "mpegparse-stats", "packets",
+      "resyncs", "skipped-bytes", NULL);
+
   gst_mpeg_parse_reset (mpeg_parse);
 
   templ = gst_element_class_get_pad_template (gstelement_class, "sink");
@@ -221,6 +239,16 @@ gst_mpeg_parse_init (GstMPEGParse * mpeg_parse, GstMPEGParseClass * klass)
       GST_DEBUG_FUNCPTR (gst_mpeg_parse_chain));
 }
 
+static void
+gst_mpeg_parse_finalize (GObject * object)
+{
+  GstMPEGParse *mpeg_parse = GST_MPEG_PARSE (object);
+
+  gst_stream_stats_clear (&mpeg_parse->stats);
+
+  G_OBJECT_CLASS (parent_class)->finalize (object);
+}
+
 #ifdef FIXME
 static void
 gst_mpeg_parse_update_streaminfo (GstMPEGParse * mpeg_parse)
@@ -700,6 +728,19 @@ gst_mpeg_parse_event (GstPad * pad, GstEvent * event)
   return ret;
 }
 
+/* moves the counters of the packetizer to the stats */
+static void
+gst_mpeg_parse_take_packetize_stats (GstMPEGParse * mpeg_parse)
+{
+  GstMPEGPacketize *packetize = mpeg_parse->packetize;
+
+  gst_stream_stats_add (&mpeg_parse->stats, STAT_RESYNCS, packetize->resyncs);
+  gst_stream_stats_add (&mpeg_parse->stats, STAT_SKIPPED_BYTES,
+      packetize->skipped_bytes);
+  packetize->resyncs = 0;
+  packetize->skipped_bytes = 0;
+}
+
 static GstFlowReturn
 gst_mpeg_parse_chain (GstPad * pad, GstBuffer * buffer)
 {
@@ -709,6 +750,7 @@ gst_mpeg_parse_chain (GstPad * pad, GstBuffer * buffer)
   gboolean mpeg2;
   GstClockTime time;
   guint64 size;
+  guint packets = 0;
 
   if (GST_BUFFER_FLAG_IS_SET (buffer, GST_BUFFER_FLAG_DISCONT)) {
     GST_DEBUG_OBJECT (mpeg_parse, "buffer with DISCONT flag set");
@@ -730,6 +772,7 @@ gst_mpeg_parse_chain (GstPad * pad, GstBuffer * buffer)
 
     id = GST_MPEG_PACKETIZE_ID (mpeg_parse->packetize);
     mpeg2 = GST_MPEG_PACKETIZE_IS_MPEG2 (mpeg_parse->packetize);
+    packets++;
 
     GST_LOG_OBJECT (mpeg_parse, "have chunk 0x%02X", id);
 
@@ -845,6 +888,10 @@ gst_mpeg_parse_chain (GstPad * pad, GstBuffer * buffer)
     GST_DEBUG_OBJECT (mpeg_parse, "flow: %s", gst_flow_get_name (result));
   }
 
+  gst_stream_stats_add (&mpeg_parse->stats, STAT_PACKETS, packets);
+  gst_mpeg_parse_take_packetize_stats (mpeg_parse);
+  gst_stream_stats_post (&mpeg_parse->stats, GST_ELEMENT_CAST (mpeg_parse));
+
   return result;
 }
 
@@ -1269,6 +1316,7 @@ gst_mpeg_parse_change_state (GstElement * element, GstStateChange transition)
   switch (transition) {
     case GST_STATE_CHANGE_PAUSED_TO_READY:
       if (mpeg_parse->packetize) {
+        gst_mpeg_parse_take_packetize_stats (mpeg_parse);
         gst_mpeg_packetize_destroy (mpeg_parse->packetize);
         mpeg_parse->packetize = NULL;
       }
@@ -1299,6 +1347,13 @@ gst_mpeg_parse_get_property (GObject * object, guint prop_id, GValue * value,
     case ARG_TIME_OFFSET:
       g_value_set_uint64 (value, mpeg_parse->current_ts);
       break;
+    case ARG_STATS:
+      g_value_take_boxed (value, gst_stream_stats_get (&mpeg_parse->stats));
+      break;
+    case ARG_STATS_INTERVAL:
+      g_value_set_uint (value,
+          gst_stream_stats_get_interval (&mpeg_parse->stats));
+      break;
     default:
       G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
       break;
@@ -1320,6 +1375,10 @@ gst_mpeg_parse_set_property (GObject * object, guint prop_id,
     case ARG_BYTE_OFFSET:
       mpeg_parse->byte_offset = g_value_get_uint64 (value);
       break;
+    case ARG_STATS_INTERVAL:
+      gst_stream_stats_set_interval (&mpeg_parse->stats,
+          g_value_get_uint (value));
+      break;
     default:
       G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
       break;
@@ -22,6 +22,7 @@
 #define __MPEG_PARSE_H__
 
 #include <gst/gst.h>
+#include <gst/streamstats-private.h>
 #include "gstmpegpacketize.h"
 
 G_BEGIN_DECLS
@@ -95,6 +96,10 @@ struct _GstMPEGParse
   gint index_id;
 
   guint64 byte_offset;
+
+  /* stream health, see the stats property. The packetizer counts its
+   * resyncs itself, they are moved here after each buffer */
+  GstStreamStats stats;
 };
 
 struct _GstMPEGParseClass
@@ -181,6 +181,7 @@ gst_real_audio_demux_init (GstRealAudioDemux * demux,
   gst_element_add_pad (GST_ELEMENT (demux), demux->sinkpad);
 
   demux->adapter = gst_adapter_new ();
+  gst_read_ahead_init (&demux->readahead);
   gst_real_audio_demux_reset (demux);
 }
 
@@ -216,11 +217,19 @@ gst_real_audio_demux_sink_activate_pull (GstPad * sinkpad, gboolean active)
   if (active) {
     demux->seekable = TRUE;
 
+    gst_read_ahead_start (&demux->readahead, sinkpad,
+        GST_READ_AHEAD_DEFAULT_WINDOW);
+
     return gst_pad_start_task (sinkpad,
         (GstTaskFunction) gst_real_audio_demux_loop, demux);
   } else {
+    gboolean res;
+
     demux->seekable = FALSE;
-    return gst_pad_stop_task (sinkpad);
+    res = gst_pad_stop_task (sinkpad);
+    gst_read_ahead_stop (&demux->readahead);
+
+    return res;
   }
 }
 
@@ -624,6 +633,7 @@ gst_real_audio_demux_loop (GstRealAudioDemux * demux)
   if (demux->upstream_size > 0 && demux->offset >= demux->upstream_size)
     goto eos;
 
+  gst_read_ahead_hint (&demux->readahead, demux->offset, bytes_needed);
   ret = gst_pad_pull_range (demux->sinkpad, demux->offset, bytes_needed, &buf);
 
   if (ret != GST_FLOW_OK)
@@ -22,6 +22,7 @@
 
 #include <gst/gst.h>
 #include <gst/base/gstadapter.h>
+#include <gst/readahead-private.h>
 
 G_BEGIN_DECLS
 
@@ -86,6 +87,7 @@ struct _GstRealAudioDemux {
   GstSegment               segment;
 
   gboolean                 seekable;
+  GstReadAhead             readahead;
 };
 
 struct _GstRealAudioDemuxClass {
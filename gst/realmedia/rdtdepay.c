@@ -305,11 +305,28 @@ gst_rdt_depay_push (GstRDTDepay * rdtdepay, GstBuffer * buffer)
 }
 
 static GstFlowReturn
+gst_rdt_depay_push_list (GstRDTDepay * rdtdepay, GstBufferList * list)
+{
+  if (rdtdepay->need_newsegment) {
+    GstEvent *event;
+
+    event = create_segment_event (rdtdepay, FALSE, 0);
+    gst_pad_push_event (rdtdepay->srcpad, event);
+
+    rdtdepay->need_newsegment = FALSE;
+  }
+
+  return gst_pad_push_list (rdtdepay->srcpad, list);
+}
+
+/* Adds a group with a RealMedia data packet header and the payload of @packet
+ * to @it. The payload is a sub-buffer of the RDT buffer, so it is never
+ * copied when downstream handles buffer lists, like rmdemux does. */
+static void
 gst_rdt_depay_handle_data (GstRDTDepay * rdtdepay, GstClockTime outtime,
-    GstRDTPacket * packet)
+    GstRDTPacket * packet, GstBufferListIterator * it)
 {
-  GstFlowReturn ret;
-  GstBuffer *outbuf;
+  GstBuffer *outbuf, *payload;
   guint8 *data, *outdata;
   guint size;
   guint16 stream_id;
@@ -322,10 +339,6 @@ gst_rdt_depay_handle_data (GstRDTDepay * rdtdepay, GstClockTime outtime,
   /* get pointers to the packet data */
   gst_rdt_packet_data_peek_data (packet, &data, &size);
 
-  outbuf = gst_buffer_new_and_alloc (12 + size);
-  outdata = GST_BUFFER_DATA (outbuf);
-  GST_BUFFER_TIMESTAMP (outbuf) = outtime;
-
   GST_DEBUG_OBJECT (rdtdepay, "have size %u", size);
 
   /* copy over some things */
@@ -373,25 +386,39 @@ gst_rdt_depay_handle_data (GstRDTDepay * rdtdepay, GstClockTime outtime,
   else
     outflags = 0;
 
+  outbuf = gst_buffer_new_and_alloc (12);
+  outdata = GST_BUFFER_DATA (outbuf);
+  GST_BUFFER_TIMESTAMP (outbuf) = outtime;
+  gst_buffer_set_caps (outbuf, GST_PAD_CAPS (rdtdepay->srcpad));
+
+  if (rdtdepay->discont) {
+    GST_BUFFER_FLAG_SET (outbuf, GST_BUFFER_FLAG_DISCONT);
+    rdtdepay->discont = FALSE;
+  }
+
   GST_WRITE_UINT16_BE (outdata + 0, 0); /* version   */
   GST_WRITE_UINT16_BE (outdata + 2, size + 12); /* length    */
   GST_WRITE_UINT16_BE (outdata + 4, stream_id); /* stream    */
   GST_WRITE_UINT32_BE (outdata + 6, timestamp); /* timestamp */
   GST_WRITE_UINT16_BE (outdata + 10, outflags); /* flags     */
-  memcpy (outdata + 12, data, size);
 
-  GST_DEBUG_OBJECT (rdtdepay, "Pushing packet, outtime %" GST_TIME_FORMAT,
+  payload = gst_buffer_create_sub (packet->buffer,
+      data - GST_BUFFER_DATA (packet->buffer), size);
+
+  GST_DEBUG_OBJECT (rdtdepay, "Queueing packet, outtime %" GST_TIME_FORMAT,
       GST_TIME_ARGS (outtime));
 
-  ret = gst_rdt_depay_push (rdtdepay, outbuf);
+  gst_buffer_list_iterator_add_group (it);
+  gst_buffer_list_iterator_add (it, outbuf);
+  gst_buffer_list_iterator_add (it, payload);
 
-  return ret;
+  return;
 
   /* ERRORS */
 dropping:
   {
     GST_WARNING_OBJECT (rdtdepay, "%d <= 100, dropping old packet", gap);
-    return GST_FLOW_OK;
+    return;
   }
 }
 
@@ -403,6 +430,8 @@ gst_rdt_depay_chain (GstPad * pad, GstBuffer * buf)
   GstClockTime timestamp;
   gboolean more;
   GstRDTPacket packet;
+  GstBufferList *list;
+  GstBufferListIterator *it;
 
   rdtdepay = GST_RDT_DEPAY (GST_PAD_PARENT (pad));
 
@@ -429,7 +458,10 @@ gst_rdt_depay_chain (GstPad * pad, GstBuffer * buf)
   GST_LOG_OBJECT (rdtdepay, "received buffer timestamp %" GST_TIME_FORMAT,
       GST_TIME_ARGS (timestamp));
 
-  /* data is in RDT format. */
+  /* data is in RDT format, collect all data packets in one list */
+  list = gst_buffer_list_new ();
+  it = gst_buffer_list_iterate (list);
+
   more = gst_rdt_buffer_get_first_packet (buf, &packet);
   while (more) {
     GstRDTType type;
@@ -439,7 +471,7 @@ gst_rdt_depay_chain (GstPad * pad, GstBuffer * buf)
 
     if (GST_RDT_IS_DATA_TYPE (type)) {
       GST_DEBUG_OBJECT (rdtdepay, "We have a data packet");
-      ret = gst_rdt_depay_handle_data (rdtdepay, timestamp, &packet);
+      gst_rdt_depay_handle_data (rdtdepay, timestamp, &packet, it);
     } else {
       switch (type) {
         default:
@@ -447,11 +479,18 @@ gst_rdt_depay_chain (GstPad * pad, GstBuffer * buf)
           break;
       }
     }
-    if (ret != GST_FLOW_OK)
-      break;
 
     more = gst_rdt_packet_move_to_next (&packet);
   }
+  gst_buffer_list_iterator_free (it);
+
+  if (gst_buffer_list_n_groups (list) > 0) {
+    GST_DEBUG_OBJECT (rdtdepay, "Pushing %u packets",
+        gst_buffer_list_n_groups (list));
+    ret = gst_rdt_depay_push_list (rdtdepay, list);
+  } else {
+    gst_buffer_list_unref (list);
+  }
 
   gst_buffer_unref (buf);
 
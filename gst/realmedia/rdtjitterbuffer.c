@@ -28,6 +28,10 @@ GST_DEBUG_CATEGORY_STATIC (rdt_jitter_buffer_debug);
 #define MAX_WINDOW	RDT_JITTER_BUFFER_MAX_WINDOW
 #define MAX_TIME	(2 * GST_SECOND)
 
+/* the reorder delay is a peak value that slowly decays, it loses 1/REORDER_DECAY
+ * of its value for every inserted packet */
+#define REORDER_DECAY	256
+
 /* signals and args */
 enum
 {
@@ -108,6 +112,9 @@ rdt_jitter_buffer_reset_skew (RDTJitterBuffer * jbuf)
   jbuf->window_min = 0;
   jbuf->skew = 0;
   jbuf->prev_send_diff = -1;
+  /* both are measured against the old skew and timestamps */
+  jbuf->jitter = 0;
+  jbuf->reorder_delay = 0;
 }
 
 /* For the clock skew we use a windowed low point averaging algorithm as can be
@@ -243,6 +250,17 @@ again:
   /* measure the diff */
   delta = ((gint64) recv_diff) - ((gint64) send_diff);
 
+  /* the interarrival jitter is the smoothed deviation of the delta from the
+   * estimated skew, like the RTP jitter in RFC 3550 */
+  {
+    guint64 dev = ABS (delta - jbuf->skew);
+
+    if (dev > jbuf->jitter)
+      jbuf->jitter += (dev - jbuf->jitter) / 16;
+    else
+      jbuf->jitter -= (jbuf->jitter - dev) / 16;
+  }
+
   pos = jbuf->window_pos;
 
   if (jbuf->window_filling) {
@@ -351,6 +369,7 @@ rdt_jitter_buffer_insert (RDTJitterBuffer * jbuf, GstBuffer * buf,
   guint16 seqnum;
   GstRDTPacket packet;
   gboolean more;
+  GstBuffer *head;
 
   g_return_val_if_fail (jbuf != NULL, FALSE);
   g_return_val_if_fail (buf != NULL, FALSE);
@@ -395,6 +414,21 @@ rdt_jitter_buffer_insert (RDTJitterBuffer * jbuf, GstBuffer * buf,
     GST_BUFFER_TIMESTAMP (buf) = time;
   }
 
+  /* measure how far behind the newest packet in the queue this one arrived,
+   * that is how long we have to wait to get reordered packets in order */
+  jbuf->reorder_delay -= jbuf->reorder_delay / REORDER_DECAY;
+  head = g_queue_peek_head (jbuf->packets);
+  if (list != jbuf->packets->head && head != NULL && clock_rate) {
+    GstClockTime head_time = GST_BUFFER_TIMESTAMP (head);
+
+    if (GST_CLOCK_TIME_IS_VALID (head_time) && GST_CLOCK_TIME_IS_VALID (time)
+        && head_time > time && head_time - time > jbuf->reorder_delay) {
+      jbuf->reorder_delay = head_time - time;
+      GST_DEBUG ("new reorder delay %" GST_TIME_FORMAT,
+          GST_TIME_ARGS (jbuf->reorder_delay));
+    }
+  }
+
   if (list)
     g_queue_insert_before (jbuf->packets, list, buf);
   else
@@ -463,7 +497,8 @@ rdt_jitter_buffer_peek (RDTJitterBuffer * jbuf)
  * rdt_jitter_buffer_flush:
  * @jbuf: an #RDTJitterBuffer
  *
- * Flush all packets from the jitterbuffer.
+ * Flush all packets from the jitterbuffer and forget the measured jitter and
+ * reorder delay.
  */
 void
 rdt_jitter_buffer_flush (RDTJitterBuffer * jbuf)
@@ -474,6 +509,9 @@ rdt_jitter_buffer_flush (RDTJitterBuffer * jbuf)
 
   while ((buffer = g_queue_pop_head (jbuf->packets)))
     gst_buffer_unref (buffer);
+
+  jbuf->jitter = 0;
+  jbuf->reorder_delay = 0;
 }
 
 /**
@@ -529,3 +567,36 @@ rdt_jitter_buffer_get_ts_diff (RDTJitterBuffer * jbuf)
   }
   return result;
 }
+
+/**
+ * rdt_jitter_buffer_get_jitter:
+ * @jbuf: an #RDTJitterBuffer
+ *
+ * Get the smoothed interarrival jitter of the packets inserted in @jbuf.
+ *
+ * Returns: The jitter in nanoseconds.
+ */
+GstClockTime
+rdt_jitter_buffer_get_jitter (RDTJitterBuffer * jbuf)
+{
+  g_return_val_if_fail (jbuf != NULL, 0);
+
+  return jbuf->jitter;
+}
+
+/**
+ * rdt_jitter_buffer_get_reorder_delay:
+ * @jbuf: an #RDTJitterBuffer
+ *
+ * Get the recent peak of the time that out-of-order packets arrived after
+ * newer packets.
+ *
+ * Returns: The reorder delay in nanoseconds.
+ */
+GstClockTime
+rdt_jitter_buffer_get_reorder_delay (RDTJitterBuffer * jbuf)
+{
+  g_return_val_if_fail (jbuf != NULL, 0);
+
+  return jbuf->reorder_delay;
+}
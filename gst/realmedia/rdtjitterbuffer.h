@@ -63,6 +63,10 @@ struct _RDTJitterBuffer {
   gint64         window_min;
   gint64         skew;
   gint64         prev_send_diff;
+
+  /* for adaptive latency */
+  GstClockTime   jitter;
+  GstClockTime   reorder_delay;
 };
 
 struct _RDTJitterBufferClass {
@@ -88,4 +92,7 @@ void                  rdt_jitter_buffer_flush            (RDTJitterBuffer *jbuf)
 guint                 rdt_jitter_buffer_num_packets      (RDTJitterBuffer *jbuf);
 guint32               rdt_jitter_buffer_get_ts_diff      (RDTJitterBuffer *jbuf);
 
+GstClockTime          rdt_jitter_buffer_get_jitter       (RDTJitterBuffer *jbuf);
+GstClockTime          rdt_jitter_buffer_get_reorder_delay (RDTJitterBuffer *jbuf);
+
 #endif /* __RDT_JITTER_BUFFER_H__ */
@@ -81,11 +81,22 @@ enum
 };
 
 #define DEFAULT_LATENCY_MS      200
+#define DEFAULT_ADAPTIVE_LATENCY FALSE
+#define DEFAULT_MIN_LATENCY_MS  20
+#define DEFAULT_MAX_LATENCY_MS  2000
+
+/* don't bother the pipeline with latency changes smaller than this */
+#define LATENCY_THRESHOLD_MS    10
+/* how often we consider lowering the latency */
+#define LATENCY_SHRINK_INTERVAL (2 * GST_SECOND)
 
 enum
 {
   PROP_0,
-  PROP_LATENCY
+  PROP_LATENCY,
+  PROP_ADAPTIVE_LATENCY,
+  PROP_MIN_LATENCY,
+  PROP_MAX_LATENCY
 };
 
 static GstStaticPadTemplate gst_rdt_manager_recv_rtp_sink_template =
@@ -214,6 +225,10 @@ struct _GstRDTManagerSession
   /* some accounting */
   guint64 num_late;
   guint64 num_duplicates;
+
+  /* adaptive latency in ms, protected by the jbuf lock */
+  guint latency_ms;
+  GstClockTime last_shrink_time;
 };
 
 /* find a session with the given id */
@@ -243,6 +258,8 @@ create_session (GstRDTManager * rdtmanager, gint id)
   sess->jbuf = rdt_jitter_buffer_new ();
   sess->jbuf_lock = g_mutex_new ();
   sess->jbuf_cond = g_cond_new ();
+  sess->latency_ms = rdtmanager->latency;
+  sess->last_shrink_time = GST_CLOCK_TIME_NONE;
   rdtmanager->sessions = g_slist_prepend (rdtmanager->sessions, sess);
 
   return sess;
@@ -431,6 +448,19 @@ gst_rdt_manager_class_init (GstRDTManagerClass * g_class)
       g_param_spec_uint ("latency", "Buffer latency in ms",
           "Amount of ms to buffer", 0, G_MAXUINT, DEFAULT_LATENCY_MS,
           G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
+  g_object_class_install_property (gobject_class, PROP_ADAPTIVE_LATENCY,
+      g_param_spec_boolean ("adaptive-latency", "Adaptive latency",
+          "Size the latency from the measured jitter and reordering, "
+          "starting from latency", DEFAULT_ADAPTIVE_LATENCY,
+          G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
+  g_object_class_install_property (gobject_class, PROP_MIN_LATENCY,
+      g_param_spec_uint ("min-latency", "Minimum latency in ms",
+          "Lowest latency in ms the adaptive latency will use", 0, G_MAXUINT,
+          DEFAULT_MIN_LATENCY_MS, G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
+  g_object_class_install_property (gobject_class, PROP_MAX_LATENCY,
+      g_param_spec_uint ("max-latency", "Maximum latency in ms",
+          "Highest latency in ms the adaptive latency will use", 0, G_MAXUINT,
+          DEFAULT_MAX_LATENCY_MS, G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
 
   /**
    * GstRDTManager::request-pt-map:
@@ -515,6 +545,9 @@ gst_rdt_manager_init (GstRDTManager * rdtmanager, GstRDTManagerClass * klass)
 {
   rdtmanager->provided_clock = gst_system_clock_obtain ();
   rdtmanager->latency = DEFAULT_LATENCY_MS;
+  rdtmanager->adaptive_latency = DEFAULT_ADAPTIVE_LATENCY;
+  rdtmanager->min_latency = DEFAULT_MIN_LATENCY_MS;
+  rdtmanager->max_latency = DEFAULT_MAX_LATENCY_MS;
 }
 
 static void
@@ -543,7 +576,22 @@ gst_rdt_manager_query_src (GstPad * pad, GstQuery * query)
     {
       GstClockTime latency;
 
-      latency = rdtmanager->latency * GST_MSECOND;
+      if (rdtmanager->adaptive_latency) {
+        GSList *walk;
+        guint max_ms = 0;
+
+        /* all sessions need to be played out with the same latency */
+        for (walk = rdtmanager->sessions; walk; walk = g_slist_next (walk)) {
+          GstRDTManagerSession *sess = (GstRDTManagerSession *) walk->data;
+
+          JBUF_LOCK (sess);
+          max_ms = MAX (max_ms, sess->latency_ms);
+          JBUF_UNLOCK (sess);
+        }
+        latency = max_ms * GST_MSECOND;
+      } else {
+        latency = rdtmanager->latency * GST_MSECOND;
+      }
 
       /* we pretend to be live with a 3 second latency */
       gst_query_set_latency (query, TRUE, latency, -1);
@@ -581,6 +629,12 @@ gst_rdt_manager_src_activate_push (GstPad * pad, gboolean active)
     session->last_out_time = -1;
     session->next_seqnum = -1;
     session->eos = FALSE;
+    /* start measuring again, whatever we queued or measured before the
+     * flush says nothing about the new data */
+    rdt_jitter_buffer_flush (session->jbuf);
+    rdt_jitter_buffer_reset_skew (session->jbuf);
+    session->latency_ms = rdtmanager->latency;
+    session->last_shrink_time = GST_CLOCK_TIME_NONE;
     JBUF_UNLOCK (session);
 
     /* start pushing out buffers */
@@ -609,6 +663,53 @@ gst_rdt_manager_src_activate_push (GstPad * pad, gboolean active)
   return result;
 }
 
+/* Update the adaptive latency of @session from the jitter and the reorder
+ * delay measured by its jitterbuffer. We grow the latency as soon as the
+ * measurements ask for it and only shrink it every LATENCY_SHRINK_INTERVAL,
+ * halfway to the target. Must be called with the jbuf lock.
+ *
+ * Returns: TRUE when the latency changed and must be posted. */
+static gboolean
+gst_rdt_manager_update_latency (GstRDTManager * rdtmanager,
+    GstRDTManagerSession * session, GstClockTime timestamp)
+{
+  GstClockTime jitter, reorder;
+  guint64 target;
+  guint latency;
+
+  jitter = rdt_jitter_buffer_get_jitter (session->jbuf);
+  reorder = rdt_jitter_buffer_get_reorder_delay (session->jbuf);
+
+  /* 4 times the jitter covers nearly all late packets, add the time we have to
+   * wait for reordered packets */
+  target = (4 * jitter + reorder + GST_MSECOND - 1) / GST_MSECOND;
+  target = CLAMP (target, rdtmanager->min_latency, rdtmanager->max_latency);
+
+  latency = session->latency_ms;
+  if (target > latency) {
+    latency = target;
+  } else if (GST_CLOCK_TIME_IS_VALID (timestamp)) {
+    if (!GST_CLOCK_TIME_IS_VALID (session->last_shrink_time)) {
+      session->last_shrink_time = timestamp;
+    } else if (timestamp >= session->last_shrink_time + LATENCY_SHRINK_INTERVAL) {
+      session->last_shrink_time = timestamp;
+      latency -= (latency - target) / 2;
+    }
+  }
+
+  if (latency < session->latency_ms + LATENCY_THRESHOLD_MS &&
+      latency + LATENCY_THRESHOLD_MS > session->latency_ms)
+    return FALSE;
+
+  GST_DEBUG_OBJECT (rdtmanager, "session %d: jitter %" GST_TIME_FORMAT
+      ", reorder %" GST_TIME_FORMAT ", latency %u -> %u ms", session->id,
+      GST_TIME_ARGS (jitter), GST_TIME_ARGS (reorder), session->latency_ms,
+      latency);
+  session->latency_ms = latency;
+
+  return TRUE;
+}
+
 static GstFlowReturn
 gst_rdt_manager_handle_data_packet (GstRDTManagerSession * session,
     GstClockTime timestamp, GstRDTPacket * packet)
@@ -618,6 +719,7 @@ gst_rdt_manager_handle_data_packet (GstRDTManagerSession * session,
   gboolean tail;
   GstFlowReturn res;
   GstBuffer *buffer;
+  gboolean latency_changed = FALSE;
 
   rdtmanager = session->dec;
 
@@ -637,6 +739,10 @@ gst_rdt_manager_handle_data_packet (GstRDTManagerSession * session,
           session->clock_rate, &tail))
     goto duplicate;
 
+  if (rdtmanager->adaptive_latency)
+    latency_changed =
+        gst_rdt_manager_update_latency (rdtmanager, session, timestamp);
+
   /* signal addition of new buffer when the _loop is waiting. */
   if (session->waiting)
     JBUF_SIGNAL (session);
@@ -644,6 +750,11 @@ gst_rdt_manager_handle_data_packet (GstRDTManagerSession * session,
 finished:
   JBUF_UNLOCK (session);
 
+  /* let the application reconfigure the pipeline latency */
+  if (latency_changed)
+    gst_element_post_message (GST_ELEMENT_CAST (rdtmanager),
+        gst_message_new_latency (GST_OBJECT_CAST (rdtmanager)));
+
   return res;
 
   /* ERRORS */
@@ -1057,6 +1168,15 @@ gst_rdt_manager_set_property (GObject * object, guint prop_id,
     case PROP_LATENCY:
       src->latency = g_value_get_uint (value);
       break;
+    case PROP_ADAPTIVE_LATENCY:
+      src->adaptive_latency = g_value_get_boolean (value);
+      break;
+    case PROP_MIN_LATENCY:
+      src->min_latency = g_value_get_uint (value);
+      break;
+    case PROP_MAX_LATENCY:
+      src->max_latency = g_value_get_uint (value);
+      break;
     default:
       G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
       break;
@@ -1075,6 +1195,15 @@ gst_rdt_manager_get_property (GObject * object, guint prop_id, GValue * value,
     case PROP_LATENCY:
       g_value_set_uint (value, src->latency);
       break;
+    case PROP_ADAPTIVE_LATENCY:
+      g_value_set_boolean (value, src->adaptive_latency);
+      break;
+    case PROP_MIN_LATENCY:
+      g_value_set_uint (value, src->min_latency);
+      break;
+    case PROP_MAX_LATENCY:
+      g_value_set_uint (value, src->max_latency);
+      break;
     default:
       G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
       break;
@@ -61,6 +61,9 @@ struct _GstRDTManager {
   GstElement  element;
 
   guint       latency;
+  gboolean    adaptive_latency;
+  guint       min_latency;
+  guint       max_latency;
   GSList     *sessions;
   GstClock   *provided_clock;
 };
@@ -132,13 +132,29 @@ GST_DEBUG_CATEGORY_STATIC (rmdemux_debug);
 
 static GstElementClass *parent_class = NULL;
 
+#define DEFAULT_SELECT_STREAMS  FALSE
+#define DEFAULT_BANDWIDTH       0
+
+enum
+{
+  PROP_0,
+  PROP_SELECT_STREAMS,
+  PROP_BANDWIDTH
+};
+
 static void gst_rmdemux_class_init (GstRMDemuxClass * klass);
 static void gst_rmdemux_base_init (GstRMDemuxClass * klass);
 static void gst_rmdemux_init (GstRMDemux * rmdemux);
 static void gst_rmdemux_finalize (GObject * object);
+static void gst_rmdemux_set_property (GObject * object, guint prop_id,
+    const GValue * value, GParamSpec * pspec);
+static void gst_rmdemux_get_property (GObject * object, guint prop_id,
+    GValue * value, GParamSpec * pspec);
 static GstStateChangeReturn gst_rmdemux_change_state (GstElement * element,
     GstStateChange transition);
 static GstFlowReturn gst_rmdemux_chain (GstPad * pad, GstBuffer * buffer);
+static GstFlowReturn gst_rmdemux_chain_list (GstPad * pad,
+    GstBufferList * list);
 static void gst_rmdemux_loop (GstPad * pad);
 static gboolean gst_rmdemux_sink_activate (GstPad * sinkpad);
 static gboolean gst_rmdemux_sink_activate_push (GstPad * sinkpad,
@@ -166,11 +182,15 @@ static void gst_rmdemux_parse_data (GstRMDemux * rmdemux, const guint8 * data,
 static void gst_rmdemux_parse_cont (GstRMDemux * rmdemux, const guint8 * data,
     int length);
 static GstFlowReturn gst_rmdemux_parse_packet (GstRMDemux * rmdemux,
-    GstBuffer * in, guint16 version);
+    guint size, guint16 version);
+static GstFlowReturn gst_rmdemux_parse_direct_packet (GstRMDemux * rmdemux,
+    GstBuffer * header, GstBuffer * payload);
 static void gst_rmdemux_parse_indx_data (GstRMDemux * rmdemux,
     const guint8 * data, int length);
 static void gst_rmdemux_stream_clear_cached_subpackets (GstRMDemux * rmdemux,
     GstRMDemuxStream * stream);
+static void gst_rmdemux_select_streams (GstRMDemux * rmdemux);
+static void gst_rmdemux_expose_streams (GstRMDemux * rmdemux);
 static GstRMDemuxStream *gst_rmdemux_get_stream_by_id (GstRMDemux * rmdemux,
     int id);
 
@@ -229,6 +249,63 @@ gst_rmdemux_class_init (GstRMDemuxClass * klass)
       0, "Demuxer for Realmedia streams");
 
   gobject_class->finalize = gst_rmdemux_finalize;
+  gobject_class->set_property = gst_rmdemux_set_property;
+  gobject_class->get_property = gst_rmdemux_get_property;
+
+  g_object_class_install_property (gobject_class, PROP_SELECT_STREAMS,
+      g_param_spec_boolean ("select-streams", "Select streams",
+          "Expose only one of the alternative bitrate streams of a "
+          "SureStream file", DEFAULT_SELECT_STREAMS,
+          G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
+  g_object_class_install_property (gobject_class, PROP_BANDWIDTH,
+      g_param_spec_uint ("bandwidth", "Bandwidth",
+          "Maximum total bitrate of the selected streams in bits/s "
+          "(0 = select the highest quality)", 0, G_MAXUINT, DEFAULT_BANDWIDTH,
+          G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
+}
+
+static void
+gst_rmdemux_set_property (GObject * object, guint prop_id,
+    const GValue * value, GParamSpec * pspec)
+{
+  GstRMDemux *rmdemux = GST_RMDEMUX (object);
+
+  /* only takes effect for the next file, selection happens while parsing
+   * the headers */
+  GST_OBJECT_LOCK (rmdemux);
+  switch (prop_id) {
+    case PROP_SELECT_STREAMS:
+      rmdemux->select_streams = g_value_get_boolean (value);
+      break;
+    case PROP_BANDWIDTH:
+      rmdemux->bandwidth = g_value_get_uint (value);
+      break;
+    default:
+      G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
+      break;
+  }
+  GST_OBJECT_UNLOCK (rmdemux);
+}
+
+static void
+gst_rmdemux_get_property (GObject * object, guint prop_id, GValue * value,
+    GParamSpec * pspec)
+{
+  GstRMDemux *rmdemux = GST_RMDEMUX (object);
+
+  GST_OBJECT_LOCK (rmdemux);
+  switch (prop_id) {
+    case PROP_SELECT_STREAMS:
+      g_value_set_boolean (value, rmdemux->select_streams);
+      break;
+    case PROP_BANDWIDTH:
+      g_value_set_uint (value, rmdemux->bandwidth);
+      break;
+    default:
+      G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
+      break;
+  }
+  GST_OBJECT_UNLOCK (rmdemux);
 }
 
 static void
@@ -253,6 +330,8 @@ gst_rmdemux_init (GstRMDemux * rmdemux)
       GST_DEBUG_FUNCPTR (gst_rmdemux_sink_event));
   gst_pad_set_chain_function (rmdemux->sinkpad,
       GST_DEBUG_FUNCPTR (gst_rmdemux_chain));
+  gst_pad_set_chain_list_function (rmdemux->sinkpad,
+      GST_DEBUG_FUNCPTR (gst_rmdemux_chain_list));
   gst_pad_set_activate_function (rmdemux->sinkpad,
       GST_DEBUG_FUNCPTR (gst_rmdemux_sink_activate));
   gst_pad_set_activatepull_function (rmdemux->sinkpad,
@@ -264,8 +343,11 @@ gst_rmdemux_init (GstRMDemux * rmdemux)
 
   rmdemux->adapter = gst_adapter_new ();
   rmdemux->first_ts = GST_CLOCK_TIME_NONE;
+  gst_read_ahead_init (&rmdemux->readahead);
   rmdemux->base_ts = GST_CLOCK_TIME_NONE;
   rmdemux->need_newsegment = TRUE;
+  rmdemux->select_streams = DEFAULT_SELECT_STREAMS;
+  rmdemux->bandwidth = DEFAULT_BANDWIDTH;
 
   gst_rm_utils_run_tests ();
 }
@@ -684,6 +766,26 @@ gst_rmdemux_src_query_types (GstPad * pad)
   return query_types;
 }
 
+static void
+gst_rmdemux_free_stream (GstRMDemux * rmdemux, GstRMDemuxStream * stream)
+{
+  g_object_unref (stream->adapter);
+  gst_rmdemux_stream_clear_cached_subpackets (rmdemux, stream);
+  /* pads of streams that were never exposed are not in the element yet */
+  if (stream->pad) {
+    if (GST_PAD_PARENT (stream->pad) == GST_ELEMENT_CAST (rmdemux))
+      gst_element_remove_pad (GST_ELEMENT (rmdemux), stream->pad);
+    else
+      gst_object_unref (stream->pad);
+  }
+  if (stream->pending_tags)
+    gst_tag_list_free (stream->pending_tags);
+  if (stream->subpackets)
+    g_ptr_array_free (stream->subpackets, TRUE);
+  g_free (stream->index);
+  g_free (stream);
+}
+
 static void
 gst_rmdemux_reset (GstRMDemux * rmdemux)
 {
@@ -693,24 +795,20 @@ gst_rmdemux_reset (GstRMDemux * rmdemux)
   rmdemux->running = FALSE;
   GST_OBJECT_UNLOCK (rmdemux);
 
-  for (cur = rmdemux->streams; cur; cur = cur->next) {
-    GstRMDemuxStream *stream = cur->data;
-
-    g_object_unref (stream->adapter);
-    gst_rmdemux_stream_clear_cached_subpackets (rmdemux, stream);
-    gst_element_remove_pad (GST_ELEMENT (rmdemux), stream->pad);
-    if (stream->pending_tags)
-      gst_tag_list_free (stream->pending_tags);
-    if (stream->subpackets)
-      g_ptr_array_free (stream->subpackets, TRUE);
-    g_free (stream->index);
-    g_free (stream);
-  }
+  for (cur = rmdemux->streams; cur; cur = cur->next)
+    gst_rmdemux_free_stream (rmdemux, cur->data);
   g_slist_free (rmdemux->streams);
   rmdemux->streams = NULL;
   rmdemux->n_audio_streams = 0;
   rmdemux->n_video_streams = 0;
 
+  for (cur = rmdemux->logical_streams; cur; cur = cur->next)
+    g_array_free (cur->data, TRUE);
+  g_slist_free (rmdemux->logical_streams);
+  rmdemux->logical_streams = NULL;
+  g_slist_free (rmdemux->unselected_streams);
+  rmdemux->unselected_streams = NULL;
+
   if (rmdemux->pending_tags != NULL) {
     gst_tag_list_free (rmdemux->pending_tags);
     rmdemux->pending_tags = NULL;
@@ -815,9 +913,17 @@ gst_rmdemux_sink_activate_pull (GstPad * pad, gboolean active)
     rmdemux->loop_state = RMDEMUX_LOOP_STATE_HEADER;
     rmdemux->data_offset = G_MAXUINT;
 
+    gst_read_ahead_start (&rmdemux->readahead, pad,
+        GST_READ_AHEAD_DEFAULT_WINDOW);
+
     return gst_pad_start_task (pad, (GstTaskFunction) gst_rmdemux_loop, pad);
   } else {
-    return gst_pad_stop_task (pad);
+    gboolean res;
+
+    res = gst_pad_stop_task (pad);
+    gst_read_ahead_stop (&rmdemux->readahead);
+
+    return res;
   }
 }
 
@@ -855,6 +961,7 @@ gst_rmdemux_loop (GstPad * pad)
       size = rmdemux->size;
   }
 
+  gst_read_ahead_hint (&rmdemux->readahead, rmdemux->offset, size);
   ret = gst_pad_pull_range (pad, rmdemux->offset, size, &buffer);
   if (ret != GST_FLOW_OK) {
     if (rmdemux->offset == rmdemux->index_offset) {
@@ -1025,6 +1132,12 @@ gst_rmdemux_chain (GstPad * pad, GstBuffer * buffer)
 
         switch (rmdemux->object_id) {
           case GST_MAKE_FOURCC ('.', 'R', 'M', 'F'):
+            /* the streams are added while parsing the headers that follow,
+             * they all have to see the same settings */
+            GST_OBJECT_LOCK (rmdemux);
+            rmdemux->selecting = rmdemux->select_streams;
+            rmdemux->max_bandwidth = rmdemux->bandwidth;
+            GST_OBJECT_UNLOCK (rmdemux);
             rmdemux->state = RMDEMUX_STATE_HEADER_RMF;
             break;
           case GST_MAKE_FOURCC ('P', 'R', 'O', 'P'):
@@ -1115,6 +1228,8 @@ gst_rmdemux_chain (GstPad * pad, GstBuffer * buffer)
       {
         /* If we haven't already done so then signal there are no more pads */
         if (!rmdemux->have_pads) {
+          gst_rmdemux_select_streams (rmdemux);
+          gst_rmdemux_expose_streams (rmdemux);
           GST_LOG_OBJECT (rmdemux, "no more pads");
           gst_element_no_more_pads (GST_ELEMENT (rmdemux));
           rmdemux->have_pads = TRUE;
@@ -1191,8 +1306,6 @@ gst_rmdemux_chain (GstPad * pad, GstBuffer * buffer)
             /* Invalid, just drop it */
             gst_adapter_flush (rmdemux->adapter, 4);
           } else {
-            GstBuffer *buffer;
-
             avail = gst_adapter_available (rmdemux->adapter);
             if (avail < length)
               goto unlock;
@@ -1204,9 +1317,7 @@ gst_rmdemux_chain (GstPad * pad, GstBuffer * buffer)
             gst_adapter_flush (rmdemux->adapter, 4);
             length -= 4;
 
-            buffer = gst_adapter_take_buffer (rmdemux->adapter, length);
-
-            ret = gst_rmdemux_parse_packet (rmdemux, buffer, version);
+            ret = gst_rmdemux_parse_packet (rmdemux, length, version);
             rmdemux->chunk_index++;
           }
 
@@ -1238,6 +1349,52 @@ unlock:
   return ret;
 }
 
+/* rdtdepay pushes every data packet as a group of a 12 byte version 0 data
+ * packet header and a sub-buffer with the payload. Between data packets we
+ * take the fields from the header and use the payload as is instead of
+ * collecting both in the adapter and copying them out again. Anything else
+ * goes through the normal chain function. */
+static GstFlowReturn
+gst_rmdemux_chain_list (GstPad * pad, GstBufferList * list)
+{
+  GstRMDemux *rmdemux = GST_RMDEMUX (GST_PAD_PARENT (pad));
+  GstBufferListIterator *it;
+  GstBuffer *buf;
+  GstFlowReturn ret = GST_FLOW_OK;
+
+  it = gst_buffer_list_iterate (list);
+  while (ret == GST_FLOW_OK && gst_buffer_list_iterator_next_group (it)) {
+    if (gst_buffer_list_iterator_n_buffers (it) == 2 &&
+        rmdemux->state == RMDEMUX_STATE_DATA_PACKET &&
+        gst_adapter_available (rmdemux->adapter) == 0) {
+      GstBuffer *header, *payload;
+      const guint8 *data;
+
+      header = gst_buffer_list_iterator_next (it);
+      payload = gst_buffer_list_iterator_next (it);
+      data = GST_BUFFER_DATA (header);
+
+      if (GST_BUFFER_SIZE (header) == 12 && RMDEMUX_GUINT16_GET (data) == 0 &&
+          RMDEMUX_GUINT16_GET (data + 2) == 12 + GST_BUFFER_SIZE (payload)) {
+        ret = gst_rmdemux_parse_direct_packet (rmdemux, header, payload);
+        continue;
+      }
+
+      ret = gst_rmdemux_chain (pad, gst_buffer_ref (header));
+      if (ret == GST_FLOW_OK)
+        ret = gst_rmdemux_chain (pad, gst_buffer_ref (payload));
+      continue;
+    }
+
+    while (ret == GST_FLOW_OK && (buf = gst_buffer_list_iterator_next (it)))
+      ret = gst_rmdemux_chain (pad, gst_buffer_ref (buf));
+  }
+  gst_buffer_list_iterator_free (it);
+  gst_buffer_list_unref (list);
+
+  return ret;
+}
+
 static GstRMDemuxStream *
 gst_rmdemux_get_stream_by_id (GstRMDemux * rmdemux, int id)
 {
@@ -1282,6 +1439,156 @@ gst_rmdemux_send_event (GstRMDemux * rmdemux, GstEvent * event)
   gst_event_unref (event);
 }
 
+static gint
+gst_rmdemux_compare_bitrate (gconstpointer a, gconstpointer b)
+{
+  const GstRMDemuxStream *sa = *(const GstRMDemuxStream **) a;
+  const GstRMDemuxStream *sb = *(const GstRMDemuxStream **) b;
+
+  if (sa->bitrate < sb->bitrate)
+    return -1;
+  if (sa->bitrate > sb->bitrate)
+    return 1;
+  return 0;
+}
+
+/* SureStream files carry the same content encoded at several bitrates, each
+ * alternative in its own physical stream. When stream selection is enabled
+ * we keep one physical stream per logical stream: the best one, or with a
+ * bandwidth limit the best combination that fits, starting from the lowest
+ * bitrate of every group and upgrading the cheapest steps first. Packets of
+ * the other alternatives are then skipped without being copied. */
+static void
+gst_rmdemux_select_streams (GstRMDemux * rmdemux)
+{
+  GPtrArray **groups;
+  guint *chosen;
+  guint n_groups, i, j;
+  guint64 total;
+  GSList *cur, *drop = NULL;
+
+  if (!rmdemux->selecting || rmdemux->logical_streams == NULL)
+    return;
+
+  n_groups = g_slist_length (rmdemux->logical_streams);
+  groups = g_new0 (GPtrArray *, n_groups);
+  chosen = g_new0 (guint, n_groups);
+
+  /* collect the alternatives we can actually play, sorted by bitrate */
+  for (cur = rmdemux->logical_streams, i = 0; cur; cur = cur->next, i++) {
+    GArray *ids = cur->data;
+
+    groups[i] = g_ptr_array_new ();
+    for (j = 0; j < ids->len; j++) {
+      GstRMDemuxStream *stream;
+
+      stream = gst_rmdemux_get_stream_by_id (rmdemux,
+          g_array_index (ids, gint, j));
+      if (stream != NULL && stream->pad != NULL)
+        g_ptr_array_add (groups[i], stream);
+    }
+    g_ptr_array_sort (groups[i], gst_rmdemux_compare_bitrate);
+  }
+
+  if (rmdemux->max_bandwidth == 0) {
+    for (i = 0; i < n_groups; i++)
+      chosen[i] = groups[i]->len ? groups[i]->len - 1 : 0;
+  } else {
+    total = 0;
+    for (i = 0; i < n_groups; i++) {
+      if (groups[i]->len > 0)
+        total += ((GstRMDemuxStream *) g_ptr_array_index (groups[i],
+                0))->bitrate;
+    }
+
+    /* greedily take the cheapest upgrade that still fits */
+    while (TRUE) {
+      guint best = n_groups;
+      guint32 best_cost = G_MAXUINT32;
+
+      for (i = 0; i < n_groups; i++) {
+        GstRMDemuxStream *cur_s, *next_s;
+        guint32 cost;
+
+        if (chosen[i] + 1 >= groups[i]->len)
+          continue;
+        cur_s = g_ptr_array_index (groups[i], chosen[i]);
+        next_s = g_ptr_array_index (groups[i], chosen[i] + 1);
+        cost = next_s->bitrate - cur_s->bitrate;
+        if (total + cost <= rmdemux->max_bandwidth && cost < best_cost) {
+          best = i;
+          best_cost = cost;
+        }
+      }
+      if (best == n_groups)
+        break;
+      chosen[best]++;
+      total += best_cost;
+    }
+    GST_DEBUG_OBJECT (rmdemux, "selected %" G_GUINT64_FORMAT " bits/s of %u",
+        total, rmdemux->max_bandwidth);
+  }
+
+  for (i = 0; i < n_groups; i++) {
+    for (j = 0; j < groups[i]->len; j++) {
+      GstRMDemuxStream *stream = g_ptr_array_index (groups[i], j);
+
+      if (j == chosen[i]) {
+        GST_INFO_OBJECT (rmdemux, "selected stream %d with bitrate %u",
+            stream->id, stream->bitrate);
+      } else if (!g_slist_find (drop, stream)) {
+        drop = g_slist_prepend (drop, stream);
+      }
+    }
+  }
+
+  /* a stream could in theory be listed in more than one logical stream, never
+   * drop one that was selected somewhere */
+  for (i = 0; i < n_groups; i++) {
+    if (groups[i]->len > 0)
+      drop = g_slist_remove (drop, g_ptr_array_index (groups[i], chosen[i]));
+    g_ptr_array_free (groups[i], TRUE);
+  }
+  g_free (groups);
+  g_free (chosen);
+
+  for (cur = drop; cur; cur = cur->next) {
+    GstRMDemuxStream *stream = cur->data;
+
+    GST_DEBUG_OBJECT (rmdemux, "dropping stream %d with bitrate %u",
+        stream->id, stream->bitrate);
+    rmdemux->streams = g_slist_remove (rmdemux->streams, stream);
+    rmdemux->unselected_streams =
+        g_slist_prepend (rmdemux->unselected_streams,
+        GINT_TO_POINTER (stream->id));
+    gst_rmdemux_free_stream (rmdemux, stream);
+  }
+  g_slist_free (drop);
+}
+
+static void
+gst_rmdemux_expose_streams (GstRMDemux * rmdemux)
+{
+  GSList *cur;
+
+  for (cur = rmdemux->streams; cur; cur = cur->next) {
+    GstRMDemuxStream *stream = cur->data;
+
+    if (stream->pad == NULL || GST_PAD_CAPS (stream->pad) == NULL)
+      continue;
+
+    /* already added while parsing the headers */
+    if (GST_PAD_PARENT (stream->pad) == GST_ELEMENT_CAST (rmdemux))
+      continue;
+
+    GST_DEBUG_OBJECT (rmdemux, "adding pad %s with caps %" GST_PTR_FORMAT
+        ", stream_id=%d", GST_PAD_NAME (stream->pad),
+        GST_PAD_CAPS (stream->pad), stream->id);
+    gst_pad_set_active (stream->pad, TRUE);
+    gst_element_add_pad (GST_ELEMENT_CAST (rmdemux), stream->pad);
+  }
+}
+
 static void
 gst_rmdemux_add_stream (GstRMDemux * rmdemux, GstRMDemuxStream * stream)
 {
@@ -1495,10 +1802,16 @@ gst_rmdemux_add_stream (GstRMDemux * rmdemux, GstRMDemuxStream * stream)
     gst_pad_set_query_function (stream->pad,
         GST_DEBUG_FUNCPTR (gst_rmdemux_src_query));
 
-    GST_DEBUG_OBJECT (rmdemux, "adding pad %s with caps %" GST_PTR_FORMAT
-        ", stream_id=%d", GST_PAD_NAME (stream->pad), stream_caps, stream->id);
-    gst_pad_set_active (stream->pad, TRUE);
-    gst_element_add_pad (GST_ELEMENT_CAST (rmdemux), stream->pad);
+    /* when selecting SureStream alternatives, the pad is added in
+     * gst_rmdemux_expose_streams() once all headers are parsed and we know
+     * which alternatives we keep */
+    if (!rmdemux->selecting) {
+      GST_DEBUG_OBJECT (rmdemux, "adding pad %s with caps %" GST_PTR_FORMAT
+          ", stream_id=%d", GST_PAD_NAME (stream->pad), stream_caps,
+          stream->id);
+      gst_pad_set_active (stream->pad, TRUE);
+      gst_element_add_pad (GST_ELEMENT_CAST (rmdemux), stream->pad);
+    }
 
     codec_name = gst_pb_utils_get_codec_description (stream_caps);
 
@@ -1561,6 +1874,45 @@ gst_rmdemux_parse_prop (GstRMDemux * rmdemux, const guint8 * data, int length)
   GST_LOG_OBJECT (rmdemux, "flags: 0x%04x", RMDEMUX_GUINT16_GET (data + 38));
 }
 
+static void
+gst_rmdemux_parse_logical_stream (GstRMDemux * rmdemux, const guint8 * data,
+    int length)
+{
+  GArray *group;
+  guint n_physical, i;
+
+  /* size (4), version (2), number of physical streams (2), followed by the
+   * physical stream numbers (2 each), their data offsets and the rule map */
+  if (length < 8)
+    goto too_short;
+
+  n_physical = RMDEMUX_GUINT16_GET (data + 6);
+  GST_DEBUG_OBJECT (rmdemux, "logical stream with %u physical streams",
+      n_physical);
+
+  if (n_physical == 0)
+    return;
+  if (length < 8 + n_physical * 2)
+    goto too_short;
+
+  group = g_array_sized_new (FALSE, FALSE, sizeof (gint), n_physical);
+  for (i = 0; i < n_physical; i++) {
+    gint id = RMDEMUX_GUINT16_GET (data + 8 + i * 2);
+
+    GST_LOG_OBJECT (rmdemux, "physical stream %u: id %d", i, id);
+    g_array_append_val (group, id);
+  }
+  rmdemux->logical_streams = g_slist_append (rmdemux->logical_streams, group);
+  return;
+
+  /* ERRORS */
+too_short:
+  {
+    GST_WARNING_OBJECT (rmdemux, "logical stream header too short");
+    return;
+  }
+}
+
 static void
 gst_rmdemux_parse_mdpr (GstRMDemux * rmdemux, const guint8 * data, int length)
 {
@@ -1642,6 +1994,10 @@ gst_rmdemux_parse_mdpr (GstRMDemux * rmdemux, const guint8 * data, int length)
   } else if (strcmp (stream1_type_string, "") == 0 &&
       strcmp (stream2_type_string, "logical-fileinfo") == 0) {
     stream_type = GST_RMDEMUX_STREAM_FILEINFO;
+  } else if (g_str_has_prefix (stream2_type_string, "logical-")) {
+    /* SureStream: groups the physical streams that encode the same content
+     * at different bitrates */
+    stream_type = GST_RMDEMUX_STREAM_LOGICAL;
   } else {
     stream_type = GST_RMDEMUX_STREAM_UNKNOWN;
     GST_WARNING_OBJECT (rmdemux, "unknown stream type \"%s\",\"%s\"",
@@ -1790,6 +2146,10 @@ gst_rmdemux_parse_mdpr (GstRMDemux * rmdemux, const guint8 * data, int length)
       }
     }
       break;
+    case GST_RMDEMUX_STREAM_LOGICAL:
+      gst_rmdemux_parse_logical_stream (rmdemux, data + offset,
+          length - offset);
+      break;
     case GST_RMDEMUX_STREAM_UNKNOWN:
     default:
       break;
@@ -2503,17 +2863,11 @@ gst_rmdemux_parse_audio_packet (GstRMDemux * rmdemux, GstRMDemuxStream * stream,
 {
   GstFlowReturn ret;
   GstBuffer *buffer;
-  const guint8 *data;
-  guint size;
-
-  data = GST_BUFFER_DATA (in) + offset;
-  size = GST_BUFFER_SIZE (in) - offset;
 
-  buffer = gst_buffer_new_and_alloc (size);
+  /* descrambling makes the buffer writable when needed */
+  buffer = gst_buffer_create_sub (in, offset, GST_BUFFER_SIZE (in) - offset);
   gst_buffer_set_caps (buffer, GST_PAD_CAPS (stream->pad));
 
-  memcpy (GST_BUFFER_DATA (buffer), (guint8 *) data, size);
-
   if (rmdemux->first_ts != -1 && timestamp > rmdemux->first_ts)
     timestamp -= rmdemux->first_ts;
   else
@@ -2546,37 +2900,26 @@ gst_rmdemux_parse_audio_packet (GstRMDemux * rmdemux, GstRMDemuxStream * stream,
   return ret;
 }
 
+/* handles a packet for @stream, @in holds its payload or is NULL when the
+ * whole packet of @size bytes, including the @header_size bytes of the stream
+ * header, is still in the adapter */
 static GstFlowReturn
-gst_rmdemux_parse_packet (GstRMDemux * rmdemux, GstBuffer * in, guint16 version)
+gst_rmdemux_handle_packet (GstRMDemux * rmdemux, GstRMDemuxStream * stream,
+    GstBuffer * in, guint size, guint header_size, guint16 version, guint32 ts,
+    guint8 flags)
 {
-  guint16 id;
-  GstRMDemuxStream *stream;
-  guint size;
   GstFlowReturn cret, ret;
   GstClockTime timestamp;
   gboolean key;
-  guint8 *data, *base;
-  guint8 flags;
-  guint32 ts;
-
-  base = data = GST_BUFFER_DATA (in);
-  size = GST_BUFFER_SIZE (in);
-
-  /* stream number */
-  id = RMDEMUX_GUINT16_GET (data);
-
-  stream = gst_rmdemux_get_stream_by_id (rmdemux, id);
-  if (!stream || !stream->pad)
-    goto unknown_stream;
+  guint offset;
 
   /* timestamp in Msec */
-  ts = RMDEMUX_GUINT32_GET (data + 2);
   timestamp = ts * GST_MSECOND;
 
   gst_segment_set_last_stop (&rmdemux->segment, GST_FORMAT_TIME, timestamp);
 
   GST_LOG_OBJECT (rmdemux, "Parsing a packet for stream=%d, timestamp=%"
-      GST_TIME_FORMAT ", size %u, version=%d, ts=%u", id,
+      GST_TIME_FORMAT ", size %u, version=%d, ts=%u", stream->id,
       GST_TIME_ARGS (timestamp), size, version, ts);
 
   if (rmdemux->first_ts == GST_CLOCK_TIME_NONE) {
@@ -2585,21 +2928,6 @@ gst_rmdemux_parse_packet (GstRMDemux * rmdemux, GstBuffer * in, guint16 version)
     rmdemux->first_ts = timestamp;
   }
 
-  /* skip stream_id and timestamp */
-  data += (2 + 4);
-  size -= (2 + 4);
-
-  /* get flags */
-  flags = GST_READ_UINT8 (data + 1);
-
-  data += 2;
-  size -= 2;
-
-  /* version 1 has an extra byte */
-  if (version == 1) {
-    data += 1;
-    size -= 1;
-  }
   key = (flags & 0x02) != 0;
   GST_DEBUG_OBJECT (rmdemux, "flags %d, Keyframe %d", flags, key);
 
@@ -2629,40 +2957,140 @@ gst_rmdemux_parse_packet (GstRMDemux * rmdemux, GstBuffer * in, guint16 version)
     stream->pending_tags = NULL;
   }
 
-  if ((rmdemux->offset + size) <= stream->seek_offset) {
+  if ((rmdemux->offset + size - header_size) <= stream->seek_offset) {
     GST_DEBUG_OBJECT (rmdemux,
         "Stream %d is skipping: seek_offset=%d, offset=%d, size=%u",
-        stream->id, stream->seek_offset, rmdemux->offset, size);
+        stream->id, stream->seek_offset, rmdemux->offset, size - header_size);
+    if (in)
+      gst_buffer_unref (in);
+    else
+      gst_adapter_flush (rmdemux->adapter, size);
     cret = GST_FLOW_OK;
     goto beach;
   }
 
+  if (in) {
+    offset = 0;
+  } else {
+    in = gst_adapter_take_buffer (rmdemux->adapter, size);
+    offset = header_size;
+  }
+
   /* do special headers */
   if (stream->subtype == GST_RMDEMUX_STREAM_VIDEO) {
     ret =
-        gst_rmdemux_parse_video_packet (rmdemux, stream, in, data - base,
+        gst_rmdemux_parse_video_packet (rmdemux, stream, in, offset,
         version, timestamp, key);
   } else if (stream->subtype == GST_RMDEMUX_STREAM_AUDIO) {
     ret =
-        gst_rmdemux_parse_audio_packet (rmdemux, stream, in, data - base,
+        gst_rmdemux_parse_audio_packet (rmdemux, stream, in, offset,
         version, timestamp, key);
-  } else
+  } else {
+    gst_buffer_unref (in);
     ret = GST_FLOW_OK;
+  }
 
   cret = gst_rmdemux_combine_flows (rmdemux, stream, ret);
 
 beach:
   return cret;
+}
+
+static void
+gst_rmdemux_unknown_stream (GstRMDemux * rmdemux, guint16 id)
+{
+  /* packets of SureStream alternatives we did not select are dropped
+   * without ever copying them out of the adapter */
+  if (g_slist_find (rmdemux->unselected_streams, GINT_TO_POINTER (id))) {
+    GST_LOG_OBJECT (rmdemux, "Skipping packet of unselected stream %d", id);
+  } else {
+    GST_WARNING_OBJECT (rmdemux, "No stream for stream id %d in parsing "
+        "data packet", id);
+  }
+}
+
+static GstFlowReturn
+gst_rmdemux_parse_packet (GstRMDemux * rmdemux, guint size, guint16 version)
+{
+  guint16 id;
+  GstRMDemuxStream *stream;
+  const guint8 *data;
+  guint8 flags;
+  guint32 ts;
+  guint header_size;
+
+  /* stream_id, timestamp, reserved and flags, version 1 has an extra byte */
+  header_size = (version == 1) ? 2 + 4 + 2 + 1 : 2 + 4 + 2;
+  if (size < header_size)
+    goto short_packet;
+
+  data = gst_adapter_peek (rmdemux->adapter, header_size);
+
+  /* stream number */
+  id = RMDEMUX_GUINT16_GET (data);
+
+  stream = gst_rmdemux_get_stream_by_id (rmdemux, id);
+  if (!stream || !stream->pad)
+    goto unknown_stream;
+
+  ts = RMDEMUX_GUINT32_GET (data + 2);
+  flags = GST_READ_UINT8 (data + 2 + 4 + 1);
+
+  return gst_rmdemux_handle_packet (rmdemux, stream, NULL, size, header_size,
+      version, ts, flags);
 
   /* ERRORS */
+short_packet:
+  {
+    GST_WARNING_OBJECT (rmdemux, "Data packet of %u bytes is too short", size);
+    gst_adapter_flush (rmdemux->adapter, size);
+    return GST_FLOW_OK;
+  }
 unknown_stream:
   {
-    GST_WARNING_OBJECT (rmdemux, "No stream for stream id %d in parsing "
-        "data packet", id);
+    gst_rmdemux_unknown_stream (rmdemux, id);
+    gst_adapter_flush (rmdemux->adapter, size);
     return GST_FLOW_OK;
   }
 }
 
+/* a data packet from rdtdepay, @header is the version 0 data packet header
+ * with the stream header, see gst_rmdemux_chain_list() */
+static GstFlowReturn
+gst_rmdemux_parse_direct_packet (GstRMDemux * rmdemux, GstBuffer * header,
+    GstBuffer * payload)
+{
+  GstRMDemuxStream *stream;
+  const guint8 *data;
+  guint16 id;
+  GstFlowReturn ret;
+
+  if (rmdemux->base_ts == -1) {
+    rmdemux->base_ts = GST_BUFFER_TIMESTAMP (header);
+    GST_LOG_OBJECT (rmdemux, "base_ts %" GST_TIME_FORMAT,
+        GST_TIME_ARGS (rmdemux->base_ts));
+  }
+
+  data = GST_BUFFER_DATA (header) + 4;
+  id = RMDEMUX_GUINT16_GET (data);
+
+  stream = gst_rmdemux_get_stream_by_id (rmdemux, id);
+  if (!stream || !stream->pad) {
+    gst_rmdemux_unknown_stream (rmdemux, id);
+    ret = GST_FLOW_OK;
+  } else {
+    ret = gst_rmdemux_handle_packet (rmdemux, stream,
+        gst_buffer_ref (payload), 8 + GST_BUFFER_SIZE (payload), 8, 0,
+        RMDEMUX_GUINT32_GET (data + 2), GST_READ_UINT8 (data + 2 + 4 + 1));
+  }
+
+  rmdemux->chunk_index++;
+  if (rmdemux->chunk_index == rmdemux->n_chunks)
+    rmdemux->state = RMDEMUX_STATE_HEADER;
+
+  return ret;
+}
+
 gboolean
 gst_rmdemux_plugin_init (GstPlugin * plugin)
 {
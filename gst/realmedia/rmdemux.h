@@ -24,6 +24,7 @@
 #include <gst/gst.h>
 #include <gst/base/gstadapter.h>
 #include <gst/pbutils/descriptions.h>
+#include <gst/readahead-private.h>
 
 G_BEGIN_DECLS
 
@@ -69,7 +70,8 @@ typedef enum
   GST_RMDEMUX_STREAM_UNKNOWN,
   GST_RMDEMUX_STREAM_VIDEO,
   GST_RMDEMUX_STREAM_AUDIO,
-  GST_RMDEMUX_STREAM_FILEINFO
+  GST_RMDEMUX_STREAM_FILEINFO,
+  GST_RMDEMUX_STREAM_LOGICAL
 } GstRMDemuxStreamType;
 
 typedef struct _GstRMDemux GstRMDemux;
@@ -97,6 +99,7 @@ struct _GstRMDemux {
 
   guint offset;
   gboolean seekable;
+  GstReadAhead readahead;
 
   GstRMDemuxState state;
   GstRMDemuxLoopState loop_state;
@@ -126,6 +129,18 @@ struct _GstRMDemux {
 
   /* container tags for all streams */
   GstTagList *pending_tags;
+
+  /* SureStream: physical stream ids of each logical stream (GArray of gint),
+   * and the ids of the streams we dropped when selecting one per group */
+  GSList *logical_streams;
+  GSList *unselected_streams;
+  /* the properties, copied when the .RMF header is parsed */
+  gboolean selecting;
+  guint max_bandwidth;
+
+  /* properties, with LOCK */
+  gboolean select_streams;
+  guint bandwidth;
 };
 
 struct _GstRMDemuxClass {
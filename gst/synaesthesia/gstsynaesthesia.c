@@ -31,6 +31,10 @@
  * gst-launch -v audiotestsrc ! audioconvert ! synaesthesia ! ffmpegcolorspace ! xvimagesink
  * ]|
  * </refsect2>
+ *
+ * Besides xRGB, the visualisation can be output as I420 or NV12 directly.
+ * This saves a colourspace conversion when feeding a video encoder, and the
+ * frames take 1.5 bytes per pixel instead of 4.
  */
 
 #ifdef HAVE_CONFIG_H
@@ -43,7 +47,8 @@ static GstStaticPadTemplate gst_synaesthesia_src_template =
 GST_STATIC_PAD_TEMPLATE ("src",
     GST_PAD_SRC,
     GST_PAD_ALWAYS,
-    GST_STATIC_CAPS (GST_VIDEO_CAPS_xRGB_HOST_ENDIAN)
+    GST_STATIC_CAPS (GST_VIDEO_CAPS_xRGB_HOST_ENDIAN "; "
+        GST_VIDEO_CAPS_YUV ("{ I420, NV12 }"))
     );
 
 static GstStaticPadTemplate gst_synaesthesia_sink_template =
@@ -275,6 +280,7 @@ gst_synaesthesia_src_setcaps (GstPad * pad, GstCaps * caps)
 {
   GstSynaesthesia *synaesthesia;
   GstStructure *structure;
+  GstVideoFormat format;
   gint w, h;
   gint num, denom;
   gboolean res = TRUE;
@@ -282,12 +288,12 @@ gst_synaesthesia_src_setcaps (GstPad * pad, GstCaps * caps)
   synaesthesia = GST_SYNAESTHESIA (gst_pad_get_parent (pad));
   structure = gst_caps_get_structure (caps, 0);
 
-  if (!gst_structure_get_int (structure, "width", &w) ||
-      !gst_structure_get_int (structure, "height", &h) ||
+  if (!gst_video_format_parse_caps (caps, &format, &w, &h) ||
       !gst_structure_get_fraction (structure, "framerate", &num, &denom)) {
     goto missing_caps_details;
   }
 
+  synaesthesia->format = format;
   synaesthesia->width = w;
   synaesthesia->height = h;
   synaesthesia->fps_n = num;
@@ -301,9 +307,10 @@ gst_synaesthesia_src_setcaps (GstPad * pad, GstCaps * caps)
   synaesthesia->spf = gst_util_uint64_scale_int (synaesthesia->rate,
       synaesthesia->fps_d, synaesthesia->fps_n);
 
-  GST_DEBUG_OBJECT (synaesthesia, "dimension %dx%d, framerate %d/%d, spf %d",
-      synaesthesia->width, synaesthesia->height,
-      synaesthesia->fps_n, synaesthesia->fps_d, synaesthesia->spf);
+  GST_DEBUG_OBJECT (synaesthesia, "format %d, dimension %dx%d, framerate "
+      "%d/%d, spf %d", synaesthesia->format, synaesthesia->width,
+      synaesthesia->height, synaesthesia->fps_n, synaesthesia->fps_d,
+      synaesthesia->spf);
 
 done:
   gst_object_unref (synaesthesia);
@@ -313,12 +320,38 @@ done:
 missing_caps_details:
   {
     GST_WARNING_OBJECT (synaesthesia,
-        "missing width, height or framerate in the caps");
+        "missing format, width, height or framerate in the caps");
     res = FALSE;
     goto done;
   }
 }
 
+/* renders the next frame into outbuf, which has the negotiated size */
+static void
+gst_synaesthesia_render (GstSynaesthesia * synaesthesia, GstBuffer * outbuf)
+{
+  guint8 *data = GST_BUFFER_DATA (outbuf);
+  GstVideoFormat format = synaesthesia->format;
+  gint w = synaesthesia->width, h = synaesthesia->height;
+
+  switch (format) {
+    case GST_VIDEO_FORMAT_I420:
+    case GST_VIDEO_FORMAT_NV12:
+      synaesthesia_update_yuv (synaesthesia->si, synaesthesia->datain,
+          data + gst_video_format_get_component_offset (format, 0, w, h),
+          gst_video_format_get_row_stride (format, 0, w),
+          data + gst_video_format_get_component_offset (format, 1, w, h),
+          data + gst_video_format_get_component_offset (format, 2, w, h),
+          gst_video_format_get_row_stride (format, 1, w),
+          gst_video_format_get_pixel_stride (format, 1));
+      break;
+    default:
+      memcpy (data, synaesthesia_update (synaesthesia->si,
+              synaesthesia->datain), GST_BUFFER_SIZE (outbuf));
+      break;
+  }
+}
+
 static GstFlowReturn
 gst_synaesthesia_chain (GstPad * pad, GstBuffer * buffer)
 {
@@ -359,7 +392,6 @@ gst_synaesthesia_chain (GstPad * pad, GstBuffer * buffer)
         (const guint16 *) gst_adapter_peek (synaesthesia->adapter,
         bytesperread);
     GstBuffer *outbuf;
-    guchar *out_frame;
     guint i;
 
     /* deinterleave */
@@ -371,8 +403,9 @@ gst_synaesthesia_chain (GstPad * pad, GstBuffer * buffer)
     ret =
         gst_pad_alloc_buffer_and_set_caps (synaesthesia->srcpad,
         GST_BUFFER_OFFSET_NONE,
-        synaesthesia->width * synaesthesia->height * 4,
-        GST_PAD_CAPS (synaesthesia->srcpad), &outbuf);
+        gst_video_format_get_size (synaesthesia->format, synaesthesia->width,
+            synaesthesia->height), GST_PAD_CAPS (synaesthesia->srcpad),
+        &outbuf);
 
     /* no buffer allocated, we don't care why. */
     if (ret != GST_FLOW_OK)
@@ -381,9 +414,7 @@ gst_synaesthesia_chain (GstPad * pad, GstBuffer * buffer)
     GST_BUFFER_TIMESTAMP (outbuf) = synaesthesia->next_ts;
     GST_BUFFER_DURATION (outbuf) = synaesthesia->frame_duration;
 
-    out_frame = (guchar *)
-        synaesthesia_update (synaesthesia->si, synaesthesia->datain);
-    memcpy (GST_BUFFER_DATA (outbuf), out_frame, GST_BUFFER_SIZE (outbuf));
+    gst_synaesthesia_render (synaesthesia, outbuf);
 
     ret = gst_pad_push (synaesthesia->srcpad, outbuf);
     outbuf = NULL;
@@ -56,6 +56,7 @@ struct _GstSynaesthesia
   gint16 datain[2][FFT_BUFFER_SIZE];
 
   /* video state */
+  GstVideoFormat format;
   gint fps_n, fps_d;
   gint width;
   gint height;
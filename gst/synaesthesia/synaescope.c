@@ -96,6 +96,10 @@ static int bitReverse[FFT_BUFFER_SIZE];
 /* Shared lookup tables for colors */
 static int scaleDown[256];
 static guint32 colEq[256];
+/* colEq in BT.601 YCbCr */
+static guint8 colEqY[256];
+static guint8 colEqU[256];
+static guint8 colEqV[256];
 
 static void synaes_fft (double *x, double *y);
 static void synaescope_coreGo (syn_instance * si);
@@ -270,6 +274,47 @@ synaescope32 (syn_instance * si)
 }
 
 
+/* index into the colEq tables of the 2-byte intensity pixel at p */
+#define COLEQ_INDEX(p) (((p)[0] >> 4) + ((p)[1] & 0xf0))
+
+/* Write the intensity map as 4:2:0 YCbCr. Chroma is the average of each 2x2
+ * block; with odd sizes the last column/row is repeated. */
+static void
+synaescope_yuv (syn_instance * si, guint8 * ydst, gint y_stride,
+    guint8 * udst, guint8 * vdst, gint uv_stride, gint uv_pixel_stride)
+{
+  int x, y;
+
+  synaescope_coreGo (si);
+
+  for (y = 0; y < si->resy; y += 2) {
+    unsigned char *in0 = si->output + y * si->resx * 2;
+    unsigned char *in1 = (y + 1 < si->resy) ? in0 + si->resx * 2 : in0;
+    guint8 *y0 = ydst + y * y_stride;
+    guint8 *y1 = (y + 1 < si->resy) ? y0 + y_stride : y0;
+    guint8 *u = udst + (y / 2) * uv_stride;
+    guint8 *v = vdst + (y / 2) * uv_stride;
+
+    for (x = 0; x < si->resx; x += 2) {
+      int x1 = (x + 1 < si->resx) ? x + 1 : x;
+      int a = COLEQ_INDEX (in0 + x * 2);
+      int b = COLEQ_INDEX (in0 + x1 * 2);
+      int c = COLEQ_INDEX (in1 + x * 2);
+      int d = COLEQ_INDEX (in1 + x1 * 2);
+
+      y0[x] = colEqY[a];
+      y0[x1] = colEqY[b];
+      y1[x] = colEqY[c];
+      y1[x1] = colEqY[d];
+      *u = (colEqU[a] + colEqU[b] + colEqU[c] + colEqU[d] + 2) >> 2;
+      *v = (colEqV[a] + colEqV[b] + colEqV[c] + colEqV[d] + 2) >> 2;
+      u += uv_pixel_stride;
+      v += uv_pixel_stride;
+    }
+  }
+}
+
+
 static int
 bitReverser (int i)
 {
@@ -336,6 +381,18 @@ synaesthesia_update (syn_instance * si, gint16 data[2][FFT_BUFFER_SIZE])
   return si->display;
 }
 
+/* Like synaesthesia_update(), but writes 4:2:0 YCbCr to the given planes.
+ * uv_pixel_stride is 1 for planar chroma (I420) and 2 for interleaved
+ * chroma (NV12, with v = u + 1). */
+void
+synaesthesia_update_yuv (syn_instance * si, gint16 data[2][FFT_BUFFER_SIZE],
+    guint8 * y, gint y_stride, guint8 * u, guint8 * v, gint uv_stride,
+    gint uv_pixel_stride)
+{
+  synaescope_set_data (si, data);
+  synaescope_yuv (si, y, y_stride, u, v, uv_stride, uv_pixel_stride);
+}
+
 void
 synaesthesia_init (void)
 {
@@ -374,6 +431,10 @@ synaesthesia_init (void)
     int blue = PEAKIFY ((i & 15) * 16);
 
     colEq[i] = (red << 16) + (green << 8) + blue;
+
+    colEqY[i] = ((66 * red + 129 * green + 25 * blue + 128) >> 8) + 16;
+    colEqU[i] = ((-38 * red - 74 * green + 112 * blue + 128) >> 8) + 128;
+    colEqV[i] = ((112 * red - 94 * green - 18 * blue + 128) >> 8) + 128;
   }
 
   inited = 1;
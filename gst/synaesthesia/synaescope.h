@@ -38,5 +38,8 @@ void synaesthesia_close (syn_instance * si);
 gboolean synaesthesia_resize (syn_instance * si, guint resx, guint resy);
 guint32 *synaesthesia_update (syn_instance * si,
     gint16 data[2][FFT_BUFFER_SIZE]);
+void synaesthesia_update_yuv (syn_instance * si,
+    gint16 data[2][FFT_BUFFER_SIZE], guint8 * y, gint y_stride, guint8 * u,
+    guint8 * v, gint uv_stride, gint uv_pixel_stride);
 
 #endif
@@ -0,0 +1,144 @@
+/* GStreamer
+ * Copyright (C) 2013 GStreamer developers
+ *
+ * asfdemux-packets.c: measure asfdemux data packet parsing throughput
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 59 Temple Place - Suite 330,
+ * Boston, MA 02111-1307, USA.
+ */
+
+/* Runs filesrc ! asfdemux ! fakesink on an ASF file, once in pull mode and
+ * once in push mode, and prints how many data packets asfdemux parsed per
+ * second, from its stats property. Nothing is decoded, so the time is
+ * dominated by packet and payload parsing. Run the benchmark twice to make
+ * sure the file is in the page cache, and compare the numbers of two builds
+ * to see the effect of a parser change.
+ *
+ * Usage: asfdemux-packets FILE [ITERATIONS]
+ */
+
+#include <stdlib.h>
+#include <gst/gst.h>
+
+static void
+pad_added_cb (GstElement * demux, GstPad * pad, GstBin * pipeline)
+{
+  GstElement *sink;
+  GstPad *sinkpad;
+
+  sink = gst_element_factory_make ("fakesink", NULL);
+  g_object_set (sink, "sync", FALSE, "async", FALSE, NULL);
+  gst_bin_add (pipeline, sink);
+  gst_element_set_state (sink, GST_STATE_PLAYING);
+
+  sinkpad = gst_element_get_static_pad (sink, "sink");
+  gst_pad_link (pad, sinkpad);
+  gst_object_unref (sinkpad);
+}
+
+/* returns the time it took, and the number of packets in @packets */
+static GstClockTime
+run_pipeline (const gchar * filename, gboolean push, guint64 * packets)
+{
+  GstElement *pipeline, *src, *queue = NULL, *demux;
+  GstStructure *stats;
+  GstBus *bus;
+  GstMessage *msg;
+  GstClockTime start, end;
+
+  pipeline = gst_pipeline_new ("pipeline");
+  src = gst_element_factory_make ("filesrc", NULL);
+  demux = gst_element_factory_make ("asfdemux", NULL);
+  if (demux == NULL) {
+    g_printerr ("no element 'asfdemux'\n");
+    exit (1);
+  }
+  g_object_set (src, "location", filename, NULL);
+  gst_bin_add_many (GST_BIN (pipeline), src, demux, NULL);
+
+  /* a queue only operates in push mode, which makes asfdemux use its
+   * chain function */
+  if (push) {
+    queue = gst_element_factory_make ("queue", NULL);
+    gst_bin_add (GST_BIN (pipeline), queue);
+    gst_element_link_many (src, queue, demux, NULL);
+  } else {
+    gst_element_link (src, demux);
+  }
+  g_signal_connect (demux, "pad-added", G_CALLBACK (pad_added_cb), pipeline);
+
+  start = gst_util_get_timestamp ();
+  gst_element_set_state (pipeline, GST_STATE_PLAYING);
+
+  bus = gst_element_get_bus (pipeline);
+  msg = gst_bus_poll (bus, GST_MESSAGE_EOS | GST_MESSAGE_ERROR, -1);
+  end = gst_util_get_timestamp ();
+
+  if (GST_MESSAGE_TYPE (msg) == GST_MESSAGE_ERROR) {
+    GError *err = NULL;
+
+    gst_message_parse_error (msg, &err, NULL);
+    g_printerr ("error: %s\n", err->message);
+    g_error_free (err);
+    exit (1);
+  }
+  gst_message_unref (msg);
+  gst_object_unref (bus);
+
+  g_object_get (demux, "stats", &stats, NULL);
+  gst_structure_get_uint64 (stats, "packets", packets);
+  gst_structure_free (stats);
+
+  gst_element_set_state (pipeline, GST_STATE_NULL);
+  gst_object_unref (pipeline);
+
+  return end - start;
+}
+
+static void
+run_mode (const gchar * filename, gboolean push, gint iterations)
+{
+  GstClockTime total = 0;
+  guint64 packets = 0;
+  gint i;
+
+  for (i = 0; i < iterations; i++)
+    total += run_pipeline (filename, push, &packets);
+  total /= iterations;
+
+  g_print ("%s mode: %" G_GUINT64_FORMAT " packets in %" GST_TIME_FORMAT
+      ", %.0f packets/s\n", push ? "push" : "pull", packets,
+      GST_TIME_ARGS (total), packets / ((gdouble) MAX (total, 1) / GST_SECOND));
+}
+
+gint
+main (gint argc, gchar * argv[])
+{
+  gint iterations = 5;
+
+  gst_init (&argc, &argv);
+
+  if (argc < 2) {
+    g_print ("usage: %s FILE [ITERATIONS]\n", argv[0]);
+    return 1;
+  }
+  if (argc > 2)
+    iterations = MAX (1, atoi (argv[2]));
+
+  run_mode (argv[1], FALSE, iterations);
+  run_mode (argv[1], TRUE, iterations);
+
+  return 0;
+}
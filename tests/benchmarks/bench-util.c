@@ -0,0 +1,122 @@
+/* GStreamer
+ * Copyright (C) 2013 GStreamer developers
+ *
+ * bench-util.c: helpers shared by the benchmarks
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 59 Temple Place - Suite 330,
+ * Boston, MA 02111-1307, USA.
+ */
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include "bench-util.h"
+
+/* creates @name, falling back to mpegaudioparse for mp3parse */
+GstElement *
+bench_make_element (const gchar * name)
+{
+  GstElement *element;
+
+  element = gst_element_factory_make (name, NULL);
+  if (element == NULL && g_str_equal (name, "mp3parse"))
+    element = gst_element_factory_make ("mpegaudioparse", NULL);
+
+  return element;
+}
+
+/* encodes @num_buffers buffers of audio to @filename, in a format @element
+ * can read. Returns FALSE if there is no synthetic input for @element */
+gboolean
+bench_make_synthetic (const gchar * element, guint num_buffers,
+    const gchar * filename)
+{
+  GstElement *pipeline;
+  GstBus *bus;
+  GstMessage *msg;
+  gchar *desc;
+  gboolean res;
+
+  if (g_str_equal (element, "asfdemux"))
+    desc = g_strdup_printf ("audiotestsrc num-buffers=%u ! lamemp3enc ! "
+        "asfindexmux ! filesink location=\"%s\"", num_buffers, filename);
+  else if (g_str_equal (element, "mp3parse") ||
+      g_str_equal (element, "mpegaudioparse") || g_str_equal (element, "mad"))
+    desc = g_strdup_printf ("audiotestsrc num-buffers=%u ! lamemp3enc ! "
+        "filesink location=\"%s\"", num_buffers, filename);
+  else
+    return FALSE;
+
+  pipeline = gst_parse_launch (desc, NULL);
+  g_free (desc);
+  if (pipeline == NULL)
+    return FALSE;
+
+  gst_element_set_state (pipeline, GST_STATE_PLAYING);
+  bus = gst_element_get_bus (pipeline);
+  msg = gst_bus_poll (bus, GST_MESSAGE_EOS | GST_MESSAGE_ERROR, -1);
+  res = GST_MESSAGE_TYPE (msg) == GST_MESSAGE_EOS;
+  gst_message_unref (msg);
+  gst_object_unref (bus);
+
+  gst_element_set_state (pipeline, GST_STATE_NULL);
+  gst_object_unref (pipeline);
+
+  return res;
+}
+
+/* links @pad to a new fakesink in @pipeline that doesn't sync to the clock.
+ * Add probes on @pad before calling this to see the first buffer */
+GstElement *
+bench_link_fakesink (GstPad * pad, GstBin * pipeline)
+{
+  GstElement *sink;
+  GstPad *sinkpad;
+
+  sink = gst_element_factory_make ("fakesink", NULL);
+  g_object_set (sink, "sync", FALSE, NULL);
+  gst_bin_add (pipeline, sink);
+  gst_element_sync_state_with_parent (sink);
+
+  sinkpad = gst_element_get_static_pad (sink, "sink");
+  gst_pad_link (pad, sinkpad);
+  gst_object_unref (sinkpad);
+
+  return sink;
+}
+
+/* the read() calls and bytes read by the process so far, from
+ * /proc/self/io. Both are G_MAXUINT64 where that isn't available */
+void
+bench_read_proc_io (guint64 * syscr, guint64 * rchar)
+{
+  gchar *contents, **lines, **l;
+
+  *syscr = *rchar = G_MAXUINT64;
+
+  if (!g_file_get_contents ("/proc/self/io", &contents, NULL, NULL))
+    return;
+
+  lines = g_strsplit (contents, "\n", -1);
+  for (l = lines; *l; l++) {
+    if (g_str_has_prefix (*l, "syscr: "))
+      *syscr = g_ascii_strtoull (*l + 7, NULL, 10);
+    else if (g_str_has_prefix (*l, "rchar: "))
+      *rchar = g_ascii_strtoull (*l + 7, NULL, 10);
+  }
+  g_strfreev (lines);
+  g_free (contents);
+}
@@ -0,0 +1,40 @@
+/* GStreamer
+ * Copyright (C) 2013 GStreamer developers
+ *
+ * bench-util.h: helpers shared by the benchmarks
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 59 Temple Place - Suite 330,
+ * Boston, MA 02111-1307, USA.
+ */
+
+#ifndef __BENCH_UTIL_H__
+#define __BENCH_UTIL_H__
+
+#include <gst/gst.h>
+
+G_BEGIN_DECLS
+
+GstElement * bench_make_element   (const gchar * name);
+
+gboolean     bench_make_synthetic (const gchar * element, guint num_buffers,
+                                   const gchar * filename);
+
+GstElement * bench_link_fakesink  (GstPad * pad, GstBin * pipeline);
+
+void         bench_read_proc_io   (guint64 * syscr, guint64 * rchar);
+
+G_END_DECLS
+
+#endif /* __BENCH_UTIL_H__ */
@@ -0,0 +1,158 @@
+/* GStreamer
+ * Copyright (C) 2013 GStreamer developers
+ *
+ * demux-cold-cache.c: measure pull-mode demuxing with a cold page cache
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 59 Temple Place - Suite 330,
+ * Boston, MA 02111-1307, USA.
+ */
+
+/* Runs filesrc ! <demuxer> ! fakesink on a local file, once after dropping
+ * the file from the page cache and once with the file cached, and prints the
+ * time it took to reach EOS. Dropping the file from the page cache only works
+ * for files on a real disk (not tmpfs) and needs posix_fadvise().
+ *
+ * Usage: demux-cold-cache FILE [DEMUXER] [ITERATIONS]
+ * DEMUXER defaults to asfdemux.
+ */
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include <stdlib.h>
+#include <gst/gst.h>
+
+#ifdef G_OS_UNIX
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+static gboolean
+drop_page_cache (const gchar * filename)
+{
+#if defined (G_OS_UNIX) && defined (HAVE_POSIX_FADVISE)
+  gint fd;
+  gboolean res;
+
+  fd = open (filename, O_RDONLY);
+  if (fd < 0)
+    return FALSE;
+
+  /* only clean pages are dropped, make sure there are no dirty ones */
+  fdatasync (fd);
+  res = posix_fadvise (fd, 0, 0, POSIX_FADV_DONTNEED) == 0;
+  close (fd);
+
+  return res;
+#else
+  return FALSE;
+#endif
+}
+
+static void
+pad_added_cb (GstElement * demux, GstPad * pad, GstBin * pipeline)
+{
+  GstElement *sink;
+  GstPad *sinkpad;
+
+  sink = gst_element_factory_make ("fakesink", NULL);
+  g_object_set (sink, "sync", FALSE, "async", FALSE, NULL);
+  gst_bin_add (pipeline, sink);
+  gst_element_set_state (sink, GST_STATE_PLAYING);
+
+  sinkpad = gst_element_get_static_pad (sink, "sink");
+  gst_pad_link (pad, sinkpad);
+  gst_object_unref (sinkpad);
+}
+
+static GstClockTime
+run_pipeline (const gchar * filename, const gchar * demuxer)
+{
+  GstElement *pipeline, *src, *demux;
+  GstBus *bus;
+  GstMessage *msg;
+  GstClockTime start, end;
+
+  pipeline = gst_pipeline_new ("pipeline");
+  src = gst_element_factory_make ("filesrc", NULL);
+  demux = gst_element_factory_make (demuxer, NULL);
+  if (demux == NULL) {
+    g_printerr ("no element '%s'\n", demuxer);
+    exit (1);
+  }
+  g_object_set (src, "location", filename, NULL);
+  gst_bin_add_many (GST_BIN (pipeline), src, demux, NULL);
+  gst_element_link (src, demux);
+  g_signal_connect (demux, "pad-added", G_CALLBACK (pad_added_cb), pipeline);
+
+  start = gst_util_get_timestamp ();
+  gst_element_set_state (pipeline, GST_STATE_PLAYING);
+
+  bus = gst_element_get_bus (pipeline);
+  msg = gst_bus_poll (bus, GST_MESSAGE_EOS | GST_MESSAGE_ERROR, -1);
+  end = gst_util_get_timestamp ();
+
+  if (GST_MESSAGE_TYPE (msg) == GST_MESSAGE_ERROR) {
+    GError *err = NULL;
+
+    gst_message_parse_error (msg, &err, NULL);
+    g_printerr ("error: %s\n", err->message);
+    g_error_free (err);
+    exit (1);
+  }
+  gst_message_unref (msg);
+  gst_object_unref (bus);
+
+  gst_element_set_state (pipeline, GST_STATE_NULL);
+  gst_object_unref (pipeline);
+
+  return end - start;
+}
+
+gint
+main (gint argc, gchar * argv[])
+{
+  const gchar *filename, *demuxer = "asfdemux";
+  GstClockTime cold = 0, warm = 0;
+  gint i, iterations = 3;
+
+  gst_init (&argc, &argv);
+
+  if (argc < 2) {
+    g_print ("usage: %s FILE [DEMUXER] [ITERATIONS]\n", argv[0]);
+    return 1;
+  }
+  filename = argv[1];
+  if (argc > 2)
+    demuxer = argv[2];
+  if (argc > 3)
+    iterations = MAX (1, atoi (argv[3]));
+
+  for (i = 0; i < iterations; i++) {
+    if (!drop_page_cache (filename)) {
+      g_printerr ("could not drop %s from the page cache\n", filename);
+      return 1;
+    }
+    cold += run_pipeline (filename, demuxer);
+    warm += run_pipeline (filename, demuxer);
+  }
+
+  g_print ("%s: cold cache %" GST_TIME_FORMAT ", warm cache %" GST_TIME_FORMAT
+      " (average of %d runs)\n", demuxer, GST_TIME_ARGS (cold / iterations),
+      GST_TIME_ARGS (warm / iterations), iterations);
+
+  return 0;
+}
@@ -0,0 +1,322 @@
+/* GStreamer
+ * Copyright (C) 2013 GStreamer developers
+ *
+ * first-buffer.c: measure the startup cost of demuxers and sources
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 59 Temple Place - Suite 330,
+ * Boston, MA 02111-1307, USA.
+ */
+
+/* Brings filesrc ! ELEMENT ! fakesink (or ELEMENT ! fakesink for sources
+ * like dvdreadsrc, with the file as its device) to PAUSED and prints a
+ * timeline of what happened until the pipeline prerolled: reads that jumped
+ * to another offset (usually the index at the end of the file), pads being
+ * added, and the first buffer on each pad. For every event it prints the
+ * time since the state change, the bytes that went into the element and,
+ * on Linux, the read() calls and bytes read by the whole process from
+ * /proc/self/io. A summary splits this into the header, index and pad
+ * creation phases.
+ *
+ * Synthetic inputs can be created for asfdemux and mp3parse (with
+ * lamemp3enc and asfindexmux), the other elements need a file, e.g. a VOB for
+ * mpegdemux and dvddemux or a DVD image for dvdreadsrc.
+ *
+ * Usage: first-buffer ELEMENT FILE
+ *        first-buffer ELEMENT --synthetic
+ */
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#ifdef HAVE_UNISTD_H
+#include <unistd.h>
+#endif
+#include <glib/gstdio.h>
+#include <gst/gst.h>
+#include <gst/glib-compat-private.h>
+
+#include "bench-util.h"
+
+typedef enum
+{
+  EVENT_START,
+  EVENT_JUMP,
+  EVENT_PAD_ADDED,
+  EVENT_NO_MORE_PADS,
+  EVENT_FIRST_BUFFER,
+  EVENT_PREROLLED
+} EventType;
+
+typedef struct
+{
+  EventType type;
+  gchar *what;
+  GstClockTime time;
+  guint64 bytes;
+  guint64 syscr;                /* read syscalls, G_MAXUINT64 if unknown */
+  guint64 rchar;                /* bytes read by syscalls */
+} Event;
+
+static GMutex *lock;
+static GArray *events;
+static GstClockTime start_time;
+static guint64 bytes_in;
+static guint64 next_offset = -1;
+
+/* call with lock */
+static void
+add_event (EventType type, gchar * what)
+{
+  Event ev;
+
+  ev.type = type;
+  ev.what = what;
+  ev.time = gst_util_get_timestamp () - start_time;
+  ev.bytes = bytes_in;
+  bench_read_proc_io (&ev.syscr, &ev.rchar);
+
+  g_array_append_val (events, ev);
+}
+
+static gboolean
+input_probe (GstPad * pad, GstBuffer * buf, gpointer user_data)
+{
+  guint64 offset = GST_BUFFER_OFFSET (buf);
+
+  g_mutex_lock (lock);
+  if (offset != GST_BUFFER_OFFSET_NONE) {
+    if (next_offset != -1 && offset != next_offset)
+      add_event (EVENT_JUMP, g_strdup_printf ("read at %" G_GUINT64_FORMAT,
+              offset));
+    next_offset = offset + GST_BUFFER_SIZE (buf);
+  }
+  bytes_in += GST_BUFFER_SIZE (buf);
+  g_mutex_unlock (lock);
+
+  return TRUE;
+}
+
+static gboolean
+output_probe (GstPad * pad, GstBuffer * buf, gpointer user_data)
+{
+  if (g_object_get_data (G_OBJECT (pad), "seen-buffer"))
+    return TRUE;
+  g_object_set_data (G_OBJECT (pad), "seen-buffer", GINT_TO_POINTER (1));
+
+  g_mutex_lock (lock);
+  add_event (EVENT_FIRST_BUFFER, g_strdup_printf ("first buffer on %s",
+          GST_PAD_NAME (pad)));
+  g_mutex_unlock (lock);
+
+  return TRUE;
+}
+
+static void
+link_output (GstPad * pad, GstBin * pipeline)
+{
+  gst_pad_add_buffer_probe (pad, G_CALLBACK (output_probe), NULL);
+  bench_link_fakesink (pad, pipeline);
+}
+
+static void
+pad_added_cb (GstElement * element, GstPad * pad, GstBin * pipeline)
+{
+  g_mutex_lock (lock);
+  add_event (EVENT_PAD_ADDED, g_strdup_printf ("pad-added %s",
+          GST_PAD_NAME (pad)));
+  g_mutex_unlock (lock);
+
+  link_output (pad, pipeline);
+}
+
+static void
+no_more_pads_cb (GstElement * element, gpointer user_data)
+{
+  g_mutex_lock (lock);
+  add_event (EVENT_NO_MORE_PADS, g_strdup ("no-more-pads"));
+  g_mutex_unlock (lock);
+}
+
+static void
+print_events (void)
+{
+  const Event *header_end = NULL, *index_end = NULL, *last = NULL;
+  const Event *first = &g_array_index (events, Event, 0);
+  guint i;
+
+  g_print ("%-32s %16s %10s %10s %12s\n", "event", "time", "bytes",
+      "read()s", "read bytes");
+
+  for (i = 0; i < events->len; i++) {
+    const Event *ev = &g_array_index (events, Event, i);
+
+    if (ev->syscr != G_MAXUINT64)
+      g_print ("%-32s %" GST_TIME_FORMAT " %10" G_GUINT64_FORMAT " %10"
+          G_GUINT64_FORMAT " %12" G_GUINT64_FORMAT "\n", ev->what,
+          GST_TIME_ARGS (ev->time), ev->bytes, ev->syscr - first->syscr,
+          ev->rchar - first->rchar);
+    else
+      g_print ("%-32s %" GST_TIME_FORMAT " %10" G_GUINT64_FORMAT "\n",
+          ev->what, GST_TIME_ARGS (ev->time), ev->bytes);
+
+    /* the header ends with the first jump or pad, the index with the first
+     * pad, pad creation with the first buffer on the last pad */
+    if (header_end == NULL && (ev->type == EVENT_JUMP ||
+            ev->type == EVENT_PAD_ADDED || ev->type == EVENT_FIRST_BUFFER))
+      header_end = ev;
+    if (index_end == NULL && (ev->type == EVENT_PAD_ADDED ||
+            ev->type == EVENT_FIRST_BUFFER))
+      index_end = ev;
+    if (ev->type == EVENT_FIRST_BUFFER)
+      last = ev;
+  }
+
+  if (header_end == NULL || index_end == NULL || last == NULL)
+    return;
+
+  g_print ("\n%-32s %16s %10s\n", "phase", "time", "bytes");
+  g_print ("%-32s %" GST_TIME_FORMAT " %10" G_GUINT64_FORMAT "\n",
+      "header", GST_TIME_ARGS (header_end->time), header_end->bytes);
+  g_print ("%-32s %" GST_TIME_FORMAT " %10" G_GUINT64_FORMAT "\n",
+      "index", GST_TIME_ARGS (index_end->time - header_end->time),
+      index_end->bytes - header_end->bytes);
+  g_print ("%-32s %" GST_TIME_FORMAT " %10" G_GUINT64_FORMAT "\n",
+      "pads until first buffers", GST_TIME_ARGS (last->time - index_end->time),
+      last->bytes - index_end->bytes);
+}
+
+gint
+main (gint argc, gchar * argv[])
+{
+  GstElement *pipeline, *element, *src;
+  GstPad *pad;
+  GstBus *bus;
+  GstMessage *msg;
+  gchar *filename, *tmpname = NULL;
+  const gchar *name;
+  gboolean is_source;
+  guint i;
+  gint ret = 0;
+
+  gst_init (&argc, &argv);
+
+  if (argc < 3) {
+    g_print ("usage: %s ELEMENT FILE|--synthetic\n", argv[0]);
+    return 1;
+  }
+  name = argv[1];
+
+  if (g_str_equal (argv[2], "--synthetic")) {
+    gint fd;
+
+    fd = g_file_open_tmp ("first-buffer-XXXXXX", &tmpname, NULL);
+    if (fd < 0)
+      return 1;
+    close (fd);
+    if (!bench_make_synthetic (name, 1300, tmpname)) {
+      g_printerr ("no synthetic input for %s\n", name);
+      g_unlink (tmpname);
+      return 1;
+    }
+    filename = tmpname;
+  } else {
+    filename = argv[2];
+  }
+
+  element = bench_make_element (name);
+  if (element == NULL) {
+    g_printerr ("no element '%s'\n", name);
+    ret = 1;
+    goto done;
+  }
+
+  lock = g_mutex_new ();
+  events = g_array_new (FALSE, FALSE, sizeof (Event));
+
+  pipeline = gst_pipeline_new ("pipeline");
+  gst_bin_add (GST_BIN (pipeline), element);
+
+  pad = gst_element_get_static_pad (element, "sink");
+  is_source = (pad == NULL);
+  if (!is_source) {
+    src = gst_element_factory_make ("filesrc", NULL);
+    g_object_set (src, "location", filename, NULL);
+    gst_bin_add (GST_BIN (pipeline), src);
+    gst_element_link (src, element);
+
+    gst_pad_add_buffer_probe (pad, G_CALLBACK (input_probe), NULL);
+    gst_object_unref (pad);
+  } else {
+    /* a source, dvdreadsrc reads images given as device */
+    g_object_set (element, "device", filename, NULL);
+  }
+
+  if ((pad = gst_element_get_static_pad (element, "src"))) {
+    if (is_source)
+      gst_pad_add_buffer_probe (pad, G_CALLBACK (input_probe), NULL);
+    link_output (pad, GST_BIN (pipeline));
+    gst_object_unref (pad);
+  } else {
+    g_signal_connect (element, "pad-added", G_CALLBACK (pad_added_cb),
+        pipeline);
+    g_signal_connect (element, "no-more-pads", G_CALLBACK (no_more_pads_cb),
+        NULL);
+  }
+
+  g_mutex_lock (lock);
+  start_time = gst_util_get_timestamp ();
+  add_event (EVENT_START, g_strdup ("start"));
+  g_mutex_unlock (lock);
+
+  gst_element_set_state (pipeline, GST_STATE_PAUSED);
+
+  bus = gst_element_get_bus (pipeline);
+  msg = gst_bus_poll (bus, GST_MESSAGE_ASYNC_DONE | GST_MESSAGE_ERROR,
+      30 * GST_SECOND);
+  if (msg == NULL || GST_MESSAGE_TYPE (msg) == GST_MESSAGE_ERROR) {
+    g_printerr ("%s did not preroll\n", name);
+    ret = 1;
+  } else {
+    g_mutex_lock (lock);
+    add_event (EVENT_PREROLLED, g_strdup ("prerolled"));
+    g_mutex_unlock (lock);
+  }
+  if (msg)
+    gst_message_unref (msg);
+  gst_object_unref (bus);
+
+  gst_element_set_state (pipeline, GST_STATE_NULL);
+  gst_object_unref (pipeline);
+
+  if (ret == 0)
+    print_events ();
+
+  for (i = 0; i < events->len; i++)
+    g_free (g_array_index (events, Event, i).what);
+  g_array_free (events, TRUE);
+  g_mutex_free (lock);
+
+done:
+  if (tmpname) {
+    g_unlink (tmpname);
+    g_free (tmpname);
+  }
+
+  return ret;
+}
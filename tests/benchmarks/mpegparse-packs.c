@@ -0,0 +1,122 @@
+/* GStreamer
+ * Copyright (C) 2013 GStreamer developers
+ *
+ * mpegparse-packs.c: measure demuxing of pack-aligned program streams
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 59 Temple Place - Suite 330,
+ * Boston, MA 02111-1307, USA.
+ */
+
+/* Runs filesrc ! <demuxer> ! fakesink on a DVD title and prints how long
+ * it took, once with 2048 byte blocks, which lets the packetizer parse the
+ * packs in place, and once with a block size that is not a multiple of the
+ * pack size, which makes it fall back to the byte-wise parser.
+ *
+ * A full title can be created by concatenating the VOB files of a title set,
+ * e.g. cat VIDEO_TS/VTS_01_[1-9].VOB > title.vob. Run the benchmark twice to
+ * make sure the file is in the page cache.
+ *
+ * Usage: mpegparse-packs FILE [DEMUXER]
+ * DEMUXER defaults to dvddemux.
+ */
+
+#include <stdlib.h>
+#include <gst/gst.h>
+
+static void
+pad_added_cb (GstElement * demux, GstPad * pad, GstBin * pipeline)
+{
+  GstElement *sink;
+  GstPad *sinkpad;
+
+  sink = gst_element_factory_make ("fakesink", NULL);
+  g_object_set (sink, "sync", FALSE, "async", FALSE, NULL);
+  gst_bin_add (pipeline, sink);
+  gst_element_set_state (sink, GST_STATE_PLAYING);
+
+  sinkpad = gst_element_get_static_pad (sink, "sink");
+  gst_pad_link (pad, sinkpad);
+  gst_object_unref (sinkpad);
+}
+
+static GstClockTime
+run_pipeline (const gchar * filename, const gchar * demuxer, guint blocksize)
+{
+  GstElement *pipeline, *src, *demux;
+  GstBus *bus;
+  GstMessage *msg;
+  GstClockTime start, end;
+
+  pipeline = gst_pipeline_new ("pipeline");
+  src = gst_element_factory_make ("filesrc", NULL);
+  demux = gst_element_factory_make (demuxer, NULL);
+  if (demux == NULL) {
+    g_printerr ("no element '%s'\n", demuxer);
+    exit (1);
+  }
+  g_object_set (src, "location", filename, "blocksize", blocksize, NULL);
+  gst_bin_add_many (GST_BIN (pipeline), src, demux, NULL);
+  gst_element_link (src, demux);
+  g_signal_connect (demux, "pad-added", G_CALLBACK (pad_added_cb), pipeline);
+
+  start = gst_util_get_timestamp ();
+  gst_element_set_state (pipeline, GST_STATE_PLAYING);
+
+  bus = gst_element_get_bus (pipeline);
+  msg = gst_bus_poll (bus, GST_MESSAGE_EOS | GST_MESSAGE_ERROR, -1);
+  end = gst_util_get_timestamp ();
+
+  if (GST_MESSAGE_TYPE (msg) == GST_MESSAGE_ERROR) {
+    GError *err = NULL;
+
+    gst_message_parse_error (msg, &err, NULL);
+    g_printerr ("error: %s\n", err->message);
+    g_error_free (err);
+    exit (1);
+  }
+  gst_message_unref (msg);
+  gst_object_unref (bus);
+
+  gst_element_set_state (pipeline, GST_STATE_NULL);
+  gst_object_unref (pipeline);
+
+  return end - start;
+}
+
+gint
+main (gint argc, gchar * argv[])
+{
+  const gchar *filename, *demuxer = "dvddemux";
+  GstClockTime aligned, unaligned;
+
+  gst_init (&argc, &argv);
+
+  if (argc < 2) {
+    g_print ("usage: %s FILE [DEMUXER]\n", argv[0]);
+    return 1;
+  }
+  filename = argv[1];
+  if (argc > 2)
+    demuxer = argv[2];
+
+  aligned = run_pipeline (filename, demuxer, 16 * 2048);
+  unaligned = run_pipeline (filename, demuxer, 16 * 2048 - 1);
+
+  g_print ("%s: pack-aligned %" GST_TIME_FORMAT ", unaligned %"
+      GST_TIME_FORMAT "\n", demuxer, GST_TIME_ARGS (aligned),
+      GST_TIME_ARGS (unaligned));
+
+  return 0;
+}
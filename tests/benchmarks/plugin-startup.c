@@ -0,0 +1,157 @@
+/* GStreamer
+ * Copyright (C) 2013 GStreamer developers
+ *
+ * plugin-startup.c: measure plugin loading and element creation
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 59 Temple Place - Suite 330,
+ * Boston, MA 02111-1307, USA.
+ */
+
+/* For every plugin of this module found in the registry, prints how long it
+ * takes a new process to load the plugin and to create one instance of each
+ * of its elements. Creating the first instance includes initialising the
+ * element class. Every measurement runs in a fresh child process, as a
+ * plugin is only loaded once per process.
+ *
+ * Set GST_PLUGIN_PATH to the build directory to measure uninstalled plugins.
+ *
+ * Usage: plugin-startup [ITERATIONS]
+ */
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <gst/gst.h>
+
+/* child: load @name and create its elements, print the times in ns */
+static gint
+measure_plugin (const gchar * name)
+{
+  GstPlugin *plugin;
+  GList *features, *l;
+  GstClockTime start, load, create = 0;
+
+  start = gst_util_get_timestamp ();
+  plugin = gst_plugin_load_by_name (name);
+  load = gst_util_get_timestamp () - start;
+
+  if (plugin == NULL) {
+    g_printerr ("could not load plugin %s\n", name);
+    return 1;
+  }
+  gst_object_unref (plugin);
+
+  features = gst_registry_get_feature_list_by_plugin (gst_registry_get_default
+      (), name);
+  for (l = features; l; l = l->next) {
+    GstElement *element;
+
+    if (!GST_IS_ELEMENT_FACTORY (l->data))
+      continue;
+
+    start = gst_util_get_timestamp ();
+    element = gst_element_factory_create (GST_ELEMENT_FACTORY (l->data), NULL);
+    create += gst_util_get_timestamp () - start;
+
+    if (element)
+      gst_object_unref (element);
+  }
+  gst_plugin_feature_list_free (features);
+
+  g_print ("%" G_GUINT64_FORMAT " %" G_GUINT64_FORMAT "\n", load, create);
+
+  return 0;
+}
+
+static gboolean
+run_child (const gchar * self, const gchar * name, GstClockTime * load,
+    GstClockTime * create)
+{
+  gchar *argv[] = { (gchar *) self, (gchar *) "--plugin", (gchar *) name,
+    NULL
+  };
+  gchar *out = NULL;
+  gint status;
+  guint64 l, c;
+  gboolean res = FALSE;
+
+  if (!g_spawn_sync (NULL, argv, NULL, 0, NULL, NULL, &out, NULL, &status,
+          NULL))
+    return FALSE;
+
+  if (status == 0 && sscanf (out, "%" G_GUINT64_FORMAT " %" G_GUINT64_FORMAT,
+          &l, &c) == 2) {
+    *load += l;
+    *create += c;
+    res = TRUE;
+  }
+  g_free (out);
+
+  return res;
+}
+
+gint
+main (gint argc, gchar * argv[])
+{
+  GList *plugins, *l;
+  GstClockTime total_load = 0, total_create = 0;
+  gint i, iterations = 5;
+
+  gst_init (&argc, &argv);
+
+  if (argc == 3 && g_str_equal (argv[1], "--plugin"))
+    return measure_plugin (argv[2]);
+
+  if (argc > 1)
+    iterations = MAX (1, atoi (argv[1]));
+
+  g_print ("%-20s %15s %15s\n", "plugin", "load", "create");
+
+  plugins = gst_default_registry_get_plugin_list ();
+  for (l = plugins; l; l = l->next) {
+    GstPlugin *plugin = l->data;
+    const gchar *name = gst_plugin_get_name (plugin);
+    GstClockTime load = 0, create = 0;
+
+    if (g_strcmp0 (gst_plugin_get_source (plugin), PACKAGE) != 0)
+      continue;
+
+    for (i = 0; i < iterations; i++) {
+      if (!run_child (argv[0], name, &load, &create)) {
+        g_printerr ("measuring %s failed\n", name);
+        break;
+      }
+    }
+    if (i < iterations)
+      continue;
+
+    load /= iterations;
+    create /= iterations;
+    g_print ("%-20s %" GST_TIME_FORMAT " %" GST_TIME_FORMAT "\n", name,
+        GST_TIME_ARGS (load), GST_TIME_ARGS (create));
+    total_load += load;
+    total_create += create;
+  }
+  gst_plugin_list_free (plugins);
+
+  g_print ("%-20s %" GST_TIME_FORMAT " %" GST_TIME_FORMAT
+      " (average of %d runs)\n", "total", GST_TIME_ARGS (total_load),
+      GST_TIME_ARGS (total_create), iterations);
+
+  return 0;
+}
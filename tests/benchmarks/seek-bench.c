@@ -0,0 +1,386 @@
+/* GStreamer
+ * Copyright (C) 2013 GStreamer developers
+ *
+ * seek-bench.c: measure seek latency and accuracy
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 59 Temple Place - Suite 330,
+ * Boston, MA 02111-1307, USA.
+ */
+
+/* Prerolls filesrc ! ELEMENTS ! fakesink and then does random flushing,
+ * accurate and key unit seeks in TIME format. For every seek it prints the
+ * time until the pipeline prerolled again, the bytes that went into the
+ * first element, the bytes the process read (from /proc/self/io on Linux)
+ * and where the first buffer after the seek landed compared to the seek
+ * target. A summary per seek type follows.
+ *
+ * ELEMENTS is a chain of element names without properties, like "mpeg2dec",
+ * "mp3parse ! mad" or "asfdemux ! mad". Dynamic pads (asfdemux, rmdemux,
+ * rademux, mpegdemux, dvddemux...) are linked to the next element of the
+ * chain if it accepts them, the first such pad wins. All other output pads
+ * go to a fakesink. dvdreadsrc is used without filesrc, with FILE as its
+ * device.
+ *
+ * Synthetic inputs can be created when the chain starts with asfdemux,
+ * mp3parse or mad.
+ *
+ * Usage: seek-bench ELEMENTS FILE|--synthetic [SEEKS] [SEED]
+ */
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include <stdio.h>
+#include <stdlib.h>
+#ifdef HAVE_UNISTD_H
+#include <unistd.h>
+#endif
+#include <glib/gstdio.h>
+#include <gst/gst.h>
+#include <gst/glib-compat-private.h>
+
+#include "bench-util.h"
+
+typedef struct
+{
+  const gchar *name;
+  GstSeekFlags flags;
+
+  guint count;
+  GstClockTime latency;
+  GstClockTime max_latency;
+  guint64 bytes;
+  GstClockTime error;           /* absolute landing error */
+  GstClockTime max_error;
+} SeekType;
+
+static SeekType seek_types[] = {
+  {"flush", GST_SEEK_FLAG_FLUSH},
+  {"accurate", GST_SEEK_FLAG_FLUSH | GST_SEEK_FLAG_ACCURATE},
+  {"key-unit", GST_SEEK_FLAG_FLUSH | GST_SEEK_FLAG_KEY_UNIT}
+};
+
+static GMutex *lock;
+static guint64 bytes_in;
+/* timestamp of the first buffer after the last flush on any output pad */
+static GstClockTime landed;
+
+static guint64
+read_proc_rchar (void)
+{
+  guint64 syscr, rchar;
+
+  bench_read_proc_io (&syscr, &rchar);
+
+  return rchar != G_MAXUINT64 ? rchar : 0;
+}
+
+static gboolean
+input_probe (GstPad * pad, GstBuffer * buf, gpointer user_data)
+{
+  g_mutex_lock (lock);
+  bytes_in += GST_BUFFER_SIZE (buf);
+  g_mutex_unlock (lock);
+
+  return TRUE;
+}
+
+static gboolean
+output_event_probe (GstPad * pad, GstEvent * event, gpointer user_data)
+{
+  if (GST_EVENT_TYPE (event) == GST_EVENT_FLUSH_STOP)
+    g_object_set_data (G_OBJECT (pad), "armed", GINT_TO_POINTER (1));
+
+  return TRUE;
+}
+
+static gboolean
+output_buffer_probe (GstPad * pad, GstBuffer * buf, gpointer user_data)
+{
+  GstClockTime ts = GST_BUFFER_TIMESTAMP (buf);
+
+  if (!g_object_get_data (G_OBJECT (pad), "armed")
+      || !GST_CLOCK_TIME_IS_VALID (ts))
+    return TRUE;
+  g_object_set_data (G_OBJECT (pad), "armed", NULL);
+
+  /* with several streams, take the one that landed earliest */
+  g_mutex_lock (lock);
+  if (!GST_CLOCK_TIME_IS_VALID (landed) || ts < landed)
+    landed = ts;
+  g_mutex_unlock (lock);
+
+  return TRUE;
+}
+
+static void
+link_output (GstPad * pad, GstBin * pipeline)
+{
+  gst_pad_add_event_probe (pad, G_CALLBACK (output_event_probe), NULL);
+  gst_pad_add_buffer_probe (pad, G_CALLBACK (output_buffer_probe), NULL);
+  bench_link_fakesink (pad, pipeline);
+}
+
+/* links a new pad to the next element in the chain if that is still
+ * unlinked and accepts it, e.g. the audio stream of a demuxer to a decoder.
+ * All other pads go to a fakesink */
+static void
+pad_added_cb (GstElement * element, GstPad * pad, GstBin * pipeline)
+{
+  GstElement *next;
+  GstPad *sinkpad;
+
+  next = g_object_get_data (G_OBJECT (element), "next");
+  if (next) {
+    sinkpad = gst_element_get_static_pad (next, "sink");
+    if (!gst_pad_is_linked (sinkpad) &&
+        gst_pad_link (pad, sinkpad) == GST_PAD_LINK_OK) {
+      gst_object_unref (sinkpad);
+      return;
+    }
+    gst_object_unref (sinkpad);
+  }
+
+  link_output (pad, pipeline);
+}
+
+static gboolean
+wait_preroll (GstElement * pipeline)
+{
+  GstBus *bus;
+  GstMessage *msg;
+  gboolean res;
+
+  bus = gst_element_get_bus (pipeline);
+  msg = gst_bus_poll (bus, GST_MESSAGE_ASYNC_DONE | GST_MESSAGE_ERROR,
+      30 * GST_SECOND);
+  res = msg != NULL && GST_MESSAGE_TYPE (msg) == GST_MESSAGE_ASYNC_DONE;
+  if (msg)
+    gst_message_unref (msg);
+  gst_object_unref (bus);
+
+  return res;
+}
+
+static GstElement *
+make_pipeline (const gchar * elements, const gchar * filename)
+{
+  GstElement *pipeline, *first = NULL, *prev = NULL, *element, *src;
+  GstPad *pad;
+  gchar **names;
+  guint i;
+
+  pipeline = gst_pipeline_new ("pipeline");
+
+  names = g_strsplit (elements, "!", -1);
+  for (i = 0; names[i]; i++) {
+    g_strstrip (names[i]);
+    element = bench_make_element (names[i]);
+    if (element == NULL) {
+      g_printerr ("could not create '%s'\n", names[i]);
+      g_strfreev (names);
+      gst_object_unref (pipeline);
+      return NULL;
+    }
+    gst_bin_add (GST_BIN (pipeline), element);
+
+    /* elements with sometimes pads are linked once the pads appear */
+    if (prev && !gst_element_link (prev, element)) {
+      g_object_set_data (G_OBJECT (prev), "next", element);
+      g_signal_connect (prev, "pad-added", G_CALLBACK (pad_added_cb),
+          pipeline);
+    }
+    if (first == NULL)
+      first = element;
+    prev = element;
+  }
+  g_strfreev (names);
+
+  if ((pad = gst_element_get_static_pad (first, "sink"))) {
+    src = gst_element_factory_make ("filesrc", NULL);
+    g_object_set (src, "location", filename, NULL);
+    gst_bin_add (GST_BIN (pipeline), src);
+    gst_element_link (src, first);
+  } else {
+    /* a source, dvdreadsrc reads images given as device */
+    g_object_set (first, "device", filename, NULL);
+    pad = gst_element_get_static_pad (first, "src");
+  }
+  gst_pad_add_buffer_probe (pad, G_CALLBACK (input_probe), NULL);
+  gst_object_unref (pad);
+
+  if ((pad = gst_element_get_static_pad (prev, "src"))) {
+    link_output (pad, GST_BIN (pipeline));
+    gst_object_unref (pad);
+  } else {
+    g_signal_connect (prev, "pad-added", G_CALLBACK (pad_added_cb),
+        pipeline);
+  }
+
+  return pipeline;
+}
+
+gint
+main (gint argc, gchar * argv[])
+{
+  GstElement *pipeline;
+  GstFormat format = GST_FORMAT_TIME;
+  gint64 duration;
+  gchar *filename, *tmpname = NULL;
+  GRand *rand;
+  guint i, seeks = 50;
+  gint ret = 0;
+
+  gst_init (&argc, &argv);
+
+  if (argc < 3) {
+    g_print ("usage: %s ELEMENTS FILE|--synthetic [SEEKS] [SEED]\n", argv[0]);
+    return 1;
+  }
+  if (argc > 3)
+    seeks = MAX (1, atoi (argv[3]));
+  if (argc > 4)
+    rand = g_rand_new_with_seed (atoi (argv[4]));
+  else
+    rand = g_rand_new_with_seed (0);
+
+  if (g_str_equal (argv[2], "--synthetic")) {
+    gchar **names;
+    gboolean made;
+    gint fd;
+
+    fd = g_file_open_tmp ("seek-bench-XXXXXX", &tmpname, NULL);
+    if (fd < 0)
+      return 1;
+    close (fd);
+    /* the input is made for the first element of the chain */
+    names = g_strsplit (argv[1], "!", 2);
+    made = bench_make_synthetic (g_strstrip (names[0]), 2600, tmpname);
+    g_strfreev (names);
+    if (!made) {
+      g_printerr ("no synthetic input for %s\n", argv[1]);
+      g_unlink (tmpname);
+      return 1;
+    }
+    filename = tmpname;
+  } else {
+    filename = argv[2];
+  }
+
+  lock = g_mutex_new ();
+
+  pipeline = make_pipeline (argv[1], filename);
+  if (pipeline == NULL) {
+    ret = 1;
+    goto done;
+  }
+
+  gst_element_set_state (pipeline, GST_STATE_PAUSED);
+  if (!wait_preroll (pipeline)) {
+    g_printerr ("%s did not preroll\n", argv[1]);
+    ret = 1;
+    goto stop;
+  }
+  if (!gst_element_query_duration (pipeline, &format, &duration) ||
+      duration <= 0) {
+    g_printerr ("%s did not report a duration\n", argv[1]);
+    ret = 1;
+    goto stop;
+  }
+
+  g_print ("%-9s %16s %16s %10s %12s %16s %17s\n", "type", "target",
+      "latency", "bytes", "read bytes", "landed", "error");
+
+  for (i = 0; i < seeks; i++) {
+    SeekType *type = &seek_types[g_rand_int_range (rand, 0,
+            G_N_ELEMENTS (seek_types))];
+    GstClockTime target, start, latency;
+    GstClockTimeDiff error;
+    guint64 rchar, bytes;
+
+    /* stay away from the end, some elements go EOS instead of prerolling */
+    target = g_rand_double (rand) * duration * 0.95;
+
+    g_mutex_lock (lock);
+    bytes_in = 0;
+    landed = GST_CLOCK_TIME_NONE;
+    g_mutex_unlock (lock);
+
+    rchar = read_proc_rchar ();
+    start = gst_util_get_timestamp ();
+    if (!gst_element_seek_simple (pipeline, GST_FORMAT_TIME, type->flags,
+            target)) {
+      g_print ("%-9s %" GST_TIME_FORMAT " seek failed\n", type->name,
+          GST_TIME_ARGS (target));
+      continue;
+    }
+    if (!wait_preroll (pipeline)) {
+      g_print ("%-9s %" GST_TIME_FORMAT " did not preroll\n", type->name,
+          GST_TIME_ARGS (target));
+      continue;
+    }
+    latency = gst_util_get_timestamp () - start;
+    rchar = read_proc_rchar () - rchar;
+
+    g_mutex_lock (lock);
+    bytes = bytes_in;
+    error = GST_CLOCK_TIME_IS_VALID (landed) ?
+        GST_CLOCK_DIFF (target, landed) : 0;
+    g_print ("%-9s %" GST_TIME_FORMAT " %" GST_TIME_FORMAT " %10"
+        G_GUINT64_FORMAT " %12" G_GUINT64_FORMAT " %" GST_TIME_FORMAT " %c%"
+        GST_TIME_FORMAT "\n", type->name, GST_TIME_ARGS (target),
+        GST_TIME_ARGS (latency), bytes, rchar, GST_TIME_ARGS (landed),
+        error < 0 ? '-' : '+', GST_TIME_ARGS (ABS (error)));
+    g_mutex_unlock (lock);
+
+    type->count++;
+    type->latency += latency;
+    type->max_latency = MAX (type->max_latency, latency);
+    type->bytes += bytes;
+    type->error += ABS (error);
+    type->max_error = MAX (type->max_error, (GstClockTime) ABS (error));
+  }
+
+  g_print ("\n%-9s %5s %16s %16s %12s %16s %16s\n", "type", "seeks",
+      "avg latency", "max latency", "avg bytes", "avg error", "max error");
+  for (i = 0; i < G_N_ELEMENTS (seek_types); i++) {
+    SeekType *type = &seek_types[i];
+
+    if (type->count == 0)
+      continue;
+
+    g_print ("%-9s %5u %" GST_TIME_FORMAT " %" GST_TIME_FORMAT " %12"
+        G_GUINT64_FORMAT " %" GST_TIME_FORMAT " %" GST_TIME_FORMAT "\n",
+        type->name, type->count, GST_TIME_ARGS (type->latency / type->count),
+        GST_TIME_ARGS (type->max_latency), type->bytes / type->count,
+        GST_TIME_ARGS (type->error / type->count),
+        GST_TIME_ARGS (type->max_error));
+  }
+
+stop:
+  gst_element_set_state (pipeline, GST_STATE_NULL);
+  gst_object_unref (pipeline);
+
+done:
+  g_mutex_free (lock);
+  g_rand_free (rand);
+  if (tmpname) {
+    g_unlink (tmpname);
+    g_free (tmpname);
+  }
+
+  return ret;
+}
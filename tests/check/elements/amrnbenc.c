@@ -65,16 +65,16 @@ buffer_unref (void *buffer, void *user_data)
   gst_buffer_unref (GST_BUFFER (buffer));
 }
 
-GstElement *
-setup_amrnbenc ()
+static GstElement *
+setup_amrnbenc_full (gboolean dtx)
 {
   GstElement *amrnbenc;
   GstBus *bus;
-  guint64 granulerate_n, granulerate_d;
 
   GST_DEBUG ("setup_amrnbenc");
 
   amrnbenc = gst_check_setup_element ("amrnbenc");
+  g_object_set (amrnbenc, "dtx", dtx, NULL);
   srcpad = gst_check_setup_src_pad (amrnbenc, &srctemplate, NULL);
   sinkpad = gst_check_setup_sink_pad (amrnbenc, &sinktemplate, NULL);
   gst_pad_set_active (srcpad, TRUE);
@@ -91,6 +91,12 @@ setup_amrnbenc ()
   return amrnbenc;
 }
 
+GstElement *
+setup_amrnbenc ()
+{
+  return setup_amrnbenc_full (FALSE);
+}
+
 static void
 cleanup_amrnbenc (GstElement * amrnbenc)
 {
@@ -140,6 +146,59 @@ GST_START_TEST (test_enc)
 
 GST_END_TEST;
 
+/* encode 1 second of digital silence and return the number of output bytes */
+static guint
+encode_silence (void)
+{
+  GList *l;
+  GstClockTime expected_ts = 0;
+  guint total = 0;
+
+  /* 50 frames of 160 samples */
+  push_data (50 * 320, GST_FLOW_OK);
+
+  fail_unless_equals_int (g_list_length (buffers), 50);
+  for (l = buffers; l; l = l->next) {
+    GstBuffer *buf = GST_BUFFER (l->data);
+
+    /* SID and NO_DATA frames cover 20 ms like speech frames */
+    fail_unless_equals_uint64 (GST_BUFFER_TIMESTAMP (buf), expected_ts);
+    fail_unless_equals_uint64 (GST_BUFFER_DURATION (buf), 20 * GST_MSECOND);
+    expected_ts += 20 * GST_MSECOND;
+    total += GST_BUFFER_SIZE (buf);
+  }
+
+  return total;
+}
+
+GST_START_TEST (test_enc_dtx)
+{
+  GstElement *amrnbenc;
+  guint64 speech, sid, no_data;
+  guint size, dtx_size;
+
+  amrnbenc = setup_amrnbenc_full (FALSE);
+  size = encode_silence ();
+  g_object_get (amrnbenc, "sid-frames", &sid, "no-data-frames", &no_data,
+      NULL);
+  fail_unless_equals_uint64 (sid + no_data, 0);
+  cleanup_amrnbenc (amrnbenc);
+
+  amrnbenc = setup_amrnbenc_full (TRUE);
+  dtx_size = encode_silence ();
+  g_object_get (amrnbenc, "speech-frames", &speech, "sid-frames", &sid,
+      "no-data-frames", &no_data, NULL);
+  fail_unless_equals_uint64 (speech + sid + no_data, 50);
+  fail_unless (no_data > 0);
+  cleanup_amrnbenc (amrnbenc);
+
+  GST_INFO ("silence: %u bytes without DTX, %u bytes with DTX", size,
+      dtx_size);
+  fail_unless (dtx_size < size / 2);
+}
+
+GST_END_TEST;
+
 static Suite *
 amrnbenc_suite ()
 {
@@ -148,6 +207,7 @@ amrnbenc_suite ()
 
   suite_add_tcase (s, tc_chain);
   tcase_add_test (tc_chain, test_enc);
+  tcase_add_test (tc_chain, test_enc_dtx);
   return s;
 }
 
@@ -0,0 +1,761 @@
+/* GStreamer
+ *
+ * unit test for asfindexmux
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 59 Temple Place - Suite 330,
+ * Boston, MA 02111-1307, USA.
+ */
+
+#include <unistd.h>
+
+#include <glib/gstdio.h>
+#include <gst/check/gstcheck.h>
+
+/* For ease of programming we use globals to keep refs for our floating
+ * src and sink pads we create; otherwise we always have to do get_pad,
+ * get_peer, and then remove references in every test function */
+static GstPad *mysrcpad, *mysinkpad;
+
+#define VIDEO_CAPS_STRING "video/x-wmv, " \
+                           "wmvversion = (int) 3, " \
+                           "width = (int) 320, " \
+                           "height = (int) 240, " \
+                           "framerate = (fraction) 25/1"
+
+#define NUM_FRAMES        50
+#define KEYFRAME_DISTANCE 10
+#define FRAME_SIZE        1000
+#define FRAME_DURATION    (GST_SECOND / 25)
+
+static GstStaticPadTemplate sinktemplate = GST_STATIC_PAD_TEMPLATE ("sink",
+    GST_PAD_SINK,
+    GST_PAD_ALWAYS,
+    GST_STATIC_CAPS ("video/x-ms-asf"));
+
+static GstStaticPadTemplate srctemplate = GST_STATIC_PAD_TEMPLATE ("src",
+    GST_PAD_SRC,
+    GST_PAD_ALWAYS,
+    GST_STATIC_CAPS (VIDEO_CAPS_STRING));
+
+/* Data Object GUID as it appears in the file */
+static const guint8 data_object_guid[16] = {
+  0x36, 0x26, 0xb2, 0x75, 0x8e, 0x66, 0xcf, 0x11,
+  0xa6, 0xd9, 0x00, 0xaa, 0x00, 0x62, 0xce, 0x6c
+};
+
+/* the data object header is followed by the data packets */
+#define DATA_OBJECT_HEADER_SIZE   (16 + 8 + 16 + 8 + 2)
+/* the default asfindexmux packet size */
+#define PACKET_SIZE               4800
+
+/* Simple Index Object GUID as it appears in the file */
+static const guint8 simple_index_guid[16] = {
+  0x90, 0x08, 0x00, 0x33, 0xb1, 0xe5, 0xcf, 0x11,
+  0x89, 0xf4, 0x00, 0xa0, 0xc9, 0x03, 0x49, 0xcb
+};
+
+/* the sink pad has to accept the byte newsegment event asfindexmux sends before
+ * rewriting the header, otherwise the header is not updated at EOS */
+static gboolean
+sink_event (GstPad * pad, GstEvent * event)
+{
+  gst_event_unref (event);
+  return TRUE;
+}
+
+static GstElement *
+setup_asfindexmux (void)
+{
+  GstElement *asfindexmux;
+  GstPad *sinkpad;
+
+  GST_DEBUG ("setup_asfindexmux");
+  asfindexmux = gst_check_setup_element ("asfindexmux");
+
+  mysrcpad = gst_pad_new_from_static_template (&srctemplate, "src");
+  fail_unless (mysrcpad != NULL);
+  sinkpad = gst_element_get_request_pad (asfindexmux, "video_%d");
+  fail_unless (sinkpad != NULL);
+  fail_unless (gst_pad_link (mysrcpad, sinkpad) == GST_PAD_LINK_OK);
+  gst_object_unref (sinkpad);
+
+  mysinkpad = gst_check_setup_sink_pad (asfindexmux, &sinktemplate, NULL);
+  gst_pad_set_event_function (mysinkpad, sink_event);
+
+  gst_pad_set_active (mysrcpad, TRUE);
+  gst_pad_set_active (mysinkpad, TRUE);
+
+  return asfindexmux;
+}
+
+static void
+cleanup_asfindexmux (GstElement * asfindexmux)
+{
+  GstPad *sinkpad;
+
+  GST_DEBUG ("cleanup_asfindexmux");
+  gst_element_set_state (asfindexmux, GST_STATE_NULL);
+
+  gst_pad_set_active (mysrcpad, FALSE);
+  gst_pad_set_active (mysinkpad, FALSE);
+  sinkpad = gst_pad_get_peer (mysrcpad);
+  gst_pad_unlink (mysrcpad, sinkpad);
+  gst_element_release_request_pad (asfindexmux, sinkpad);
+  gst_object_unref (sinkpad);
+  gst_object_unref (mysrcpad);
+  mysrcpad = NULL;
+  gst_check_teardown_sink_pad (asfindexmux);
+  gst_check_teardown_element (asfindexmux);
+
+  g_list_foreach (buffers, (GFunc) gst_mini_object_unref, NULL);
+  g_list_free (buffers);
+  buffers = NULL;
+}
+
+/* muxes NUM_FRAMES video frames with a keyframe every KEYFRAME_DISTANCE
+ * frames and returns the resulting file, with the rewritten header applied */
+static GByteArray *
+mux_frames (void)
+{
+  GstElement *asfindexmux;
+  GstBuffer *inbuffer;
+  GByteArray *file;
+  GstCaps *caps;
+  GList *l;
+  gint i;
+
+  asfindexmux = setup_asfindexmux ();
+  fail_unless (gst_element_set_state (asfindexmux,
+          GST_STATE_PLAYING) == GST_STATE_CHANGE_SUCCESS,
+      "could not set to playing");
+
+  caps = gst_caps_from_string (VIDEO_CAPS_STRING);
+  fail_unless (gst_pad_set_caps (mysrcpad, caps));
+  fail_unless (gst_pad_push_event (mysrcpad,
+          gst_event_new_new_segment (FALSE, 1.0, GST_FORMAT_TIME, 0, -1, 0)));
+
+  for (i = 0; i < NUM_FRAMES; i++) {
+    inbuffer = gst_buffer_new_and_alloc (FRAME_SIZE);
+    memset (GST_BUFFER_DATA (inbuffer), i, FRAME_SIZE);
+    gst_buffer_set_caps (inbuffer, caps);
+    GST_BUFFER_TIMESTAMP (inbuffer) = i * FRAME_DURATION;
+    GST_BUFFER_DURATION (inbuffer) = FRAME_DURATION;
+    if (i % KEYFRAME_DISTANCE != 0)
+      GST_BUFFER_FLAG_SET (inbuffer, GST_BUFFER_FLAG_DELTA_UNIT);
+    fail_unless (gst_pad_push (mysrcpad, inbuffer) == GST_FLOW_OK);
+  }
+  gst_caps_unref (caps);
+
+  fail_unless (gst_pad_push_event (mysrcpad, gst_event_new_eos ()));
+
+  /* header, data packets, index and the rewritten header */
+  fail_unless (g_list_length (buffers) >= 4);
+
+  file = g_byte_array_new ();
+  for (l = buffers; l; l = l->next) {
+    GstBuffer *outbuffer = GST_BUFFER (l->data);
+    guint64 offset = GST_BUFFER_OFFSET (outbuffer);
+
+    fail_unless (GST_BUFFER_OFFSET_IS_VALID (outbuffer));
+    fail_unless (offset <= file->len);
+    if (offset + GST_BUFFER_SIZE (outbuffer) > file->len)
+      g_byte_array_set_size (file, offset + GST_BUFFER_SIZE (outbuffer));
+    memcpy (file->data + offset, GST_BUFFER_DATA (outbuffer),
+        GST_BUFFER_SIZE (outbuffer));
+  }
+
+  cleanup_asfindexmux (asfindexmux);
+
+  return file;
+}
+
+/* collects the output of asfindexmux in a pipeline, at the buffer offsets */
+static void
+mux_handoff (GstElement * sink, GstBuffer * buf, GstPad * pad,
+    GByteArray * file)
+{
+  guint64 offset = GST_BUFFER_OFFSET (buf);
+
+  fail_unless (GST_BUFFER_OFFSET_IS_VALID (buf));
+  fail_unless (offset <= file->len);
+  if (offset + GST_BUFFER_SIZE (buf) > file->len)
+    g_byte_array_set_size (file, offset + GST_BUFFER_SIZE (buf));
+  memcpy (file->data + offset, GST_BUFFER_DATA (buf), GST_BUFFER_SIZE (buf));
+}
+
+static GstElement *
+add_video_src (GstElement * pipeline, GstElement * asfindexmux)
+{
+  GstElement *src;
+  GstCaps *caps;
+  GstPad *srcpad, *sinkpad;
+
+  src = gst_element_factory_make ("appsrc", NULL);
+  fail_unless (src != NULL);
+  caps = gst_caps_from_string (VIDEO_CAPS_STRING);
+  g_object_set (src, "caps", caps, "format", GST_FORMAT_TIME, NULL);
+  gst_caps_unref (caps);
+  gst_bin_add (GST_BIN (pipeline), src);
+
+  srcpad = gst_element_get_static_pad (src, "src");
+  sinkpad = gst_element_get_request_pad (asfindexmux, "video_%d");
+  fail_unless (sinkpad != NULL);
+  fail_unless (gst_pad_link (srcpad, sinkpad) == GST_PAD_LINK_OK);
+  gst_object_unref (srcpad);
+  gst_object_unref (sinkpad);
+
+  return src;
+}
+
+/* queues @n_frames keyframes starting at @start on @src, then EOS */
+static void
+push_video (GstElement * src, guint n_frames, GstClockTime start, guint8 fill)
+{
+  GstFlowReturn ret;
+  GstBuffer *buf;
+  guint i;
+
+  for (i = 0; i < n_frames; i++) {
+    buf = gst_buffer_new_and_alloc (FRAME_SIZE);
+    memset (GST_BUFFER_DATA (buf), fill, FRAME_SIZE);
+    GST_BUFFER_TIMESTAMP (buf) = start + i * FRAME_DURATION;
+    GST_BUFFER_DURATION (buf) = FRAME_DURATION;
+    g_signal_emit_by_name (src, "push-buffer", buf, &ret);
+    gst_buffer_unref (buf);
+    fail_unless (ret == GST_FLOW_OK);
+  }
+  g_signal_emit_by_name (src, "end-of-stream", &ret);
+}
+
+/* muxes NUM_FRAMES frames filled with 1 from time 0 and 10 frames filled
+ * with 2 from @second_start into a file without preroll, so asfdemux only
+ * waits the minimum preroll of 500ms in low-latency mode */
+static GByteArray *
+mux_two_streams (GstClockTime second_start)
+{
+  GstElement *pipeline, *asfindexmux, *sink, *src1, *src2;
+  GByteArray *file;
+  GstMessage *msg;
+  GstBus *bus;
+
+  file = g_byte_array_new ();
+
+  pipeline = gst_pipeline_new ("pipeline");
+  asfindexmux = gst_element_factory_make ("asfindexmux", NULL);
+  sink = gst_element_factory_make ("fakesink", NULL);
+  fail_unless (asfindexmux != NULL && sink != NULL);
+  g_object_set (asfindexmux, "preroll", (guint64) 0, NULL);
+  g_object_set (sink, "sync", FALSE, "signal-handoffs", TRUE, NULL);
+  g_signal_connect (sink, "handoff", G_CALLBACK (mux_handoff), file);
+  gst_bin_add_many (GST_BIN (pipeline), asfindexmux, sink, NULL);
+  fail_unless (gst_element_link (asfindexmux, sink));
+
+  src1 = add_video_src (pipeline, asfindexmux);
+  src2 = add_video_src (pipeline, asfindexmux);
+  push_video (src1, NUM_FRAMES, 0, 1);
+  push_video (src2, 10, second_start, 2);
+
+  fail_if (gst_element_set_state (pipeline,
+          GST_STATE_PLAYING) == GST_STATE_CHANGE_FAILURE);
+  bus = gst_element_get_bus (pipeline);
+  msg = gst_bus_poll (bus, GST_MESSAGE_EOS | GST_MESSAGE_ERROR, -1);
+  fail_unless (GST_MESSAGE_TYPE (msg) == GST_MESSAGE_EOS);
+  gst_message_unref (msg);
+  gst_object_unref (bus);
+
+  gst_element_set_state (pipeline, GST_STATE_NULL);
+  gst_object_unref (pipeline);
+
+  return file;
+}
+
+static gchar *
+write_temp_file (GByteArray * file)
+{
+  GError *err = NULL;
+  gchar *filename;
+  gint fd;
+
+  fd = g_file_open_tmp ("asfindexmux-test-XXXXXX.asf", &filename, &err);
+  fail_unless (fd >= 0, "could not create temp file: %s",
+      (err) ? err->message : "");
+  fail_unless (write (fd, file->data, file->len) == (gssize) file->len);
+  close (fd);
+
+  return filename;
+}
+
+/* what came out of asfdemux */
+static GList *demuxed;
+static GstClockTime newsegment_start;
+
+static gboolean
+demux_buffer_probe (GstPad * pad, GstBuffer * buf, gpointer user_data)
+{
+  demuxed = g_list_append (demuxed, gst_buffer_ref (buf));
+  return TRUE;
+}
+
+static gboolean
+demux_event_probe (GstPad * pad, GstEvent * event, gpointer user_data)
+{
+  if (GST_EVENT_TYPE (event) == GST_EVENT_NEWSEGMENT) {
+    gint64 start;
+
+    gst_event_parse_new_segment (event, NULL, NULL, NULL, &start, NULL, NULL);
+    newsegment_start = start;
+  }
+  return TRUE;
+}
+
+static void
+demux_pad_added (GstElement * demux, GstPad * pad, GstBin * pipeline)
+{
+  GstElement *sink;
+  GstPad *sinkpad;
+
+  sink = gst_element_factory_make ("fakesink", NULL);
+  fail_unless (sink != NULL);
+  g_object_set (sink, "sync", FALSE, "async", FALSE, NULL);
+  gst_bin_add (pipeline, sink);
+  gst_element_set_state (sink, GST_STATE_PLAYING);
+
+  gst_pad_add_buffer_probe (pad, G_CALLBACK (demux_buffer_probe), NULL);
+  gst_pad_add_event_probe (pad, G_CALLBACK (demux_event_probe), NULL);
+
+  sinkpad = gst_element_get_static_pad (sink, "sink");
+  fail_unless (gst_pad_link (pad, sinkpad) == GST_PAD_LINK_OK);
+  gst_object_unref (sinkpad);
+}
+
+static void
+clear_demuxed (void)
+{
+  g_list_foreach (demuxed, (GFunc) gst_mini_object_unref, NULL);
+  g_list_free (demuxed);
+  demuxed = NULL;
+  newsegment_start = GST_CLOCK_TIME_NONE;
+}
+
+static void
+wait_for_eos (GstElement * pipeline)
+{
+  GstMessage *msg;
+  GstBus *bus;
+
+  bus = gst_element_get_bus (pipeline);
+  msg = gst_bus_poll (bus, GST_MESSAGE_EOS | GST_MESSAGE_ERROR, -1);
+  fail_unless (GST_MESSAGE_TYPE (msg) == GST_MESSAGE_EOS);
+  gst_message_unref (msg);
+  gst_object_unref (bus);
+}
+
+GST_START_TEST (test_mux_and_demux)
+{
+  GByteArray *file;
+  gchar *filename;
+  GstElement *pipeline, *src, *demux;
+  GList *l;
+  guint i;
+
+  file = mux_frames ();
+  filename = write_temp_file (file);
+
+  pipeline = gst_pipeline_new ("pipeline");
+  src = gst_element_factory_make ("filesrc", NULL);
+  demux = gst_element_factory_make ("asfdemux", NULL);
+  fail_unless (src != NULL && demux != NULL);
+  g_object_set (src, "location", filename, NULL);
+  gst_bin_add_many (GST_BIN (pipeline), src, demux, NULL);
+  fail_unless (gst_element_link (src, demux));
+  g_signal_connect (demux, "pad-added", G_CALLBACK (demux_pad_added),
+      pipeline);
+
+  clear_demuxed ();
+  fail_if (gst_element_set_state (pipeline,
+          GST_STATE_PLAYING) == GST_STATE_CHANGE_FAILURE);
+  wait_for_eos (pipeline);
+
+  /* every frame comes out once, in order, with its keyframe flag */
+  fail_unless_equals_int (g_list_length (demuxed), NUM_FRAMES);
+  for (l = demuxed, i = 0; l; l = l->next, i++) {
+    GstBuffer *buf = GST_BUFFER (l->data);
+
+    fail_unless_equals_int (GST_BUFFER_SIZE (buf), FRAME_SIZE);
+    fail_unless_equals_int (GST_BUFFER_DATA (buf)[0], i);
+    fail_unless_equals_uint64 (GST_BUFFER_TIMESTAMP (buf), i * FRAME_DURATION);
+    if (i % KEYFRAME_DISTANCE == 0)
+      fail_if (GST_BUFFER_FLAG_IS_SET (buf, GST_BUFFER_FLAG_DELTA_UNIT));
+    else
+      fail_unless (GST_BUFFER_FLAG_IS_SET (buf, GST_BUFFER_FLAG_DELTA_UNIT));
+  }
+
+  gst_element_set_state (pipeline, GST_STATE_NULL);
+  gst_object_unref (pipeline);
+  clear_demuxed ();
+
+  g_unlink (filename);
+  g_free (filename);
+  g_byte_array_free (file, TRUE);
+}
+
+GST_END_TEST;
+
+GST_START_TEST (test_simple_index_seek)
+{
+  GByteArray *file;
+  gchar *filename;
+  GstElement *pipeline, *src, *demux;
+  GstBuffer *buf;
+  gboolean found = FALSE;
+  guint i;
+
+  file = mux_frames ();
+
+  /* the index is appended after the data object */
+  for (i = 0; i + sizeof (simple_index_guid) <= file->len; i++) {
+    if (memcmp (file->data + i, simple_index_guid,
+            sizeof (simple_index_guid)) == 0) {
+      found = TRUE;
+      break;
+    }
+  }
+  fail_unless (found, "no simple index written");
+
+  filename = write_temp_file (file);
+
+  pipeline = gst_pipeline_new ("pipeline");
+  src = gst_element_factory_make ("filesrc", NULL);
+  demux = gst_element_factory_make ("asfdemux", NULL);
+  fail_unless (src != NULL && demux != NULL);
+  g_object_set (src, "location", filename, NULL);
+  gst_bin_add_many (GST_BIN (pipeline), src, demux, NULL);
+  fail_unless (gst_element_link (src, demux));
+  g_signal_connect (demux, "pad-added", G_CALLBACK (demux_pad_added),
+      pipeline);
+
+  clear_demuxed ();
+  fail_if (gst_element_set_state (pipeline,
+          GST_STATE_PLAYING) == GST_STATE_CHANGE_FAILURE);
+  wait_for_eos (pipeline);
+  clear_demuxed ();
+
+  /* 1.1s is between the keyframes at 0.8s and 1.2s. The index entry for 1s
+   * points at the packet holding the keyframe at 0.8s; without the index
+   * asfdemux would estimate a packet and start somewhere else. */
+  fail_unless (gst_element_seek_simple (pipeline, GST_FORMAT_TIME,
+          GST_SEEK_FLAG_FLUSH | GST_SEEK_FLAG_KEY_UNIT,
+          11 * GST_SECOND / 10));
+  wait_for_eos (pipeline);
+
+  fail_unless (demuxed != NULL);
+  buf = GST_BUFFER (demuxed->data);
+  fail_unless_equals_uint64 (GST_BUFFER_TIMESTAMP (buf),
+      2 * KEYFRAME_DISTANCE * FRAME_DURATION);
+  fail_if (GST_BUFFER_FLAG_IS_SET (buf, GST_BUFFER_FLAG_DELTA_UNIT));
+  fail_unless_equals_uint64 (newsegment_start,
+      2 * KEYFRAME_DISTANCE * FRAME_DURATION);
+  fail_unless_equals_int (g_list_length (demuxed),
+      NUM_FRAMES - 2 * KEYFRAME_DISTANCE);
+
+  gst_element_set_state (pipeline, GST_STATE_NULL);
+  gst_object_unref (pipeline);
+  clear_demuxed ();
+
+  g_unlink (filename);
+  g_free (filename);
+  g_byte_array_free (file, TRUE);
+}
+
+GST_END_TEST;
+
+/* pads added so far, and when no-more-pads came */
+static guint pads_added;
+static guint pads_at_no_more_pads;
+static guint no_more_pads_count;
+
+static void
+count_pad_added (GstElement * demux, GstPad * pad, gpointer user_data)
+{
+  pads_added++;
+}
+
+static void
+demux_no_more_pads (GstElement * demux, gpointer user_data)
+{
+  pads_at_no_more_pads = pads_added;
+  no_more_pads_count++;
+}
+
+/* demuxes @file with asfdemux, optionally in low-latency mode */
+static void
+demux_file (GByteArray * file, gboolean low_latency)
+{
+  GstElement *pipeline, *src, *demux;
+  gchar *filename;
+  gboolean prop_low_latency;
+
+  filename = write_temp_file (file);
+
+  pipeline = gst_pipeline_new ("pipeline");
+  src = gst_element_factory_make ("filesrc", NULL);
+  demux = gst_element_factory_make ("asfdemux", NULL);
+  fail_unless (src != NULL && demux != NULL);
+  g_object_set (src, "location", filename, NULL);
+  g_object_set (demux, "low-latency", low_latency, NULL);
+  g_object_get (demux, "low-latency", &prop_low_latency, NULL);
+  fail_unless_equals_int (prop_low_latency, low_latency);
+  gst_bin_add_many (GST_BIN (pipeline), src, demux, NULL);
+  fail_unless (gst_element_link (src, demux));
+  g_signal_connect (demux, "pad-added", G_CALLBACK (count_pad_added), NULL);
+  g_signal_connect (demux, "pad-added", G_CALLBACK (demux_pad_added),
+      pipeline);
+  g_signal_connect (demux, "no-more-pads", G_CALLBACK (demux_no_more_pads),
+      NULL);
+
+  clear_demuxed ();
+  pads_added = pads_at_no_more_pads = no_more_pads_count = 0;
+  fail_if (gst_element_set_state (pipeline,
+          GST_STATE_PLAYING) == GST_STATE_CHANGE_FAILURE);
+  wait_for_eos (pipeline);
+
+  gst_element_set_state (pipeline, GST_STATE_NULL);
+  gst_object_unref (pipeline);
+
+  g_unlink (filename);
+  g_free (filename);
+}
+
+static guint
+count_demuxed (guint8 fill)
+{
+  GList *l;
+  guint n = 0;
+
+  for (l = demuxed; l; l = l->next) {
+    if (GST_BUFFER_DATA (GST_BUFFER (l->data))[0] == fill)
+      n++;
+  }
+
+  return n;
+}
+
+/* a stream that starts after the first one but within the preroll gets its
+ * pad, and no-more-pads only comes after that */
+GST_START_TEST (test_low_latency_late_stream)
+{
+  GByteArray *file;
+
+  file = mux_two_streams (200 * GST_MSECOND);
+  demux_file (file, TRUE);
+
+  fail_unless_equals_int (pads_added, 2);
+  fail_unless_equals_int (no_more_pads_count, 1);
+  fail_unless_equals_int (pads_at_no_more_pads, 2);
+  fail_unless_equals_int (count_demuxed (1), NUM_FRAMES);
+  fail_unless_equals_int (count_demuxed (2), 10);
+
+  clear_demuxed ();
+  g_byte_array_free (file, TRUE);
+}
+
+GST_END_TEST;
+
+/* a stream without data within the preroll is given up on: no-more-pads is
+ * signalled and the stream gets no pad when its data shows up */
+GST_START_TEST (test_low_latency_preroll_expired)
+{
+  GByteArray *file;
+
+  file = mux_two_streams (1500 * GST_MSECOND);
+  demux_file (file, TRUE);
+
+  fail_unless_equals_int (pads_added, 1);
+  fail_unless_equals_int (no_more_pads_count, 1);
+  fail_unless_equals_int (pads_at_no_more_pads, 1);
+  fail_unless_equals_int (count_demuxed (1), NUM_FRAMES);
+  fail_unless_equals_int (count_demuxed (2), 0);
+
+  clear_demuxed ();
+  g_byte_array_free (file, TRUE);
+}
+
+GST_END_TEST;
+
+/* returns the offset of the first data packet of @file and their number */
+static guint
+find_data_packets (GByteArray * file, guint * n_packets)
+{
+  guint64 size;
+  guint i;
+
+  for (i = 0; i + DATA_OBJECT_HEADER_SIZE <= file->len; i++) {
+    if (memcmp (file->data + i, data_object_guid,
+            sizeof (data_object_guid)) == 0)
+      break;
+  }
+  fail_unless (i + DATA_OBJECT_HEADER_SIZE <= file->len, "no data object");
+
+  size = GST_READ_UINT64_LE (file->data + i + 16);
+  fail_unless (size >= DATA_OBJECT_HEADER_SIZE);
+  fail_unless_equals_int ((size - DATA_OBJECT_HEADER_SIZE) % PACKET_SIZE, 0);
+  *n_packets = (size - DATA_OBJECT_HEADER_SIZE) / PACKET_SIZE;
+
+  return i + DATA_OBJECT_HEADER_SIZE;
+}
+
+/* Rewrites every @step-th data packet from packet @first on from the WORD
+ * padding length asfindexmux writes to a BYTE padding length. The rest of the
+ * packet moves forward by one byte and the padding grows by one, so the
+ * payloads stay the same but the packet header has a different layout.
+ * Packets with too much padding for a byte are left alone. Returns the
+ * number of rewritten packets. */
+static guint
+rewrite_packet_layouts (GByteArray * file, guint first, guint step)
+{
+  guint offset, n_packets, padding, i, n = 0;
+  guint8 *data;
+
+  offset = find_data_packets (file, &n_packets);
+  fail_unless (offset + n_packets * PACKET_SIZE <= file->len);
+
+  for (i = first; i < n_packets; i += step) {
+    data = file->data + offset + i * PACKET_SIZE;
+
+    /* error correction, multiple payloads with a WORD padding length */
+    fail_unless_equals_int (data[0], 0x82);
+    fail_unless_equals_int (data[3], 0x11);
+    padding = GST_READ_UINT16_LE (data + 5);
+    if (padding >= G_MAXUINT8)
+      continue;
+
+    data[3] = 0x09;
+    data[5] = padding + 1;
+    memmove (data + 6, data + 7, PACKET_SIZE - 7);
+    data[PACKET_SIZE - 1] = 0;
+    n++;
+  }
+
+  return n;
+}
+
+/* demuxes @file and checks that the same buffers as in @expected come out */
+static void
+check_same_payloads (GByteArray * file, GList * expected)
+{
+  GList *l, *e;
+
+  demux_file (file, FALSE);
+
+  fail_unless_equals_int (g_list_length (demuxed), g_list_length (expected));
+  for (l = demuxed, e = expected; l; l = l->next, e = e->next) {
+    GstBuffer *buf = GST_BUFFER (l->data);
+    GstBuffer *ref = GST_BUFFER (e->data);
+
+    fail_unless_equals_int (GST_BUFFER_SIZE (buf), GST_BUFFER_SIZE (ref));
+    fail_unless (memcmp (GST_BUFFER_DATA (buf), GST_BUFFER_DATA (ref),
+            GST_BUFFER_SIZE (ref)) == 0);
+    fail_unless_equals_uint64 (GST_BUFFER_TIMESTAMP (buf),
+        GST_BUFFER_TIMESTAMP (ref));
+    fail_unless_equals_int (GST_BUFFER_FLAG_IS_SET (buf,
+            GST_BUFFER_FLAG_DELTA_UNIT), GST_BUFFER_FLAG_IS_SET (ref,
+            GST_BUFFER_FLAG_DELTA_UNIT));
+  }
+
+  clear_demuxed ();
+}
+
+/* asfdemux parses packets at fixed offsets once two packets in a row have
+ * the same header layout, and with the generic parser otherwise. Both must
+ * give the same payloads, also when the layout changes in the middle */
+GST_START_TEST (test_packet_layouts)
+{
+  GByteArray *file, *changed;
+  GList *expected, *l;
+  guint n_packets, i;
+
+  file = mux_frames ();
+  find_data_packets (file, &n_packets);
+  fail_unless (n_packets >= 6);
+
+  /* one layout: all but the first packets take the fast path */
+  demux_file (file, FALSE);
+  expected = demuxed;
+  demuxed = NULL;
+
+  fail_unless_equals_int (g_list_length (expected), NUM_FRAMES);
+  for (l = expected, i = 0; l; l = l->next, i++) {
+    GstBuffer *buf = GST_BUFFER (l->data);
+    guint j;
+
+    fail_unless_equals_int (GST_BUFFER_SIZE (buf), FRAME_SIZE);
+    for (j = 0; j < FRAME_SIZE; j++)
+      fail_unless_equals_int (GST_BUFFER_DATA (buf)[j], i);
+  }
+
+  /* the layout changes halfway: the first packets of the new layout go
+   * through the generic parser, the later ones through the fast path */
+  changed = g_byte_array_new ();
+  g_byte_array_append (changed, file->data, file->len);
+  fail_unless (rewrite_packet_layouts (changed, n_packets / 2, 1) > 1);
+  check_same_payloads (changed, expected);
+  g_byte_array_free (changed, TRUE);
+
+  /* alternating layouts: the packets go through the generic parser */
+  changed = g_byte_array_new ();
+  g_byte_array_append (changed, file->data, file->len);
+  fail_unless (rewrite_packet_layouts (changed, 1, 2) > 1);
+  check_same_payloads (changed, expected);
+  g_byte_array_free (changed, TRUE);
+
+  g_list_foreach (expected, (GFunc) gst_mini_object_unref, NULL);
+  g_list_free (expected);
+  g_byte_array_free (file, TRUE);
+}
+
+GST_END_TEST;
+
+static Suite *
+asfindexmux_suite (void)
+{
+  Suite *s = suite_create ("asfindexmux");
+  TCase *tc_chain = tcase_create ("general");
+
+  suite_add_tcase (s, tc_chain);
+  tcase_add_test (tc_chain, test_mux_and_demux);
+  tcase_add_test (tc_chain, test_simple_index_seek);
+  tcase_add_test (tc_chain, test_low_latency_late_stream);
+  tcase_add_test (tc_chain, test_low_latency_preroll_expired);
+  tcase_add_test (tc_chain, test_packet_layouts);
+
+  return s;
+}
+
+int
+main (int argc, char **argv)
+{
+  int nf;
+
+  Suite *s = asfindexmux_suite ();
+  SRunner *sr = srunner_create (s);
+
+  gst_check_init (&argc, &argv);
+
+  srunner_run_all (sr, CK_NORMAL);
+  nf = srunner_ntests_failed (sr);
+  srunner_free (sr);
+
+  return nf;
+}
@@ -0,0 +1,254 @@
+/* GStreamer
+ *
+ * unit test for dvdlpcmdec
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 59 Temple Place - Suite 330,
+ * Boston, MA 02111-1307, USA.
+ */
+
+#include <unistd.h>
+#include <math.h>
+
+#include <gst/check/gstcheck.h>
+
+/* For ease of programming we use globals to keep refs for our floating
+ * src and sink pads we create; otherwise we always have to do get_pad,
+ * get_peer, and then remove references in every test function */
+static GstPad *mysrcpad, *mysinkpad;
+
+#define LPCM_CAPS_STRING "audio/x-lpcm, " \
+    "rate = (int) 48000, " \
+    "dynamic_range = (int) 0, " \
+    "emphasis = (boolean) false, " \
+    "mute = (boolean) false"
+
+static GstStaticPadTemplate sinktemplate = GST_STATIC_PAD_TEMPLATE ("sink",
+    GST_PAD_SINK,
+    GST_PAD_ALWAYS,
+    GST_STATIC_CAPS ("audio/x-raw-int"));
+
+static GstStaticPadTemplate srctemplate = GST_STATIC_PAD_TEMPLATE ("src",
+    GST_PAD_SRC,
+    GST_PAD_ALWAYS,
+    GST_STATIC_CAPS ("audio/x-lpcm"));
+
+static GstElement *
+setup_dvdlpcmdec (void)
+{
+  GstElement *dvdlpcmdec;
+
+  GST_DEBUG ("setup_dvdlpcmdec");
+  dvdlpcmdec = gst_check_setup_element ("dvdlpcmdec");
+  mysrcpad = gst_check_setup_src_pad (dvdlpcmdec, &srctemplate, NULL);
+  mysinkpad = gst_check_setup_sink_pad (dvdlpcmdec, &sinktemplate, NULL);
+  gst_pad_set_active (mysrcpad, TRUE);
+  gst_pad_set_active (mysinkpad, TRUE);
+
+  return dvdlpcmdec;
+}
+
+static void
+cleanup_dvdlpcmdec (GstElement * dvdlpcmdec)
+{
+  GST_DEBUG ("cleanup_dvdlpcmdec");
+  gst_element_set_state (dvdlpcmdec, GST_STATE_NULL);
+
+  g_list_foreach (buffers, (GFunc) gst_mini_object_unref, NULL);
+  g_list_free (buffers);
+  buffers = NULL;
+
+  gst_pad_set_active (mysrcpad, FALSE);
+  gst_pad_set_active (mysinkpad, FALSE);
+  gst_check_teardown_src_pad (dvdlpcmdec);
+  gst_check_teardown_sink_pad (dvdlpcmdec);
+  gst_check_teardown_element (dvdlpcmdec);
+}
+
+/* pushes @size bytes of raw LPCM of @width bits and returns the single
+ * output buffer */
+static GstBuffer *
+push_lpcm (GstElement * dvdlpcmdec, gint width, gint channels,
+    const guint8 * data, guint size)
+{
+  GstBuffer *inbuffer;
+  GstCaps *caps;
+
+  caps = gst_caps_from_string (LPCM_CAPS_STRING);
+  gst_caps_set_simple (caps, "width", G_TYPE_INT, width, "channels",
+      G_TYPE_INT, channels, NULL);
+
+  inbuffer = gst_buffer_new_and_alloc (size);
+  memcpy (GST_BUFFER_DATA (inbuffer), data, size);
+  GST_BUFFER_TIMESTAMP (inbuffer) = 0;
+  gst_buffer_set_caps (inbuffer, caps);
+  gst_caps_unref (caps);
+
+  fail_unless (gst_pad_push (mysrcpad, inbuffer) == GST_FLOW_OK);
+  fail_unless_equals_int (g_list_length (buffers), 1);
+
+  return GST_BUFFER (buffers->data);
+}
+
+/* four 20-bit samples: the upper 16 bits of each, then the low nibbles of
+ * the first two samples and of the last two samples */
+static const guint8 lpcm_20bit[] = {
+  0x12, 0x34, 0x56, 0x78, 0x9a, 0xbc, 0xde, 0xf0, 0xa5, 0xc3
+};
+
+/* the same samples in 24 bits, with the lowest nibble cleared */
+static const guint8 lpcm_20bit_unpacked[] = {
+  0x12, 0x34, 0xa0, 0x56, 0x78, 0x50, 0x9a, 0xbc, 0xc0, 0xde, 0xf0, 0x30
+};
+
+GST_START_TEST (test_20bit_unpack)
+{
+  GstElement *dvdlpcmdec;
+  GstBuffer *outbuffer;
+
+  dvdlpcmdec = setup_dvdlpcmdec ();
+  fail_unless (gst_element_set_state (dvdlpcmdec,
+          GST_STATE_PLAYING) == GST_STATE_CHANGE_SUCCESS,
+      "could not set to playing");
+
+  outbuffer = push_lpcm (dvdlpcmdec, 20, 2, lpcm_20bit, sizeof (lpcm_20bit));
+  fail_unless_equals_int (GST_BUFFER_SIZE (outbuffer),
+      sizeof (lpcm_20bit_unpacked));
+  fail_unless (memcmp (GST_BUFFER_DATA (outbuffer), lpcm_20bit_unpacked,
+          sizeof (lpcm_20bit_unpacked)) == 0);
+
+  cleanup_dvdlpcmdec (dvdlpcmdec);
+}
+
+GST_END_TEST;
+
+/* 16-bit samples 0x1000, 0x4000, -0x4000 and 0 */
+static const guint8 lpcm_16bit[] = {
+  0x10, 0x00, 0x40, 0x00, 0xc0, 0x00, 0x00, 0x00
+};
+
+/* 24-bit samples 0x100000, 0x300000, -0x300000 and 0 */
+static const guint8 lpcm_24bit[] = {
+  0x10, 0x00, 0x30, 0x00, 0xd0, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00
+};
+
+static void
+check_sample (gint32 sample, gdouble expected)
+{
+  /* the gain is applied in fixed point */
+  fail_unless (ABS (sample - expected) <= 1.0,
+      "sample %d, expected %.1f", sample, expected);
+}
+
+/* samples that exceed full scale after the gain saturate */
+GST_START_TEST (test_gain_clipping)
+{
+  GstElement *dvdlpcmdec;
+  GstBuffer *outbuffer;
+  const guint8 *data;
+  gdouble factor = pow (10.0, 12.0 / 20.0);
+
+  dvdlpcmdec = setup_dvdlpcmdec ();
+  g_object_set (dvdlpcmdec, "gain", 12.0, NULL);
+  fail_unless (gst_element_set_state (dvdlpcmdec,
+          GST_STATE_PLAYING) == GST_STATE_CHANGE_SUCCESS,
+      "could not set to playing");
+
+  outbuffer = push_lpcm (dvdlpcmdec, 16, 1, lpcm_16bit, sizeof (lpcm_16bit));
+  fail_unless_equals_int (GST_BUFFER_SIZE (outbuffer), sizeof (lpcm_16bit));
+  data = GST_BUFFER_DATA (outbuffer);
+  check_sample ((gint16) GST_READ_UINT16_BE (data), 0x1000 * factor);
+  fail_unless_equals_int ((gint16) GST_READ_UINT16_BE (data + 2), 32767);
+  fail_unless_equals_int ((gint16) GST_READ_UINT16_BE (data + 4), -32768);
+  fail_unless_equals_int ((gint16) GST_READ_UINT16_BE (data + 6), 0);
+
+  gst_buffer_unref (outbuffer);
+  g_list_free (buffers);
+  buffers = NULL;
+
+  outbuffer = push_lpcm (dvdlpcmdec, 24, 1, lpcm_24bit, sizeof (lpcm_24bit));
+  fail_unless_equals_int (GST_BUFFER_SIZE (outbuffer), sizeof (lpcm_24bit));
+  data = GST_BUFFER_DATA (outbuffer);
+  check_sample (((gint32) GST_READ_UINT24_BE (data) << 8) >> 8,
+      0x100000 * factor);
+  fail_unless_equals_int (GST_READ_UINT24_BE (data + 3), 0x7fffff);
+  fail_unless_equals_int (GST_READ_UINT24_BE (data + 6), 0x800000);
+  fail_unless_equals_int (GST_READ_UINT24_BE (data + 9), 0);
+
+  cleanup_dvdlpcmdec (dvdlpcmdec);
+}
+
+GST_END_TEST;
+
+/* the ReplayGain from tags is added and limited by the tagged peak */
+GST_START_TEST (test_replaygain_peak)
+{
+  GstElement *dvdlpcmdec;
+  GstBuffer *outbuffer;
+  GstTagList *list;
+  const guint8 *data;
+
+  dvdlpcmdec = setup_dvdlpcmdec ();
+  g_object_set (dvdlpcmdec, "replaygain", TRUE, NULL);
+  fail_unless (gst_element_set_state (dvdlpcmdec,
+          GST_STATE_PLAYING) == GST_STATE_CHANGE_SUCCESS,
+      "could not set to playing");
+
+  /* +12 dB, but a peak of 0.5 only allows about +6 dB */
+  list = gst_tag_list_new ();
+  gst_tag_list_add (list, GST_TAG_MERGE_REPLACE, GST_TAG_TRACK_GAIN, 12.0,
+      GST_TAG_TRACK_PEAK, 0.5, NULL);
+  fail_unless (gst_pad_push_event (mysrcpad, gst_event_new_tag (list)));
+
+  outbuffer = push_lpcm (dvdlpcmdec, 16, 1, lpcm_16bit, sizeof (lpcm_16bit));
+  data = GST_BUFFER_DATA (outbuffer);
+  check_sample ((gint16) GST_READ_UINT16_BE (data), 0x1000 * 2.0);
+  check_sample ((gint16) GST_READ_UINT16_BE (data + 2), 32767);
+  check_sample ((gint16) GST_READ_UINT16_BE (data + 4), -0x4000 * 2.0);
+
+  cleanup_dvdlpcmdec (dvdlpcmdec);
+}
+
+GST_END_TEST;
+
+static Suite *
+dvdlpcmdec_suite (void)
+{
+  Suite *s = suite_create ("dvdlpcmdec");
+  TCase *tc_chain = tcase_create ("general");
+
+  suite_add_tcase (s, tc_chain);
+  tcase_add_test (tc_chain, test_20bit_unpack);
+  tcase_add_test (tc_chain, test_gain_clipping);
+  tcase_add_test (tc_chain, test_replaygain_peak);
+
+  return s;
+}
+
+int
+main (int argc, char **argv)
+{
+  int nf;
+
+  Suite *s = dvdlpcmdec_suite ();
+  SRunner *sr = srunner_create (s);
+
+  gst_check_init (&argc, &argv);
+
+  srunner_run_all (sr, CK_NORMAL);
+  nf = srunner_ntests_failed (sr);
+  srunner_free (sr);
+
+  return nf;
+}
@@ -0,0 +1,115 @@
+/* GStreamer
+ *
+ * unit test for lame
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 59 Temple Place - Suite 330,
+ * Boston, MA 02111-1307, USA.
+ */
+
+#include <gst/check/gstcheck.h>
+
+#include <lame/lame.h>
+
+/* works for int, enum and boolean properties */
+static void
+check_property (GstElement * lame, const gchar * name, gint expected)
+{
+  gint value;
+
+  g_object_get (lame, name, &value, NULL);
+  fail_unless (value == expected, "%s defaults to %d, LAME uses %d", name,
+      value, expected);
+}
+
+/* the element's defaults are compile-time constants, they have to match
+ * what the library sets up for 44.1 kHz stereo input */
+GST_START_TEST (test_default_properties)
+{
+  lame_global_flags *lgf;
+  GstElement *lame;
+
+  lgf = lame_init ();
+  fail_unless (lgf != NULL);
+  fail_unless (lame_init_params (lgf) >= 0);
+
+  lame = gst_check_setup_element ("lame");
+
+  check_property (lame, "bitrate", lame_get_brate (lgf));
+  check_property (lame, "quality", lame_get_quality (lgf));
+  check_property (lame, "mode", lame_get_mode (lgf));
+  check_property (lame, "force-ms", lame_get_force_ms (lgf));
+  check_property (lame, "free-format", lame_get_free_format (lgf));
+  check_property (lame, "copyright", lame_get_copyright (lgf));
+  check_property (lame, "original", lame_get_original (lgf));
+  check_property (lame, "error-protection", lame_get_error_protection (lgf));
+  check_property (lame, "extension", lame_get_extension (lgf));
+  check_property (lame, "strict-iso", lame_get_strict_ISO (lgf));
+  check_property (lame, "disable-reservoir",
+      lame_get_disable_reservoir (lgf));
+  check_property (lame, "vbr", lame_get_VBR (lgf));
+  check_property (lame, "vbr-quality", lame_get_VBR_q (lgf));
+  check_property (lame, "vbr-mean-bitrate",
+      lame_get_VBR_mean_bitrate_kbps (lgf));
+  check_property (lame, "vbr-min-bitrate",
+      lame_get_VBR_min_bitrate_kbps (lgf));
+  check_property (lame, "vbr-max-bitrate",
+      lame_get_VBR_max_bitrate_kbps (lgf));
+  check_property (lame, "vbr-hard-min", lame_get_VBR_hard_min (lgf));
+  check_property (lame, "lowpass-freq", lame_get_lowpassfreq (lgf));
+  check_property (lame, "lowpass-width", lame_get_lowpasswidth (lgf));
+  check_property (lame, "highpass-freq", lame_get_highpassfreq (lgf));
+  check_property (lame, "highpass-width", lame_get_highpasswidth (lgf));
+  check_property (lame, "ath-only", lame_get_ATHonly (lgf));
+  check_property (lame, "ath-short", lame_get_ATHshort (lgf));
+  check_property (lame, "no-ath", lame_get_noATH (lgf));
+  check_property (lame, "ath-lower", lame_get_ATHlower (lgf));
+  check_property (lame, "allow-diff-short", lame_get_allow_diff_short (lgf));
+  check_property (lame, "no-short-blocks", lame_get_no_short_blocks (lgf));
+  check_property (lame, "emphasis", lame_get_emphasis (lgf));
+
+  gst_check_teardown_element (lame);
+  lame_close (lgf);
+}
+
+GST_END_TEST;
+
+static Suite *
+lame_suite (void)
+{
+  Suite *s = suite_create ("lame");
+  TCase *tc_chain = tcase_create ("general");
+
+  suite_add_tcase (s, tc_chain);
+  tcase_add_test (tc_chain, test_default_properties);
+
+  return s;
+}
+
+int
+main (int argc, char **argv)
+{
+  int nf;
+
+  Suite *s = lame_suite ();
+  SRunner *sr = srunner_create (s);
+
+  gst_check_init (&argc, &argv);
+
+  srunner_run_all (sr, CK_NORMAL);
+  nf = srunner_ntests_failed (sr);
+  srunner_free (sr);
+
+  return nf;
+}
@@ -1338,21 +1338,33 @@ static GstStaticPadTemplate srctemplate = GST_STATIC_PAD_TEMPLATE ("src",
         "systemstream=(boolean)false, " "mpegversion=(int)2")
     );
 
-GstElement *
-setup_mpeg2dec ()
+/* only accepts half the size of test_stream1 */
+static GstStaticPadTemplate halfsinktemplate = GST_STATIC_PAD_TEMPLATE ("sink",
+    GST_PAD_SINK,
+    GST_PAD_ALWAYS,
+    GST_STATIC_CAPS ("video/x-raw-yuv, width = (int) 88, height = (int) 72"));
+
+static GstElement *
+setup_mpeg2dec_with_sink (GstStaticPadTemplate * sink_template)
 {
   GstElement *mpeg2dec;
 
   GST_DEBUG ("setup_mpeg2dec");
   mpeg2dec = gst_check_setup_element ("mpeg2dec");
   mysrcpad = gst_check_setup_src_pad (mpeg2dec, &srctemplate, NULL);
-  mysinkpad = gst_check_setup_sink_pad (mpeg2dec, &sinktemplate, NULL);
+  mysinkpad = gst_check_setup_sink_pad (mpeg2dec, sink_template, NULL);
   gst_pad_set_active (mysrcpad, TRUE);
   gst_pad_set_active (mysinkpad, TRUE);
 
   return mpeg2dec;
 }
 
+GstElement *
+setup_mpeg2dec ()
+{
+  return setup_mpeg2dec_with_sink (&sinktemplate);
+}
+
 void
 cleanup_mpeg2dec (GstElement * mpeg2dec)
 {
@@ -1500,6 +1512,130 @@ GST_START_TEST (test_decode_stream2)
 
 GST_END_TEST;
 
+GST_START_TEST (test_decode_stream1_half)
+{
+  GstElement *mpeg2dec;
+  GstBuffer *inbuffer, *outbuffer;
+  GstBus *bus;
+  int i, num_buffers;
+  GstCaps *out_caps;
+
+  mpeg2dec = setup_mpeg2dec_with_sink (&halfsinktemplate);
+
+  fail_unless (gst_element_set_state (mpeg2dec,
+          GST_STATE_PLAYING) == GST_STATE_CHANGE_SUCCESS,
+      "could not set to playing");
+  bus = gst_bus_new ();
+
+  inbuffer = gst_buffer_new_and_alloc (sizeof (test_stream1));
+  memcpy (GST_BUFFER_DATA (inbuffer), test_stream1, sizeof (test_stream1));
+  ASSERT_BUFFER_REFCOUNT (inbuffer, "inbuffer", 1);
+  gst_buffer_ref (inbuffer);
+
+  gst_element_set_bus (mpeg2dec, bus);
+
+  /* should decode the buffer without problems */
+  fail_unless_equals_int (gst_pad_push (mysrcpad, inbuffer), GST_FLOW_OK);
+
+  gst_buffer_unref (inbuffer);
+
+  num_buffers = g_list_length (buffers);
+
+  /* should be 30 buffers, one per decoded frame */
+  fail_unless_equals_int (num_buffers, 30);
+
+  /* downstream only accepts 88x72, so we should get half the size */
+  out_caps =
+      gst_caps_new_simple ("video/x-raw-yuv", "format", GST_TYPE_FOURCC,
+      GST_STR_FOURCC ("I420"), "width", G_TYPE_INT, 88, "height", G_TYPE_INT,
+      72, "pixel-aspect-ratio", GST_TYPE_FRACTION, 1, 1, "framerate",
+      GST_TYPE_FRACTION, 25, 1, "interlaced", G_TYPE_BOOLEAN, FALSE, NULL);
+
+  for (i = 0; i < num_buffers; ++i) {
+    outbuffer = GST_BUFFER (buffers->data);
+    fail_if (outbuffer == NULL);
+
+    GST_LOG ("buffer caps %" GST_PTR_FORMAT, GST_BUFFER_CAPS (outbuffer));
+    fail_unless (gst_caps_is_equal_fixed (GST_BUFFER_CAPS (outbuffer),
+            out_caps), "Incorrect buffer caps");
+
+    /* I420 with 88x72 must have this size */
+    fail_unless_equals_int (GST_BUFFER_SIZE (outbuffer), 9504);
+
+    buffers = g_list_remove (buffers, outbuffer);
+    gst_buffer_unref (outbuffer);
+    outbuffer = NULL;
+  }
+
+  gst_caps_unref (out_caps);
+  g_list_free (buffers);
+  buffers = NULL;
+
+  gst_bus_set_flushing (bus, TRUE);
+  gst_element_set_bus (mpeg2dec, NULL);
+  gst_object_unref (GST_OBJECT (bus));
+  cleanup_mpeg2dec (mpeg2dec);
+}
+
+GST_END_TEST;
+
+GST_START_TEST (test_decode_stream1_low_delay)
+{
+  GstElement *mpeg2dec;
+  GstBuffer *inbuffer, *outbuffer;
+  GstBus *bus;
+  GstClockTime last_ts = GST_CLOCK_TIME_NONE;
+  GList *l;
+
+  mpeg2dec = setup_mpeg2dec ();
+  g_object_set (mpeg2dec, "low-delay", TRUE, NULL);
+
+  fail_unless (gst_element_set_state (mpeg2dec,
+          GST_STATE_PLAYING) == GST_STATE_CHANGE_SUCCESS,
+      "could not set to playing");
+  bus = gst_bus_new ();
+
+  inbuffer = gst_buffer_new_and_alloc (sizeof (test_stream1));
+  memcpy (GST_BUFFER_DATA (inbuffer), test_stream1, sizeof (test_stream1));
+  ASSERT_BUFFER_REFCOUNT (inbuffer, "inbuffer", 1);
+  gst_buffer_ref (inbuffer);
+
+  gst_element_set_bus (mpeg2dec, bus);
+
+  /* should decode the buffer without problems */
+  fail_unless_equals_int (gst_pad_push (mysrcpad, inbuffer), GST_FLOW_OK);
+
+  gst_buffer_unref (inbuffer);
+
+  /* the stream has no B-frames, so from the second GOP on every picture is
+   * pushed once it is decoded instead of waiting for the next reference
+   * picture: one buffer more than without low-delay */
+  fail_unless_equals_int (g_list_length (buffers), 31);
+
+  /* each picture is pushed once and in display order */
+  for (l = buffers; l; l = l->next) {
+    outbuffer = GST_BUFFER (l->data);
+
+    fail_unless (GST_BUFFER_TIMESTAMP_IS_VALID (outbuffer));
+    if (GST_CLOCK_TIME_IS_VALID (last_ts))
+      fail_unless (GST_BUFFER_TIMESTAMP (outbuffer) > last_ts);
+    last_ts = GST_BUFFER_TIMESTAMP (outbuffer);
+
+    fail_unless_equals_int (GST_BUFFER_SIZE (outbuffer), 38016);
+  }
+
+  g_list_foreach (buffers, (GFunc) gst_mini_object_unref, NULL);
+  g_list_free (buffers);
+  buffers = NULL;
+
+  gst_bus_set_flushing (bus, TRUE);
+  gst_element_set_bus (mpeg2dec, NULL);
+  gst_object_unref (GST_OBJECT (bus));
+  cleanup_mpeg2dec (mpeg2dec);
+}
+
+GST_END_TEST;
+
 GST_START_TEST (test_decode_garbage)
 {
   GstElement *mpeg2dec;
@@ -1556,6 +1692,8 @@ mpeg2dec_suite (void)
   suite_add_tcase (s, tc_chain);
   tcase_add_test (tc_chain, test_decode_stream1);
   tcase_add_test (tc_chain, test_decode_stream2);
+  tcase_add_test (tc_chain, test_decode_stream1_half);
+  tcase_add_test (tc_chain, test_decode_stream1_low_delay);
   tcase_add_test (tc_chain, test_decode_garbage);
 
   return s;
@@ -0,0 +1,334 @@
+/* GStreamer
+ *
+ * unit test for mp3parse
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 59 Temple Place - Suite 330,
+ * Boston, MA 02111-1307, USA.
+ */
+
+#include <unistd.h>
+
+#include <gst/check/gstcheck.h>
+
+/* For ease of programming we use globals to keep refs for our floating
+ * src and sink pads we create; otherwise we always have to do get_pad,
+ * get_peer, and then remove references in every test function */
+static GstPad *mysrcpad, *mysinkpad;
+
+static GstStaticPadTemplate sinktemplate = GST_STATIC_PAD_TEMPLATE ("sink",
+    GST_PAD_SINK,
+    GST_PAD_ALWAYS,
+    GST_STATIC_CAPS ("audio/mpeg"));
+
+static GstStaticPadTemplate srctemplate = GST_STATIC_PAD_TEMPLATE ("src",
+    GST_PAD_SRC,
+    GST_PAD_ALWAYS,
+    GST_STATIC_CAPS_ANY);
+
+/* MPEG-1 layer III, 128 kbit/s, 44100 Hz, joint stereo, no CRC */
+#define FRAME_HEADER 0xfffb9064
+/* the same with CRC */
+#define FRAME_HEADER_CRC 0xfffa9064
+/* the same at 48000 Hz */
+#define FRAME_HEADER_48K 0xfffa9464
+/* MPEG-1 layer II, 128 kbit/s, 44100 Hz, joint stereo, with CRC */
+#define FRAME_HEADER_LAYER2_CRC 0xfffc8064
+/* 144 * 128000 / 44100, for both layers */
+#define FRAME_SIZE 417
+/* layer III side info of MPEG-1 stereo frames */
+#define SIDE_INFO_SIZE 32
+
+#define MPEG_CAPS_STRING "audio/mpeg, " \
+    "mpegversion = (int) 1, " \
+    "layer = (int) 3, " \
+    "parsed = (boolean) false"
+
+static GstElement *
+setup_mp3parse (void)
+{
+  GstElement *mp3parse;
+
+  GST_DEBUG ("setup_mp3parse");
+  mp3parse = gst_check_setup_element ("mp3parse");
+  mysrcpad = gst_check_setup_src_pad (mp3parse, &srctemplate, NULL);
+  mysinkpad = gst_check_setup_sink_pad (mp3parse, &sinktemplate, NULL);
+  gst_pad_set_active (mysrcpad, TRUE);
+  gst_pad_set_active (mysinkpad, TRUE);
+
+  return mp3parse;
+}
+
+static void
+cleanup_mp3parse (GstElement * mp3parse)
+{
+  GST_DEBUG ("cleanup_mp3parse");
+  gst_element_set_state (mp3parse, GST_STATE_NULL);
+
+  g_list_foreach (buffers, (GFunc) gst_mini_object_unref, NULL);
+  g_list_free (buffers);
+  buffers = NULL;
+
+  gst_pad_set_active (mysrcpad, FALSE);
+  gst_pad_set_active (mysinkpad, FALSE);
+  gst_check_teardown_src_pad (mp3parse);
+  gst_check_teardown_sink_pad (mp3parse);
+  gst_check_teardown_element (mp3parse);
+}
+
+static guint
+crc16_update (guint crc, const guint8 * data, guint len)
+{
+  guint i, j;
+
+  for (i = 0; i < len; i++) {
+    crc ^= data[i] << 8;
+    for (j = 0; j < 8; j++)
+      crc = (crc & 0x8000) ? (crc << 1) ^ 0x8005 : crc << 1;
+  }
+
+  return crc & 0xffff;
+}
+
+/* returns a buffer with @garbage zero bytes followed by @frames silent
+ * frames with @header. Protected frames get the checksum a layer III frame
+ * would have, over the last two header bytes and the side info */
+static GstBuffer *
+make_frames (guint32 header, guint garbage, guint frames)
+{
+  GstBuffer *buf;
+  guint8 *data;
+  guint i, crc;
+
+  buf = gst_buffer_new_and_alloc (garbage + frames * FRAME_SIZE);
+  data = GST_BUFFER_DATA (buf);
+  memset (data, 0, GST_BUFFER_SIZE (buf));
+  for (i = 0; i < frames; i++) {
+    guint8 *frame = data + garbage + i * FRAME_SIZE;
+
+    GST_WRITE_UINT32_BE (frame, header);
+    if (!(header & 0x10000)) {
+      /* put some bits into the side info */
+      frame[6] = 0x5a;
+      crc = crc16_update (0xffff, frame + 2, 2);
+      crc = crc16_update (crc, frame + 6, SIDE_INFO_SIZE);
+      GST_WRITE_UINT16_BE (frame + 4, crc);
+    }
+  }
+
+  return buf;
+}
+
+/* pushes @garbage zero bytes followed by @frames silent frames */
+static void
+push_frames (guint garbage, guint frames)
+{
+  fail_unless (gst_pad_push (mysrcpad, make_frames (FRAME_HEADER, garbage,
+              frames)) == GST_FLOW_OK);
+}
+
+static guint64
+get_stat (GstElement * mp3parse, const gchar * field)
+{
+  GstStructure *stats;
+  guint64 value;
+
+  g_object_get (mp3parse, "stats", &stats, NULL);
+  fail_unless (stats != NULL);
+  fail_unless (gst_structure_has_name (stats, "mp3parse-stats"));
+  fail_unless (gst_structure_get_uint64 (stats, field, &value));
+  gst_structure_free (stats);
+
+  return value;
+}
+
+/* junk before the first frame is skipped without counting a lost sync, junk
+ * between frames is counted as both */
+GST_START_TEST (test_stats)
+{
+  GstElement *mp3parse;
+  guint interval;
+
+  mp3parse = setup_mp3parse ();
+  g_object_set (mp3parse, "stats-interval", 500, NULL);
+  g_object_get (mp3parse, "stats-interval", &interval, NULL);
+  fail_unless_equals_int (interval, 500);
+
+  fail_unless (gst_element_set_state (mp3parse,
+          GST_STATE_PLAYING) == GST_STATE_CHANGE_SUCCESS,
+      "could not set to playing");
+
+  fail_unless_equals_uint64 (get_stat (mp3parse, "frames"), 0);
+
+  push_frames (5, 8);
+  fail_unless_equals_int (g_list_length (buffers), 8);
+  fail_unless_equals_uint64 (get_stat (mp3parse, "frames"), 8);
+  fail_unless_equals_uint64 (get_stat (mp3parse, "resyncs"), 0);
+  fail_unless_equals_uint64 (get_stat (mp3parse, "skipped-bytes"), 5);
+
+  push_frames (3, 4);
+  fail_unless_equals_int (g_list_length (buffers), 12);
+  fail_unless_equals_uint64 (get_stat (mp3parse, "frames"), 12);
+  fail_unless_equals_uint64 (get_stat (mp3parse, "resyncs"), 1);
+  fail_unless_equals_uint64 (get_stat (mp3parse, "skipped-bytes"), 8);
+
+  /* the counters are kept over state changes */
+  fail_unless (gst_element_set_state (mp3parse,
+          GST_STATE_READY) == GST_STATE_CHANGE_SUCCESS);
+  fail_unless_equals_uint64 (get_stat (mp3parse, "frames"), 12);
+
+  cleanup_mp3parse (mp3parse);
+}
+
+GST_END_TEST;
+
+static GstElement *
+setup_fast_start (gboolean fast_start)
+{
+  GstElement *mp3parse;
+
+  mp3parse = setup_mp3parse ();
+  g_object_set (mp3parse, "fast-start", fast_start, NULL);
+  fail_unless (gst_element_set_state (mp3parse,
+          GST_STATE_PLAYING) == GST_STATE_CHANGE_SUCCESS,
+      "could not set to playing");
+
+  return mp3parse;
+}
+
+/* a single layer III frame with a good CRC is pushed right away, without
+ * fast-start it waits for the following frames */
+GST_START_TEST (test_fast_start_crc)
+{
+  GstElement *mp3parse;
+
+  mp3parse = setup_fast_start (FALSE);
+  fail_unless (gst_pad_push (mysrcpad, make_frames (FRAME_HEADER_CRC, 0,
+              1)) == GST_FLOW_OK);
+  fail_unless_equals_int (g_list_length (buffers), 0);
+  cleanup_mp3parse (mp3parse);
+
+  mp3parse = setup_fast_start (TRUE);
+  fail_unless (gst_pad_push (mysrcpad, make_frames (FRAME_HEADER_CRC, 0,
+              1)) == GST_FLOW_OK);
+  fail_unless_equals_int (g_list_length (buffers), 1);
+  fail_unless_equals_int (GST_BUFFER_SIZE (buffers->data), FRAME_SIZE);
+  cleanup_mp3parse (mp3parse);
+}
+
+GST_END_TEST;
+
+GST_START_TEST (test_fast_start_bad_crc)
+{
+  GstElement *mp3parse;
+  GstBuffer *inbuffer;
+
+  mp3parse = setup_fast_start (TRUE);
+  inbuffer = make_frames (FRAME_HEADER_CRC, 0, 1);
+  GST_BUFFER_DATA (inbuffer)[4] ^= 0xff;
+  fail_unless (gst_pad_push (mysrcpad, inbuffer) == GST_FLOW_OK);
+  fail_unless_equals_int (g_list_length (buffers), 0);
+  cleanup_mp3parse (mp3parse);
+}
+
+GST_END_TEST;
+
+/* the CRC of layer I and II frames covers a variable range and is not
+ * checked, even if it would match for layer III */
+GST_START_TEST (test_fast_start_layer2)
+{
+  GstElement *mp3parse;
+
+  mp3parse = setup_fast_start (TRUE);
+  fail_unless (gst_pad_push (mysrcpad, make_frames (FRAME_HEADER_LAYER2_CRC,
+              0, 1)) == GST_FLOW_OK);
+  fail_unless_equals_int (g_list_length (buffers), 0);
+  cleanup_mp3parse (mp3parse);
+}
+
+GST_END_TEST;
+
+/* upstream caps vouch for an unprotected frame */
+GST_START_TEST (test_fast_start_caps)
+{
+  GstElement *mp3parse;
+  GstBuffer *inbuffer;
+  GstCaps *caps;
+
+  mp3parse = setup_fast_start (TRUE);
+  inbuffer = make_frames (FRAME_HEADER, 0, 1);
+  caps = gst_caps_from_string (MPEG_CAPS_STRING);
+  gst_buffer_set_caps (inbuffer, caps);
+  gst_caps_unref (caps);
+  fail_unless (gst_pad_push (mysrcpad, inbuffer) == GST_FLOW_OK);
+  fail_unless_equals_int (g_list_length (buffers), 1);
+  cleanup_mp3parse (mp3parse);
+}
+
+GST_END_TEST;
+
+/* if the header after a fast-started frame doesn't match, the sync is
+ * counted as lost and the strict check is used again */
+GST_START_TEST (test_fast_start_false_sync)
+{
+  GstElement *mp3parse;
+
+  mp3parse = setup_fast_start (TRUE);
+  fail_unless (gst_pad_push (mysrcpad, make_frames (FRAME_HEADER_CRC, 0,
+              1)) == GST_FLOW_OK);
+  fail_unless_equals_int (g_list_length (buffers), 1);
+
+  fail_unless (gst_pad_push (mysrcpad, make_frames (FRAME_HEADER_48K, 0,
+              1)) == GST_FLOW_OK);
+  fail_unless_equals_int (g_list_length (buffers), 1);
+  fail_unless_equals_uint64 (get_stat (mp3parse, "resyncs"), 1);
+
+  cleanup_mp3parse (mp3parse);
+}
+
+GST_END_TEST;
+
+static Suite *
+mpegaudioparse_suite (void)
+{
+  Suite *s = suite_create ("mpegaudioparse");
+  TCase *tc_chain = tcase_create ("general");
+
+  suite_add_tcase (s, tc_chain);
+  tcase_add_test (tc_chain, test_stats);
+  tcase_add_test (tc_chain, test_fast_start_crc);
+  tcase_add_test (tc_chain, test_fast_start_bad_crc);
+  tcase_add_test (tc_chain, test_fast_start_layer2);
+  tcase_add_test (tc_chain, test_fast_start_caps);
+  tcase_add_test (tc_chain, test_fast_start_false_sync);
+
+  return s;
+}
+
+int
+main (int argc, char **argv)
+{
+  int nf;
+
+  Suite *s = mpegaudioparse_suite ();
+  SRunner *sr = srunner_create (s);
+
+  gst_check_init (&argc, &argv);
+
+  srunner_run_all (sr, CK_NORMAL);
+  nf = srunner_ntests_failed (sr);
+  srunner_free (sr);
+
+  return nf;
+}
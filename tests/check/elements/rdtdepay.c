@@ -0,0 +1,260 @@
+/* GStreamer
+ *
+ * unit test for rdtdepay
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 59 Temple Place - Suite 330,
+ * Boston, MA 02111-1307, USA.
+ */
+
+#include <unistd.h>
+
+#include <gst/check/gstcheck.h>
+
+/* For ease of programming we use globals to keep refs for our floating
+ * src and sink pads we create; otherwise we always have to do get_pad,
+ * get_peer, and then remove references in every test function */
+static GstPad *mysrcpad, *mysinkpad;
+/* buffer lists received on mysinkpad */
+static GList *lists;
+
+static GstStaticPadTemplate sinktemplate = GST_STATIC_PAD_TEMPLATE ("sink",
+    GST_PAD_SINK,
+    GST_PAD_ALWAYS,
+    GST_STATIC_CAPS ("application/vnd.rn-realmedia"));
+
+static GstStaticPadTemplate srctemplate = GST_STATIC_PAD_TEMPLATE ("src",
+    GST_PAD_SRC,
+    GST_PAD_ALWAYS,
+    GST_STATIC_CAPS ("application/x-rdt"));
+
+/* the RealMedia header rdtdepay pushes before the first packet */
+static const guint8 test_config[] = { '.', 'R', 'M', 'F' };
+
+#define PAYLOAD_SIZE 6
+
+/* two RDT data packets for stream 0 with a length field, sequence numbers
+ * 0 and 1 and timestamps 1000 and 1040. The first is a keyframe. Both have
+ * the same length, as gst_rdt_packet_move_to_next() reads the length of
+ * every packet from the first one */
+static const guint8 test_rdt[] = {
+  0x80, 0x00, 0x00, 0x00, 0x10, 0x00, 0x00, 0x00, 0x03, 0xe8,
+  0x01, 0x02, 0x03, 0x04, 0x05, 0x06,
+  0x80, 0x00, 0x01, 0x00, 0x10, 0x01, 0x00, 0x00, 0x04, 0x10,
+  0x11, 0x12, 0x13, 0x14, 0x15, 0x16
+};
+
+/* the RealMedia data packet headers rdtdepay makes for them */
+static const guint8 test_rm_headers[2][12] = {
+  {0x00, 0x00, 0x00, 0x12, 0x00, 0x00, 0x00, 0x00, 0x03, 0xe8, 0x00, 0x02},
+  {0x00, 0x00, 0x00, 0x12, 0x00, 0x00, 0x00, 0x00, 0x04, 0x10, 0x00, 0x00}
+};
+
+static GstFlowReturn
+chain_list (GstPad * pad, GstBufferList * list)
+{
+  lists = g_list_append (lists, list);
+
+  return GST_FLOW_OK;
+}
+
+static GstElement *
+setup_rdtdepay (gboolean use_lists)
+{
+  GstElement *rdtdepay;
+
+  GST_DEBUG ("setup_rdtdepay");
+  rdtdepay = gst_check_setup_element ("rdtdepay");
+  mysrcpad = gst_check_setup_src_pad (rdtdepay, &srctemplate, NULL);
+  mysinkpad = gst_check_setup_sink_pad (rdtdepay, &sinktemplate, NULL);
+  if (use_lists)
+    gst_pad_set_chain_list_function (mysinkpad, chain_list);
+  gst_pad_set_active (mysrcpad, TRUE);
+  gst_pad_set_active (mysinkpad, TRUE);
+
+  return rdtdepay;
+}
+
+static void
+cleanup_rdtdepay (GstElement * rdtdepay)
+{
+  GST_DEBUG ("cleanup_rdtdepay");
+  gst_element_set_state (rdtdepay, GST_STATE_NULL);
+
+  g_list_foreach (buffers, (GFunc) gst_mini_object_unref, NULL);
+  g_list_free (buffers);
+  buffers = NULL;
+  g_list_foreach (lists, (GFunc) gst_mini_object_unref, NULL);
+  g_list_free (lists);
+  lists = NULL;
+
+  gst_pad_set_active (mysrcpad, FALSE);
+  gst_pad_set_active (mysinkpad, FALSE);
+  gst_check_teardown_src_pad (rdtdepay);
+  gst_check_teardown_sink_pad (rdtdepay);
+  gst_check_teardown_element (rdtdepay);
+}
+
+/* pushes test_rdt and returns the buffer that was pushed, with a ref */
+static GstBuffer *
+push_rdt (void)
+{
+  GstBuffer *config, *inbuffer;
+  GstCaps *caps;
+
+  config = gst_buffer_new_and_alloc (sizeof (test_config));
+  memcpy (GST_BUFFER_DATA (config), test_config, sizeof (test_config));
+  caps = gst_caps_new_simple ("application/x-rdt",
+      "media", G_TYPE_STRING, "application",
+      "clock-rate", G_TYPE_INT, 1000,
+      "encoding-name", G_TYPE_STRING, "X-REAL-RDT",
+      "config", GST_TYPE_BUFFER, config, NULL);
+  gst_buffer_unref (config);
+
+  inbuffer = gst_buffer_new_and_alloc (sizeof (test_rdt));
+  memcpy (GST_BUFFER_DATA (inbuffer), test_rdt, sizeof (test_rdt));
+  GST_BUFFER_TIMESTAMP (inbuffer) = 0;
+  gst_buffer_set_caps (inbuffer, caps);
+  gst_caps_unref (caps);
+
+  gst_buffer_ref (inbuffer);
+  fail_unless (gst_pad_push (mysrcpad, inbuffer) == GST_FLOW_OK);
+
+  return inbuffer;
+}
+
+/* the config buffer is pushed on its own first */
+static void
+check_config (void)
+{
+  GstBuffer *outbuffer;
+
+  fail_unless (buffers != NULL);
+  outbuffer = GST_BUFFER (buffers->data);
+  fail_unless_equals_int (GST_BUFFER_SIZE (outbuffer), sizeof (test_config));
+  fail_unless (memcmp (GST_BUFFER_DATA (outbuffer), test_config,
+          sizeof (test_config)) == 0);
+}
+
+/* all data packets of one RDT buffer arrive as one list with a group of a
+ * RealMedia header and a payload sub-buffer per packet */
+GST_START_TEST (test_buffer_list)
+{
+  GstElement *rdtdepay;
+  GstBuffer *inbuffer, *header, *payload;
+  GstBufferListIterator *it;
+  guint i;
+
+  rdtdepay = setup_rdtdepay (TRUE);
+  fail_unless (gst_element_set_state (rdtdepay,
+          GST_STATE_PLAYING) == GST_STATE_CHANGE_SUCCESS,
+      "could not set to playing");
+
+  inbuffer = push_rdt ();
+
+  fail_unless_equals_int (g_list_length (buffers), 1);
+  check_config ();
+
+  fail_unless_equals_int (g_list_length (lists), 1);
+  fail_unless_equals_int (gst_buffer_list_n_groups (lists->data), 2);
+
+  it = gst_buffer_list_iterate (lists->data);
+  for (i = 0; i < 2; i++) {
+    fail_unless (gst_buffer_list_iterator_next_group (it));
+    fail_unless_equals_int (gst_buffer_list_iterator_n_buffers (it), 2);
+
+    header = gst_buffer_list_iterator_next (it);
+    fail_unless_equals_int (GST_BUFFER_SIZE (header), 12);
+    fail_unless (memcmp (GST_BUFFER_DATA (header), test_rm_headers[i],
+            12) == 0);
+    fail_unless_equals_uint64 (GST_BUFFER_TIMESTAMP (header), 0);
+
+    /* the payload points into the RDT buffer, it was not copied */
+    payload = gst_buffer_list_iterator_next (it);
+    fail_unless_equals_int (GST_BUFFER_SIZE (payload), PAYLOAD_SIZE);
+    fail_unless (GST_BUFFER_DATA (payload) == GST_BUFFER_DATA (inbuffer) +
+        (i + 1) * 16 - PAYLOAD_SIZE);
+  }
+  fail_if (gst_buffer_list_iterator_next_group (it));
+  gst_buffer_list_iterator_free (it);
+
+  gst_buffer_unref (inbuffer);
+  cleanup_rdtdepay (rdtdepay);
+}
+
+GST_END_TEST;
+
+/* without a chain_list function downstream gets each packet as one buffer,
+ * like before rdtdepay used buffer lists */
+GST_START_TEST (test_merged_packets)
+{
+  GstElement *rdtdepay;
+  GstBuffer *inbuffer, *outbuffer;
+  GList *l;
+  guint i;
+
+  rdtdepay = setup_rdtdepay (FALSE);
+  fail_unless (gst_element_set_state (rdtdepay,
+          GST_STATE_PLAYING) == GST_STATE_CHANGE_SUCCESS,
+      "could not set to playing");
+
+  inbuffer = push_rdt ();
+
+  fail_unless_equals_int (g_list_length (buffers), 3);
+  check_config ();
+
+  for (l = buffers->next, i = 0; l; l = l->next, i++) {
+    outbuffer = GST_BUFFER (l->data);
+    fail_unless_equals_int (GST_BUFFER_SIZE (outbuffer), 12 + PAYLOAD_SIZE);
+    fail_unless (memcmp (GST_BUFFER_DATA (outbuffer), test_rm_headers[i],
+            12) == 0);
+    fail_unless (memcmp (GST_BUFFER_DATA (outbuffer) + 12,
+            test_rdt + (i + 1) * 16 - PAYLOAD_SIZE, PAYLOAD_SIZE) == 0);
+  }
+
+  gst_buffer_unref (inbuffer);
+  cleanup_rdtdepay (rdtdepay);
+}
+
+GST_END_TEST;
+
+static Suite *
+rdtdepay_suite (void)
+{
+  Suite *s = suite_create ("rdtdepay");
+  TCase *tc_chain = tcase_create ("general");
+
+  suite_add_tcase (s, tc_chain);
+  tcase_add_test (tc_chain, test_buffer_list);
+  tcase_add_test (tc_chain, test_merged_packets);
+
+  return s;
+}
+
+int
+main (int argc, char **argv)
+{
+  int nf;
+
+  Suite *s = rdtdepay_suite ();
+  SRunner *sr = srunner_create (s);
+
+  gst_check_init (&argc, &argv);
+
+  srunner_run_all (sr, CK_NORMAL);
+  nf = srunner_ntests_failed (sr);
+  srunner_free (sr);
+
+  return nf;
+}
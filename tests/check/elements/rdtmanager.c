@@ -0,0 +1,218 @@
+/* GStreamer
+ *
+ * unit test for rdtmanager
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 59 Temple Place - Suite 330,
+ * Boston, MA 02111-1307, USA.
+ */
+
+#include <unistd.h>
+
+#include <gst/check/gstcheck.h>
+
+/* For ease of programming we use globals to keep refs for our floating
+ * src and sink pads we create; otherwise we always have to do get_pad,
+ * get_peer, and then remove references in every test function */
+static GstPad *mysrcpad, *mysinkpad;
+/* the session source pad rdtmanager adds for the first packet */
+static GstPad *session_srcpad;
+
+#define RDT_CAPS_STRING "application/x-rdt, clock-rate = (int) 1000"
+
+static GstStaticPadTemplate sinktemplate = GST_STATIC_PAD_TEMPLATE ("sink",
+    GST_PAD_SINK,
+    GST_PAD_ALWAYS,
+    GST_STATIC_CAPS ("application/x-rdt"));
+
+static GstStaticPadTemplate srctemplate = GST_STATIC_PAD_TEMPLATE ("src",
+    GST_PAD_SRC,
+    GST_PAD_ALWAYS,
+    GST_STATIC_CAPS (RDT_CAPS_STRING));
+
+static GstCaps *
+request_pt_map (GstElement * rdtmanager, guint session, guint pt,
+    gpointer user_data)
+{
+  return gst_caps_from_string (RDT_CAPS_STRING);
+}
+
+static void
+pad_added (GstElement * rdtmanager, GstPad * pad, gpointer user_data)
+{
+  if (GST_PAD_DIRECTION (pad) != GST_PAD_SRC)
+    return;
+
+  session_srcpad = pad;
+  fail_unless (gst_pad_link (pad, mysinkpad) == GST_PAD_LINK_OK);
+}
+
+static GstElement *
+setup_rdtmanager (void)
+{
+  GstElement *rdtmanager;
+  GstPad *sinkpad;
+
+  GST_DEBUG ("setup_rdtmanager");
+  rdtmanager = gst_check_setup_element ("rdtmanager");
+  g_signal_connect (rdtmanager, "request-pt-map",
+      G_CALLBACK (request_pt_map), NULL);
+  g_signal_connect (rdtmanager, "pad-added", G_CALLBACK (pad_added), NULL);
+
+  mysrcpad = gst_pad_new_from_static_template (&srctemplate, "src");
+  sinkpad = gst_element_get_request_pad (rdtmanager, "recv_rtp_sink_0");
+  fail_unless (sinkpad != NULL);
+  fail_unless (gst_pad_link (mysrcpad, sinkpad) == GST_PAD_LINK_OK);
+  gst_object_unref (sinkpad);
+
+  /* linked to the session source pad once it appears */
+  mysinkpad = gst_pad_new_from_static_template (&sinktemplate, "sink");
+  gst_pad_set_chain_function (mysinkpad, gst_check_chain_func);
+
+  gst_pad_set_active (mysrcpad, TRUE);
+  gst_pad_set_active (mysinkpad, TRUE);
+  session_srcpad = NULL;
+
+  return rdtmanager;
+}
+
+static void
+cleanup_rdtmanager (GstElement * rdtmanager)
+{
+  GstPad *sinkpad;
+
+  GST_DEBUG ("cleanup_rdtmanager");
+  gst_element_set_state (rdtmanager, GST_STATE_NULL);
+
+  gst_pad_set_active (mysrcpad, FALSE);
+  gst_pad_set_active (mysinkpad, FALSE);
+  sinkpad = gst_pad_get_peer (mysrcpad);
+  gst_pad_unlink (mysrcpad, sinkpad);
+  gst_object_unref (sinkpad);
+  if (session_srcpad)
+    gst_pad_unlink (session_srcpad, mysinkpad);
+  gst_object_unref (mysrcpad);
+  gst_object_unref (mysinkpad);
+  gst_check_teardown_element (rdtmanager);
+
+  g_list_foreach (buffers, (GFunc) gst_mini_object_unref, NULL);
+  g_list_free (buffers);
+  buffers = NULL;
+}
+
+/* a data packet without length field for stream 0 */
+static void
+push_data_packet (guint16 seqnum, guint32 rdt_time, GstClockTime arrival)
+{
+  GstBuffer *buf;
+  GstCaps *caps;
+  guint8 *data;
+
+  buf = gst_buffer_new_and_alloc (16);
+  data = GST_BUFFER_DATA (buf);
+  memset (data, 0, 16);
+  data[0] = 0x40;
+  GST_WRITE_UINT16_BE (data + 1, seqnum);
+  data[3] = 0;
+  GST_WRITE_UINT32_BE (data + 4, rdt_time);
+  GST_BUFFER_TIMESTAMP (buf) = arrival;
+
+  caps = gst_caps_from_string (RDT_CAPS_STRING);
+  gst_buffer_set_caps (buf, caps);
+  gst_caps_unref (caps);
+
+  fail_unless (gst_pad_push (mysrcpad, buf) == GST_FLOW_OK);
+}
+
+static GstClockTime
+query_latency (void)
+{
+  GstClockTime min_latency;
+  GstQuery *query;
+
+  query = gst_query_new_latency ();
+  fail_unless (gst_pad_query (session_srcpad, query));
+  gst_query_parse_latency (query, NULL, &min_latency, NULL);
+  gst_query_unref (query);
+
+  return min_latency;
+}
+
+/* the adaptive latency grows with the measured jitter and starts over from
+ * the latency property after the session has been flushed */
+GST_START_TEST (test_adaptive_latency_reset)
+{
+  GstElement *rdtmanager;
+  guint i;
+
+  rdtmanager = setup_rdtmanager ();
+  g_object_set (rdtmanager, "adaptive-latency", TRUE, "latency", 20,
+      "min-latency", 20, NULL);
+  fail_if (gst_element_set_state (rdtmanager,
+          GST_STATE_PLAYING) == GST_STATE_CHANGE_FAILURE,
+      "could not set to playing");
+
+  /* packets every 20ms, every other one arrives 60ms late */
+  for (i = 0; i < 100; i++) {
+    push_data_packet (i, i * 20,
+        i * 20 * GST_MSECOND + ((i % 2) ? 60 * GST_MSECOND : 0));
+  }
+  fail_unless (session_srcpad != NULL);
+  fail_unless (query_latency () >= 50 * GST_MSECOND);
+
+  /* flushing the session forgets the jitter and the reorder delay */
+  fail_if (gst_element_set_state (rdtmanager,
+          GST_STATE_READY) == GST_STATE_CHANGE_FAILURE);
+  fail_if (gst_element_set_state (rdtmanager,
+          GST_STATE_PLAYING) == GST_STATE_CHANGE_FAILURE);
+  fail_unless_equals_uint64 (query_latency (), 20 * GST_MSECOND);
+
+  /* steady packets don't grow it again */
+  for (i = 0; i < 100; i++)
+    push_data_packet (1000 + i, i * 20, i * 20 * GST_MSECOND);
+  fail_unless_equals_uint64 (query_latency (), 20 * GST_MSECOND);
+
+  cleanup_rdtmanager (rdtmanager);
+}
+
+GST_END_TEST;
+
+static Suite *
+rdtmanager_suite (void)
+{
+  Suite *s = suite_create ("rdtmanager");
+  TCase *tc_chain = tcase_create ("general");
+
+  suite_add_tcase (s, tc_chain);
+  tcase_add_test (tc_chain, test_adaptive_latency_reset);
+
+  return s;
+}
+
+int
+main (int argc, char **argv)
+{
+  int nf;
+
+  Suite *s = rdtmanager_suite ();
+  SRunner *sr = srunner_create (s);
+
+  gst_check_init (&argc, &argv);
+
+  srunner_run_all (sr, CK_NORMAL);
+  nf = srunner_ntests_failed (sr);
+  srunner_free (sr);
+
+  return nf;
+}
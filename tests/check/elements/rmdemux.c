@@ -0,0 +1,198 @@
+/* GStreamer
+ *
+ * unit test for rmdemux
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 59 Temple Place - Suite 330,
+ * Boston, MA 02111-1307, USA.
+ */
+
+#include <unistd.h>
+
+#include <gst/check/gstcheck.h>
+
+/* For ease of programming we use globals to keep refs for our floating
+ * src and sink pads we create; otherwise we always have to do get_pad,
+ * get_peer, and then remove references in every test function */
+static GstPad *mysrcpad;
+
+static GstStaticPadTemplate srctemplate = GST_STATIC_PAD_TEMPLATE ("src",
+    GST_PAD_SRC,
+    GST_PAD_ALWAYS,
+    GST_STATIC_CAPS ("application/vnd.rn-realmedia"));
+
+/* .RMF header and the media properties of one RealAudio 1.0 (14.4) stream */
+static const guint8 test_headers[] = {
+  /* .RMF, size 18, version 0, file version 0, 2 headers */
+  '.', 'R', 'M', 'F', 0x00, 0x00, 0x00, 0x12, 0x00, 0x00,
+  0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x02,
+  /* MDPR, size 94, version 0 */
+  'M', 'D', 'P', 'R', 0x00, 0x00, 0x00, 0x5e, 0x00, 0x00,
+  /* stream 0, max and average bitrate 8000 */
+  0x00, 0x00, 0x00, 0x00, 0x1f, 0x40, 0x00, 0x00, 0x1f, 0x40,
+  /* max and average packet size 20, start time 0, preroll 0, duration 1s */
+  0x00, 0x00, 0x00, 0x14, 0x00, 0x00, 0x00, 0x14,
+  0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+  0x00, 0x00, 0x03, 0xe8,
+  /* stream name and mime type */
+  0x0c, 'A', 'u', 'd', 'i', 'o', ' ', 'S', 't', 'r', 'e', 'a', 'm',
+  0x14, 'a', 'u', 'd', 'i', 'o', '/', 'x', '-', 'p', 'n', '-',
+  'r', 'e', 'a', 'l', 'a', 'u', 'd', 'i', 'o',
+  /* 16 bytes of type specific data: .ra header version 3 */
+  0x00, 0x00, 0x00, 0x10,
+  '.', 'r', 'a', 0xfd, 0x00, 0x03, 0x00, 0x00,
+  0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00
+};
+
+/* DATA header without packets */
+static const guint8 test_data_header[] = {
+  'D', 'A', 'T', 'A', 0x00, 0x00, 0x00, 0x12, 0x00, 0x00,
+  0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00
+};
+
+static gint pads_added;
+static gboolean no_more_pads;
+
+static void
+pad_added_cb (GstElement * rmdemux, GstPad * pad, gpointer user_data)
+{
+  /* no-more-pads must come after all pads */
+  fail_if (no_more_pads);
+  pads_added++;
+}
+
+static void
+no_more_pads_cb (GstElement * rmdemux, gpointer user_data)
+{
+  no_more_pads = TRUE;
+}
+
+static GstElement *
+setup_rmdemux (gboolean select_streams)
+{
+  GstElement *rmdemux;
+
+  GST_DEBUG ("setup_rmdemux");
+  rmdemux = gst_check_setup_element ("rmdemux");
+  g_object_set (rmdemux, "select-streams", select_streams, NULL);
+  mysrcpad = gst_check_setup_src_pad (rmdemux, &srctemplate, NULL);
+  gst_pad_set_active (mysrcpad, TRUE);
+
+  pads_added = 0;
+  no_more_pads = FALSE;
+  g_signal_connect (rmdemux, "pad-added", G_CALLBACK (pad_added_cb), NULL);
+  g_signal_connect (rmdemux, "no-more-pads", G_CALLBACK (no_more_pads_cb),
+      NULL);
+
+  return rmdemux;
+}
+
+static void
+cleanup_rmdemux (GstElement * rmdemux)
+{
+  GST_DEBUG ("cleanup_rmdemux");
+  gst_element_set_state (rmdemux, GST_STATE_NULL);
+
+  gst_pad_set_active (mysrcpad, FALSE);
+  gst_check_teardown_src_pad (rmdemux);
+  gst_check_teardown_element (rmdemux);
+}
+
+static void
+push_data (const guint8 * data, guint size)
+{
+  GstBuffer *buf;
+
+  buf = gst_buffer_new_and_alloc (size);
+  memcpy (GST_BUFFER_DATA (buf), data, size);
+  gst_buffer_set_caps (buf, GST_PAD_CAPS (mysrcpad));
+  fail_unless (gst_pad_push (mysrcpad, buf) == GST_FLOW_OK);
+}
+
+/* without stream selection, pads are added as soon as their MDPR chunk has
+ * been parsed, like before stream selection existed */
+GST_START_TEST (test_pads_added_with_headers)
+{
+  GstElement *rmdemux;
+
+  rmdemux = setup_rmdemux (FALSE);
+  fail_unless (gst_element_set_state (rmdemux,
+          GST_STATE_PLAYING) == GST_STATE_CHANGE_SUCCESS,
+      "could not set to playing");
+
+  push_data (test_headers, sizeof (test_headers));
+  fail_unless_equals_int (pads_added, 1);
+  fail_if (no_more_pads);
+
+  push_data (test_data_header, sizeof (test_data_header));
+  fail_unless_equals_int (pads_added, 1);
+  fail_unless (no_more_pads);
+
+  cleanup_rmdemux (rmdemux);
+}
+
+GST_END_TEST;
+
+/* with stream selection, pads are only added once all headers are known */
+GST_START_TEST (test_pads_added_after_selection)
+{
+  GstElement *rmdemux;
+
+  rmdemux = setup_rmdemux (TRUE);
+  fail_unless (gst_element_set_state (rmdemux,
+          GST_STATE_PLAYING) == GST_STATE_CHANGE_SUCCESS,
+      "could not set to playing");
+
+  push_data (test_headers, sizeof (test_headers));
+  fail_unless_equals_int (pads_added, 0);
+  fail_if (no_more_pads);
+
+  push_data (test_data_header, sizeof (test_data_header));
+  fail_unless_equals_int (pads_added, 1);
+  fail_unless (no_more_pads);
+
+  cleanup_rmdemux (rmdemux);
+}
+
+GST_END_TEST;
+
+static Suite *
+rmdemux_suite (void)
+{
+  Suite *s = suite_create ("rmdemux");
+  TCase *tc_chain = tcase_create ("general");
+
+  suite_add_tcase (s, tc_chain);
+  tcase_add_test (tc_chain, test_pads_added_with_headers);
+  tcase_add_test (tc_chain, test_pads_added_after_selection);
+
+  return s;
+}
+
+int
+main (int argc, char **argv)
+{
+  int nf;
+
+  Suite *s = rmdemux_suite ();
+  SRunner *sr = srunner_create (s);
+
+  gst_check_init (&argc, &argv);
+
+  srunner_run_all (sr, CK_NORMAL);
+  nf = srunner_ntests_failed (sr);
+  srunner_free (sr);
+
+  return nf;
+}
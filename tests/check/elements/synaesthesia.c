@@ -0,0 +1,234 @@
+/* GStreamer
+ *
+ * unit test for synaesthesia
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 59 Temple Place - Suite 330,
+ * Boston, MA 02111-1307, USA.
+ */
+
+#include <unistd.h>
+
+#include <gst/check/gstcheck.h>
+
+/* For ease of programming we use globals to keep refs for our floating
+ * src and sink pads we create; otherwise we always have to do get_pad,
+ * get_peer, and then remove references in every test function */
+static GstPad *mysrcpad, *mysinkpad;
+/* what mysinkpad accepts */
+static GstCaps *sink_caps;
+
+#define AUDIO_CAPS_STRING "audio/x-raw-int, " \
+    "rate = (int) 44100, " \
+    "channels = (int) 2, " \
+    "endianness = (int) BYTE_ORDER, " \
+    "width = (int) 16, " \
+    "depth = (int) 16, " \
+    "signed = (boolean) true"
+
+/* one video frame at the default 25 fps */
+#define SAMPLES_PER_FRAME (44100 / 25)
+
+static GstStaticPadTemplate sinktemplate = GST_STATIC_PAD_TEMPLATE ("sink",
+    GST_PAD_SINK,
+    GST_PAD_ALWAYS,
+    GST_STATIC_CAPS ("video/x-raw-rgb; video/x-raw-yuv"));
+
+static GstStaticPadTemplate srctemplate = GST_STATIC_PAD_TEMPLATE ("src",
+    GST_PAD_SRC,
+    GST_PAD_ALWAYS,
+    GST_STATIC_CAPS ("audio/x-raw-int"));
+
+static GstCaps *
+sink_getcaps (GstPad * pad)
+{
+  return gst_caps_ref (sink_caps);
+}
+
+static GstElement *
+setup_synaesthesia (const gchar * caps_string)
+{
+  GstElement *synaesthesia;
+
+  GST_DEBUG ("setup_synaesthesia");
+  synaesthesia = gst_check_setup_element ("synaesthesia");
+  mysrcpad = gst_check_setup_src_pad (synaesthesia, &srctemplate, NULL);
+  mysinkpad = gst_check_setup_sink_pad (synaesthesia, &sinktemplate, NULL);
+  sink_caps = gst_caps_from_string (caps_string);
+  gst_pad_set_getcaps_function (mysinkpad, sink_getcaps);
+  gst_pad_set_active (mysrcpad, TRUE);
+  gst_pad_set_active (mysinkpad, TRUE);
+
+  return synaesthesia;
+}
+
+static void
+cleanup_synaesthesia (GstElement * synaesthesia)
+{
+  GST_DEBUG ("cleanup_synaesthesia");
+  gst_element_set_state (synaesthesia, GST_STATE_NULL);
+
+  g_list_foreach (buffers, (GFunc) gst_mini_object_unref, NULL);
+  g_list_free (buffers);
+  buffers = NULL;
+
+  gst_pad_set_active (mysrcpad, FALSE);
+  gst_pad_set_active (mysinkpad, FALSE);
+  gst_check_teardown_src_pad (synaesthesia);
+  gst_check_teardown_sink_pad (synaesthesia);
+  gst_check_teardown_element (synaesthesia);
+
+  gst_caps_unref (sink_caps);
+  sink_caps = NULL;
+}
+
+/* pushes enough silence for exactly one video frame and returns it */
+static GstBuffer *
+push_frame (GstElement * synaesthesia)
+{
+  GstBuffer *inbuffer;
+  GstCaps *caps;
+  guint size = 2 * SAMPLES_PER_FRAME * 2 * sizeof (gint16);
+
+  fail_unless (gst_element_set_state (synaesthesia,
+          GST_STATE_PLAYING) == GST_STATE_CHANGE_SUCCESS,
+      "could not set to playing");
+
+  /* synaesthesia renders once more than a frame of samples is queued */
+  inbuffer = gst_buffer_new_and_alloc (size);
+  memset (GST_BUFFER_DATA (inbuffer), 0, size);
+  GST_BUFFER_TIMESTAMP (inbuffer) = 0;
+  caps = gst_caps_from_string (AUDIO_CAPS_STRING);
+  gst_buffer_set_caps (inbuffer, caps);
+  gst_caps_unref (caps);
+
+  fail_unless (gst_pad_push (mysrcpad, inbuffer) == GST_FLOW_OK);
+  fail_unless_equals_int (g_list_length (buffers), 1);
+
+  return GST_BUFFER (buffers->data);
+}
+
+static void
+check_format (GstBuffer * outbuffer, const gchar * name, guint32 fourcc,
+    gint width, gint height)
+{
+  GstStructure *s;
+  guint32 format;
+  gint w, h;
+
+  fail_unless (GST_BUFFER_CAPS (outbuffer) != NULL);
+  s = gst_caps_get_structure (GST_BUFFER_CAPS (outbuffer), 0);
+  fail_unless (gst_structure_has_name (s, name));
+  if (fourcc) {
+    fail_unless (gst_structure_get_fourcc (s, "format", &format));
+    fail_unless_equals_int (format, fourcc);
+  }
+  fail_unless (gst_structure_get_int (s, "width", &w));
+  fail_unless (gst_structure_get_int (s, "height", &h));
+  fail_unless_equals_int (w, width);
+  fail_unless_equals_int (h, height);
+}
+
+/* xRGB stays the first choice when downstream takes anything */
+GST_START_TEST (test_prefer_rgb)
+{
+  GstElement *synaesthesia;
+  GstBuffer *outbuffer;
+
+  synaesthesia = setup_synaesthesia ("video/x-raw-rgb; video/x-raw-yuv");
+
+  outbuffer = push_frame (synaesthesia);
+  check_format (outbuffer, "video/x-raw-rgb", 0, 320, 200);
+  fail_unless_equals_int (GST_BUFFER_SIZE (outbuffer), 320 * 200 * 4);
+
+  cleanup_synaesthesia (synaesthesia);
+}
+
+GST_END_TEST;
+
+/* a full Y plane and a quarter-size U and V plane */
+GST_START_TEST (test_i420)
+{
+  GstElement *synaesthesia;
+  GstBuffer *outbuffer;
+
+  synaesthesia = setup_synaesthesia ("video/x-raw-yuv, "
+      "format = (fourcc) I420, "
+      "width = (int) [ 16, 4096 ], "
+      "height = (int) [ 16, 4096 ], "
+      "framerate = (fraction) [ 0/1, 100/1 ]");
+
+  outbuffer = push_frame (synaesthesia);
+  check_format (outbuffer, "video/x-raw-yuv", GST_MAKE_FOURCC ('I', '4', '2',
+          '0'), 320, 200);
+  fail_unless_equals_int (GST_BUFFER_SIZE (outbuffer), 320 * 200 * 3 / 2);
+
+  cleanup_synaesthesia (synaesthesia);
+}
+
+GST_END_TEST;
+
+/* with an odd width the rows are padded to 4 bytes; the interleaved UV plane
+ * has the same stride and half the lines */
+GST_START_TEST (test_nv12_odd_width)
+{
+  GstElement *synaesthesia;
+  GstBuffer *outbuffer;
+
+  synaesthesia = setup_synaesthesia ("video/x-raw-yuv, "
+      "format = (fourcc) NV12, "
+      "width = (int) 15, "
+      "height = (int) 10, "
+      "framerate = (fraction) 25/1");
+
+  outbuffer = push_frame (synaesthesia);
+  check_format (outbuffer, "video/x-raw-yuv", GST_MAKE_FOURCC ('N', 'V', '1',
+          '2'), 15, 10);
+  fail_unless_equals_int (GST_BUFFER_SIZE (outbuffer), 16 * 10 + 16 * 5);
+
+  cleanup_synaesthesia (synaesthesia);
+}
+
+GST_END_TEST;
+
+static Suite *
+synaesthesia_suite (void)
+{
+  Suite *s = suite_create ("synaesthesia");
+  TCase *tc_chain = tcase_create ("general");
+
+  suite_add_tcase (s, tc_chain);
+  tcase_add_test (tc_chain, test_prefer_rgb);
+  tcase_add_test (tc_chain, test_i420);
+  tcase_add_test (tc_chain, test_nv12_odd_width);
+
+  return s;
+}
+
+int
+main (int argc, char **argv)
+{
+  int nf;
+
+  Suite *s = synaesthesia_suite ();
+  SRunner *sr = srunner_create (s);
+
+  gst_check_init (&argc, &argv);
+
+  srunner_run_all (sr, CK_NORMAL);
+  nf = srunner_ntests_failed (sr);
+  srunner_free (sr);
+
+  return nf;
+}
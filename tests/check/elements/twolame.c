@@ -0,0 +1,115 @@
+/* GStreamer
+ *
+ * unit test for twolame
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 59 Temple Place - Suite 330,
+ * Boston, MA 02111-1307, USA.
+ */
+
+#include <gst/check/gstcheck.h>
+
+#include <twolame.h>
+
+/* works for int, enum and boolean properties */
+static void
+check_property (GstElement * twolame, const gchar * name, gint expected)
+{
+  gint value;
+
+  g_object_get (twolame, name, &value, NULL);
+  fail_unless (value == expected, "%s defaults to %d, TwoLAME uses %d", name,
+      value, expected);
+}
+
+static void
+check_float_property (GstElement * twolame, const gchar * name,
+    gfloat expected)
+{
+  gfloat value;
+
+  g_object_get (twolame, name, &value, NULL);
+  fail_unless (value == expected, "%s defaults to %f, TwoLAME uses %f", name,
+      value, expected);
+}
+
+/* the element's defaults are compile-time constants, they have to match
+ * what the library sets up for 44.1 kHz stereo input. The mode is left out,
+ * the element always defaults to joint stereo. */
+GST_START_TEST (test_default_properties)
+{
+  twolame_options *glopts;
+  GstElement *twolame;
+
+  glopts = twolame_init ();
+  fail_unless (glopts != NULL);
+  twolame_set_num_channels (glopts, 2);
+  twolame_set_in_samplerate (glopts, 44100);
+  fail_unless (twolame_init_params (glopts) == 0);
+
+  twolame = gst_check_setup_element ("twolame");
+
+  check_property (twolame, "psymodel", twolame_get_psymodel (glopts));
+  check_property (twolame, "bitrate", twolame_get_bitrate (glopts));
+  check_property (twolame, "padding", twolame_get_padding (glopts));
+  check_property (twolame, "energy-level-extension",
+      twolame_get_energy_levels (glopts));
+  check_property (twolame, "emphasis", twolame_get_emphasis (glopts));
+  check_property (twolame, "error-protection",
+      twolame_get_error_protection (glopts));
+  check_property (twolame, "copyright", twolame_get_copyright (glopts));
+  check_property (twolame, "original", twolame_get_original (glopts));
+  check_property (twolame, "vbr", twolame_get_VBR (glopts));
+  check_float_property (twolame, "vbr-level", twolame_get_VBR_level (glopts));
+  check_float_property (twolame, "ath-level", twolame_get_ATH_level (glopts));
+  check_property (twolame, "vbr-max-bitrate",
+      twolame_get_VBR_max_bitrate_kbps (glopts));
+  check_property (twolame, "quick-mode", twolame_get_quick_mode (glopts));
+  check_property (twolame, "quick-mode-count",
+      twolame_get_quick_count (glopts));
+
+  gst_check_teardown_element (twolame);
+  twolame_close (&glopts);
+}
+
+GST_END_TEST;
+
+static Suite *
+twolame_suite (void)
+{
+  Suite *s = suite_create ("twolame");
+  TCase *tc_chain = tcase_create ("general");
+
+  suite_add_tcase (s, tc_chain);
+  tcase_add_test (tc_chain, test_default_properties);
+
+  return s;
+}
+
+int
+main (int argc, char **argv)
+{
+  int nf;
+
+  Suite *s = twolame_suite ();
+  SRunner *sr = srunner_create (s);
+
+  gst_check_init (&argc, &argv);
+
+  srunner_run_all (sr, CK_NORMAL);
+  nf = srunner_ntests_failed (sr);
+  srunner_free (sr);
+
+  return nf;
+}
@@ -211,6 +211,167 @@ GST_START_TEST (test_video_pad)
 
 GST_END_TEST;
 
+static void
+push_frames (gint start, gint count)
+{
+  GstBuffer *inbuffer;
+  GstCaps *caps;
+  gint i;
+
+  caps = gst_caps_from_string (VIDEO_CAPS_STRING);
+  for (i = start; i < start + count; i++) {
+    inbuffer = gst_buffer_new_and_alloc (384 * 288 * 3 / 2);
+    memset (GST_BUFFER_DATA (inbuffer), i, GST_BUFFER_SIZE (inbuffer));
+    gst_buffer_set_caps (inbuffer, caps);
+    GST_BUFFER_TIMESTAMP (inbuffer) = i * GST_SECOND / 25;
+    GST_BUFFER_DURATION (inbuffer) = GST_SECOND / 25;
+    fail_unless (gst_pad_push (mysrcpad, inbuffer) == GST_FLOW_OK);
+  }
+  gst_caps_unref (caps);
+}
+
+GST_START_TEST (test_reuse_encoder)
+{
+  GstElement *x264enc;
+  GstBuffer *outbuffer;
+  GList *l;
+  guint num_before, seen = 0;
+  gint i;
+
+  x264enc = setup_x264enc ();
+  g_object_set (x264enc, "reuse-encoder", TRUE, "bframes", 2, NULL);
+  fail_unless (gst_element_set_state (x264enc,
+          GST_STATE_PLAYING) == GST_STATE_CHANGE_SUCCESS,
+      "could not set to playing");
+
+  fail_unless (gst_pad_push_event (mysrcpad,
+          gst_event_new_new_segment (FALSE, 1.0, GST_FORMAT_TIME, 0, -1, 0)));
+  push_frames (0, 10);
+
+  /* flushing seek back to the start, frames still in the encoder are
+   * discarded and the new data starts with an IDR frame */
+  num_before = g_list_length (buffers);
+  fail_unless (gst_pad_push_event (mysrcpad, gst_event_new_flush_start ()));
+  fail_unless (gst_pad_push_event (mysrcpad, gst_event_new_flush_stop ()));
+  fail_unless (gst_pad_push_event (mysrcpad,
+          gst_event_new_new_segment (FALSE, 1.0, GST_FORMAT_TIME, 0, -1, 0)));
+  push_frames (0, 5);
+  fail_unless (gst_pad_push_event (mysrcpad, gst_event_new_eos ()));
+
+  l = g_list_nth (buffers, num_before);
+  fail_unless_equals_int (g_list_length (l), 5);
+  outbuffer = GST_BUFFER (l->data);
+  fail_if (GST_BUFFER_FLAG_IS_SET (outbuffer, GST_BUFFER_FLAG_DELTA_UNIT));
+
+  /* the timestamps went backwards, the output still has the input ones */
+  for (; l; l = l->next) {
+    outbuffer = GST_BUFFER (l->data);
+    for (i = 0; i < 5; i++) {
+      if (GST_BUFFER_TIMESTAMP (outbuffer) == i * GST_SECOND / 25)
+        seen |= 1 << i;
+    }
+  }
+  fail_unless_equals_int (seen, 0x1f);
+
+  cleanup_x264enc (x264enc);
+  g_list_foreach (buffers, (GFunc) gst_mini_object_unref, NULL);
+  g_list_free (buffers);
+  buffers = NULL;
+}
+
+GST_END_TEST;
+
+GST_START_TEST (test_segments)
+{
+  GstElement *x264enc;
+  GstBuffer *outbuffer;
+  GList *l;
+  gint i;
+
+  x264enc = setup_x264enc ();
+  g_object_set (x264enc, "segment-frames", 10, "segment-threads", 2, NULL);
+  fail_unless (gst_element_set_state (x264enc,
+          GST_STATE_PLAYING) == GST_STATE_CHANGE_SUCCESS,
+      "could not set to playing");
+
+  fail_unless (gst_pad_push_event (mysrcpad,
+          gst_event_new_new_segment (FALSE, 1.0, GST_FORMAT_TIME, 0, -1, 0)));
+  push_frames (0, 25);
+  fail_unless (gst_pad_push_event (mysrcpad, gst_event_new_eos ()));
+
+  /* all frames in order, every segment starts with an IDR frame */
+  fail_unless_equals_int (g_list_length (buffers), 25);
+  for (l = buffers, i = 0; l; l = l->next, i++) {
+    outbuffer = GST_BUFFER (l->data);
+    fail_unless_equals_uint64 (GST_BUFFER_TIMESTAMP (outbuffer),
+        i * GST_SECOND / 25);
+    if (i % 10 == 0)
+      fail_if (GST_BUFFER_FLAG_IS_SET (outbuffer, GST_BUFFER_FLAG_DELTA_UNIT));
+    /* two IDR frames don't follow each other across segments */
+    if (i % 10 == 9)
+      fail_unless (GST_BUFFER_FLAG_IS_SET (outbuffer,
+              GST_BUFFER_FLAG_DELTA_UNIT));
+  }
+
+  cleanup_x264enc (x264enc);
+  g_list_foreach (buffers, (GFunc) gst_mini_object_unref, NULL);
+  g_list_free (buffers);
+  buffers = NULL;
+}
+
+GST_END_TEST;
+
+/* a requested key unit cuts the segment, one on the first frame of a segment
+ * waits for the second one. The byte limit makes the segments go one by one
+ * but doesn't change the output */
+GST_START_TEST (test_segments_key_unit)
+{
+  GstElement *x264enc;
+  GstBuffer *outbuffer;
+  GList *l;
+  gint i;
+
+  x264enc = setup_x264enc ();
+  g_object_set (x264enc, "segment-frames", 10, "segment-threads", 2,
+      "segment-max-bytes", G_GUINT64_CONSTANT (1), NULL);
+  fail_unless (gst_element_set_state (x264enc,
+          GST_STATE_PLAYING) == GST_STATE_CHANGE_SUCCESS,
+      "could not set to playing");
+
+  fail_unless (gst_pad_push_event (mysrcpad,
+          gst_event_new_new_segment (FALSE, 1.0, GST_FORMAT_TIME, 0, -1, 0)));
+  push_frames (0, 5);
+  fail_unless (gst_pad_push_event (mysrcpad,
+          gst_event_new_custom (GST_EVENT_CUSTOM_DOWNSTREAM,
+              gst_structure_new ("GstForceKeyUnit", NULL))));
+  push_frames (5, 1);
+  fail_unless (gst_pad_push_event (mysrcpad,
+          gst_event_new_custom (GST_EVENT_CUSTOM_DOWNSTREAM,
+              gst_structure_new ("GstForceKeyUnit", NULL))));
+  push_frames (6, 19);
+  fail_unless (gst_pad_push_event (mysrcpad, gst_event_new_eos ()));
+
+  /* segments of 5, 2, 10 and 8 frames */
+  fail_unless_equals_int (g_list_length (buffers), 25);
+  for (l = buffers, i = 0; l; l = l->next, i++) {
+    outbuffer = GST_BUFFER (l->data);
+    fail_unless_equals_uint64 (GST_BUFFER_TIMESTAMP (outbuffer),
+        i * GST_SECOND / 25);
+    if (i == 0 || i == 5 || i == 7 || i == 17)
+      fail_if (GST_BUFFER_FLAG_IS_SET (outbuffer, GST_BUFFER_FLAG_DELTA_UNIT));
+    if (i == 4 || i == 6 || i == 16)
+      fail_unless (GST_BUFFER_FLAG_IS_SET (outbuffer,
+              GST_BUFFER_FLAG_DELTA_UNIT));
+  }
+
+  cleanup_x264enc (x264enc);
+  g_list_foreach (buffers, (GFunc) gst_mini_object_unref, NULL);
+  g_list_free (buffers);
+  buffers = NULL;
+}
+
+GST_END_TEST;
+
 GstCaps *pad_caps;
 
 GstCaps *
@@ -322,6 +483,9 @@ x264enc_suite (void)
   suite_add_tcase (s, tc_chain);
   tcase_add_test (tc_chain, test_video_pad);
   tcase_add_test (tc_chain, test_profile_in_caps);
+  tcase_add_test (tc_chain, test_reuse_encoder);
+  tcase_add_test (tc_chain, test_segments);
+  tcase_add_test (tc_chain, test_segments_key_unit);
 
   return s;
 }